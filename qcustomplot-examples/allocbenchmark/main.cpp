@@ -0,0 +1,159 @@
+#include "../lib/qcustomplot.h"
+
+#include <QApplication>
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// Replots a graph of 1M data points on its own buffered layer, alternating its pen so the graph is
+// redrawn each time, and counts the heap allocations of the steady-state replots (after warm-up)
+// with a replaced global operator new (and, with glibc, malloc, which also catches the QVector and
+// QString allocations of Qt). The temporaries of the drawing code come from the scratch vector
+// pools, so a steady-state replot may only perform a few small allocations for the tick labels and
+// layout bookkeeping. Afterwards, QCustomPlot::releaseMemory must empty the pools.
+// Returns 1 if any check fails.
+
+namespace
+{
+	const int DataCount = 1000000;
+	const int WarmupReplots = 10;
+	const int Replots = 200;
+	const double MaxAllocationsPerReplot = 100;
+	const double MaxBytesPerReplot = 64 * 1024;
+
+	std::atomic<long long> allocationCount(0);
+	std::atomic<long long> allocatedBytes(0);
+
+	inline void countAllocation(std::size_t size)
+	{
+		allocationCount.fetch_add(1, std::memory_order_relaxed);
+		allocatedBytes.fetch_add((long long)size, std::memory_order_relaxed);
+	}
+}
+
+#ifdef __GLIBC__
+extern "C"
+{
+	void* __libc_malloc(std::size_t size);
+	void* __libc_calloc(std::size_t count, std::size_t size);
+	void* __libc_realloc(void* pointer, std::size_t size);
+	void __libc_free(void* pointer);
+
+	void* malloc(std::size_t size)
+	{
+		countAllocation(size);
+		return __libc_malloc(size);
+	}
+
+	void* calloc(std::size_t count, std::size_t size)
+	{
+		countAllocation(count * size);
+		return __libc_calloc(count, size);
+	}
+
+	void* realloc(void* pointer, std::size_t size)
+	{
+		countAllocation(size);
+		return __libc_realloc(pointer, size);
+	}
+
+	void free(void* pointer)
+	{
+		__libc_free(pointer);
+	}
+}
+#endif
+
+void* operator new(std::size_t size)
+{
+#ifdef __GLIBC__
+	void* pointer = malloc(size ? size : 1); // counted by malloc
+#else
+	countAllocation(size);
+	void* pointer = std::malloc(size ? size : 1);
+#endif
+	if (!pointer)
+		throw std::bad_alloc();
+	return pointer;
+}
+
+void* operator new[](std::size_t size)
+{
+	return operator new(size);
+}
+
+void operator delete(void* pointer) noexcept
+{
+	std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept
+{
+	std::free(pointer);
+}
+
+int main(int argc, char* argv[])
+{
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
+	if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+		qputenv("QT_QPA_PLATFORM", "offscreen"); // the plot is never shown
+#endif
+	QApplication a(argc, argv);
+
+	QCustomPlot plot;
+	plot.resize(1200, 800);
+	plot.addLayer(QLatin1String("graph"), plot.layer(QLatin1String("main")), QCustomPlot::limAbove);
+	plot.layer(QLatin1String("graph"))->setMode(QCPLayer::lmBuffered);
+	QCPGraph* graph = plot.addGraph();
+	graph->setLayer(QLatin1String("graph"));
+	QVector<double> keys(DataCount), values(DataCount);
+	for (int i = 0; i < DataCount; ++i)
+	{
+		keys[i] = i;
+		values[i] = qSin(i / 1000.0) + qSin(i / 7.0) * 0.1;
+	}
+	graph->setData(keys, values, true);
+	plot.rescaleAxes();
+
+	const QPen pens[] = { QPen(Qt::blue), QPen(Qt::red) };
+	for (int i = 0; i < WarmupReplots; ++i)
+	{
+		graph->setPen(pens[i % 2]);
+		plot.replot();
+	}
+
+	const long long countBefore = allocationCount.load();
+	const long long bytesBefore = allocatedBytes.load();
+	QElapsedTimer timer;
+	timer.start();
+	for (int i = 0; i < Replots; ++i)
+	{
+		graph->setPen(pens[i % 2]);
+		plot.replot();
+	}
+	const qint64 time = timer.nsecsElapsed();
+	const double allocationsPerReplot = (allocationCount.load() - countBefore) / double(Replots);
+	const double bytesPerReplot = (allocatedBytes.load() - bytesBefore) / double(Replots);
+
+	const qint64 pooledBytes = plot.memoryReport().totalBytes(QCPMemoryReport::mcScratch);
+	plot.releaseMemory();
+	const qint64 releasedPooledBytes = plot.memoryReport().totalBytes(QCPMemoryReport::mcScratch);
+
+	qDebug("%d replots:          %8.2f ms per replot", Replots, time / 1e6 / Replots);
+	qDebug("allocations:         %8.1f per replot", allocationsPerReplot);
+	qDebug("allocated:           %8.1f kB per replot", bytesPerReplot / 1024.0);
+	qDebug("scratch pools:       %8.1f kB, %.1f kB after releaseMemory", pooledBytes / 1024.0, releasedPooledBytes / 1024.0);
+
+	if (allocationsPerReplot > MaxAllocationsPerReplot || bytesPerReplot > MaxBytesPerReplot)
+	{
+		qWarning("FAILED: steady-state replots allocate more than %.0f times or %.0f kB per replot", MaxAllocationsPerReplot, MaxBytesPerReplot / 1024.0);
+		return 1;
+	}
+	if (pooledBytes <= 0 || releasedPooledBytes != 0)
+	{
+		qWarning("FAILED: the scratch vector pools weren't reported or not released");
+		return 1;
+	}
+	return 0;
+}
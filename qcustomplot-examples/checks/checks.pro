@@ -0,0 +1,17 @@
+#-------------------------------------------------
+#
+# Regression checks of library behavior
+#
+#-------------------------------------------------
+
+TARGET = checks
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle
+
+include(../common.pri)
+DESTDIR = $$PROJECT_BINDIR
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+SOURCES += main.cpp
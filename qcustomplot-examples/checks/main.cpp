@@ -0,0 +1,174 @@
+#include "../lib/qcustomplot.h"
+
+#include <QApplication>
+#include <QElapsedTimer>
+
+#include <algorithm>
+
+// Checks library behavior that is hard to see by eye, each in its own function that prints what
+// went wrong. Returns 1 if any check fails.
+
+namespace
+{
+	// A tile source whose cells all have the value 1.
+	class ConstantTileSource : public QCPColorMapTileSource
+	{
+	public:
+		ConstantTileSource(int keySize, int valueSize) : mKeySize(keySize), mValueSize(valueSize) {}
+
+		int keySize() const Q_DECL_OVERRIDE { return mKeySize; }
+		int valueSize() const Q_DECL_OVERRIDE { return mValueSize; }
+		void readCells(int, int, int keyCount, int valueCount, int, double* target) const Q_DECL_OVERRIDE
+		{
+			std::fill(target, target + keyCount * valueCount, 1.0);
+		}
+
+	private:
+		int mKeySize;
+		int mValueSize;
+	};
+
+	// Draws a tiled color map whose size leaves a single cell in the last tile pixel at every mip
+	// level up to 512, upscaled by 16 so a tile pixel spans many output pixels. The map must end at
+	// its upper key and value cell edges, not at the edges of the rounded up last tile pixel.
+	bool checkTiledColorMapBorder()
+	{
+		const int size = 512 * 39 + 1;
+		const double scale = 16;
+		QCustomPlot plot;
+		plot.xAxis->grid()->setVisible(false);
+		plot.yAxis->grid()->setVisible(false);
+		plot.xAxis->setRange(0, 2 * size);
+		plot.yAxis->setRange(0, 2 * size);
+		QCPTiledColorMap* map = new QCPTiledColorMap(plot.xAxis, plot.yAxis);
+		map->setSource(new ConstantTileSource(size, size));
+		map->setKeyRange(QCPRange(0, size - 1));
+		map->setValueRange(QCPRange(0, size - 1));
+		map->setDataRange(QCPRange(0, 1));
+		QCPColorGradient gradient;
+		gradient.setColorStopAt(0, Qt::red);
+		gradient.setColorStopAt(1, Qt::red);
+		map->setGradient(gradient);
+		map->setInterpolate(false);
+
+		const QImage image = plot.toPixmap(300, 300, scale).toImage();
+		const double keyEdge = plot.xAxis->coordToPixel(size - 0.5) * scale;
+		const double valueEdge = plot.yAxis->coordToPixel(size - 0.5) * scale;
+		const double keyMiddle = plot.xAxis->coordToPixel(size / 2.0) * scale;
+		const double valueMiddle = plot.yAxis->coordToPixel(size / 2.0) * scale;
+		const QRgb red = qRgb(255, 0, 0);
+		if (image.pixel(qRound(keyEdge - 4), qRound(valueMiddle)) != red || image.pixel(qRound(keyMiddle), qRound(valueEdge + 4)) != red)
+		{
+			qWarning("FAILED: the tiled color map isn't drawn up to its border");
+			return false;
+		}
+		if (image.pixel(qRound(keyEdge + 4), qRound(valueMiddle)) == red || image.pixel(qRound(keyMiddle), qRound(valueEdge - 4)) == red)
+		{
+			qWarning("FAILED: the tiled color map is drawn beyond its border");
+			return false;
+		}
+		return true;
+	}
+
+	// Gives access to the adaptation of the interaction level to frame times.
+	class InteractionPlot : public QCustomPlot
+	{
+	public:
+		using QCustomPlot::adjustInteractionLevel;
+	};
+
+	// Feeds frame times to the interaction level adaptation. A degradation that makes the next frame
+	// fast must not be lifted by that single fast frame, otherwise the level (and with it the device
+	// pixel ratio of all paint buffers) would flip on every other frame. Lifting it must still
+	// happen after a series of fast frames.
+	bool checkInteractionLevelHysteresis()
+	{
+		const double budget = 16;
+		InteractionPlot plot;
+		plot.setInteractionDegradations(QCP::idDevicePixelRatio);
+		plot.setInteractionFrameBudget(budget);
+		plot.adjustInteractionLevel(2 * budget);
+		if (plot.interactionLevel() != 1)
+		{
+			qWarning("FAILED: a slow frame didn't raise the interaction level");
+			return false;
+		}
+		int levelChanges = 0;
+		for (int i = 0; i < 100; ++i)
+		{
+			const int level = plot.interactionLevel();
+			plot.adjustInteractionLevel(i % 2 == 0 ? budget / 8 : 2 * budget);
+			if (plot.interactionLevel() != level)
+				++levelChanges;
+		}
+		if (levelChanges > 0)
+		{
+			qWarning("FAILED: alternating fast and slow frames changed the interaction level %d times", levelChanges);
+			return false;
+		}
+		for (int i = 0; i < 100 && plot.interactionLevel() > 0; ++i)
+			plot.adjustInteractionLevel(budget / 8);
+		if (plot.interactionLevel() != 0)
+		{
+			qWarning("FAILED: consecutive fast frames didn't lower the interaction level");
+			return false;
+		}
+		return true;
+	}
+
+	// Processes events until the plot replotted, at most for a second. Returns the number of replots.
+	int waitForReplot(QCustomPlot& plot)
+	{
+		int replots = 0;
+		QMetaObject::Connection connection = QObject::connect(&plot, &QCustomPlot::afterReplot, [&replots]() { ++replots; });
+		QElapsedTimer timer;
+		timer.start();
+		while (replots == 0 && timer.elapsed() < 1000)
+			QCoreApplication::processEvents();
+		QObject::disconnect(connection);
+		return replots;
+	}
+
+	// Several queued replot requests are performed by a single replot. The replot statistics must
+	// count each request once, and not count the replot that performs them as another request.
+	bool checkQueuedReplotRequestCount()
+	{
+		const int requestCount = 5;
+		QCustomPlot plot;
+		plot.resize(200, 150);
+		waitForReplot(plot); // the initial replot queued by the constructor
+		plot.setReplotStatisticsEnabled(true);
+		for (int i = 0; i < requestCount; ++i)
+			plot.replot(QCustomPlot::rpQueuedReplot);
+		if (waitForReplot(plot) != 1)
+		{
+			qWarning("FAILED: the queued replot requests weren't performed by a single replot");
+			return false;
+		}
+		const QCPReplotStatistics statistics = plot.replotStatistics();
+		if (statistics.replotRequestCount != requestCount || statistics.coalescedRequestCount != requestCount - 1)
+		{
+			qWarning("FAILED: %d queued replot requests were counted as %d requests, %d coalesced", requestCount,
+			         statistics.replotRequestCount, statistics.coalescedRequestCount);
+			return false;
+		}
+		return true;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
+	if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+		qputenv("QT_QPA_PLATFORM", "offscreen"); // no plot is shown
+#endif
+	QApplication a(argc, argv);
+
+	bool passed = true;
+	passed &= checkTiledColorMapBorder();
+	passed &= checkInteractionLevelHysteresis();
+	passed &= checkQueuedReplotRequestCount();
+	if (passed)
+		qDebug("all checks passed");
+	return passed ? 0 : 1;
+}
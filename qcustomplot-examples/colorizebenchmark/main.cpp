@@ -0,0 +1,152 @@
+#include "../lib/qcustomplot.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+
+// Colorizes 1M cells of double, float and scaled quint16 data, linearly and logarithmically, clamped
+// and periodic, with and without alpha, once with the scalar loops (QCPColorGradient::slNone) and
+// once with each vectorized kernel the CPU supports, and prints the cells per second.
+// The kernels must produce the same colors as the scalar loops, except for logarithmic mappings,
+// where a tiny fraction of cells may be one level off. Returns 1 if they don't.
+
+namespace
+{
+	const int CellCount = 1000000;
+	const int Repetitions = 20;
+	const double MaxLogMismatchRatio = 1e-6;
+
+	enum CellType { ctDouble, ctFloat, ctUInt16 };
+
+	struct Cells
+	{
+		QVector<double> doubles;
+		QVector<float> floats;
+		QVector<quint16> uint16s;
+		QVector<unsigned char> alpha;
+		double scale;
+		double offset;
+	};
+
+	Cells createCells()
+	{
+		Cells cells;
+		cells.doubles.resize(CellCount);
+		cells.floats.resize(CellCount);
+		cells.uint16s.resize(CellCount);
+		cells.alpha.resize(CellCount);
+		cells.scale = 10.0 / 65535.0;
+		cells.offset = 0.001;
+		quint32 state = 12345;
+		for (int i = 0; i < CellCount; ++i)
+		{
+			state = state * 1664525u + 1013904223u; // LCG, so all runs use the same cells
+			const quint16 raw = quint16(state >> 16);
+			cells.uint16s[i] = raw;
+			cells.doubles[i] = raw * cells.scale + cells.offset;
+			cells.floats[i] = float(cells.doubles[i]);
+			cells.alpha[i] = i % 4 == 0 ? 255 : (unsigned char)(state >> 8);
+		}
+		return cells;
+	}
+
+	void colorize(QCPColorGradient& gradient, const Cells& cells, CellType type, bool useAlpha, bool logarithmic, QRgb* scanLine)
+	{
+		const QCPRange range(1, 9);
+		const unsigned char* alpha = cells.alpha.constData();
+		switch (type)
+		{
+		case ctDouble:
+			if (useAlpha)
+				gradient.colorize(cells.doubles.constData(), alpha, range, scanLine, CellCount, 1, logarithmic);
+			else
+				gradient.colorize(cells.doubles.constData(), range, scanLine, CellCount, 1, logarithmic);
+			break;
+		case ctFloat:
+			if (useAlpha)
+				gradient.colorize(cells.floats.constData(), alpha, range, scanLine, CellCount, 1, logarithmic);
+			else
+				gradient.colorize(cells.floats.constData(), range, scanLine, CellCount, 1, logarithmic);
+			break;
+		case ctUInt16:
+			if (useAlpha)
+				gradient.colorize(cells.uint16s.constData(), cells.scale, cells.offset, alpha, range, scanLine, CellCount, 1, logarithmic);
+			else
+				gradient.colorize(cells.uint16s.constData(), cells.scale, cells.offset, range, scanLine, CellCount, 1, logarithmic);
+			break;
+		}
+	}
+
+	// Returns the cells per second of the current QCPColorGradient::simdLevel, the colors are left in scanLine
+	double measure(QCPColorGradient& gradient, const Cells& cells, CellType type, bool useAlpha, bool logarithmic, QVector<QRgb>& scanLine)
+	{
+		colorize(gradient, cells, type, useAlpha, logarithmic, scanLine.data()); // warm up caches and the color buffer
+		QElapsedTimer timer;
+		timer.start();
+		for (int i = 0; i < Repetitions; ++i)
+			colorize(gradient, cells, type, useAlpha, logarithmic, scanLine.data());
+		return CellCount * double(Repetitions) / (qMax(Q_INT64_C(1), timer.nsecsElapsed()) / 1e9);
+	}
+
+	const char* levelName(QCPColorGradient::SimdLevel level)
+	{
+		switch (level)
+		{
+		case QCPColorGradient::slNone: return "scalar";
+		case QCPColorGradient::slSse41: return "SSE4.1";
+		case QCPColorGradient::slAvx2: return "AVX2";
+		}
+		return "";
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	QCoreApplication a(argc, argv);
+
+	const Cells cells = createCells();
+	const QCPColorGradient::SimdLevel supported = QCPColorGradient::supportedSimdLevel();
+	const char* typeNames[] = { "double", "float", "quint16" };
+	qDebug("supported kernels: %s", levelName(supported));
+
+	bool failed = false;
+	QVector<QRgb> reference(CellCount), result(CellCount);
+	for (int periodic = 0; periodic < 2; ++periodic)
+	{
+		QCPColorGradient gradient(QCPColorGradient::gpJet);
+		gradient.setPeriodic(periodic);
+		for (int logarithmic = 0; logarithmic < 2; ++logarithmic)
+		{
+			for (int type = ctDouble; type <= ctUInt16; ++type)
+			{
+				for (int useAlpha = 0; useAlpha < 2; ++useAlpha)
+				{
+					QCPColorGradient::setSimdLevel(QCPColorGradient::slNone);
+					const double scalarRate = measure(gradient, cells, CellType(type), useAlpha, logarithmic, reference);
+					QString line = QString("%1 %2 %3 %4: scalar %5 Mcells/s").arg(typeNames[type], -7)
+					               .arg(logarithmic ? "log" : "lin").arg(periodic ? "periodic" : "clamped ", useAlpha ? "alpha" : "     ")
+					               .arg(scalarRate / 1e6, 7, 'f', 1);
+					for (int level = QCPColorGradient::slSse41; level <= supported; ++level)
+					{
+						QCPColorGradient::setSimdLevel(QCPColorGradient::SimdLevel(level));
+						const double rate = measure(gradient, cells, CellType(type), useAlpha, logarithmic, result);
+						int mismatches = 0;
+						for (int i = 0; i < CellCount; ++i)
+						{
+							if (result.at(i) != reference.at(i))
+								++mismatches;
+						}
+						line += QString(", %1 %2 Mcells/s (%3x)").arg(levelName(QCPColorGradient::SimdLevel(level)))
+						        .arg(rate / 1e6, 7, 'f', 1).arg(rate / scalarRate, 0, 'f', 1);
+						if (mismatches > (logarithmic ? CellCount * MaxLogMismatchRatio : 0))
+						{
+							qWarning("FAILED: %s kernel colored %d cells differently than the scalar loops", levelName(QCPColorGradient::SimdLevel(level)), mismatches);
+							failed = true;
+						}
+					}
+					qDebug("%s", qPrintable(line));
+				}
+			}
+		}
+	}
+	return failed ? 1 : 0;
+}
@@ -8,11 +8,13 @@ PROJECT_COMMON = $$PWD/common
 HEADERS += $$PROJECT_LIBDIR/qcustomplot.h \
                      $$PROJECT_COMMON/cursorhelper.h \
                      $$PROJECT_COMMON/customplot.h \
-                     $$PROJECT_COMMON/crossline.h
+                     $$PROJECT_COMMON/crossline.h \
+                     $$PROJECT_COMMON/dataimporter.h
 
 SOURCES += $$PROJECT_LIBDIR/qcustomplot.cpp \
                      $$PROJECT_COMMON/cursorhelper.cpp \
                      $$PROJECT_COMMON/customplot.cpp \
-                     $$PROJECT_COMMON/crossline.cpp
+                     $$PROJECT_COMMON/crossline.cpp \
+                     $$PROJECT_COMMON/dataimporter.cpp
 
 CONFIG += debug_and_release build_all
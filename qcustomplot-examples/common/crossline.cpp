@@ -640,6 +640,7 @@ void CrossLine::setGraph(QCPGraph* graph)
 void CrossLine::onMouseMoved(QMouseEvent* event)
 {
 	mTargetGraph->pixelsToCoords(event->localPos(), mKeys[0], mValues[0]);
+	mParentPlot->notifyInteraction();
 	update();
 }
 
@@ -691,11 +692,13 @@ void CrossLine::onItemMoved(QCPAbstractItem* item, QMouseEvent* event)
 		}
 	}
 
+	mParentPlot->notifyInteraction();
 	update();
 }
 
 void CrossLine::update()
 {
+	QCPTraceScope trace("CrossLine::update", "app", this);
 	updateTracer();
 	updateHLine();
 	updateVLine();
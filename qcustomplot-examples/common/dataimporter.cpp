@@ -0,0 +1,378 @@
+﻿#include "dataimporter.h"
+
+#include <QFile>
+#include <QtEndian>
+#include <cstring>
+
+DataImporter::DataImporter(QObject* parent)
+	: QThread(parent)
+	  , mFormat(fmCsv)
+	  , mChunkSize(4 * 1024 * 1024)
+	  , mKeyColumn(0)
+	  , mValueColumn(1)
+	  , mSeparator(',')
+	  , mHeaderLines(0)
+	  , mRecordSize(16)
+	  , mKeyOffset(0)
+	  , mKeyType(ftDouble)
+	  , mValueOffset(8)
+	  , mValueType(ftDouble)
+	  , mBinaryHeaderSize(0)
+	  , mPointCount(0)
+	  , mSkippedRecords(0)
+{
+}
+
+DataImporter::~DataImporter()
+{
+	requestInterruption();
+	wait();
+}
+
+void DataImporter::setChunkSize(int bytes)
+{
+	mChunkSize = qMax(4096, bytes);
+}
+
+void DataImporter::setCsvColumns(int keyColumn, int valueColumn)
+{
+	mKeyColumn = qMax(0, keyColumn);
+	mValueColumn = qMax(0, valueColumn);
+}
+
+/*!
+  Describes the layout of one binary record of \a recordSize bytes. The key is stored at byte
+  \a keyOffset as \a keyType, the value at byte \a valueOffset as \a valueType.
+ */
+void DataImporter::setBinaryRecord(int recordSize, int keyOffset, FieldType keyType, int valueOffset, FieldType valueType)
+{
+	if (keyOffset < 0 || valueOffset < 0 || keyOffset + fieldSize(keyType) > recordSize || valueOffset + fieldSize(valueType) > recordSize)
+	{
+		qDebug() << "DataImporter::setBinaryRecord: fields don't fit into record of size" << recordSize;
+		return;
+	}
+	mRecordSize = recordSize;
+	mKeyOffset = keyOffset;
+	mKeyType = keyType;
+	mValueOffset = valueOffset;
+	mValueType = valueType;
+}
+
+/*!
+  Returns the maximum number of data points a QCPGraphDataContainer can hold. The container
+  indexes its points with int, and before Qt 6 a QVector can't allocate more than 2 GB.
+ */
+qint64 DataImporter::maximumPointCount()
+{
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+	return std::numeric_limits<int>::max();
+#else
+	return (std::numeric_limits<int>::max() - 64) / qint64(sizeof(QCPGraphData)); // 64 bytes for the QVector header
+#endif
+}
+
+void DataImporter::run()
+{
+	mErrorString.clear();
+	mSkippedRecords = 0;
+	mData.clear();
+	mChunks.clear();
+	mPointCount = 0;
+
+	QFile file(mFileName);
+	if (!file.open(QIODevice::ReadOnly))
+	{
+		mErrorString = file.errorString();
+		return;
+	}
+
+	bool sorted = true;
+	const bool ok = (mFormat == fmCsv ? importCsv(&file, sorted) : importBinary(&file, sorted));
+	if (!ok)
+	{
+		mChunks.clear();
+		return;
+	}
+
+	// join the blocks, releasing each one after copying, so the peak memory is only one block above the data itself
+	QVector<QCPGraphData> points(int(mPointCount));
+	QCPGraphData* target = points.data();
+	while (!mChunks.isEmpty())
+	{
+		const QVector<QCPGraphData> chunk = mChunks.takeFirst();
+		target = std::copy(chunk.constBegin(), chunk.constEnd(), target);
+	}
+
+	// hand the points over without copying them, sorting is skipped if the file was already sorted by key
+	QSharedPointer<QCPGraphDataContainer> data(new QCPGraphDataContainer);
+	const int parallelThreshold = data->parallelThreshold();
+	if (!sorted && points.size() > InPlaceSortPointCount)
+		data->setParallelThreshold(0); // the parallel sort needs a buffer as large as the data
+	data->set(std::move(points), sorted);
+	data->setParallelThreshold(parallelThreshold);
+	mData = data;
+
+	Q_EMIT progress(file.size(), file.size());
+}
+
+/*!
+  Fails with an error if \a count points (\a estimated from the file size, or exact) don't fit
+  into a QCPGraphDataContainer.
+ */
+bool DataImporter::checkPointCount(qint64 count, bool estimated)
+{
+	if (count <= maximumPointCount())
+		return true;
+	mErrorString = (estimated ? tr("The file contains about %1 data points, more than the maximum of %2") : tr("The file contains %1 data points, more than the maximum of %2"))
+		.arg(count).arg(maximumPointCount());
+	return false;
+}
+
+/*!
+  Appends a point to the last block, starting a new block if it is full. Fails if the maximum
+  point count is exceeded.
+ */
+bool DataImporter::appendPoint(double key, double value)
+{
+	if (!checkPointCount(mPointCount + 1, false))
+		return false;
+	if (mChunks.isEmpty() || mChunks.last().size() == PointChunkSize)
+	{
+		mChunks.append(QVector<QCPGraphData>());
+		mChunks.last().reserve(PointChunkSize);
+	}
+	mChunks.last().append(QCPGraphData(key, value));
+	++mPointCount;
+	return true;
+}
+
+bool DataImporter::importCsv(QIODevice* device, bool& sorted)
+{
+	const qint64 totalBytes = device->size();
+	QByteArray buffer(mChunkSize, Qt::Uninitialized);
+	int filled = 0;
+	qint64 processedBytes = 0;
+	int headerLines = mHeaderLines;
+	bool estimated = false;
+	double lastKey = -std::numeric_limits<double>::infinity();
+
+	forever
+	{
+		if (isInterruptionRequested())
+		{
+			mErrorString = tr("Import canceled");
+			return false;
+		}
+
+		// a line longer than the buffer, grow it
+		if (filled == buffer.size())
+			buffer.resize(buffer.size() * 2);
+
+		const qint64 bytesRead = device->read(buffer.data() + filled, buffer.size() - filled);
+		if (bytesRead < 0)
+		{
+			mErrorString = device->errorString();
+			return false;
+		}
+		const bool atEnd = (bytesRead == 0);
+		filled += int(bytesRead);
+		processedBytes += bytesRead;
+
+		const char* data = buffer.constData();
+		const char* end = data + filled;
+		const char* lineBegin = data;
+		while (lineBegin < end)
+		{
+			const char* lineEnd = static_cast<const char*>(memchr(lineBegin, '\n', size_t(end - lineBegin)));
+			if (!lineEnd)
+			{
+				// keep the incomplete last line for the next chunk, unless the file ends without newline
+				if (!atEnd)
+					break;
+				lineEnd = end;
+			}
+			const char* next = lineEnd + 1;
+			if (lineEnd > lineBegin && *(lineEnd - 1) == '\r')
+				--lineEnd;
+
+			if (headerLines > 0)
+			{
+				--headerLines;
+			}
+			else if (lineEnd > lineBegin)
+			{
+				double key, value;
+				if (parseCsvLine(lineBegin, lineEnd, key, value))
+				{
+					if (key < lastKey)
+						sorted = false;
+					lastKey = key;
+					if (!appendPoint(key, value))
+						return false;
+				}
+				else
+				{
+					++mSkippedRecords;
+				}
+			}
+			lineBegin = next;
+		}
+
+		// estimate the total number of points from the first chunk, to reject files that are too large before parsing them
+		if (!estimated && mPointCount > 0)
+		{
+			const double bytesPerPoint = double(lineBegin - data) / mPointCount;
+			if (!checkPointCount(qint64(totalBytes / bytesPerPoint * 0.95), true)) // with a margin, since the first lines may be shorter than average
+				return false;
+			estimated = true;
+		}
+
+		if (atEnd)
+			break;
+
+		const int remaining = int(qMax<qint64>(0, end - lineBegin));
+		memmove(buffer.data(), lineBegin, size_t(remaining));
+		filled = remaining;
+		Q_EMIT progress(processedBytes, totalBytes);
+	}
+	return true;
+}
+
+bool DataImporter::importBinary(QIODevice* device, bool& sorted)
+{
+	const qint64 totalBytes = device->size();
+	if (!checkPointCount(qMax<qint64>(0, totalBytes - mBinaryHeaderSize) / mRecordSize, false))
+		return false;
+	if (mBinaryHeaderSize > 0 && !device->seek(mBinaryHeaderSize))
+	{
+		mErrorString = device->errorString();
+		return false;
+	}
+
+	QByteArray buffer(qMax(1, mChunkSize / mRecordSize) * mRecordSize, Qt::Uninitialized);
+	int filled = 0;
+	qint64 processedBytes = mBinaryHeaderSize;
+	double lastKey = -std::numeric_limits<double>::infinity();
+
+	forever
+	{
+		if (isInterruptionRequested())
+		{
+			mErrorString = tr("Import canceled");
+			return false;
+		}
+
+		const qint64 bytesRead = device->read(buffer.data() + filled, buffer.size() - filled);
+		if (bytesRead < 0)
+		{
+			mErrorString = device->errorString();
+			return false;
+		}
+		if (bytesRead == 0)
+			break;
+		filled += int(bytesRead);
+		processedBytes += bytesRead;
+
+		const uchar* data = reinterpret_cast<const uchar*>(buffer.constData());
+		const int recordCount = filled / mRecordSize;
+		for (int i = 0; i < recordCount; ++i)
+		{
+			const uchar* record = data + i * mRecordSize;
+			const double key = readField(record + mKeyOffset, mKeyType);
+			if (qIsNaN(key))
+			{
+				++mSkippedRecords;
+				continue;
+			}
+			if (key < lastKey)
+				sorted = false;
+			lastKey = key;
+			if (!appendPoint(key, readField(record + mValueOffset, mValueType)))
+				return false;
+		}
+
+		// keep a partial record for the next read
+		const int remaining = filled - recordCount * mRecordSize;
+		memmove(buffer.data(), buffer.constData() + recordCount * mRecordSize, size_t(remaining));
+		filled = remaining;
+		Q_EMIT progress(processedBytes, totalBytes);
+	}
+	if (filled > 0)
+		++mSkippedRecords;
+	return true;
+}
+
+bool DataImporter::parseCsvLine(const char* begin, const char* end, double& key, double& value) const
+{
+	const int lastColumn = qMax(mKeyColumn, mValueColumn);
+	bool keyOk = false;
+	bool valueOk = false;
+	const char* fieldBegin = begin;
+	for (int column = 0; column <= lastColumn; ++column)
+	{
+		const char* fieldEnd = static_cast<const char*>(memchr(fieldBegin, mSeparator, size_t(end - fieldBegin)));
+		if (!fieldEnd)
+			fieldEnd = end;
+
+		// QByteArray::toDouble always uses the C locale, unlike strtod
+		if (column == mKeyColumn)
+			key = QByteArray::fromRawData(fieldBegin, int(fieldEnd - fieldBegin)).toDouble(&keyOk);
+		if (column == mValueColumn)
+			value = QByteArray::fromRawData(fieldBegin, int(fieldEnd - fieldBegin)).toDouble(&valueOk);
+
+		if (fieldEnd == end)
+			break;
+		fieldBegin = fieldEnd + 1;
+	}
+	return keyOk && valueOk && !qIsNaN(key);
+}
+
+int DataImporter::fieldSize(FieldType type)
+{
+	switch (type)
+	{
+	case ftDouble:
+	case ftInt64:
+		return 8;
+	case ftFloat:
+	case ftInt32:
+	case ftUInt32:
+		return 4;
+	case ftInt16:
+	case ftUInt16:
+		return 2;
+	}
+	return 0;
+}
+
+double DataImporter::readField(const uchar* data, FieldType type)
+{
+	switch (type)
+	{
+	case ftDouble:
+	{
+		const quint64 bits = qFromLittleEndian<quint64>(data);
+		double result;
+		memcpy(&result, &bits, sizeof(result));
+		return result;
+	}
+	case ftFloat:
+	{
+		const quint32 bits = qFromLittleEndian<quint32>(data);
+		float result;
+		memcpy(&result, &bits, sizeof(result));
+		return result;
+	}
+	case ftInt16:
+		return qFromLittleEndian<qint16>(data);
+	case ftUInt16:
+		return qFromLittleEndian<quint16>(data);
+	case ftInt32:
+		return qFromLittleEndian<qint32>(data);
+	case ftUInt32:
+		return qFromLittleEndian<quint32>(data);
+	case ftInt64:
+		return double(qFromLittleEndian<qint64>(data));
+	}
+	return qQNaN();
+}
@@ -0,0 +1,120 @@
+﻿#ifndef DATAIMPORTER_H
+#define DATAIMPORTER_H
+
+#include "../lib/qcustomplot.h"
+
+#include <QThread>
+#include <QString>
+#include <QChar>
+
+// Imports graph data from large CSV or raw binary files on a worker thread.
+// The file is read and parsed in chunks, the parsed points are collected in blocks of
+// PointChunkSize points, so no single huge allocation grows while parsing and no
+// intermediate key/value vectors are created. At the end the blocks are joined into the
+// storage of the resulting QCPGraphDataContainer, releasing each block once it is copied.
+// Files with more points than a QCPGraphDataContainer can hold (see maximumPointCount)
+// are rejected with an error before the storage is allocated.
+// When the import has finished (QThread::finished), take the result with data() and pass
+// it to QCPGraph::setData(QSharedPointer<QCPGraphDataContainer>).
+class DataImporter : public QThread
+{
+	Q_OBJECT
+
+public:
+	enum Format
+	{
+		fmCsv,
+		fmBinary
+	};
+
+	Q_ENUM(Format)
+
+	// type of a field in a binary record, always stored little-endian
+	enum FieldType
+	{
+		ftDouble,
+		ftFloat,
+		ftInt16,
+		ftUInt16,
+		ftInt32,
+		ftUInt32,
+		ftInt64
+	};
+
+	Q_ENUM(FieldType)
+
+	enum
+	{
+		PointChunkSize = 1 << 20, // number of points collected per block while parsing
+		InPlaceSortPointCount = 1 << 24 // unsorted imports larger than this are sorted in place instead of in parallel
+	};
+
+	explicit DataImporter(QObject* parent = Q_NULLPTR);
+	~DataImporter() Q_DECL_OVERRIDE;
+
+	void setFileName(const QString& fileName) { mFileName = fileName; }
+	QString fileName() const { return mFileName; }
+
+	void setFormat(Format format) { mFormat = format; }
+	Format format() const { return mFormat; }
+
+	void setChunkSize(int bytes);
+	int chunkSize() const { return mChunkSize; }
+
+	// CSV settings: zero-based column indices, field separator and number of header lines to skip
+	void setCsvColumns(int keyColumn, int valueColumn);
+	void setCsvSeparator(char separator) { mSeparator = separator; }
+	void setCsvHeaderLines(int lines) { mHeaderLines = qMax(0, lines); }
+
+	// binary settings: size of one record in bytes and position/type of key and value inside it
+	void setBinaryRecord(int recordSize, int keyOffset, FieldType keyType, int valueOffset, FieldType valueType);
+	void setBinaryHeaderSize(int bytes) { mBinaryHeaderSize = qMax(0, bytes); }
+
+	QSharedPointer<QCPGraphDataContainer> data() const { return mData; }
+	bool hasError() const { return !mErrorString.isEmpty(); }
+	QString errorString() const { return mErrorString; }
+	qint64 skippedRecords() const { return mSkippedRecords; }
+
+	static qint64 maximumPointCount();
+
+Q_SIGNALS:
+	void progress(qint64 bytesProcessed, qint64 bytesTotal);
+
+protected:
+	void run() Q_DECL_OVERRIDE;
+
+private:
+	bool importCsv(QIODevice* device, bool& sorted);
+	bool importBinary(QIODevice* device, bool& sorted);
+	bool checkPointCount(qint64 count, bool estimated);
+	bool appendPoint(double key, double value);
+	bool parseCsvLine(const char* begin, const char* end, double& key, double& value) const;
+	static int fieldSize(FieldType type);
+	static double readField(const uchar* data, FieldType type);
+
+private:
+	QString mFileName;
+	Format mFormat;
+	int mChunkSize;
+
+	int mKeyColumn;
+	int mValueColumn;
+	char mSeparator;
+	int mHeaderLines;
+
+	int mRecordSize;
+	int mKeyOffset;
+	FieldType mKeyType;
+	int mValueOffset;
+	FieldType mValueType;
+	int mBinaryHeaderSize;
+
+	QList<QVector<QCPGraphData> > mChunks;
+	qint64 mPointCount;
+
+	QSharedPointer<QCPGraphDataContainer> mData;
+	QString mErrorString;
+	qint64 mSkippedRecords;
+};
+
+#endif // DATAIMPORTER_H
@@ -259,6 +259,375 @@ QCPVector2D &QCPVector2D::operator-=(const QCPVector2D &vector)
 /* end of 'src/vector2d.cpp' */
 
 
+/* including file 'src/scratch.cpp'                                          */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPScratchPool
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPScratchPool
+  \brief The base class of the per-thread vector pools of \ref QCPScratchVector
+  
+  Each pool registers itself in a process-wide list, so the memory held by the pools of all threads
+  and element types can be measured with \ref totalMemoryUsage and freed with \ref trimAll. The
+  owning thread and these functions synchronize via the mutex of each pool, which is therefore
+  practically never contended.
+*/
+
+/*! \internal
+  
+  The list of all existing pools, see \ref QCPScratchPool.
+*/
+struct QCPScratchPoolRegistry
+{
+  QMutex mutex;
+  QList<QCPScratchPool*> pools;
+};
+
+Q_GLOBAL_STATIC(QCPScratchPoolRegistry, qcpScratchPoolRegistry)
+
+/*!
+  Creates a pool. Subclasses call \ref registerPool once they are fully constructed.
+*/
+QCPScratchPool::QCPScratchPool()
+{
+}
+
+QCPScratchPool::~QCPScratchPool()
+{
+}
+
+/*!
+  Returns the number of bytes held by the pooled vectors of all threads and element types.
+  
+  \see QCustomPlot::memoryReport
+*/
+qint64 QCPScratchPool::totalMemoryUsage()
+{
+  QCPScratchPoolRegistry *registry = qcpScratchPoolRegistry();
+  if (!registry)
+    return 0;
+  QMutexLocker registryLocker(&registry->mutex);
+  qint64 result = 0;
+  foreach (QCPScratchPool *pool, registry->pools)
+  {
+    QMutexLocker locker(&pool->mMutex);
+    result += pool->memoryUsage();
+  }
+  return result;
+}
+
+/*!
+  Deletes the pooled vectors of all threads and element types. Vectors that are currently borrowed
+  aren't affected. Later scratch vectors allocate their memory again.
+  
+  \see QCustomPlot::releaseMemory
+*/
+void QCPScratchPool::trimAll()
+{
+  QCPScratchPoolRegistry *registry = qcpScratchPoolRegistry();
+  if (!registry)
+    return;
+  QMutexLocker registryLocker(&registry->mutex);
+  foreach (QCPScratchPool *pool, registry->pools)
+  {
+    QMutexLocker locker(&pool->mMutex);
+    pool->trim();
+  }
+}
+
+/*! \internal
+  
+  Adds this pool to the list of pools that \ref totalMemoryUsage and \ref trimAll visit. Must be
+  called by the subclass constructor, since the virtual methods are called from then on.
+*/
+void QCPScratchPool::registerPool()
+{
+  if (QCPScratchPoolRegistry *registry = qcpScratchPoolRegistry())
+  {
+    QMutexLocker locker(&registry->mutex);
+    registry->pools.append(this);
+  }
+}
+
+/*! \internal
+  
+  Removes this pool from the list of pools. Must be called by the subclass destructor before it
+  deletes the pooled vectors.
+*/
+void QCPScratchPool::unregisterPool()
+{
+  if (QCPScratchPoolRegistry *registry = qcpScratchPoolRegistry())
+  {
+    QMutexLocker locker(&registry->mutex);
+    registry->pools.removeOne(this);
+  }
+}
+/* end of 'src/scratch.cpp' */
+
+
+/* including file 'src/tracer.cpp'                                           */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPTracer
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPTracer
+  \brief Records a timeline of rendering and interaction events for trace viewers
+  
+  While enabled (\ref setEnabled), the tracer records when and for how long the stages of
+  QCustomPlot's rendering and interaction handling run, e.g. \ref QCustomPlot::replot, the drawing
+  of each layer and layerable, the adaptive sampling of graphs, the color map image generation and
+  the mouse event dispatch. The events of all plots and threads are recorded by the process-wide
+  instance returned by \ref instance.
+  
+  The events are kept in a ring buffer of fixed \ref capacity, so a tracer can stay enabled during
+  a long live session without growing: once the buffer is full, the oldest events are overwritten
+  (see \ref droppedEventCount). Call \ref saveChromeTrace when a stall was observed, and load the
+  file in a trace viewer that reads the Chrome trace event format (e.g. chrome://tracing or
+  Perfetto) to see which stage took the time.
+  
+  Application code can add its own events to the timeline with \ref QCPTraceScope.
+  
+  While disabled, which is the default, each traced stage costs a single atomic read.
+*/
+
+Q_GLOBAL_STATIC(QCPTracer, qcpTracer)
+
+/*!
+  Creates a disabled tracer with a capacity of 65536 events. Use \ref instance to access the
+  process-wide tracer that is used by QCustomPlot.
+*/
+QCPTracer::QCPTracer() :
+  mEnabled(0),
+  mNextEvent(0),
+  mEventCount(0),
+  mDroppedEventCount(0)
+{
+  mClock.start();
+  mEvents.resize(65536);
+}
+
+/*!
+  Returns the process-wide tracer instance, which records the events of all QCustomPlots.
+*/
+QCPTracer *QCPTracer::instance()
+{
+  return qcpTracer();
+}
+
+/*!
+  Returns the maximum number of events the tracer keeps.
+  
+  \see setCapacity
+*/
+int QCPTracer::capacity() const
+{
+  QMutexLocker locker(&mMutex);
+  return mEvents.size();
+}
+
+/*!
+  Returns the number of events currently held by the tracer.
+*/
+int QCPTracer::eventCount() const
+{
+  QMutexLocker locker(&mMutex);
+  return mEventCount;
+}
+
+/*!
+  Returns the number of events that were overwritten since the last \ref clear, because the ring
+  buffer was full.
+  
+  \see setCapacity
+*/
+int QCPTracer::droppedEventCount() const
+{
+  QMutexLocker locker(&mMutex);
+  return mDroppedEventCount;
+}
+
+/*!
+  Sets whether events are recorded. Events recorded previously are kept, call \ref clear to discard
+  them.
+*/
+void QCPTracer::setEnabled(bool enabled)
+{
+  mEnabled.fetchAndStoreRelease(enabled ? 1 : 0);
+}
+
+/*!
+  Sets the maximum number of events the tracer keeps to \a capacity. Once it is reached, each new
+  event overwrites the oldest one. Changing the capacity discards all recorded events.
+*/
+void QCPTracer::setCapacity(int capacity)
+{
+  QMutexLocker locker(&mMutex);
+  mEvents = QVector<Event>(qMax(1, capacity));
+  mNextEvent = 0;
+  mEventCount = 0;
+  mDroppedEventCount = 0;
+}
+
+/*!
+  Discards all recorded events.
+*/
+void QCPTracer::clear()
+{
+  QMutexLocker locker(&mMutex);
+  mNextEvent = 0;
+  mEventCount = 0;
+  mDroppedEventCount = 0;
+}
+
+/*!
+  Records an event named \a name of the category \a category, which started at \a start and ended
+  at \a end (both as returned by \ref timestamp) in the calling thread. \a object optionally
+  identifies the instance the event belongs to, e.g. the plot or plottable.
+  
+  \a name and \a category are not copied, so they must stay valid for the lifetime of the tracer,
+  e.g. string literals or class names from the meta object system.
+  
+  Usually events are recorded with \ref QCPTraceScope instead of calling this method directly.
+*/
+void QCPTracer::addEvent(const char *name, const char *category, const void *object, qint64 start, qint64 end)
+{
+  Event event;
+  event.name = name;
+  event.category = category;
+  event.object = object;
+  event.thread = QThread::currentThreadId();
+  event.start = start;
+  event.duration = end-start;
+  
+  QMutexLocker locker(&mMutex);
+  mEvents[mNextEvent] = event;
+  mNextEvent = (mNextEvent+1) % mEvents.size();
+  if (mEventCount < mEvents.size())
+    ++mEventCount;
+  else
+    ++mDroppedEventCount;
+}
+
+/*!
+  Returns the recorded events in the Chrome trace event format (JSON), as complete events sorted
+  by start time. The threads are numbered in the order of their first event, timestamps are in
+  microseconds since the creation of the tracer.
+  
+  \see saveChromeTrace
+*/
+QByteArray QCPTracer::toChromeTraceJson() const
+{
+  QVector<Event> events;
+  {
+    QMutexLocker locker(&mMutex);
+    events.reserve(mEventCount);
+    const int first = (mNextEvent-mEventCount+mEvents.size()) % mEvents.size();
+    for (int i=0; i<mEventCount; ++i)
+      events.append(mEvents.at((first+i) % mEvents.size()));
+  }
+  // events are recorded when they end, so nested events precede their parent. Viewers expect the
+  // parent first, so sort by start time, longer events first:
+  std::stable_sort(events.begin(), events.end(), lessThanStart);
+  
+  QList<Qt::HANDLE> threads;
+  QByteArray result("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+  for (int i=0; i<events.size(); ++i)
+  {
+    const Event &event = events.at(i);
+    int tid = threads.indexOf(event.thread);
+    if (tid < 0)
+    {
+      threads.append(event.thread);
+      tid = threads.size()-1;
+    }
+    if (i > 0)
+      result += ',';
+    result += "\n{\"name\":\"";
+    result += QByteArray(event.name).replace('\\', "\\\\").replace('"', "\\\"");
+    result += "\",\"cat\":\"";
+    result += QByteArray(event.category).replace('\\', "\\\\").replace('"', "\\\"");
+    result += "\",\"ph\":\"X\",\"ts\":";
+    result += QByteArray::number(event.start/1000.0, 'f', 3);
+    result += ",\"dur\":";
+    result += QByteArray::number(event.duration/1000.0, 'f', 3);
+    result += ",\"pid\":1,\"tid\":" + QByteArray::number(tid+1);
+    if (event.object)
+      result += ",\"args\":{\"object\":\"0x" + QByteArray::number(quintptr(event.object), 16) + "\"}";
+    result += '}';
+  }
+  result += "\n]}\n";
+  return result;
+}
+
+/*!
+  Writes the recorded events as Chrome trace event JSON (see \ref toChromeTraceJson) to the file
+  \a fileName. Returns false if the file couldn't be written.
+*/
+bool QCPTracer::saveChromeTrace(const QString &fileName) const
+{
+  QFile file(fileName);
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+  {
+    qDebug() << Q_FUNC_INFO << "couldn't open file for writing:" << fileName;
+    return false;
+  }
+  const QByteArray json = toChromeTraceJson();
+  return file.write(json) == json.size();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPTraceScope
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPTraceScope
+  \brief Records the lifetime of a scope as event of the QCPTracer
+  
+  Create an instance on the stack at the beginning of the scope that shall appear on the timeline
+  of \ref QCPTracer::instance. When it is destroyed at the end of the scope, the event is recorded,
+  provided the tracer was enabled when the scope began:
+  
+  \code
+  void MyWidget::updateCursor()
+  {
+    QCPTraceScope trace("MyWidget::updateCursor", "app", this);
+    ...
+  }
+  \endcode
+  
+  \a name and \a category are not copied, see \ref QCPTracer::addEvent.
+*/
+
+/*!
+  Begins a scope event with the given \a name, \a category and optional \a object.
+*/
+QCPTraceScope::QCPTraceScope(const char *name, const char *category, const void *object) :
+  mName(name),
+  mCategory(category),
+  mObject(object),
+  mStart(-1)
+{
+  QCPTracer *tracer = QCPTracer::instance();
+  if (tracer && tracer->isEnabled())
+    mStart = tracer->timestamp();
+}
+
+/*!
+  Ends the scope event and records it, if the tracer was enabled when the scope began.
+*/
+QCPTraceScope::~QCPTraceScope()
+{
+  if (mStart >= 0)
+  {
+    if (QCPTracer *tracer = QCPTracer::instance())
+      tracer->addEvent(mName, mCategory, mObject, mStart, tracer->timestamp());
+  }
+}
+/* end of 'src/tracer.cpp' */
+
+
 /* including file 'src/painter.cpp', size 8670                               */
 /* commit ce344b3f96a62e5f652585e55f1ae7c7883cd45b 2018-06-25 01:03:39 +0200 */
 
@@ -638,6 +1007,51 @@ void QCPAbstractPaintBuffer::setDevicePixelRatio(double ratio)
   }
 }
 
+/*!
+  Moves the content of the buffer inside \a rect by \a dx pixels horizontally and \a dy pixels
+  vertically. Content moved outside of \a rect is discarded, and the parts of \a rect that don't
+  receive moved content are cleared to transparent. \a rect and the shift are given in logical
+  pixels, i.e. independent of the device pixel ratio.
+
+  Returns true if the buffer was scrolled. Paint buffers that can't scroll their content (or not
+  with the current device pixel ratio) return false and leave the buffer untouched. This is the
+  default implementation, \ref QCPPaintBufferPixmap and \ref QCPPaintBufferImage support scrolling
+  for integer device pixel ratios.
+
+  QCustomPlot uses this method to move the content of layers during fast panning, see \ref
+  QCPAxisRect::setRangeDragFastPan.
+
+  This method must not be called if there is currently a painter (acquired with \ref startPainting)
+  active.
+*/
+bool QCPAbstractPaintBuffer::scroll(const QRect &rect, int dx, int dy)
+{
+  Q_UNUSED(rect)
+  Q_UNUSED(dx)
+  Q_UNUSED(dy)
+  return false;
+}
+
+/*! \internal
+  
+  Clears the parts of \a rect with \a painter to transparent, that don't receive moved content
+  when the content of \a rect is scrolled by \a dx and \a dy. Used by the \ref scroll
+  implementations, since the underlying Qt scroll functions leave these parts untouched.
+  
+  \a painter must use the composition mode QPainter::CompositionMode_Source.
+*/
+void QCPAbstractPaintBuffer::clearExposedArea(QPainter *painter, const QRect &rect, int dx, int dy) const
+{
+  const QRegion exposed = QRegion(rect) - QRegion(rect.translated(dx, dy));
+#if QT_VERSION >= QT_VERSION_CHECK(5, 8, 0)
+  for (QRegion::const_iterator it=exposed.begin(); it!=exposed.end(); ++it)
+    painter->fillRect(*it, Qt::transparent);
+#else
+  foreach (const QRect &exposedRect, exposed.rects())
+    painter->fillRect(exposedRect, Qt::transparent);
+#endif
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 //////////////////// QCPPaintBufferPixmap
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -646,7 +1060,8 @@ void QCPAbstractPaintBuffer::setDevicePixelRatio(double ratio)
   \brief A paint buffer based on QPixmap, using software raster rendering
 
   This paint buffer is the default and fall-back paint buffer which uses software rendering and
-  QPixmap as internal buffer. It is used if \ref QCustomPlot::setOpenGl is false.
+  QPixmap as internal buffer. It is used if \ref QCustomPlot::setOpenGl is false and the plotting hint
+  \ref QCP::phParallelRasterization isn't set (see \ref QCPPaintBufferImage).
 */
 
 /*!
@@ -686,6 +1101,20 @@ void QCPPaintBufferPixmap::clear(const QColor &color)
   mBuffer.fill(color);
 }
 
+/* inherits documentation from base class */
+bool QCPPaintBufferPixmap::scroll(const QRect &rect, int dx, int dy)
+{
+  const int ratio = qRound(mDevicePixelRatio);
+  if (!qFuzzyCompare(mDevicePixelRatio, double(ratio)))
+    return false;
+  mBuffer.scroll(dx*ratio, dy*ratio, QRect(rect.topLeft()*ratio, rect.size()*ratio));
+  // clear the exposed part, which QPixmap::scroll leaves untouched:
+  QPainter painter(&mBuffer);
+  painter.setCompositionMode(QPainter::CompositionMode_Source);
+  clearExposedArea(&painter, rect, dx, dy);
+  return true;
+}
+
 /* inherits documentation from base class */
 void QCPPaintBufferPixmap::reallocateBuffer()
 {
@@ -706,6 +1135,111 @@ void QCPPaintBufferPixmap::reallocateBuffer()
   }
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPPaintBufferImage
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPPaintBufferImage
+  \brief A paint buffer based on QImage, using software raster rendering
+
+  This paint buffer uses software rendering like \ref QCPPaintBufferPixmap, but keeps its content
+  in a QImage of format QImage::Format_ARGB32_Premultiplied. Unlike QPixmap, QImage may be painted
+  on outside the GUI thread, so QCustomPlot uses this buffer if the plotting hint \ref
+  QCP::phParallelRasterization is set, to draw the layers of multiple paint buffers concurrently.
+  The premultiplied format is the one the raster engine composites fastest onto the widget surface.
+*/
+
+/*!
+  Creates an image paint buffer instance with the specified \a size and \a devicePixelRatio, if
+  applicable.
+*/
+QCPPaintBufferImage::QCPPaintBufferImage(const QSize &size, double devicePixelRatio) :
+  QCPAbstractPaintBuffer(size, devicePixelRatio)
+{
+  QCPPaintBufferImage::reallocateBuffer();
+}
+
+QCPPaintBufferImage::~QCPPaintBufferImage()
+{
+}
+
+/* inherits documentation from base class */
+QCPPainter *QCPPaintBufferImage::startPainting()
+{
+  QCPPainter *result = new QCPPainter(&mBuffer);
+  result->setRenderHint(QPainter::HighQualityAntialiasing);
+  return result;
+}
+
+/* inherits documentation from base class */
+void QCPPaintBufferImage::draw(QCPPainter *painter) const
+{
+  if (painter && painter->isActive())
+    painter->drawImage(0, 0, mBuffer);
+  else
+    qDebug() << Q_FUNC_INFO << "invalid or inactive painter passed";
+}
+
+/* inherits documentation from base class */
+void QCPPaintBufferImage::clear(const QColor &color)
+{
+  mBuffer.fill(color);
+}
+
+/* inherits documentation from base class */
+bool QCPPaintBufferImage::scroll(const QRect &rect, int dx, int dy)
+{
+  const int ratio = qRound(mDevicePixelRatio);
+  if (!qFuzzyCompare(mDevicePixelRatio, double(ratio)))
+    return false;
+  const QRect deviceRect(rect.topLeft()*ratio, rect.size()*ratio);
+  const int deviceDx = dx*ratio;
+  const int deviceDy = dy*ratio;
+  if (!mBuffer.rect().contains(deviceRect))
+    return false;
+  // QImage has no scroll method, so move the scan line sections directly. Rows are processed away
+  // from the shift direction, so no source row is overwritten before it was moved:
+  if (qAbs(deviceDx) < deviceRect.width() && qAbs(deviceDy) < deviceRect.height())
+  {
+    const int bytesPerPixel = mBuffer.depth()/8;
+    const int rowBytes = (deviceRect.width()-qAbs(deviceDx))*bytesPerPixel;
+    const int sourceX = deviceRect.left()+qMax(0, -deviceDx);
+    const int targetX = deviceRect.left()+qMax(0, deviceDx);
+    const int bytesPerLine = mBuffer.bytesPerLine();
+    uchar *bits = mBuffer.bits();
+    const int firstRow = deviceDy > 0 ? deviceRect.bottom() : deviceRect.top();
+    const int lastRow = deviceDy > 0 ? deviceRect.top()+deviceDy : deviceRect.bottom()+deviceDy;
+    const int rowStep = deviceDy > 0 ? -1 : 1;
+    for (int row=firstRow; row != lastRow+rowStep; row += rowStep)
+      memmove(bits+row*bytesPerLine+targetX*bytesPerPixel, bits+(row-deviceDy)*bytesPerLine+sourceX*bytesPerPixel, rowBytes);
+  }
+  // clear the exposed part:
+  QPainter painter(&mBuffer);
+  painter.setCompositionMode(QPainter::CompositionMode_Source);
+  clearExposedArea(&painter, rect, dx, dy);
+  return true;
+}
+
+/* inherits documentation from base class */
+void QCPPaintBufferImage::reallocateBuffer()
+{
+  setInvalidated();
+  if (!qFuzzyCompare(1.0, mDevicePixelRatio))
+  {
+#ifdef QCP_DEVICEPIXELRATIO_SUPPORTED
+    mBuffer = QImage(mSize*mDevicePixelRatio, QImage::Format_ARGB32_Premultiplied);
+    mBuffer.setDevicePixelRatio(mDevicePixelRatio);
+#else
+    qDebug() << Q_FUNC_INFO << "Device pixel ratios not supported for Qt versions before 5.4";
+    mDevicePixelRatio = 1.0;
+    mBuffer = QImage(mSize, QImage::Format_ARGB32_Premultiplied);
+#endif
+  } else
+  {
+    mBuffer = QImage(mSize, QImage::Format_ARGB32_Premultiplied);
+  }
+}
+
 
 #ifdef QCP_OPENGL_PBUFFER
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -1029,6 +1563,15 @@ void QCPPaintBufferGlFbo::reallocateBuffer()
   Layers with higher indices will be drawn above layers with lower indices.
 */
 
+/*! \fn bool QCPLayer::dirty() const
+  
+  Returns whether the content of this layer has changed since it was last drawn into its paint
+  buffer. Dirty layers are redrawn by the next \ref QCustomPlot::replot, while the paint buffers
+  of layers which are not dirty are reused as they are.
+  
+  \see markDirty, QCPLayerable::markLayerDirty
+*/
+
 /* end documentation of inline functions */
 
 /*!
@@ -1045,7 +1588,8 @@ QCPLayer::QCPLayer(QCustomPlot *parentPlot, const QString &layerName) :
   mName(layerName),
   mIndex(-1), // will be set to a proper value by the QCustomPlot layer creation function
   mVisible(true),
-  mMode(lmLogical)
+  mMode(lmLogical),
+  mDirty(true)
 {
   // Note: no need to make sure layerName is unique, because layer
   // management is done with QCustomPlot functions.
@@ -1075,7 +1619,12 @@ QCPLayer::~QCPLayer()
 */
 void QCPLayer::setVisible(bool visible)
 {
-  mVisible = visible;
+  if (mVisible != visible)
+  {
+    mVisible = visible;
+    // layerables on other layers may have a layerable parent on this layer, so their real visibility changes, too:
+    mParentPlot->markAllLayersDirty();
+  }
 }
 
 /*!
@@ -1104,6 +1653,7 @@ void QCPLayer::setMode(QCPLayer::LayerMode mode)
   if (mMode != mode)
   {
     mMode = mode;
+    mDirty = true;
     if (!mPaintBuffer.isNull())
       mPaintBuffer.data()->setInvalidated();
   }
@@ -1123,13 +1673,35 @@ void QCPLayer::draw(QCPPainter *painter)
     {
       painter->save();
       painter->setClipRect(child->clipRect().translated(0, -1));
-      child->applyDefaultAntialiasingHint(painter);
-      child->draw(painter);
+      drawChild(painter, child);
       painter->restore();
     }
   }
 }
 
+/*! \internal
+
+  Draws the layerable \a child with the provided \a painter, after applying its default
+  antialiasing hint. The clip rect must already be set by the caller.
+
+  If replot statistics are enabled (\ref QCustomPlot::setReplotStatisticsEnabled), the draw time of
+  \a child is measured during replots. If the \ref QCPTracer is enabled, the drawing is recorded as
+  event named after the class of \a child.
+*/
+void QCPLayer::drawChild(QCPPainter *painter, QCPLayerable *child)
+{
+  child->applyDefaultAntialiasingHint(painter);
+  QCPTraceScope trace(child->metaObject()->className(), "draw", child);
+  if (mParentPlot->collectsReplotStatistics())
+  {
+    QElapsedTimer timer;
+    timer.start();
+    child->draw(painter);
+    mParentPlot->addLayerableDrawTime(child, timer.nsecsElapsed()/1e6);
+  } else
+    child->draw(painter);
+}
+
 /*! \internal
 
   Draws the contents of this layer into the paint buffer which is associated with this layer. The
@@ -1140,6 +1712,7 @@ void QCPLayer::draw(QCPPainter *painter)
 */
 void QCPLayer::drawToPaintBuffer()
 {
+  QCPTraceScope trace("QCPLayer::drawToPaintBuffer", "render", this);
   if (!mPaintBuffer.isNull())
   {
     if (QCPPainter *painter = mPaintBuffer.data()->startPainting())
@@ -1156,6 +1729,48 @@ void QCPLayer::drawToPaintBuffer()
     qDebug() << Q_FUNC_INFO << "no valid paint buffer associated with this layer";
 }
 
+/*! \internal
+
+  Like \ref drawToPaintBuffer, but only draws the part of the layer that lies inside \a rect, by
+  intersecting the clip rect of each layerable with \a rect. Layerables that don't intersect \a
+  rect aren't drawn at all. The paint buffer isn't cleared inside \a rect, this is the
+  responsibility of the caller.
+
+  This is used to redraw the strips exposed by scrolling the paint buffer during fast panning (see
+  \ref QCPAxisRect::setRangeDragFastPan).
+*/
+void QCPLayer::drawToPaintBuffer(const QRect &rect)
+{
+  QCPTraceScope trace("QCPLayer::drawToPaintBuffer", "render", this);
+  if (!mPaintBuffer.isNull())
+  {
+    if (QCPPainter *painter = mPaintBuffer.data()->startPainting())
+    {
+      if (painter->isActive())
+      {
+        foreach (QCPLayerable *child, mChildren)
+        {
+          if (child->realVisibility())
+          {
+            const QRect clip = child->clipRect().translated(0, -1) & rect;
+            if (clip.isEmpty())
+              continue;
+            painter->save();
+            painter->setClipRect(clip);
+            drawChild(painter, child);
+            painter->restore();
+          }
+        }
+      } else
+        qDebug() << Q_FUNC_INFO << "paint buffer returned inactive painter";
+      delete painter;
+      mPaintBuffer.data()->donePainting();
+    } else
+      qDebug() << Q_FUNC_INFO << "paint buffer returned zero painter";
+  } else
+    qDebug() << Q_FUNC_INFO << "no valid paint buffer associated with this layer";
+}
+
 /*!
   If the layer mode (\ref setMode) is set to \ref lmBuffered, this method allows replotting only
   the layerables on this specific layer, without the need to replot all other layers (as a call to
@@ -1175,6 +1790,16 @@ void QCPLayer::replot()
   {
     if (!mPaintBuffer.isNull())
     {
+      mParentPlot->cancelFastPan(); // the buffer now shows the current state, so a pending fast pan must not move it
+      foreach (QCPLayerable *child, mChildren)
+      {
+        QCPAbstractPlottable *plottable = qobject_cast<QCPAbstractPlottable*>(child);
+        if (plottable && plottable->realVisibility())
+          plottable->prepareDraw();
+      }
+      foreach (QCPLayerable *child, mChildren)
+        child->mDrawnContentRevision = child->contentRevision();
+      mDirty = false;
       mPaintBuffer.data()->clear(Qt::transparent);
       drawToPaintBuffer();
       mPaintBuffer.data()->setInvalidated(false);
@@ -1185,6 +1810,21 @@ void QCPLayer::replot()
     mParentPlot->replot();
 }
 
+/*!
+  Marks this layer as dirty, so the next \ref QCustomPlot::replot redraws its paint buffer instead
+  of reusing the previously rendered content.
+  
+  Layerables call this implicitly via \ref QCPLayerable::markLayerDirty whenever one of their
+  visual properties changes, so it usually only needs to be called manually if the appearance of a
+  layerable was changed by means QCustomPlot can't track, e.g. by modifying a shared ticker.
+  
+  \see dirty, QCustomPlot::markAllLayersDirty
+*/
+void QCPLayer::markDirty()
+{
+  mDirty = true;
+}
+
 /*! \internal
   
   Adds the \a layerable to the list of this layer. If \a prepend is set to true, the layerable will
@@ -1203,6 +1843,7 @@ void QCPLayer::addChild(QCPLayerable *layerable, bool prepend)
       mChildren.prepend(layerable);
     else
       mChildren.append(layerable);
+    mDirty = true;
     if (!mPaintBuffer.isNull())
       mPaintBuffer.data()->setInvalidated();
   } else
@@ -1222,6 +1863,7 @@ void QCPLayer::removeChild(QCPLayerable *layerable)
 {
   if (mChildren.removeOne(layerable))
   {
+    mDirty = true;
     if (!mPaintBuffer.isNull())
       mPaintBuffer.data()->setInvalidated();
   } else
@@ -1342,7 +1984,9 @@ QCPLayerable::QCPLayerable(QCustomPlot *plot, QString targetLayer, QCPLayerable
   mParentPlot(plot),
   mParentLayerable(parentLayerable),
   mLayer(0),
-  mAntialiased(true)
+  mAntialiased(true),
+  mContentRevision(0),
+  mDrawnContentRevision(0)
 {
   if (mParentPlot)
   {
@@ -1369,7 +2013,13 @@ QCPLayerable::~QCPLayerable()
 */
 void QCPLayerable::setVisible(bool on)
 {
-  mVisible = on;
+  if (mVisible != on)
+  {
+    mVisible = on;
+    // child layerables (see \ref parentLayerable) may reside on other layers:
+    if (mParentPlot)
+      mParentPlot->markAllLayersDirty();
+  }
 }
 
 /*!
@@ -1417,6 +2067,7 @@ bool QCPLayerable::setLayer(const QString &layerName)
 void QCPLayerable::setAntialiased(bool enabled)
 {
   mAntialiased = enabled;
+  markLayerDirty();
 }
 
 /*!
@@ -1434,6 +2085,38 @@ bool QCPLayerable::realVisibility() const
   return mVisible && (!mLayer || mLayer->visible()) && (!mParentLayerable || mParentLayerable.data()->realVisibility());
 }
 
+/*!
+  Notifies the layer of this layerable that the layerable's appearance has changed, so the next
+  \ref QCustomPlot::replot redraws the layer instead of reusing its paint buffer. All property
+  setters that affect the drawn output call this method.
+  
+  If the appearance was changed by means QCustomPlot can't track (e.g. the contents of a shared
+  ticker or a subclass member without setter), call this method manually before replotting.
+  
+  \see contentRevision, QCPLayer::markDirty
+*/
+void QCPLayerable::markLayerDirty()
+{
+  ++mContentRevision;
+  if (mLayer)
+    mLayer->markDirty();
+}
+
+/*!
+  Returns a number that changes whenever the drawn content of this layerable changes. Before
+  drawing, \ref QCustomPlot::replot compares it to the value of the previous replot and marks the
+  layer dirty if it differs.
+  
+  The base implementation returns a counter that is incremented by \ref markLayerDirty.
+  Subclasses whose appearance depends on external state, like the data container of a plottable,
+  reimplement this method and add the revision of that state, so changes which don't go through a
+  setter of the layerable itself are detected, too.
+*/
+quint64 QCPLayerable::contentRevision() const
+{
+  return mContentRevision;
+}
+
 /*!
   This function is used to decide whether a click hits a layerable object or not.
 
@@ -1569,7 +2252,7 @@ bool QCPLayerable::moveToLayer(QCPLayer *layer, bool prepend)
 */
 void QCPLayerable::applyAntialiasingHint(QCPPainter *painter, bool localAntialiased, QCP::AntialiasedElement overrideElement) const
 {
-  if (mParentPlot && mParentPlot->notAntialiasedElements().testFlag(overrideElement))
+  if (mParentPlot && (mParentPlot->notAntialiasedElements().testFlag(overrideElement) || mParentPlot->activeInteractionDegradations().testFlag(QCP::idAntialiasing)))
     painter->setAntialiasing(false);
   else if (mParentPlot && mParentPlot->antialiasedElements().testFlag(overrideElement))
     painter->setAntialiasing(true);
@@ -2856,6 +3539,7 @@ QCPRange QCPSelectionRect::range(const QCPAxis *axis) const
 void QCPSelectionRect::setPen(const QPen &pen)
 {
   mPen = pen;
+  markLayerDirty();
 }
 
 /*!
@@ -2867,6 +3551,7 @@ void QCPSelectionRect::setPen(const QPen &pen)
 void QCPSelectionRect::setBrush(const QBrush &brush)
 {
   mBrush = brush;
+  markLayerDirty();
 }
 
 /*!
@@ -2878,6 +3563,7 @@ void QCPSelectionRect::cancel()
   if (mActive)
   {
     mActive = false;
+    markLayerDirty();
     emit canceled(mRect, 0);
   }
 }
@@ -2893,6 +3579,7 @@ void QCPSelectionRect::startSelection(QMouseEvent *event)
   mActive = true;
   mRect = QRect(event->pos(), event->pos());
   emit started(event);
+  markLayerDirty();
 }
 
 /*! \internal
@@ -2904,6 +3591,7 @@ void QCPSelectionRect::startSelection(QMouseEvent *event)
 void QCPSelectionRect::moveSelection(QMouseEvent *event)
 {
   mRect.setBottomRight(event->pos());
+  markLayerDirty();
   emit changed(mRect, event);
   layer()->replot();
 }
@@ -2919,6 +3607,7 @@ void QCPSelectionRect::endSelection(QMouseEvent *event)
   mRect.setBottomRight(event->pos());
   mActive = false;
   emit accepted(mRect, event);
+  markLayerDirty();
 }
 
 /*! \internal
@@ -2932,6 +3621,7 @@ void QCPSelectionRect::keyPressEvent(QKeyEvent *event)
   if (event->key() == Qt::Key_Escape && mActive)
   {
     mActive = false;
+    markLayerDirty();
     emit canceled(mRect, event);
   }
 }
@@ -3217,6 +3907,8 @@ void QCPLayoutElement::setOuterRect(const QRect &rect)
   {
     mOuterRect = rect;
     mRect = mOuterRect.adjusted(mMargins.left(), mMargins.top(), -mMargins.right(), -mMargins.bottom());
+    if (mParentPlot)
+      mParentPlot->markAllLayersDirty(); // layout changed, which may move anything that is positioned relative to this element
   }
 }
 
@@ -3237,6 +3929,8 @@ void QCPLayoutElement::setMargins(const QMargins &margins)
   {
     mMargins = margins;
     mRect = mOuterRect.adjusted(mMargins.left(), mMargins.top(), -mMargins.right(), -mMargins.bottom());
+    if (mParentPlot)
+      mParentPlot->markAllLayersDirty();
   }
 }
 
@@ -7188,6 +7882,7 @@ QCPGrid::QCPGrid(QCPAxis *parentAxis) :
 void QCPGrid::setSubGridVisible(bool visible)
 {
   mSubGridVisible = visible;
+  markLayerDirty();
 }
 
 /*!
@@ -7196,6 +7891,7 @@ void QCPGrid::setSubGridVisible(bool visible)
 void QCPGrid::setAntialiasedSubGrid(bool enabled)
 {
   mAntialiasedSubGrid = enabled;
+  markLayerDirty();
 }
 
 /*!
@@ -7204,6 +7900,7 @@ void QCPGrid::setAntialiasedSubGrid(bool enabled)
 void QCPGrid::setAntialiasedZeroLine(bool enabled)
 {
   mAntialiasedZeroLine = enabled;
+  markLayerDirty();
 }
 
 /*!
@@ -7212,6 +7909,7 @@ void QCPGrid::setAntialiasedZeroLine(bool enabled)
 void QCPGrid::setPen(const QPen &pen)
 {
   mPen = pen;
+  markLayerDirty();
 }
 
 /*!
@@ -7220,6 +7918,7 @@ void QCPGrid::setPen(const QPen &pen)
 void QCPGrid::setSubGridPen(const QPen &pen)
 {
   mSubGridPen = pen;
+  markLayerDirty();
 }
 
 /*!
@@ -7231,6 +7930,7 @@ void QCPGrid::setSubGridPen(const QPen &pen)
 void QCPGrid::setZeroLinePen(const QPen &pen)
 {
   mZeroLinePen = pen;
+  markLayerDirty();
 }
 
 /*! \internal
@@ -7679,6 +8379,7 @@ void QCPAxis::setScaleType(QCPAxis::ScaleType type)
     if (mScaleType == stLogarithmic)
       setRange(mRange.sanitizedForLogScale());
     mCachedMarginValid = false;
+    mParentPlot->markAllLayersDirty();
     emit scaleTypeChanged(mScaleType);
   }
 }
@@ -7705,6 +8406,7 @@ void QCPAxis::setRange(const QCPRange &range)
   {
     mRange = range.sanitizedForLinScale();
   }
+  mParentPlot->markAllLayersDirty(); // everything drawn in plot coordinates may have moved
   emit rangeChanged(mRange);
   emit rangeChanged(mRange, oldRange);
 }
@@ -7749,6 +8451,7 @@ void QCPAxis::setSelectedParts(const SelectableParts &selected)
   {
     mSelectedParts = selected;
     emit selectionChanged(mSelectedParts);
+    markLayerDirty();
   }
 }
 
@@ -7777,6 +8480,7 @@ void QCPAxis::setRange(double lower, double upper)
   {
     mRange = mRange.sanitizedForLinScale();
   }
+  mParentPlot->markAllLayersDirty(); // everything drawn in plot coordinates may have moved
   emit rangeChanged(mRange);
   emit rangeChanged(mRange, oldRange);
 }
@@ -7820,6 +8524,7 @@ void QCPAxis::setRangeLower(double lower)
   {
     mRange = mRange.sanitizedForLinScale();
   }
+  mParentPlot->markAllLayersDirty(); // everything drawn in plot coordinates may have moved
   emit rangeChanged(mRange);
   emit rangeChanged(mRange, oldRange);
 }
@@ -7842,6 +8547,7 @@ void QCPAxis::setRangeUpper(double upper)
   {
     mRange = mRange.sanitizedForLinScale();
   }
+  mParentPlot->markAllLayersDirty(); // everything drawn in plot coordinates may have moved
   emit rangeChanged(mRange);
   emit rangeChanged(mRange, oldRange);
 }
@@ -7857,7 +8563,11 @@ void QCPAxis::setRangeUpper(double upper)
 */
 void QCPAxis::setRangeReversed(bool reversed)
 {
-  mRangeReversed = reversed;
+  if (mRangeReversed != reversed)
+  {
+    mRangeReversed = reversed;
+    mParentPlot->markAllLayersDirty();
+  }
 }
 
 /*!
@@ -7880,6 +8590,7 @@ void QCPAxis::setTicker(QSharedPointer<QCPAxisTicker> ticker)
   else
     qDebug() << Q_FUNC_INFO << "can not set 0 as axis ticker";
   // no need to invalidate margin cache here because produced tick labels are checked for changes in setupTickVector
+  markLayerDirty();
 }
 
 /*!
@@ -7896,6 +8607,7 @@ void QCPAxis::setTicks(bool show)
   {
     mTicks = show;
     mCachedMarginValid = false;
+    markLayerDirty();
   }
 }
 
@@ -7910,6 +8622,7 @@ void QCPAxis::setTickLabels(bool show)
     mCachedMarginValid = false;
     if (!mTickLabels)
       mTickVectorLabels.clear();
+    markLayerDirty();
   }
 }
 
@@ -7923,6 +8636,7 @@ void QCPAxis::setTickLabelPadding(int padding)
   {
     mAxisPainter->tickLabelPadding = padding;
     mCachedMarginValid = false;
+    markLayerDirty();
   }
 }
 
@@ -7937,6 +8651,7 @@ void QCPAxis::setTickLabelFont(const QFont &font)
   {
     mTickLabelFont = font;
     mCachedMarginValid = false;
+    markLayerDirty();
   }
 }
 
@@ -7948,6 +8663,7 @@ void QCPAxis::setTickLabelFont(const QFont &font)
 void QCPAxis::setTickLabelColor(const QColor &color)
 {
   mTickLabelColor = color;
+  markLayerDirty();
 }
 
 /*!
@@ -7965,6 +8681,7 @@ void QCPAxis::setTickLabelRotation(double degrees)
   {
     mAxisPainter->tickLabelRotation = qBound(-90.0, degrees, 90.0);
     mCachedMarginValid = false;
+    markLayerDirty();
   }
 }
 
@@ -7979,6 +8696,7 @@ void QCPAxis::setTickLabelSide(LabelSide side)
 {
   mAxisPainter->tickLabelSide = side;
   mCachedMarginValid = false;
+  markLayerDirty();
 }
 
 /*!
@@ -8013,6 +8731,7 @@ void QCPAxis::setTickLabelSide(LabelSide side)
 */
 void QCPAxis::setNumberFormat(const QString &formatCode)
 {
+  markLayerDirty();
   if (formatCode.isEmpty())
   {
     qDebug() << Q_FUNC_INFO << "Passed formatCode is empty";
@@ -8077,6 +8796,7 @@ void QCPAxis::setNumberPrecision(int precision)
   {
     mNumberPrecision = precision;
     mCachedMarginValid = false;
+    markLayerDirty();
   }
 }
 
@@ -8105,6 +8825,7 @@ void QCPAxis::setTickLengthIn(int inside)
   if (mAxisPainter->tickLengthIn != inside)
   {
     mAxisPainter->tickLengthIn = inside;
+    markLayerDirty();
   }
 }
 
@@ -8121,6 +8842,7 @@ void QCPAxis::setTickLengthOut(int outside)
   {
     mAxisPainter->tickLengthOut = outside;
     mCachedMarginValid = false; // only outside tick length can change margin
+    markLayerDirty();
   }
 }
 
@@ -8137,6 +8859,7 @@ void QCPAxis::setSubTicks(bool show)
   {
     mSubTicks = show;
     mCachedMarginValid = false;
+    markLayerDirty();
   }
 }
 
@@ -8165,6 +8888,7 @@ void QCPAxis::setSubTickLengthIn(int inside)
   if (mAxisPainter->subTickLengthIn != inside)
   {
     mAxisPainter->subTickLengthIn = inside;
+    markLayerDirty();
   }
 }
 
@@ -8181,6 +8905,7 @@ void QCPAxis::setSubTickLengthOut(int outside)
   {
     mAxisPainter->subTickLengthOut = outside;
     mCachedMarginValid = false; // only outside tick length can change margin
+    markLayerDirty();
   }
 }
 
@@ -8192,6 +8917,7 @@ void QCPAxis::setSubTickLengthOut(int outside)
 void QCPAxis::setBasePen(const QPen &pen)
 {
   mBasePen = pen;
+  markLayerDirty();
 }
 
 /*!
@@ -8202,6 +8928,7 @@ void QCPAxis::setBasePen(const QPen &pen)
 void QCPAxis::setTickPen(const QPen &pen)
 {
   mTickPen = pen;
+  markLayerDirty();
 }
 
 /*!
@@ -8212,6 +8939,7 @@ void QCPAxis::setTickPen(const QPen &pen)
 void QCPAxis::setSubTickPen(const QPen &pen)
 {
   mSubTickPen = pen;
+  markLayerDirty();
 }
 
 /*!
@@ -8225,6 +8953,7 @@ void QCPAxis::setLabelFont(const QFont &font)
   {
     mLabelFont = font;
     mCachedMarginValid = false;
+    markLayerDirty();
   }
 }
 
@@ -8236,6 +8965,7 @@ void QCPAxis::setLabelFont(const QFont &font)
 void QCPAxis::setLabelColor(const QColor &color)
 {
   mLabelColor = color;
+  markLayerDirty();
 }
 
 /*!
@@ -8248,6 +8978,7 @@ void QCPAxis::setLabel(const QString &str)
   {
     mLabel = str;
     mCachedMarginValid = false;
+    markLayerDirty();
   }
 }
 
@@ -8262,6 +8993,7 @@ void QCPAxis::setLabelPadding(int padding)
   {
     mAxisPainter->labelPadding = padding;
     mCachedMarginValid = false;
+    markLayerDirty();
   }
 }
 
@@ -8281,6 +9013,7 @@ void QCPAxis::setPadding(int padding)
   {
     mPadding = padding;
     mCachedMarginValid = false;
+    markLayerDirty();
   }
 }
 
@@ -8294,7 +9027,11 @@ void QCPAxis::setPadding(int padding)
 */
 void QCPAxis::setOffset(int offset)
 {
-  mAxisPainter->offset = offset;
+  if (mAxisPainter->offset != offset) // called by the axis rect on every layout update, so only mark actual changes
+  {
+    mAxisPainter->offset = offset;
+    markLayerDirty();
+  }
 }
 
 /*!
@@ -8308,6 +9045,7 @@ void QCPAxis::setSelectedTickLabelFont(const QFont &font)
   {
     mSelectedTickLabelFont = font;
     // don't set mCachedMarginValid to false here because margin calculation is always done with non-selected fonts
+    markLayerDirty();
   }
 }
 
@@ -8320,6 +9058,7 @@ void QCPAxis::setSelectedLabelFont(const QFont &font)
 {
   mSelectedLabelFont = font;
   // don't set mCachedMarginValid to false here because margin calculation is always done with non-selected fonts
+  markLayerDirty();
 }
 
 /*!
@@ -8332,6 +9071,7 @@ void QCPAxis::setSelectedTickLabelColor(const QColor &color)
   if (color != mSelectedTickLabelColor)
   {
     mSelectedTickLabelColor = color;
+    markLayerDirty();
   }
 }
 
@@ -8343,6 +9083,7 @@ void QCPAxis::setSelectedTickLabelColor(const QColor &color)
 void QCPAxis::setSelectedLabelColor(const QColor &color)
 {
   mSelectedLabelColor = color;
+  markLayerDirty();
 }
 
 /*!
@@ -8353,6 +9094,7 @@ void QCPAxis::setSelectedLabelColor(const QColor &color)
 void QCPAxis::setSelectedBasePen(const QPen &pen)
 {
   mSelectedBasePen = pen;
+  markLayerDirty();
 }
 
 /*!
@@ -8363,6 +9105,7 @@ void QCPAxis::setSelectedBasePen(const QPen &pen)
 void QCPAxis::setSelectedTickPen(const QPen &pen)
 {
   mSelectedTickPen = pen;
+  markLayerDirty();
 }
 
 /*!
@@ -8373,6 +9116,7 @@ void QCPAxis::setSelectedTickPen(const QPen &pen)
 void QCPAxis::setSelectedSubTickPen(const QPen &pen)
 {
   mSelectedSubTickPen = pen;
+  markLayerDirty();
 }
 
 /*!
@@ -8388,6 +9132,7 @@ void QCPAxis::setSelectedSubTickPen(const QPen &pen)
 void QCPAxis::setLowerEnding(const QCPLineEnding &ending)
 {
   mAxisPainter->lowerEnding = ending;
+  markLayerDirty();
 }
 
 /*!
@@ -8403,6 +9148,7 @@ void QCPAxis::setLowerEnding(const QCPLineEnding &ending)
 void QCPAxis::setUpperEnding(const QCPLineEnding &ending)
 {
   mAxisPainter->upperEnding = ending;
+  markLayerDirty();
 }
 
 /*!
@@ -8424,6 +9170,7 @@ void QCPAxis::moveRange(double diff)
     mRange.lower *= diff;
     mRange.upper *= diff;
   }
+  mParentPlot->markAllLayersDirty(); // everything drawn in plot coordinates may have moved
   emit rangeChanged(mRange);
   emit rangeChanged(mRange, oldRange);
 }
@@ -8473,6 +9220,7 @@ void QCPAxis::scaleRange(double factor, double center)
     } else
       qDebug() << Q_FUNC_INFO << "Center of scaling operation doesn't lie in same logarithmic sign domain as range:" << center;
   }
+  mParentPlot->markAllLayersDirty(); // everything drawn in plot coordinates may have moved
   emit rangeChanged(mRange);
   emit rangeChanged(mRange, oldRange);
 }
@@ -8878,6 +9626,7 @@ void QCPAxis::mouseMoveEvent(QMouseEvent *event, const QPointF &startPos)
     
     if (mParentPlot->noAntialiasingOnDrag())
       mParentPlot->setNotAntialiasedElements(QCP::aeAll);
+    mParentPlot->notifyInteraction();
     mParentPlot->replot(QCustomPlot::rpQueuedReplot);
   }
 }
@@ -8935,6 +9684,7 @@ void QCPAxis::wheelEvent(QWheelEvent *event)
   const double wheelSteps = event->delta()/120.0; // a single step delta is +/-120 usually
   const double factor = qPow(mAxisRect->rangeZoomFactor(orientation()), wheelSteps);
   scaleRange(factor, pixelToCoord(orientation() == Qt::Horizontal ? event->pos().x() : event->pos().y()));
+  mParentPlot->notifyInteraction();
   mParentPlot->replot();
 }
 
@@ -9026,8 +9776,15 @@ void QCPAxis::setupTickVectors()
   if ((!mTicks && !mTickLabels && !mGrid->visible()) || mRange.size() <= 0) return;
   
   QVector<QString> oldLabels = mTickVectorLabels;
+  QVector<double> oldTicks = mTickVector;
+  QVector<double> oldSubTicks = mSubTickVector;
   mTicker->generate(mRange, mParentPlot->locale(), mNumberFormatChar, mNumberPrecision, mTickVector, mSubTicks ? &mSubTickVector : 0, mTickLabels ? &mTickVectorLabels : 0);
   mCachedMarginValid &= mTickVectorLabels == oldLabels; // if labels have changed, margin might have changed, too
+  if (mTickVector != oldTicks || mSubTickVector != oldSubTicks || mTickVectorLabels != oldLabels) // ticker settings aren't tracked, so detect their effect here
+  {
+    markLayerDirty();
+    mGrid->markLayerDirty();
+  }
 }
 
 /*! \internal
@@ -9457,6 +10214,21 @@ void QCPAxisPainterPrivate::clearCache()
   mLabelCache.clear();
 }
 
+/*! \internal
+  
+  Returns the number of bytes held by the pixmaps in the internal label cache.
+*/
+qint64 QCPAxisPainterPrivate::cacheMemoryUsage() const
+{
+  qint64 result = 0;
+  foreach (const QString &text, mLabelCache.keys())
+  {
+    if (const CachedLabel *cachedLabel = mLabelCache.object(text))
+      result += qint64(cachedLabel->pixmap.width())*cachedLabel->pixmap.height()*cachedLabel->pixmap.depth()/8;
+  }
+  return result;
+}
+
 /*! \internal
   
   Returns a hash that allows uniquely identifying whether the label parameters have changed such
@@ -10358,6 +11130,8 @@ QCPSelectionDecorator::~QCPSelectionDecorator()
 void QCPSelectionDecorator::setPen(const QPen &pen)
 {
   mPen = pen;
+  if (mPlottable)
+    mPlottable->markLayerDirty();
 }
 
 /*!
@@ -10366,6 +11140,8 @@ void QCPSelectionDecorator::setPen(const QPen &pen)
 void QCPSelectionDecorator::setBrush(const QBrush &brush)
 {
   mBrush = brush;
+  if (mPlottable)
+    mPlottable->markLayerDirty();
 }
 
 /*!
@@ -10391,6 +11167,8 @@ void QCPSelectionDecorator::setScatterStyle(const QCPScatterStyle &scatterStyle,
 void QCPSelectionDecorator::setUsedScatterProperties(const QCPScatterStyle::ScatterProperties &properties)
 {
   mUsedScatterProperties = properties;
+  if (mPlottable)
+    mPlottable->markLayerDirty();
 }
 
 /*!
@@ -10604,6 +11382,26 @@ bool QCPSelectionDecorator::registerWithPlottable(QCPAbstractPlottable *plottabl
   abstract base class only.
 */
 
+/*! \fn void QCPAbstractPlottable::drainIngestChannel()
+  \internal
+  
+  Called by \ref QCustomPlot::replot right after the \ref QCustomPlot::beforeReplot signal, to
+  give plottables the opportunity to merge data that was queued by other threads into their data
+  containers. The default implementation does nothing.
+  
+  \see QCPAbstractPlottable1D::ingestChannel
+*/
+
+/*! \fn void QCPAbstractPlottable::prepareDraw()
+  \internal
+  
+  Called on the GUI thread by \ref QCustomPlot::replot after the layout was updated (and by \ref
+  QCPLayer::replot), before the layers are drawn, for all plottables that are visible. Since \ref
+  draw may run on another thread (see \ref QCP::phParallelRasterization) and must thus not change
+  the state of the plottable, this is the place to e.g. start or cancel background work that
+  depends on the current view. The default implementation does nothing.
+*/
+
 /* end of documentation of inline functions */
 /* start of documentation of pure virtual functions */
 
@@ -10735,6 +11533,7 @@ QCPAbstractPlottable::~QCPAbstractPlottable()
 void QCPAbstractPlottable::setName(const QString &name)
 {
   mName = name;
+  markLayerDirty();
 }
 
 /*!
@@ -10746,6 +11545,7 @@ void QCPAbstractPlottable::setName(const QString &name)
 void QCPAbstractPlottable::setAntialiasedFill(bool enabled)
 {
   mAntialiasedFill = enabled;
+  markLayerDirty();
 }
 
 /*!
@@ -10757,6 +11557,7 @@ void QCPAbstractPlottable::setAntialiasedFill(bool enabled)
 void QCPAbstractPlottable::setAntialiasedScatters(bool enabled)
 {
   mAntialiasedScatters = enabled;
+  markLayerDirty();
 }
 
 /*!
@@ -10770,6 +11571,7 @@ void QCPAbstractPlottable::setAntialiasedScatters(bool enabled)
 void QCPAbstractPlottable::setPen(const QPen &pen)
 {
   mPen = pen;
+  markLayerDirty();
 }
 
 /*!
@@ -10784,6 +11586,7 @@ void QCPAbstractPlottable::setPen(const QPen &pen)
 void QCPAbstractPlottable::setBrush(const QBrush &brush)
 {
   mBrush = brush;
+  markLayerDirty();
 }
 
 /*!
@@ -10800,6 +11603,7 @@ void QCPAbstractPlottable::setBrush(const QBrush &brush)
 void QCPAbstractPlottable::setKeyAxis(QCPAxis *axis)
 {
   mKeyAxis = axis;
+  markLayerDirty();
 }
 
 /*!
@@ -10816,6 +11620,7 @@ void QCPAbstractPlottable::setKeyAxis(QCPAxis *axis)
 void QCPAbstractPlottable::setValueAxis(QCPAxis *axis)
 {
   mValueAxis = axis;
+  markLayerDirty();
 }
 
 
@@ -10846,6 +11651,7 @@ void QCPAbstractPlottable::setSelection(QCPDataSelection selection)
     emit selectionChanged(selected());
     emit selectionChanged(mSelection);
   }
+  markLayerDirty();
 }
 
 /*!
@@ -10872,6 +11678,7 @@ void QCPAbstractPlottable::setSelectionDecorator(QCPSelectionDecorator *decorato
     delete mSelectionDecorator;
     mSelectionDecorator = 0;
   }
+  markLayerDirty();
 }
 
 /*!
@@ -10901,6 +11708,33 @@ void QCPAbstractPlottable::setSelectable(QCP::SelectionType selectable)
 }
 
 
+/*!
+  Returns the number of bytes this plottable holds in its data and cached images, including unused
+  preallocated memory. If \a reclaimableBytes is not zero, it is set to the part of it that \ref
+  releaseMemory would free.
+  
+  The base class implementation returns zero. Plottables holding considerable memory reimplement
+  this method, and the report of \ref QCustomPlot::memoryReport is based on it.
+*/
+qint64 QCPAbstractPlottable::memoryUsage(qint64 *reclaimableBytes) const
+{
+  if (reclaimableBytes)
+    *reclaimableBytes = 0;
+  return 0;
+}
+
+/*!
+  Frees memory this plottable doesn't strictly need, e.g. unused preallocated space of its data
+  container or caches that are recreated on demand. The plot keeps its appearance.
+  
+  This is called by \ref QCustomPlot::releaseMemory. The base class implementation does nothing.
+  
+  \see memoryUsage
+*/
+void QCPAbstractPlottable::releaseMemory()
+{
+}
+
 /*!
   Convenience function for transforming a key/value pair to pixels on the QCustomPlot surface,
   taking the orientations of the axes associated with this plottable into account (e.g. whether key
@@ -11593,6 +12427,7 @@ void QCPItemPosition::setTypeX(QCPItemPosition::PositionType type)
     
     if (retainPixelPosition)
       setPixelPosition(pixel);
+    mParentItem->markLayerDirty();
   }
 }
 
@@ -11623,6 +12458,7 @@ void QCPItemPosition::setTypeY(QCPItemPosition::PositionType type)
     
     if (retainPixelPosition)
       setPixelPosition(pixel);
+    mParentItem->markLayerDirty();
   }
 }
 
@@ -11713,6 +12549,7 @@ bool QCPItemPosition::setParentAnchorX(QCPItemAnchor *parentAnchor, bool keepPix
     setPixelPosition(pixelP);
   else
     setCoords(0, coords().y());
+  mParentItem->markLayerDirty();
   return true;
 }
 
@@ -11778,6 +12615,7 @@ bool QCPItemPosition::setParentAnchorY(QCPItemAnchor *parentAnchor, bool keepPix
     setPixelPosition(pixelP);
   else
     setCoords(coords().x(), 0);
+  mParentItem->markLayerDirty();
   return true;
 }
 
@@ -11800,8 +12638,12 @@ bool QCPItemPosition::setParentAnchorY(QCPItemAnchor *parentAnchor, bool keepPix
 */
 void QCPItemPosition::setCoords(double key, double value)
 {
-  mKey = key;
-  mValue = value;
+  if (mKey != key || mValue != value) // items like QCPItemTracer update their positions while drawing, so only mark actual changes
+  {
+    mKey = key;
+    mValue = value;
+    mParentItem->markLayerDirty();
+  }
 }
 
 /*! \overload
@@ -11924,6 +12766,7 @@ void QCPItemPosition::setAxes(QCPAxis *keyAxis, QCPAxis *valueAxis)
 {
   mKeyAxis = keyAxis;
   mValueAxis = valueAxis;
+  mParentItem->markLayerDirty();
 }
 
 /*!
@@ -11934,6 +12777,7 @@ void QCPItemPosition::setAxes(QCPAxis *keyAxis, QCPAxis *valueAxis)
 void QCPItemPosition::setAxisRect(QCPAxisRect *axisRect)
 {
   mAxisRect = axisRect;
+  mParentItem->markLayerDirty();
 }
 
 /*!
@@ -12239,6 +13083,36 @@ QCPAxisRect *QCPAbstractItem::clipAxisRect() const
   return mClipAxisRect.data();
 }
 
+/*!
+  Additionally takes the items into account which the positions of this item are anchored to (see
+  \ref QCPItemPosition::setParentAnchor), because moving them moves this item, too.
+  
+  \seebaseclassmethod
+*/
+quint64 QCPAbstractItem::contentRevision() const
+{
+  quint64 result = QCPLayerable::contentRevision();
+  foreach (QCPItemPosition *position, mPositions)
+  {
+    if (position->parentAnchorX())
+      result += position->parentAnchorX()->mParentItem->contentRevision();
+    if (position->parentAnchorY() && position->parentAnchorY() != position->parentAnchorX())
+      result += position->parentAnchorY()->mParentItem->contentRevision();
+  }
+  return result;
+}
+
+/*!
+  Returns an estimate of the number of bytes this item holds, for \ref QCustomPlot::memoryReport.
+  
+  The base class implementation accounts for the positions and anchors of the item. Items holding
+  larger resources, like the pixmap of \ref QCPItemPixmap, add them in their reimplementation.
+*/
+qint64 QCPAbstractItem::memoryUsage() const
+{
+  return qint64(mPositions.size())*sizeof(QCPItemPosition) + qint64(mAnchors.size()-mPositions.size())*sizeof(QCPItemAnchor);
+}
+
 /*!
   Sets whether the item shall be clipped to an axis rect or whether it shall be visible on the
   entire QCustomPlot. The axis rect can be set with \ref setClipAxisRect.
@@ -12250,6 +13124,7 @@ void QCPAbstractItem::setClipToAxisRect(bool clip)
   mClipToAxisRect = clip;
   if (mClipToAxisRect)
     setParentLayerable(mClipAxisRect.data());
+  markLayerDirty();
 }
 
 /*!
@@ -12263,6 +13138,7 @@ void QCPAbstractItem::setClipAxisRect(QCPAxisRect *rect)
   mClipAxisRect = rect;
   if (mClipToAxisRect)
     setParentLayerable(mClipAxisRect.data());
+  markLayerDirty();
 }
 
 /*!
@@ -12303,6 +13179,7 @@ void QCPAbstractItem::setSelected(bool selected)
   {
     mSelected = selected;
     emit selectionChanged(mSelected);
+    markLayerDirty();
   }
 }
 
@@ -12547,114 +13424,424 @@ QCP::Interaction QCPAbstractItem::selectionCategory() const
 /* end of 'src/item.cpp' */
 
 
-/* including file 'src/core.cpp', size 126207                                */
-/* commit ce344b3f96a62e5f652585e55f1ae7c7883cd45b 2018-06-25 01:03:39 +0200 */
+/* including file 'src/replotstatistics.cpp'                                */
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
-//////////////////// QCustomPlot
+//////////////////// QCPLayerableStatistics
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-/*! \class QCustomPlot
+/*! \class QCPLayerableStatistics
+  \brief The drawing statistics of a single layerable in one replot
   
-  \brief The central class of the library. This is the QWidget which displays the plot and
-  interacts with the user.
+  Instances are part of \ref QCPReplotStatistics::layerables, see \ref
+  QCustomPlot::setReplotStatisticsEnabled.
   
-  For tutorials on how to use QCustomPlot, see the website\n
-  http://www.qcustomplot.com/
+  \a drawTime is the time in milliseconds the layerable spent in its draw method. For graphs, \a
+  inputPointCount is the number of visible data points, and \a outputPointCount the number of
+  points that remained after the adaptive sampling and were actually converted to pixel
+  coordinates. For other layerables, both are zero.
 */
 
-/* start of documentation of inline functions */
+/*!
+  Creates a QCPLayerableStatistics instance with all values set to zero.
+*/
+QCPLayerableStatistics::QCPLayerableStatistics() :
+  drawTime(0),
+  inputPointCount(0),
+  outputPointCount(0)
+{
+}
 
-/*! \fn QCPSelectionRect *QCustomPlot::selectionRect() const
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPReplotStatistics
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPReplotStatistics
+  \brief Phase timings and counters of one replot
   
-  Allows access to the currently used QCPSelectionRect instance (or subclass thereof), that is used
-  to handle and draw selection rect interactions (see \ref setSelectionRectMode).
+  If enabled with \ref QCustomPlot::setReplotStatisticsEnabled, QCustomPlot measures how the time
+  of each replot is spent, and provides the result of the last replot via \ref
+  QCustomPlot::replotStatistics. All times are in milliseconds:
   
-  \see setSelectionRect
-*/
-
-/*! \fn QCPLayoutGrid *QCustomPlot::plotLayout() const
+  \li \a replotTime: the entire \ref QCustomPlot::replot call
+  \li \a layoutTime: updating the layout, including \a tickTime
+  \li \a tickTime: generating ticks and tick labels of all axes
+  \li \a bufferSetupTime: creating, resizing and assigning the paint buffers
+  \li \a drawTime: drawing the layers into the paint buffers
+  \li \a paintTime: painting the buffers onto the widget surface. If the replot only schedules a
+  repaint (see \ref QCustomPlot::replot), this is filled in once the widget was painted.
   
-  Returns the top level layout of this QCustomPlot instance. It is a \ref QCPLayoutGrid, initially containing just
-  one cell with the main QCPAxisRect inside.
+  \a paintBufferCount is the number of paint buffers, and \a paintBufferReallocations the number of
+  paint buffers that were created or reallocated due to a resize or device pixel ratio change.
+  \a redrawnLayerCount and \a reusedLayerCount are the layers that were redrawn and the layers
+  whose buffer content was reused, like \ref QCustomPlot::redrawnLayerCount. \a replotRequestCount
+  counts the calls of \ref QCustomPlot::replot since the previous replot (the replot that is
+  performed for queued calls isn't a request of its own), \a coalescedRequestCount the queued ones
+  among them that were merged into an already pending queued replot.
+  
+  \a layerables holds the statistics of each drawn layerable, in drawing order.
 */
 
-/* end of documentation of inline functions */
-/* start of documentation of signals */
-
-/*! \fn void QCustomPlot::mouseDoubleClick(QMouseEvent *event)
+/*!
+  Creates a QCPReplotStatistics instance with all values set to zero.
+*/
+QCPReplotStatistics::QCPReplotStatistics() :
+  replotTime(0),
+  layoutTime(0),
+  tickTime(0),
+  bufferSetupTime(0),
+  drawTime(0),
+  paintTime(0),
+  paintBufferCount(0),
+  paintBufferReallocations(0),
+  redrawnLayerCount(0),
+  reusedLayerCount(0),
+  replotRequestCount(0),
+  coalescedRequestCount(0)
+{
+}
 
-  This signal is emitted when the QCustomPlot receives a mouse double click event.
+/*!
+  Returns a human readable summary of the statistics, spanning multiple lines. The last lines list
+  the \a maxLayerables layerables with the longest draw times. This is the text shown by \ref
+  QCPReplotStatisticsHud.
 */
+QString QCPReplotStatistics::toString(int maxLayerables) const
+{
+  QString result = QString(QLatin1String("replot %1 ms: layout %2 (ticks %3), buffers %4, draw %5, paint %6"))
+      .arg(replotTime, 0, 'f', 2).arg(layoutTime, 0, 'f', 2).arg(tickTime, 0, 'f', 2)
+      .arg(bufferSetupTime, 0, 'f', 2).arg(drawTime, 0, 'f', 2).arg(paintTime, 0, 'f', 2);
+  result += QString(QLatin1String("\nlayers: %1 redrawn, %2 reused; paint buffers: %3, %4 reallocated"))
+      .arg(redrawnLayerCount).arg(reusedLayerCount).arg(paintBufferCount).arg(paintBufferReallocations);
+  result += QString(QLatin1String("\nreplot requests: %1, %2 coalesced")).arg(replotRequestCount).arg(coalescedRequestCount);
+  
+  QList<QCPLayerableStatistics> sorted = layerables;
+  std::stable_sort(sorted.begin(), sorted.end(), moreDrawTime);
+  for (int i=0; i<qMin(maxLayerables, sorted.size()); ++i)
+  {
+    const QCPLayerableStatistics &entry = sorted.at(i);
+    QString name = QLatin1String("(deleted)");
+    if (QCPLayerable *layerable = entry.layerable.data())
+    {
+      name = QLatin1String(layerable->metaObject()->className());
+      if (QCPAbstractPlottable *plottable = qobject_cast<QCPAbstractPlottable*>(layerable))
+      {
+        if (!plottable->name().isEmpty())
+          name += QLatin1String(" \"") + plottable->name() + QLatin1Char('"');
+      }
+    }
+    result += QString(QLatin1String("\n%1: %2 ms")).arg(name).arg(entry.drawTime, 0, 'f', 2);
+    if (entry.inputPointCount > 0)
+      result += QString(QLatin1String(", %1 -> %2 points")).arg(entry.inputPointCount).arg(entry.outputPointCount);
+  }
+  return result;
+}
 
-/*! \fn void QCustomPlot::mousePress(QMouseEvent *event)
 
-  This signal is emitted when the QCustomPlot receives a mouse press event.
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPReplotStatisticsHud
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPReplotStatisticsHud
+  \brief Shows the replot statistics as text overlay on the plot
   
-  It is emitted before QCustomPlot handles any other mechanism like range dragging. So a slot
-  connected to this signal can still influence the behaviour e.g. with \ref QCPAxisRect::setRangeDrag or \ref
-  QCPAxisRect::setRangeDragAxes.
+  The heads-up display draws \ref QCPReplotStatistics::toString of the previous replot into the
+  top left corner of the viewport. It is created and removed with \ref
+  QCustomPlot::setReplotStatisticsHudVisible, and placed on the "overlay" layer. Access it via \ref
+  QCustomPlot::replotStatisticsHud to change its appearance.
 */
 
-/*! \fn void QCustomPlot::mouseMove(QMouseEvent *event)
+/*!
+  Creates a new QCPReplotStatisticsHud instance. Usually it is created by \ref
+  QCustomPlot::setReplotStatisticsHudVisible instead.
+*/
+QCPReplotStatisticsHud::QCPReplotStatisticsHud(QCustomPlot *parentPlot) :
+  QCPLayerable(parentPlot),
+  mTextColor(Qt::white),
+  mBrush(QColor(0, 0, 0, 160))
+{
+  mFont = parentPlot->font();
+  mFont.setFamily(QLatin1String("Monospace"));
+  mFont.setStyleHint(QFont::TypeWriter);
+}
 
-  This signal is emitted when the QCustomPlot receives a mouse move event.
-  
-  It is emitted before QCustomPlot handles any other mechanism like range dragging. So a slot
-  connected to this signal can still influence the behaviour e.g. with \ref QCPAxisRect::setRangeDrag or \ref
-  QCPAxisRect::setRangeDragAxes.
-  
-  \warning It is discouraged to change the drag-axes with \ref QCPAxisRect::setRangeDragAxes here,
-  because the dragging starting point was saved the moment the mouse was pressed. Thus it only has
-  a meaning for the range drag axes that were set at that moment. If you want to change the drag
-  axes, consider doing this in the \ref mousePress signal instead.
+/*!
+  Sets the font of the statistics text.
 */
+void QCPReplotStatisticsHud::setFont(const QFont &font)
+{
+  mFont = font;
+  markLayerDirty();
+}
 
-/*! \fn void QCustomPlot::mouseRelease(QMouseEvent *event)
+/*!
+  Sets the color of the statistics text.
+*/
+void QCPReplotStatisticsHud::setTextColor(const QColor &color)
+{
+  mTextColor = color;
+  markLayerDirty();
+}
 
-  This signal is emitted when the QCustomPlot receives a mouse release event.
-  
-  It is emitted before QCustomPlot handles any other mechanisms like object selection. So a
-  slot connected to this signal can still influence the behaviour e.g. with \ref setInteractions or
-  \ref QCPAbstractPlottable::setSelectable.
+/*!
+  Sets the brush of the background box behind the statistics text. Use Qt::NoBrush to omit the
+  box.
 */
+void QCPReplotStatisticsHud::setBrush(const QBrush &brush)
+{
+  mBrush = brush;
+  markLayerDirty();
+}
 
-/*! \fn void QCustomPlot::mouseWheel(QMouseEvent *event)
+/* inherits documentation from base class */
+void QCPReplotStatisticsHud::applyDefaultAntialiasingHint(QCPPainter *painter) const
+{
+  applyAntialiasingHint(painter, mAntialiased, QCP::aeOther);
+}
 
-  This signal is emitted when the QCustomPlot receives a mouse wheel event.
+/*! \internal
   
-  It is emitted before QCustomPlot handles any other mechanisms like range zooming. So a slot
-  connected to this signal can still influence the behaviour e.g. with \ref QCPAxisRect::setRangeZoom, \ref
-  QCPAxisRect::setRangeZoomAxes or \ref QCPAxisRect::setRangeZoomFactor.
+  Draws the statistics of the previous replot, since the current replot is still in progress.
+  
+  \seebaseclassmethod
 */
+void QCPReplotStatisticsHud::draw(QCPPainter *painter)
+{
+  const QString text = mParentPlot->replotStatistics().toString();
+  painter->setFont(mFont);
+  const QRect textRect = painter->fontMetrics().boundingRect(mParentPlot->viewport().adjusted(8, 8, -8, -8), Qt::AlignLeft|Qt::AlignTop, text);
+  painter->setPen(Qt::NoPen);
+  painter->setBrush(mBrush);
+  painter->drawRect(textRect.adjusted(-4, -4, 4, 4));
+  painter->setPen(mTextColor);
+  painter->drawText(textRect, Qt::AlignLeft|Qt::AlignTop, text);
+}
+/* end of 'src/replotstatistics.cpp' */
 
-/*! \fn void QCustomPlot::plottableClick(QCPAbstractPlottable *plottable, int dataIndex, QMouseEvent *event)
 
-  This signal is emitted when a plottable is clicked.
+/* including file 'src/memoryreport.cpp'                                    */
 
-  \a event is the mouse event that caused the click and \a plottable is the plottable that received
-  the click. The parameter \a dataIndex indicates the data point that was closest to the click
-  position.
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPMemoryReport
+////////////////////////////////////////////////////////////////////////////////////////////////////
 
-  \see plottableDoubleClick
+/*! \class QCPMemoryReport
+  \brief A breakdown of the memory held by a QCustomPlot
+  
+  A report is created by \ref QCustomPlot::memoryReport. Each \ref Entry accounts for a plottable, a
+  paint buffer, the tick label cache of an axis, an item or the scratch vector pools, as given by its
+  \ref Category. The \a
+  name identifies the object, \a bytes is the memory it holds and \a reclaimableBytes the part of
+  it that \ref QCustomPlot::releaseMemory would free, e.g. unused preallocated space of data
+  containers.
+  
+  The numbers cover the large allocations (data points, images, pixmaps and buffers), not the
+  QObject instances themselves. Data containers shared between plottables are accounted for with
+  each plottable.
 */
 
-/*! \fn void QCustomPlot::plottableDoubleClick(QCPAbstractPlottable *plottable, int dataIndex, QMouseEvent *event)
-
-  This signal is emitted when a plottable is double clicked.
-
-  \a event is the mouse event that caused the click and \a plottable is the plottable that received
-  the click. The parameter \a dataIndex indicates the data point that was closest to the click
-  position.
+/*!
+  Creates an empty report.
+*/
+QCPMemoryReport::QCPMemoryReport()
+{
+}
 
-  \see plottableClick
+/*!
+  Returns the sum of the bytes of all entries.
 */
+qint64 QCPMemoryReport::totalBytes() const
+{
+  qint64 result = 0;
+  for (int i=0; i<entries.size(); ++i)
+    result += entries.at(i).bytes;
+  return result;
+}
 
-/*! \fn void QCustomPlot::itemClick(QCPAbstractItem *item, QMouseEvent *event)
+/*! \overload
   
-  This signal is emitted when an item is clicked.
-
-  \a event is the mouse event that caused the click and \a item is the item that received the
+  Returns the sum of the bytes of all entries with the given \a category.
+*/
+qint64 QCPMemoryReport::totalBytes(Category category) const
+{
+  qint64 result = 0;
+  for (int i=0; i<entries.size(); ++i)
+  {
+    if (entries.at(i).category == category)
+      result += entries.at(i).bytes;
+  }
+  return result;
+}
+
+/*!
+  Returns the sum of the reclaimable bytes of all entries.
+*/
+qint64 QCPMemoryReport::reclaimableBytes() const
+{
+  qint64 result = 0;
+  for (int i=0; i<entries.size(); ++i)
+    result += entries.at(i).reclaimableBytes;
+  return result;
+}
+
+/*!
+  Returns a human readable listing of the entries and totals, one entry per line.
+*/
+QString QCPMemoryReport::toString() const
+{
+  QString result = QString(QLatin1String("total %1 kB, %2 kB reclaimable"))
+      .arg(totalBytes()/1024.0, 0, 'f', 1).arg(reclaimableBytes()/1024.0, 0, 'f', 1);
+  for (int i=0; i<entries.size(); ++i)
+  {
+    const Entry &entry = entries.at(i);
+    result += QString(QLatin1String("\n%1: %2 kB")).arg(entry.name).arg(entry.bytes/1024.0, 0, 'f', 1);
+    if (entry.reclaimableBytes > 0)
+      result += QString(QLatin1String(" (%1 kB reclaimable)")).arg(entry.reclaimableBytes/1024.0, 0, 'f', 1);
+  }
+  return result;
+}
+/* end of 'src/memoryreport.cpp' */
+
+
+/* including file 'src/core.cpp', size 126207                                */
+/* commit ce344b3f96a62e5f652585e55f1ae7c7883cd45b 2018-06-25 01:03:39 +0200 */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCustomPlot
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCustomPlot
+  
+  \brief The central class of the library. This is the QWidget which displays the plot and
+  interacts with the user.
+  
+  For tutorials on how to use QCustomPlot, see the website\n
+  http://www.qcustomplot.com/
+*/
+
+/* start of documentation of inline functions */
+
+/*! \fn QCPSelectionRect *QCustomPlot::selectionRect() const
+  
+  Allows access to the currently used QCPSelectionRect instance (or subclass thereof), that is used
+  to handle and draw selection rect interactions (see \ref setSelectionRectMode).
+  
+  \see setSelectionRect
+*/
+
+/*! \fn QCPLayoutGrid *QCustomPlot::plotLayout() const
+  
+  Returns the top level layout of this QCustomPlot instance. It is a \ref QCPLayoutGrid, initially containing just
+  one cell with the main QCPAxisRect inside.
+*/
+
+/*! \fn int QCustomPlot::redrawnLayerCount() const
+  
+  Returns how many layers were drawn into their paint buffer during the last \ref replot. Layers
+  sharing a paint buffer with a dirty layer (see \ref QCPLayer::dirty) are redrawn, too, and are
+  included in this count.
+  
+  \see reusedLayerCount
+*/
+
+/*! \fn int QCustomPlot::reusedLayerCount() const
+  
+  Returns how many layers weren't drawn during the last \ref replot, because neither they nor any
+  other layer sharing their paint buffer had changed, so the existing buffer content was reused.
+  
+  \see redrawnLayerCount
+*/
+
+/*! \fn QCPReplotStatistics QCustomPlot::replotStatistics() const
+  
+  Returns the phase timings and counters of the last \ref replot. The statistics are only
+  collected if enabled with \ref setReplotStatisticsEnabled, otherwise all values are zero.
+*/
+
+/*! \fn QCPReplotStatisticsHud *QCustomPlot::replotStatisticsHud() const
+  
+  Returns the overlay that shows the replot statistics on the plot, or 0 if it isn't shown.
+  
+  \see setReplotStatisticsHudVisible
+*/
+
+/* end of documentation of inline functions */
+/* start of documentation of signals */
+
+/*! \fn void QCustomPlot::mouseDoubleClick(QMouseEvent *event)
+
+  This signal is emitted when the QCustomPlot receives a mouse double click event.
+*/
+
+/*! \fn void QCustomPlot::mousePress(QMouseEvent *event)
+
+  This signal is emitted when the QCustomPlot receives a mouse press event.
+  
+  It is emitted before QCustomPlot handles any other mechanism like range dragging. So a slot
+  connected to this signal can still influence the behaviour e.g. with \ref QCPAxisRect::setRangeDrag or \ref
+  QCPAxisRect::setRangeDragAxes.
+*/
+
+/*! \fn void QCustomPlot::mouseMove(QMouseEvent *event)
+
+  This signal is emitted when the QCustomPlot receives a mouse move event.
+  
+  It is emitted before QCustomPlot handles any other mechanism like range dragging. So a slot
+  connected to this signal can still influence the behaviour e.g. with \ref QCPAxisRect::setRangeDrag or \ref
+  QCPAxisRect::setRangeDragAxes.
+  
+  \warning It is discouraged to change the drag-axes with \ref QCPAxisRect::setRangeDragAxes here,
+  because the dragging starting point was saved the moment the mouse was pressed. Thus it only has
+  a meaning for the range drag axes that were set at that moment. If you want to change the drag
+  axes, consider doing this in the \ref mousePress signal instead.
+*/
+
+/*! \fn void QCustomPlot::mouseRelease(QMouseEvent *event)
+
+  This signal is emitted when the QCustomPlot receives a mouse release event.
+  
+  It is emitted before QCustomPlot handles any other mechanisms like object selection. So a
+  slot connected to this signal can still influence the behaviour e.g. with \ref setInteractions or
+  \ref QCPAbstractPlottable::setSelectable.
+*/
+
+/*! \fn void QCustomPlot::mouseWheel(QMouseEvent *event)
+
+  This signal is emitted when the QCustomPlot receives a mouse wheel event.
+  
+  It is emitted before QCustomPlot handles any other mechanisms like range zooming. So a slot
+  connected to this signal can still influence the behaviour e.g. with \ref QCPAxisRect::setRangeZoom, \ref
+  QCPAxisRect::setRangeZoomAxes or \ref QCPAxisRect::setRangeZoomFactor.
+*/
+
+/*! \fn void QCustomPlot::plottableClick(QCPAbstractPlottable *plottable, int dataIndex, QMouseEvent *event)
+
+  This signal is emitted when a plottable is clicked.
+
+  \a event is the mouse event that caused the click and \a plottable is the plottable that received
+  the click. The parameter \a dataIndex indicates the data point that was closest to the click
+  position.
+
+  \see plottableDoubleClick
+*/
+
+/*! \fn void QCustomPlot::plottableDoubleClick(QCPAbstractPlottable *plottable, int dataIndex, QMouseEvent *event)
+
+  This signal is emitted when a plottable is double clicked.
+
+  \a event is the mouse event that caused the click and \a plottable is the plottable that received
+  the click. The parameter \a dataIndex indicates the data point that was closest to the click
+  position.
+
+  \see plottableClick
+*/
+
+/*! \fn void QCustomPlot::itemClick(QCPAbstractItem *item, QMouseEvent *event)
+  
+  This signal is emitted when an item is clicked.
+
+  \a event is the mouse event that caused the click and \a item is the item that received the
   click.
   
   \see itemDoubleClick
@@ -12752,6 +13939,15 @@ QCP::Interaction QCPAbstractItem::selectionCategory() const
   \see replot, beforeReplot
 */
 
+/*! \fn void QCustomPlot::memoryBudgetExceeded(qint64 bytes, qint64 budget)
+  
+  This signal is emitted after a replot, if the plot holds \a bytes of memory, which is more than
+  the \a budget set with \ref setMemoryBudget. If \ref setAutoReleaseMemory is enabled, the signal
+  is only emitted if releasing memory didn't suffice.
+  
+  \see memoryReport
+*/
+
 /* end of documentation of signals */
 /* start of documentation of public members */
 
@@ -12880,11 +14076,29 @@ QCustomPlot::QCustomPlot(QWidget *parent) :
   mSelectionRectMode(QCP::srmNone),
   mSelectionRect(0),
   mOpenGl(false),
+  mInteractionDegradations(QCP::idNone),
+  mInteractionFrameBudget(16),
+  mInteractionRefineDelay(250),
+  mReplotScheduler(0),
+  mReplotPriority(0),
+  mReplotStatisticsEnabled(false),
+  mMemoryBudget(0),
+  mAutoReleaseMemory(false),
   mMouseHasMoved(false),
   mMouseEventLayerable(0),
   mMouseSignalLayerable(0),
   mReplotting(false),
   mReplotQueued(false),
+  mProcessingQueuedReplot(false),
+  mRedrawnLayerCount(0),
+  mReusedLayerCount(0),
+  mFastPanCancelled(false),
+  mInteracting(false),
+  mInteractionLevel(0),
+  mInteractionFastFrames(0),
+  mActiveInteractionDegradations(QCP::idNone),
+  mInteractionRefineTimer(new QTimer(this)),
+  mReplotStatisticsHud(0),
   mOpenGlMultisamples(16),
   mOpenGlAntialiasedElementsBackup(QCP::aeNone),
   mOpenGlCacheLabelsBackup(true)
@@ -12906,6 +14120,8 @@ QCustomPlot::QCustomPlot(QWidget *parent) :
   
   mOpenGlAntialiasedElementsBackup = mAntialiasedElements;
   mOpenGlCacheLabelsBackup = mPlottingHints.testFlag(QCP::phCacheLabels);
+  mInteractionRefineTimer->setSingleShot(true);
+  connect(mInteractionRefineTimer, SIGNAL(timeout()), this, SLOT(finishInteraction()));
   // create initial layers:
   mLayers.append(new QCPLayer(this, QLatin1String("background")));
   mLayers.append(new QCPLayer(this, QLatin1String("grid")));
@@ -12955,6 +14171,8 @@ QCustomPlot::QCustomPlot(QWidget *parent) :
 
 QCustomPlot::~QCustomPlot()
 {
+  if (mReplotScheduler)
+    mReplotScheduler->unregisterPlot(this);
   clearPlottables();
   clearItems();
 
@@ -12993,6 +14211,7 @@ void QCustomPlot::setAntialiasedElements(const QCP::AntialiasedElements &antiali
   // make sure elements aren't in mNotAntialiasedElements and mAntialiasedElements simultaneously:
   if ((mNotAntialiasedElements & mAntialiasedElements) != 0)
     mNotAntialiasedElements |= ~mAntialiasedElements;
+  markAllLayersDirty();
 }
 
 /*!
@@ -13012,6 +14231,7 @@ void QCustomPlot::setAntialiasedElement(QCP::AntialiasedElement antialiasedEleme
   // make sure elements aren't in mNotAntialiasedElements and mAntialiasedElements simultaneously:
   if ((mNotAntialiasedElements & mAntialiasedElements) != 0)
     mNotAntialiasedElements |= ~mAntialiasedElements;
+  markAllLayersDirty();
 }
 
 /*!
@@ -13039,6 +14259,7 @@ void QCustomPlot::setNotAntialiasedElements(const QCP::AntialiasedElements &notA
   // make sure elements aren't in mNotAntialiasedElements and mAntialiasedElements simultaneously:
   if ((mNotAntialiasedElements & mAntialiasedElements) != 0)
     mAntialiasedElements |= ~mNotAntialiasedElements;
+  markAllLayersDirty();
 }
 
 /*!
@@ -13058,6 +14279,7 @@ void QCustomPlot::setNotAntialiasedElement(QCP::AntialiasedElement notAntialiase
   // make sure elements aren't in mNotAntialiasedElements and mAntialiasedElements simultaneously:
   if ((mNotAntialiasedElements & mAntialiasedElements) != 0)
     mAntialiasedElements |= ~mNotAntialiasedElements;
+  markAllLayersDirty();
 }
 
 /*!
@@ -13180,11 +14402,34 @@ void QCustomPlot::setNoAntialiasingOnDrag(bool enabled)
 /*!
   Sets the plotting hints for this QCustomPlot instance as an \a or combination of QCP::PlottingHint.
   
+  If \ref QCP::phParallelRasterization is set and OpenGL is disabled, the paint buffers are
+  QImages (\ref QCPPaintBufferImage), and \ref replot draws the layers of different paint buffers
+  concurrently on the global QThreadPool, before they are composited onto the widget surface in
+  the paint event. Layers share a paint buffer unless they are in \ref QCPLayer::lmBuffered mode
+  (or adjacent to one), so to benefit from this hint, put heavy plottables on their own buffered
+  layers (e.g. separate buffered "grid", "main" and "overlay" layers). Since the layerables of
+  different paint buffers are then drawn at the same time, they must not depend on state that
+  another layerable changes while drawing. An example is an item anchored to a \ref QCPItemTracer
+  on a different buffered layer, since the tracer updates its position in its draw method. Further,
+  drawing QPixmaps (e.g. cached axis labels, \ref QCPItemPixmap or axis rect backgrounds) outside
+  the GUI thread requires a platform that supports threaded pixmaps, which is the case for the
+  common raster platforms of Qt 5 and newer.
+  
+  Toggling \ref QCP::phParallelRasterization recreates all paint buffers.
+  
   \see setPlottingHint
 */
 void QCustomPlot::setPlottingHints(const QCP::PlottingHints &hints)
 {
+  const bool bufferTypeChanged = hints.testFlag(QCP::phParallelRasterization) != mPlottingHints.testFlag(QCP::phParallelRasterization);
   mPlottingHints = hints;
+  if (bufferTypeChanged && !mOpenGl)
+  {
+    // recreate all paint buffers, so they have the type appropriate for the new hints:
+    mPaintBuffers.clear();
+    setupPaintBuffers();
+  }
+  markAllLayersDirty();
 }
 
 /*!
@@ -13363,6 +14608,271 @@ void QCustomPlot::setOpenGl(bool enabled, int multisampling)
 #endif
 }
 
+/*!
+  Sets which measures QCustomPlot may take to keep replots within the frame budget (\ref
+  setInteractionFrameBudget) while the user interacts with the plot. By default, this is \ref
+  QCP::idNone, i.e. the plot is always drawn in full quality.
+  
+  Interactions are range drags and wheel zooms on axis rects and axes, as well as anything else that
+  calls \ref notifyInteraction, e.g. moving cursor items with the mouse. The time each replot
+  during an interaction takes is measured. If it exceeds the frame budget, the next replot applies
+  one more of the allowed \a degradations (in the order of the \ref QCP::InteractionDegradation
+  enum). Once ten consecutive replots took less than a third of the budget, the most recently added
+  measure is lifted again. The reached level (\ref interactionLevel) is kept for the next interaction. Once no
+  interaction was registered for the refine delay (\ref setInteractionRefineDelay), a replot in
+  full quality is performed.
+  
+  This works independently of \ref setNoAntialiasingOnDrag, which always disables antialiasing
+  during drags.
+  
+  \see activeInteractionDegradations
+*/
+void QCustomPlot::setInteractionDegradations(const QCP::InteractionDegradations &degradations)
+{
+  mInteractionDegradations = degradations;
+}
+
+/*!
+  Sets the time in \a milliseconds a replot during an interaction should take at most. Replot times
+  above this budget make QCustomPlot reduce the rendering quality, see \ref
+  setInteractionDegradations. The default is 16 ms, corresponding to 60 frames per second.
+*/
+void QCustomPlot::setInteractionFrameBudget(double milliseconds)
+{
+  mInteractionFrameBudget = qMax(0.0, milliseconds);
+}
+
+/*!
+  Sets the time in \a milliseconds after the last registered interaction step, after which the
+  plot is replotted in full quality. See \ref setInteractionDegradations. The default is 250 ms.
+*/
+void QCustomPlot::setInteractionRefineDelay(int milliseconds)
+{
+  mInteractionRefineDelay = qMax(0, milliseconds);
+}
+
+/*!
+  Sets the replot scheduler that performs the queued replots of this plot (see \ref
+  QCustomPlot::rpQueuedReplot). Set \a scheduler to 0 (the default) to perform them in the next
+  event loop iteration.
+  
+  Applications with many plots can share one scheduler (e.g. \ref QCPReplotScheduler::instance)
+  between all of them, to coalesce their queued replots into frames with a maximum frame rate. See
+  the documentation of \ref QCPReplotScheduler for details.
+  
+  \see setReplotPriority
+*/
+void QCustomPlot::setReplotScheduler(QCPReplotScheduler *scheduler)
+{
+  if (scheduler == mReplotScheduler)
+    return;
+  QCPReplotScheduler *oldScheduler = mReplotScheduler.data();
+  if (oldScheduler)
+    oldScheduler->unregisterPlot(this);
+  mReplotScheduler = scheduler;
+  if (mReplotScheduler)
+    mReplotScheduler->registerPlot(this);
+  if (mReplotQueued && oldScheduler) // hand the pending queued replot over (without previous scheduler, the queued replot is already pending in the event loop)
+  {
+    if (mReplotScheduler)
+      mReplotScheduler->requestReplot(this);
+    else
+      QTimer::singleShot(0, this, SLOT(processQueuedReplot()));
+  }
+}
+
+/*!
+  Sets the priority of the queued replots of this plot in its replot scheduler (\ref
+  setReplotScheduler). If the replots of a frame exceed the frame budget, plots with higher \a
+  priority are replotted first. The default is 0.
+*/
+void QCustomPlot::setReplotPriority(int priority)
+{
+  mReplotPriority = priority;
+}
+
+/*!
+  Sets whether each replot measures how its time is spent. The statistics of the last replot are
+  available via \ref replotStatistics, see \ref QCPReplotStatistics for the collected values.
+  
+  The measurements add a small overhead to every replot, so they are disabled by default. To show
+  the statistics on the plot itself, use \ref setReplotStatisticsHudVisible.
+*/
+void QCustomPlot::setReplotStatisticsEnabled(bool enabled)
+{
+  if (mReplotStatisticsEnabled == enabled)
+    return;
+  mReplotStatisticsEnabled = enabled;
+  mReplotStatistics = QCPReplotStatistics();
+  mPendingStatistics = QCPReplotStatistics();
+  mLayerableStatistics.clear();
+  if (!enabled)
+    setReplotStatisticsHudVisible(false);
+}
+
+/*!
+  Sets whether the replot statistics are shown as text overlay in the top left corner of the plot,
+  by a \ref QCPReplotStatisticsHud on the "overlay" layer. Showing the overlay also enables the
+  statistics (\ref setReplotStatisticsEnabled).
+  
+  Since the overlay is redrawn in every replot, it shows the statistics of the respective previous
+  replot.
+  
+  \see replotStatisticsHud
+*/
+void QCustomPlot::setReplotStatisticsHudVisible(bool visible)
+{
+  if (visible && !mReplotStatisticsHud)
+  {
+    setReplotStatisticsEnabled(true);
+    mReplotStatisticsHud = new QCPReplotStatisticsHud(this);
+    mReplotStatisticsHud->setLayer(QLatin1String("overlay"));
+  } else if (!visible && mReplotStatisticsHud)
+  {
+    delete mReplotStatisticsHud;
+    mReplotStatisticsHud = 0;
+  }
+}
+
+/*!
+  Sets the memory budget of this plot to \a bytes. After a replot, at most once per second, the
+  memory held by the plot (see \ref memoryReport) is compared with the budget. If it's exceeded,
+  \ref setAutoReleaseMemory is enabled and releasing the reclaimable memory would get the plot
+  within the budget, \ref releaseMemory is called. If the memory still exceeds the budget, the
+  signal \ref memoryBudgetExceeded is emitted.
+  
+  A budget of 0, which is the default, disables the check.
+*/
+void QCustomPlot::setMemoryBudget(qint64 bytes)
+{
+  mMemoryBudget = qMax(qint64(0), bytes);
+}
+
+/*!
+  Sets whether \ref releaseMemory is called automatically when the memory budget (\ref
+  setMemoryBudget) is exceeded. Memory is only released if that gets the plot within the budget,
+  e.g. it isn't released while the data alone exceeds the budget.
+  
+  Releasing memory squeezes the data containers, which costs a copy of the data and causes a
+  redraw, and the following data additions need to allocate again. So the budget should leave
+  some headroom above the typical memory usage.
+*/
+void QCustomPlot::setAutoReleaseMemory(bool enabled)
+{
+  mAutoReleaseMemory = enabled;
+}
+
+/*!
+  Registers a step of a user interaction, so the following replots may use reduced quality as
+  configured with \ref setInteractionDegradations. The full quality is restored by a replot once
+  this method wasn't called for the time set with \ref setInteractionRefineDelay.
+  
+  QCustomPlot calls this method itself for range drags and wheel zooms. Call it when your
+  application replots the plot in response to other continuous user input, e.g. while moving a
+  cursor or marker item with the mouse.
+*/
+void QCustomPlot::notifyInteraction()
+{
+  if (mInteractionDegradations == QCP::idNone)
+    return;
+  mInteracting = true;
+  mInteractionRefineTimer->start(mInteractionRefineDelay);
+}
+
+/*!
+  Returns a breakdown of the memory held by this plot: the data and cached images of each plottable
+  (\ref QCPAbstractPlottable::memoryUsage), each paint buffer at its device pixel ratio, the tick
+  label cache of each axis, each item and the scratch vector pools (\ref QCPScratchVector). The
+  pools are shared by all plots, so they appear in the report of each plot.
+  
+  \see setMemoryBudget, releaseMemory
+*/
+QCPMemoryReport QCustomPlot::memoryReport() const
+{
+  QCPMemoryReport report;
+  foreach (QCPAbstractPlottable *plottable, mPlottables)
+  {
+    QCPMemoryReport::Entry entry;
+    entry.category = QCPMemoryReport::mcPlottable;
+    entry.name = QLatin1String(plottable->metaObject()->className());
+    if (!plottable->name().isEmpty())
+      entry.name += QLatin1String(" \"") + plottable->name() + QLatin1Char('"');
+    entry.bytes = plottable->memoryUsage(&entry.reclaimableBytes);
+    report.entries.append(entry);
+  }
+  for (int i=0; i<mPaintBuffers.size(); ++i)
+  {
+    const QCPAbstractPaintBuffer *buffer = mPaintBuffers.at(i).data();
+    QStringList layerNames;
+    foreach (QCPLayer *layer, mLayers)
+    {
+      if (layer->mPaintBuffer.data() == buffer)
+        layerNames.append(layer->name());
+    }
+    QCPMemoryReport::Entry entry;
+    entry.category = QCPMemoryReport::mcPaintBuffer;
+    entry.name = QString(QLatin1String("paint buffer %1 (%2)")).arg(i).arg(layerNames.join(QLatin1String(", ")));
+    entry.bytes = qint64(qCeil(buffer->size().width()*buffer->devicePixelRatio()))*qCeil(buffer->size().height()*buffer->devicePixelRatio())*4;
+    entry.reclaimableBytes = 0;
+    report.entries.append(entry);
+  }
+  const QList<QCPAxisRect*> rects = axisRects();
+  const QMetaEnum axisTypeEnum = QCPAxis::staticMetaObject.enumerator(QCPAxis::staticMetaObject.indexOfEnumerator("AxisType"));
+  for (int i=0; i<rects.size(); ++i)
+  {
+    foreach (QCPAxis *axis, rects.at(i)->axes())
+    {
+      QCPMemoryReport::Entry entry;
+      entry.category = QCPMemoryReport::mcLabelCache;
+      entry.name = QString(QLatin1String("label cache of axis rect %1, %2 axis %3")).arg(i)
+          .arg(QLatin1String(axisTypeEnum.valueToKey(axis->axisType())))
+          .arg(rects.at(i)->axes(axis->axisType()).indexOf(axis));
+      entry.bytes = axis->mAxisPainter->cacheMemoryUsage();
+      entry.reclaimableBytes = entry.bytes;
+      report.entries.append(entry);
+    }
+  }
+  foreach (QCPAbstractItem *item, mItems)
+  {
+    QCPMemoryReport::Entry entry;
+    entry.category = QCPMemoryReport::mcItem;
+    entry.name = QLatin1String(item->metaObject()->className());
+    entry.bytes = item->memoryUsage();
+    entry.reclaimableBytes = 0;
+    report.entries.append(entry);
+  }
+  QCPMemoryReport::Entry scratchEntry;
+  scratchEntry.category = QCPMemoryReport::mcScratch;
+  scratchEntry.name = QLatin1String("scratch vector pools (shared by all plots)");
+  scratchEntry.bytes = QCPScratchPool::totalMemoryUsage();
+  scratchEntry.reclaimableBytes = scratchEntry.bytes;
+  report.entries.append(scratchEntry);
+  return report;
+}
+
+/*!
+  Frees memory the plot doesn't strictly need, without changing its appearance: Each plottable
+  releases unused preallocated memory and caches (\ref QCPAbstractPlottable::releaseMemory), the
+  tick label caches of all axes are cleared, and the pooled scratch vectors of all threads are
+  deleted (\ref QCPScratchPool::trimAll).
+  
+  This is called automatically when the memory budget is exceeded, if \ref setAutoReleaseMemory is
+  enabled.
+  
+  \see memoryReport
+*/
+void QCustomPlot::releaseMemory()
+{
+  foreach (QCPAbstractPlottable *plottable, mPlottables)
+    plottable->releaseMemory();
+  foreach (QCPAxisRect *rect, axisRects())
+  {
+    foreach (QCPAxis *axis, rect->axes())
+      axis->mAxisPainter->clearCache();
+  }
+  QCPScratchPool::trimAll();
+}
+
 /*!
   Sets the viewport of this QCustomPlot. Usually users of QCustomPlot don't need to change the
   viewport manually.
@@ -13404,7 +14914,12 @@ void QCustomPlot::setBufferDevicePixelRatio(double ratio)
 #ifdef QCP_DEVICEPIXELRATIO_SUPPORTED
     mBufferDevicePixelRatio = ratio;
     for (int i=0; i<mPaintBuffers.size(); ++i)
-      mPaintBuffers.at(i)->setDevicePixelRatio(mBufferDevicePixelRatio);
+    {
+      mPaintBuffers.at(i)->setDevicePixelRatio(effectiveBufferDevicePixelRatio());
+      mPaintBuffers.at(i)->setInvalidated(); // reallocated buffer content is undefined
+    }
+    if (mReplotStatisticsEnabled)
+      mPendingStatistics.paintBufferReallocations += mPaintBuffers.size();
     // Note: axis label cache has devicePixelRatio as part of cache hash, so no need to manually clear cache here
 #else
     qDebug() << Q_FUNC_INFO << "Device pixel ratios not supported for Qt versions before 5.4";
@@ -14179,6 +15694,19 @@ bool QCustomPlot::moveLayer(QCPLayer *layer, QCPLayer *otherLayer, QCustomPlot::
   return true;
 }
 
+/*!
+  Marks all layers as dirty, so the next \ref replot redraws every paint buffer. This is done
+  automatically when plot-wide settings which affect all layerables change, e.g. \ref
+  setAntialiasedElements or the range of an axis.
+  
+  \see QCPLayer::markDirty, QCPLayerable::markLayerDirty
+*/
+void QCustomPlot::markAllLayersDirty()
+{
+  foreach (QCPLayer *layer, mLayers)
+    layer->mDirty = true;
+}
+
 /*!
   Returns the number of axis rects in the plot.
   
@@ -14395,6 +15923,40 @@ void QCustomPlot::deselectAll()
   }
 }
 
+/*! \internal
+  
+  Draws the layer groups \a groups[i] for i in [\a begin, \a end) into their paint buffers, as part
+  of \ref QCustomPlot::replot. Each group is a range of adjacent layers sharing one paint buffer.
+  If the plotting hint \ref QCP::phParallelRasterization is set, instances are passed to \ref
+  qcpParallelFor, so the paint buffers are drawn concurrently.
+*/
+class QCPLayerGroupDrawFunctor
+{
+public:
+  QCPLayerGroupDrawFunctor(const QList<QCPLayer*> &layers, const QVector<QPair<int, int> > &groups) :
+    mLayers(layers), mGroups(groups)
+  {}
+  
+  void operator()(int begin, int end) const
+  {
+    for (int i=begin; i<end; ++i)
+    {
+      const QPair<int, int> group = mGroups.at(i);
+      QCPAbstractPaintBuffer *buffer = mLayers.at(group.first)->mPaintBuffer.data();
+      if (buffer)
+        buffer->clear(Qt::transparent);
+      for (int layerIndex=group.first; layerIndex<group.second; ++layerIndex)
+        mLayers.at(layerIndex)->drawToPaintBuffer();
+      if (buffer)
+        buffer->setInvalidated(false);
+    }
+  }
+  
+private:
+  const QList<QCPLayer*> &mLayers;
+  const QVector<QPair<int, int> > &mGroups;
+};
+
 /*!
   Causes a complete replot into the internal paint buffer(s). Finally, the widget surface is
   refreshed with the new buffer contents. This is the method that must be called to make changes to
@@ -14406,7 +15968,8 @@ void QCustomPlot::deselectAll()
   it is advisable to set \a refreshPriority to \ref QCustomPlot::rpQueuedReplot. This way, the
   actual replotting is deferred to the next event loop iteration. Multiple successive calls of \ref
   replot with this priority will only cause a single replot, avoiding redundant replots and
-  improving performance.
+  improving performance. If a replot scheduler is set (\ref setReplotScheduler), it performs the
+  queued replot instead, in its next frame.
 
   Under a few circumstances, QCustomPlot causes a replot by itself. Those are resize events of the
   QCustomPlot widget and user interactions (object selection and range dragging/zooming).
@@ -14416,41 +15979,152 @@ void QCustomPlot::deselectAll()
   signals on two QCustomPlots to make them replot synchronously, it won't cause an infinite
   recursion.
 
+  Right after \ref beforeReplot was emitted, the data that other threads have pushed into the
+  ingest channels of plottables (see \ref QCPAbstractPlottable1D::ingestChannel) is merged into the
+  respective data containers.
+
   If a layer is in mode \ref QCPLayer::lmBuffered (\ref QCPLayer::setMode), it is also possible to
   replot only that specific layer via \ref QCPLayer::replot. See the documentation there for
   details.
+
+  If the plotting hint \ref QCP::phParallelRasterization is set, the paint buffers that need
+  redrawing are drawn concurrently, see \ref setPlottingHints.
 */
 void QCustomPlot::replot(QCustomPlot::RefreshPriority refreshPriority)
 {
   if (refreshPriority == QCustomPlot::rpQueuedReplot)
   {
+    if (mReplotStatisticsEnabled)
+    {
+      ++mPendingStatistics.replotRequestCount;
+      if (mReplotQueued)
+        ++mPendingStatistics.coalescedRequestCount;
+    }
     if (!mReplotQueued)
     {
       mReplotQueued = true;
-      QTimer::singleShot(0, this, SLOT(replot()));
+      if (mReplotScheduler)
+        mReplotScheduler->requestReplot(this);
+      else
+        QTimer::singleShot(0, this, SLOT(processQueuedReplot()));
     }
     return;
   }
   
+  if (mReplotStatisticsEnabled && !mProcessingQueuedReplot) // the queued requests were already counted when they were made
+    ++mPendingStatistics.replotRequestCount;
+  mProcessingQueuedReplot = false;
   if (mReplotting) // incase signals loop back to replot slot
     return;
+  QCPTraceScope trace("QCustomPlot::replot", "plot", this);
   mReplotting = true;
   mReplotQueued = false;
+  QElapsedTimer frameTimer;
+  frameTimer.start();
   emit beforeReplot();
   
+  // merge data that other threads have pushed into the ingest channels of plottables:
+  foreach (QCPAbstractPlottable *plottable, mPlottables)
+    plottable->drainIngestChannel();
+  
+  updateInteractionQuality();
+  if (mReplotStatisticsHud && mReplotStatisticsHud->realVisibility())
+    mReplotStatisticsHud->markLayerDirty(); // shows the statistics of the previous replot, which changed
+  QElapsedTimer phaseTimer;
+  phaseTimer.start();
   updateLayout();
-  // draw all layered objects (grid, axes, plottables, items, legend,...) into their buffers:
+  if (mReplotStatisticsEnabled)
+    mPendingStatistics.layoutTime = phaseTimer.nsecsElapsed()/1e6;
+  // let plottables prepare for drawing on this thread, since the layers may be drawn by other threads:
+  foreach (QCPAbstractPlottable *plottable, mPlottables)
+  {
+    if (plottable->realVisibility())
+      plottable->prepareDraw();
+  }
+  // draw all layered objects (grid, axes, plottables, items, legend,...) into their buffers. Buffers
+  // of which all layers are unchanged since the last replot keep their content:
+  phaseTimer.restart();
   setupPaintBuffers();
-  foreach (QCPLayer *layer, mLayers)
-    layer->drawToPaintBuffer();
+  if (mReplotStatisticsEnabled)
+    mPendingStatistics.bufferSetupTime = phaseTimer.nsecsElapsed()/1e6;
+  // with a pending fast pan (see QCPAxisRect::setRangeDragFastPan), layers that just move with the drag
+  // may be scrolled instead of redrawn. This must be determined before collectDirtyLayers updates the
+  // drawn content revisions:
+  QVector<bool> fastPanLayers;
+  if (!mFastPanCancelled && mFastPanAxisRect && mFastPanAxisRect->rect() == mFastPanRect && !mFastPanDelta.isNull())
+  {
+    fastPanLayers.resize(mLayers.size());
+    for (int i=0; i<mLayers.size(); ++i)
+      fastPanLayers[i] = layerFollowsFastPan(mLayers.at(i));
+  }
+  collectDirtyLayers();
+  mRedrawnLayerCount = 0;
+  mReusedLayerCount = 0;
+  QVector<QPair<int, int> > dirtyGroups; // layer index ranges [first, second) of the buffers that need redrawing
+  int layerIndex = 0;
+  while (layerIndex < mLayers.size())
+  {
+    // layers sharing a paint buffer are adjacent, find the range of layers drawn into the current buffer:
+    QCPAbstractPaintBuffer *buffer = mLayers.at(layerIndex)->mPaintBuffer.data();
+    bool bufferDirty = !buffer || buffer->invalidated();
+    int groupEnd = layerIndex;
+    while (groupEnd < mLayers.size() && mLayers.at(groupEnd)->mPaintBuffer.data() == buffer)
+    {
+      bufferDirty |= mLayers.at(groupEnd)->dirty();
+      ++groupEnd;
+    }
+    if (bufferDirty)
+    {
+      bool scrollable = buffer && !buffer->invalidated() && !fastPanLayers.isEmpty();
+      for (int i=layerIndex; i<groupEnd; ++i)
+      {
+        mLayers.at(i)->mDirty = false; // reset before drawing, so changes made while drawing aren't lost
+        scrollable = scrollable && fastPanLayers.at(i);
+      }
+      if (!scrollable || !scrollFastPanLayers(layerIndex, groupEnd))
+        dirtyGroups.append(qMakePair(layerIndex, groupEnd));
+      mRedrawnLayerCount += groupEnd-layerIndex;
+    } else
+      mReusedLayerCount += groupEnd-layerIndex;
+    layerIndex = groupEnd;
+  }
+  // each group paints into its own buffer, so with QImage buffers the groups may be drawn concurrently:
+  const QCPLayerGroupDrawFunctor drawGroups(mLayers, dirtyGroups);
+  phaseTimer.restart();
+  if (mPlottingHints.testFlag(QCP::phParallelRasterization) && !mOpenGl && dirtyGroups.size() > 1)
+    qcpParallelFor(dirtyGroups.size(), 1, drawGroups);
+  else
+    drawGroups(0, dirtyGroups.size());
+  if (mReplotStatisticsEnabled)
+    mPendingStatistics.drawTime = phaseTimer.nsecsElapsed()/1e6;
+  // the buffers now match the current axis ranges, so the next fast pan step starts afresh:
+  mFastPanAxisRect = 0;
+  mFastPanDelta = QPoint();
+  mFastPanCancelled = false;
+  // buffers without layers (e.g. below a bottom layer in lmBuffered mode) just need to be emptied:
   for (int i=0; i<mPaintBuffers.size(); ++i)
-    mPaintBuffers.at(i)->setInvalidated(false);
+  {
+    if (mPaintBuffers.at(i)->invalidated())
+    {
+      mPaintBuffers.at(i)->clear(Qt::transparent);
+      mPaintBuffers.at(i)->setInvalidated(false);
+    }
+  }
   
   if ((refreshPriority == rpRefreshHint && mPlottingHints.testFlag(QCP::phImmediateRefresh)) || refreshPriority==rpImmediateRefresh)
     repaint();
   else
     update();
   
+  if (mInteracting)
+    adjustInteractionLevel(frameTimer.nsecsElapsed()/1e6);
+  if (mReplotStatisticsEnabled)
+  {
+    mPendingStatistics.replotTime = frameTimer.nsecsElapsed()/1e6;
+    finishReplotStatistics();
+  }
+  checkMemoryBudget();
+  
   emit afterReplot();
   mReplotting = false;
 }
@@ -14745,6 +16419,9 @@ QSize QCustomPlot::sizeHint() const
 void QCustomPlot::paintEvent(QPaintEvent *event)
 {
   Q_UNUSED(event);
+  QCPTraceScope trace("QCustomPlot::paintEvent", "render", this);
+  QElapsedTimer paintTimer;
+  paintTimer.start();
   QCPPainter painter(this);
   if (painter.isActive())
   {
@@ -14755,6 +16432,8 @@ void QCustomPlot::paintEvent(QPaintEvent *event)
     for (int bufferIndex = 0; bufferIndex < mPaintBuffers.size(); ++bufferIndex)
       mPaintBuffers.at(bufferIndex)->draw(&painter);
   }
+  if (mReplotStatisticsEnabled) // during an immediate refresh, the paint belongs to the ongoing replot, otherwise to the finished one
+    (mReplotting ? mPendingStatistics : mReplotStatistics).paintTime += paintTimer.nsecsElapsed()/1e6;
 }
 
 /*! \internal
@@ -14781,6 +16460,7 @@ void QCustomPlot::resizeEvent(QResizeEvent *event)
 */
 void QCustomPlot::mouseDoubleClickEvent(QMouseEvent *event)
 {
+  QCPTraceScope trace("QCustomPlot::mouseDoubleClickEvent", "input", this);
   emit mouseDoubleClick(event);
   mMouseHasMoved = false;
   mMousePressPos = event->pos();
@@ -14833,6 +16513,7 @@ void QCustomPlot::mouseDoubleClickEvent(QMouseEvent *event)
 */
 void QCustomPlot::mousePressEvent(QMouseEvent *event)
 {
+  QCPTraceScope trace("QCustomPlot::mousePressEvent", "input", this);
   emit mousePress(event);
   // save some state to tell in releaseEvent whether it was a click:
   mMouseHasMoved = false;
@@ -14883,6 +16564,7 @@ void QCustomPlot::mousePressEvent(QMouseEvent *event)
 */
 void QCustomPlot::mouseMoveEvent(QMouseEvent *event)
 {
+  QCPTraceScope trace("QCustomPlot::mouseMoveEvent", "input", this);
   emit mouseMove(event);
   
   if (!mMouseHasMoved && (mMousePressPos-event->pos()).manhattanLength() > 3)
@@ -14912,6 +16594,7 @@ void QCustomPlot::mouseMoveEvent(QMouseEvent *event)
 */
 void QCustomPlot::mouseReleaseEvent(QMouseEvent *event)
 {
+  QCPTraceScope trace("QCustomPlot::mouseReleaseEvent", "input", this);
   emit mouseRelease(event);
   
   if (!mMouseHasMoved) // mouse hasn't moved (much) between press and release, so handle as click
@@ -14966,6 +16649,7 @@ void QCustomPlot::mouseReleaseEvent(QMouseEvent *event)
 */
 void QCustomPlot::wheelEvent(QWheelEvent *event)
 {
+  QCPTraceScope trace("QCustomPlot::wheelEvent", "input", this);
   emit mouseWheel(event);
   // forward event to layerable under cursor:
   QList<QCPLayerable*> candidates = layerableListAt(event->pos(), false);
@@ -15079,8 +16763,10 @@ void QCustomPlot::drawBackground(QCPPainter *painter)
 
   This method uses \ref createPaintBuffer to create new paint buffers.
 
-  After this method, the paint buffers are empty (filled with \c Qt::transparent) and invalidated
-  (so an attempt to replot only a single buffered layer causes a full replot).
+  Paint buffers that were newly created or resized, as well as buffers whose set of associated
+  layers changed, are invalidated (so an attempt to replot only a single buffered layer causes a
+  full replot, and \ref replot redraws them). All other paint buffers keep their content, so it
+  can be reused if none of their layers is dirty.
 
   This method is called in every \ref replot call, prior to actually drawing the layers (into their
   associated paint buffer). If the paint buffers don't need changing/reallocating, this method
@@ -15089,39 +16775,456 @@ void QCustomPlot::drawBackground(QCPPainter *painter)
 void QCustomPlot::setupPaintBuffers()
 {
   int bufferIndex = 0;
+  const int initialBufferCount = mPaintBuffers.size();
   if (mPaintBuffers.isEmpty())
     mPaintBuffers.append(QSharedPointer<QCPAbstractPaintBuffer>(createPaintBuffer()));
   
   for (int layerIndex = 0; layerIndex < mLayers.size(); ++layerIndex)
   {
     QCPLayer *layer = mLayers.at(layerIndex);
-    if (layer->mode() == QCPLayer::lmLogical)
+    if (layer->mode() == QCPLayer::lmBuffered)
+    {
+      ++bufferIndex;
+      if (bufferIndex >= mPaintBuffers.size())
+        mPaintBuffers.append(QSharedPointer<QCPAbstractPaintBuffer>(createPaintBuffer()));
+    }
+    if (layer->mPaintBuffer.data() != mPaintBuffers.at(bufferIndex).data()) // layer changed buffer, so content of both old and new buffer is stale
     {
+      if (!layer->mPaintBuffer.isNull())
+        layer->mPaintBuffer.data()->setInvalidated();
       layer->mPaintBuffer = mPaintBuffers.at(bufferIndex).toWeakRef();
-    } else if (layer->mode() == QCPLayer::lmBuffered)
+      mPaintBuffers.at(bufferIndex)->setInvalidated();
+    }
+    if (layer->mode() == QCPLayer::lmBuffered && layerIndex < mLayers.size()-1 && mLayers.at(layerIndex+1)->mode() == QCPLayer::lmLogical) // not last layer, and next one is logical, so prepare another buffer for next layerables
     {
       ++bufferIndex;
       if (bufferIndex >= mPaintBuffers.size())
         mPaintBuffers.append(QSharedPointer<QCPAbstractPaintBuffer>(createPaintBuffer()));
-      layer->mPaintBuffer = mPaintBuffers.at(bufferIndex).toWeakRef();
-      if (layerIndex < mLayers.size()-1 && mLayers.at(layerIndex+1)->mode() == QCPLayer::lmLogical) // not last layer, and next one is logical, so prepare another buffer for next layerables
-      {
-        ++bufferIndex;
-        if (bufferIndex >= mPaintBuffers.size())
-          mPaintBuffers.append(QSharedPointer<QCPAbstractPaintBuffer>(createPaintBuffer()));
-      }
     }
   }
+  if (mReplotStatisticsEnabled)
+    mPendingStatistics.paintBufferReallocations += qMax(0, mPaintBuffers.size()-initialBufferCount);
   // remove unneeded buffers:
   while (mPaintBuffers.size()-1 > bufferIndex)
     mPaintBuffers.removeLast();
-  // resize buffers to viewport size and clear contents:
+  // resize buffers to viewport size, reallocated buffers must be redrawn:
   for (int i=0; i<mPaintBuffers.size(); ++i)
   {
-    mPaintBuffers.at(i)->setSize(viewport().size()); // won't do anything if already correct size
-    mPaintBuffers.at(i)->clear(Qt::transparent);
-    mPaintBuffers.at(i)->setInvalidated();
+    if (mPaintBuffers.at(i)->size() != viewport().size())
+    {
+      mPaintBuffers.at(i)->setSize(viewport().size());
+      mPaintBuffers.at(i)->setInvalidated();
+      if (mReplotStatisticsEnabled && i < initialBufferCount)
+        ++mPendingStatistics.paintBufferReallocations;
+    }
+  }
+}
+
+/*! \internal
+
+  Compares the \ref QCPLayerable::contentRevision of every layerable with the revision it had when
+  it was last drawn, and marks the layers of changed layerables as dirty (\ref QCPLayer::dirty).
+
+  This catches changes that don't pass through a property setter of the layerable itself, like
+  modifications of a plottable's data container. It is called by \ref replot right before the
+  layers are drawn.
+*/
+void QCustomPlot::collectDirtyLayers()
+{
+  foreach (QCPLayer *layer, mLayers)
+  {
+    foreach (QCPLayerable *layerable, layer->mChildren)
+    {
+      const quint64 revision = layerable->contentRevision();
+      if (revision != layerable->mDrawnContentRevision)
+      {
+        layerable->mDrawnContentRevision = revision;
+        layer->mDirty = true;
+      }
+    }
+  }
+}
+
+/*! \internal
+
+  Called by \ref QCPAxisRect::mouseMoveEvent before it changes the axis ranges of a range drag step
+  on \a axisRect in fast pan mode (\ref QCPAxisRect::setRangeDragFastPan). Returns whether the step
+  may be applied to the paint buffers by scrolling. This isn't the case if a fast pan was canceled
+  since the last replot, if another axis rect is panning, or if the first step of a pan finds dirty
+  layers, i.e. the paint buffers don't show the current state of the plot yet.
+
+  \see addFastPanStep, cancelFastPan
+*/
+bool QCustomPlot::beginFastPanStep(QCPAxisRect *axisRect)
+{
+  if (mFastPanCancelled)
+    return false;
+  if (mFastPanAxisRect)
+    return mFastPanAxisRect == axisRect;
+  foreach (QCPLayer *layer, mLayers)
+  {
+    if (layer->dirty())
+    {
+      cancelFastPan();
+      return false;
+    }
+  }
+  return true;
+}
+
+/*! \internal
+
+  Adds a range drag step on \a axisRect to the pending fast pan, which moved the content of the
+  drag axes by \a delta pixels. The accumulated shift is applied by the next \ref replot.
+
+  \see beginFastPanStep, cancelFastPan
+*/
+void QCustomPlot::addFastPanStep(QCPAxisRect *axisRect, const QPoint &delta)
+{
+  if (mFastPanCancelled)
+    return;
+  if (!mFastPanAxisRect)
+  {
+    mFastPanAxisRect = axisRect;
+    mFastPanRect = axisRect->rect();
+    mFastPanDelta = QPoint();
+  } else if (mFastPanAxisRect != axisRect)
+  {
+    cancelFastPan();
+    return;
+  }
+  mFastPanDelta += delta;
+}
+
+/*! \internal
+
+  Discards the pending fast pan, so the next \ref replot redraws all dirty layers regularly. This is
+  necessary whenever the paint buffers can't be brought up to date by scrolling, e.g. because a
+  drag step couldn't be expressed as a uniform pixel shift, or a buffer was redrawn in between by
+  \ref QCPLayer::replot.
+
+  \see beginFastPanStep, addFastPanStep
+*/
+void QCustomPlot::cancelFastPan()
+{
+  mFastPanCancelled = true;
+  mFastPanAxisRect = 0;
+  mFastPanDelta = QPoint();
+}
+
+/*! \internal
+
+  Returns whether the content drawn in coordinates of \a axis moves along with the pending fast pan.
+  This is the case if \a axis belongs to the panning axis rect and either is one of its range drag
+  axes, or the pan has no component in the orientation of \a axis.
+*/
+bool QCustomPlot::axisFollowsFastPan(QCPAxis *axis) const
+{
+  if (!axis || axis->axisRect() != mFastPanAxisRect.data())
+    return false;
+  const int delta = axis->orientation() == Qt::Horizontal ? mFastPanDelta.x() : mFastPanDelta.y();
+  return delta == 0 || mFastPanAxisRect->rangeDragAxes(axis->orientation()).contains(axis);
+}
+
+/*! \internal
+
+  Returns whether \a layerable is drawn such that, inside the panning axis rect, its pixels just
+  move with the pending fast pan. See \ref QCPAxisRect::setRangeDragFastPan for the layerables that
+  qualify.
+*/
+bool QCustomPlot::layerableFollowsFastPan(QCPLayerable *layerable) const
+{
+  if (QCPGrid *grid = qobject_cast<QCPGrid*>(layerable))
+    return axisFollowsFastPan(qobject_cast<QCPAxis*>(grid->parentLayerable()));
+  if (QCPAbstractPlottable *plottable = qobject_cast<QCPAbstractPlottable*>(layerable))
+    return axisFollowsFastPan(plottable->keyAxis()) && axisFollowsFastPan(plottable->valueAxis());
+  if (QCPAbstractItem *item = qobject_cast<QCPAbstractItem*>(layerable))
+  {
+    if (!item->clipToAxisRect() || item->clipAxisRect() != mFastPanAxisRect.data())
+      return false;
+    foreach (QCPItemPosition *position, item->positions())
+    {
+      if (position->typeX() != QCPItemPosition::ptPlotCoords || position->typeY() != QCPItemPosition::ptPlotCoords)
+        return false;
+      if (position->parentAnchorX() || position->parentAnchorY())
+        return false;
+      if (!axisFollowsFastPan(position->keyAxis()) || !axisFollowsFastPan(position->valueAxis()))
+        return false;
+    }
+    return true;
+  }
+  if (layerable == mFastPanAxisRect.data())
+    return mFastPanAxisRect->backgroundBrush().style() == Qt::NoBrush && mFastPanAxisRect->background().isNull();
+  if (qobject_cast<QCPLayout*>(layerable) && !qobject_cast<QCPLegend*>(layerable)) // layouts don't draw anything themselves, except the legend (border and background brush)
+    return true;
+  return false;
+}
+
+/*! \internal
+
+  Returns whether the paint buffer content of \a layer may be scrolled by the pending fast pan
+  instead of being redrawn. This requires that all visible layerables of \a layer either follow the
+  pan (\ref layerableFollowsFastPan), or are clipped outside of the panning axis rect and unchanged
+  since the last replot. Except for grids, whose ticks change with the pan, layerables with changed
+  content (\ref QCPLayerable::contentRevision) always prevent scrolling, since the shifted pixels
+  would show outdated content.
+*/
+bool QCustomPlot::layerFollowsFastPan(QCPLayer *layer) const
+{
+  if (!layer->visible())
+    return false;
+  foreach (QCPLayerable *layerable, layer->mChildren)
+  {
+    if (!layerable->realVisibility())
+      continue;
+    if (layerable->contentRevision() != layerable->mDrawnContentRevision && !qobject_cast<QCPGrid*>(layerable))
+      return false;
+    if (!layerableFollowsFastPan(layerable) && layerable->clipRect().intersects(mFastPanRect))
+      return false;
+  }
+  return true;
+}
+
+/*! \internal
+
+  Applies the pending fast pan to the layers with indices in [\a begin, \a end), which share one
+  paint buffer: the buffer content inside the panning axis rect is scrolled by the accumulated pixel
+  shift, and only the exposed strips are redrawn. Returns false if the buffer couldn't be scrolled,
+  in which case the caller must redraw the layers regularly.
+*/
+bool QCustomPlot::scrollFastPanLayers(int begin, int end)
+{
+  QCPAbstractPaintBuffer *buffer = mLayers.at(begin)->mPaintBuffer.data();
+  // layerables are drawn with their clip rect shifted up by one pixel (see QCPLayer::draw), so this
+  // is the area of the axis rect content in the buffer:
+  const QRect scrollRect = mFastPanRect.translated(0, -1) & QRect(QPoint(0, 0), buffer->size());
+  const int dx = mFastPanDelta.x();
+  const int dy = mFastPanDelta.y();
+  if (qAbs(dx) >= scrollRect.width() || qAbs(dy) >= scrollRect.height())
+    return false;
+  if (!buffer->scroll(scrollRect, dx, dy))
+    return false;
+  // redraw the exposed strips, which must not overlap so antialiased pixels aren't blended twice:
+  QList<QRect> strips;
+  QRect remainder = scrollRect;
+  if (dx > 0)
+  {
+    strips << QRect(scrollRect.left(), scrollRect.top(), dx, scrollRect.height());
+    remainder.setLeft(scrollRect.left()+dx);
+  } else if (dx < 0)
+  {
+    strips << QRect(scrollRect.right()+1+dx, scrollRect.top(), -dx, scrollRect.height());
+    remainder.setRight(scrollRect.right()+dx);
+  }
+  if (dy > 0)
+    strips << QRect(remainder.left(), scrollRect.top(), remainder.width(), dy);
+  else if (dy < 0)
+    strips << QRect(remainder.left(), scrollRect.bottom()+1+dy, remainder.width(), -dy);
+  foreach (const QRect &strip, strips)
+  {
+    for (int i=begin; i<end; ++i)
+      mLayers.at(i)->drawToPaintBuffer(strip);
+  }
+  buffer->setInvalidated(false);
+  return true;
+}
+
+/*! \internal
+
+  Applies the interaction quality for the upcoming replot: While the user interacts with the plot
+  (see \ref notifyInteraction), the degradations of the current \ref interactionLevel are
+  activated, otherwise full quality is restored. If the active degradations change, all layers are
+  marked dirty, and the paint buffers are reallocated if the device pixel ratio changes.
+
+  \see setInteractionDegradations
+*/
+void QCustomPlot::updateInteractionQuality()
+{
+  const QCP::InteractionDegradations degradations = mInteracting ? interactionDegradationsForLevel(mInteractionLevel) : QCP::InteractionDegradations(QCP::idNone);
+  if (degradations == mActiveInteractionDegradations)
+    return;
+  const bool ratioChanged = degradations.testFlag(QCP::idDevicePixelRatio) != mActiveInteractionDegradations.testFlag(QCP::idDevicePixelRatio);
+  mActiveInteractionDegradations = degradations;
+  markAllLayersDirty();
+  if (ratioChanged)
+  {
+    for (int i=0; i<mPaintBuffers.size(); ++i)
+    {
+      mPaintBuffers.at(i)->setDevicePixelRatio(effectiveBufferDevicePixelRatio());
+      mPaintBuffers.at(i)->setInvalidated(); // reallocated buffer content is undefined
+    }
+    if (mReplotStatisticsEnabled)
+      mPendingStatistics.paintBufferReallocations += mPaintBuffers.size();
+  }
+}
+
+/*! \internal
+
+  Adapts the \ref interactionLevel to the duration \a frameTime (in milliseconds) of the replot that
+  just finished during an interaction: If the frame budget was exceeded, the next allowed
+  degradation is added. If ten consecutive replots took less than a third of the budget, the most
+  recently added one is lifted. The new level takes effect with the next replot.
+  
+  Lifting a degradation needs several fast replots, because a single one is typically fast only
+  thanks to the degradation. Lifting it right away would switch the level on every other replot,
+  and each switch redraws all layers (and may reallocate the paint buffers).
+
+  \see setInteractionFrameBudget
+*/
+void QCustomPlot::adjustInteractionLevel(double frameTime)
+{
+  if (frameTime < mInteractionFrameBudget/3.0)
+    ++mInteractionFastFrames;
+  else
+    mInteractionFastFrames = 0;
+  if (frameTime > mInteractionFrameBudget)
+  {
+    if (interactionDegradationsForLevel(mInteractionLevel+1) != interactionDegradationsForLevel(mInteractionLevel))
+      ++mInteractionLevel;
+  } else if (mInteractionFastFrames >= 10 && mInteractionLevel > 0)
+  {
+    --mInteractionLevel;
+    mInteractionFastFrames = 0;
+  }
+}
+
+/*! \internal
+
+  Returns the degradations that are active at the interaction quality \a level, i.e. the first \a
+  level of the degradations allowed by \ref setInteractionDegradations, in the order of the \ref
+  QCP::InteractionDegradation enum.
+*/
+QCP::InteractionDegradations QCustomPlot::interactionDegradationsForLevel(int level) const
+{
+  static const QCP::InteractionDegradation order[] = {QCP::idAntialiasing, QCP::idFills, QCP::idDecimation, QCP::idScatterThinning, QCP::idDevicePixelRatio};
+  QCP::InteractionDegradations result = QCP::idNone;
+  for (int i=0; i<int(sizeof(order)/sizeof(order[0])) && level > 0; ++i)
+  {
+    if (mInteractionDegradations.testFlag(order[i]))
+    {
+      result |= order[i];
+      --level;
+    }
+  }
+  return result;
+}
+
+/*! \internal
+
+  Returns the device pixel ratio the paint buffers currently use. This is the configured \ref
+  setBufferDevicePixelRatio, unless it is lowered to 1 by the interaction degradation \ref
+  QCP::idDevicePixelRatio.
+*/
+double QCustomPlot::effectiveBufferDevicePixelRatio() const
+{
+  if (mActiveInteractionDegradations.testFlag(QCP::idDevicePixelRatio))
+    return qMin(1.0, mBufferDevicePixelRatio);
+  return mBufferDevicePixelRatio;
+}
+
+/*! \internal
+
+  Called when no interaction was registered (\ref notifyInteraction) for the refine delay. Ends the
+  interaction and, if the plot was drawn in reduced quality, queues a replot in full quality.
+*/
+void QCustomPlot::finishInteraction()
+{
+  mInteracting = false;
+  if (mActiveInteractionDegradations != QCP::idNone)
+    replot(rpQueuedReplot);
+}
+
+/*! \internal
+
+  Performs the replot that was requested by one or more calls of \ref replot with \ref
+  rpQueuedReplot. Called from the event loop, or by the \ref QCPReplotScheduler of this plot.
+  
+  Unlike a direct call of \ref replot, this doesn't count as another replot request in the replot
+  statistics (see \ref setReplotStatisticsEnabled), since the queued calls were already counted.
+*/
+void QCustomPlot::processQueuedReplot()
+{
+  mProcessingQueuedReplot = true;
+  replot(rpRefreshHint);
+}
+
+/*! \internal
+
+  Adds \a milliseconds to the draw time of \a layerable in the statistics of the ongoing replot
+  (see \ref setReplotStatisticsEnabled). Called by \ref QCPLayer::drawChild, possibly from multiple
+  threads concurrently if parallel rasterization is enabled.
+*/
+void QCustomPlot::addLayerableDrawTime(const QCPLayerable *layerable, double milliseconds)
+{
+  QMutexLocker locker(&mLayerableStatisticsMutex);
+  mLayerableStatistics[layerable].drawTime += milliseconds;
+}
+
+/*! \internal
+
+  Adds \a inputCount visible data points and \a outputCount points remaining after adaptive
+  sampling to the statistics of \a layerable in the ongoing replot. Called by plottables while they
+  draw, see \ref addLayerableDrawTime.
+*/
+void QCustomPlot::addLayerablePointCounts(const QCPLayerable *layerable, int inputCount, int outputCount)
+{
+  QMutexLocker locker(&mLayerableStatisticsMutex);
+  QCPLayerableStatistics &statistics = mLayerableStatistics[layerable];
+  statistics.inputPointCount += inputCount;
+  statistics.outputPointCount += outputCount;
+}
+
+/*! \internal
+
+  Completes the statistics collected during the replot that is about to finish, and makes them
+  available via \ref replotStatistics. The statistics of the next replot start from zero.
+*/
+void QCustomPlot::finishReplotStatistics()
+{
+  mPendingStatistics.paintBufferCount = mPaintBuffers.size();
+  mPendingStatistics.redrawnLayerCount = mRedrawnLayerCount;
+  mPendingStatistics.reusedLayerCount = mReusedLayerCount;
+  foreach (QCPLayer *layer, mLayers)
+  {
+    foreach (QCPLayerable *layerable, layer->children())
+    {
+      QHash<const QCPLayerable*, QCPLayerableStatistics>::iterator it = mLayerableStatistics.find(layerable);
+      if (it != mLayerableStatistics.end())
+      {
+        it.value().layerable = layerable;
+        mPendingStatistics.layerables.append(it.value());
+      }
+    }
+  }
+  mReplotStatistics = mPendingStatistics;
+  mPendingStatistics = QCPReplotStatistics();
+  mLayerableStatistics.clear();
+}
+
+/*! \internal
+
+  Compares the memory held by the plot with the memory budget (\ref setMemoryBudget), at most once
+  per second. If the budget is exceeded, releases memory if \ref setAutoReleaseMemory is enabled
+  and the reclaimable memory suffices to get within the budget, and emits \ref
+  memoryBudgetExceeded if the budget is still exceeded. Called at the end of \ref replot.
+  
+  Releasing memory that can't get the plot within the budget would only cause the released caches
+  and preallocations to be rebuilt, over and over again while the data stays too large.
+*/
+void QCustomPlot::checkMemoryBudget()
+{
+  if (mMemoryBudget <= 0 || (mMemoryCheckTimer.isValid() && mMemoryCheckTimer.elapsed() < 1000))
+    return;
+  mMemoryCheckTimer.start();
+  const QCPMemoryReport report = memoryReport();
+  qint64 bytes = report.totalBytes();
+  if (bytes > mMemoryBudget && mAutoReleaseMemory && bytes-report.reclaimableBytes() <= mMemoryBudget)
+  {
+    releaseMemory();
+    bytes = memoryReport().totalBytes();
   }
+  if (bytes > mMemoryBudget)
+    emit memoryBudgetExceeded(bytes, mMemoryBudget);
 }
 
 /*! \internal
@@ -15137,15 +17240,17 @@ QCPAbstractPaintBuffer *QCustomPlot::createPaintBuffer()
   if (mOpenGl)
   {
 #if defined(QCP_OPENGL_FBO)
-    return new QCPPaintBufferGlFbo(viewport().size(), mBufferDevicePixelRatio, mGlContext, mGlPaintDevice);
+    return new QCPPaintBufferGlFbo(viewport().size(), effectiveBufferDevicePixelRatio(), mGlContext, mGlPaintDevice);
 #elif defined(QCP_OPENGL_PBUFFER)
-    return new QCPPaintBufferGlPbuffer(viewport().size(), mBufferDevicePixelRatio, mOpenGlMultisamples);
+    return new QCPPaintBufferGlPbuffer(viewport().size(), effectiveBufferDevicePixelRatio(), mOpenGlMultisamples);
 #else
     qDebug() << Q_FUNC_INFO << "OpenGL enabled even though no support for it compiled in, this shouldn't have happened. Falling back to pixmap paint buffer.";
-    return new QCPPaintBufferPixmap(viewport().size(), mBufferDevicePixelRatio);
+    return new QCPPaintBufferPixmap(viewport().size(), effectiveBufferDevicePixelRatio());
 #endif
-  } else
-    return new QCPPaintBufferPixmap(viewport().size(), mBufferDevicePixelRatio);
+  } else if (mPlottingHints.testFlag(QCP::phParallelRasterization))
+    return new QCPPaintBufferImage(viewport().size(), effectiveBufferDevicePixelRatio());
+  else
+    return new QCPPaintBufferPixmap(viewport().size(), effectiveBufferDevicePixelRatio());
 }
 
 /*!
@@ -15743,21 +17848,378 @@ void QCustomPlot::toPainter(QCPPainter *painter, int width, int height)
 }
 /* end of 'src/core.cpp' */
 
-//amalgamation: add plottable1d.cpp
-
-/* including file 'src/colorgradient.cpp', size 25342                        */
-/* commit ce344b3f96a62e5f652585e55f1ae7c7883cd45b 2018-06-25 01:03:39 +0200 */
 
+/* including file 'src/replotscheduler.cpp'                                  */
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
-//////////////////// QCPColorGradient
+//////////////////// QCPReplotScheduler
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-/*! \class QCPColorGradient
-  \brief Defines a color gradient for use with e.g. \ref QCPColorMap
+/*! \class QCPReplotScheduler
+  \brief Performs the queued replots of multiple QCustomPlots in frames with a limited frame rate
   
-  This class describes a color gradient which can be used to encode data with color. For example,
-  QCPColorMap and QCPColorScale have \ref QCPColorMap::setGradient "setGradient" methods which
+  Without a scheduler, each QCustomPlot performs its queued replots (\ref
+  QCustomPlot::rpQueuedReplot) in the next event loop iteration. An application with dozens of
+  plots that receive streamed data thus replots all of them independently, as often as data
+  arrives. Plots that share a scheduler (\ref QCustomPlot::setReplotScheduler) instead have their
+  queued replots collected and performed together in frames, at most \ref setFrameRate times per
+  second. Multiple requests of a plot within one frame cause a single replot.
+  
+  Within a frame, the plots are replotted in the order of their \ref QCustomPlot::setReplotPriority.
+  Once the replots of a frame took longer than the frame budget (\ref setFrameBudget), the
+  remaining plots are deferred to the next frame. Their priority is raised by one for each frame
+  they waited, so they can't starve. Plots that are hidden, minimized or completely obscured are
+  skipped, and replotted when they become visible again.
+  
+  The scheduler keeps statistics about the frames, e.g. \ref missedFrameCount and \ref
+  averageFrameTime. The signals \ref frameFinished and \ref budgetMissed report each frame.
+  
+  Immediate replots (all refresh priorities other than \ref QCustomPlot::rpQueuedReplot) are not
+  affected by the scheduler. Like the plots, the scheduler must live in the GUI thread.
+*/
+
+/* start of documentation of inline functions */
+
+/*! \fn int QCPReplotScheduler::missedFrameCount() const
+  
+  Returns the number of frames since the last \ref resetStatistics, whose replots took longer than
+  the frame budget (\ref setFrameBudget).
+*/
+
+/*! \fn int QCPReplotScheduler::deferredReplotCount() const
+  
+  Returns the number of replots since the last \ref resetStatistics, that were deferred to the
+  following frame because the frame budget was exhausted.
+*/
+
+/*! \fn int QCPReplotScheduler::skippedReplotCount() const
+  
+  Returns the number of replots since the last \ref resetStatistics, that were skipped because the
+  plot wasn't visible. They are performed once the plot becomes visible again.
+*/
+
+/*! \fn double QCPReplotScheduler::averageFrameTime() const
+  
+  Returns the average time in milliseconds the replots of a frame took, since the last \ref
+  resetStatistics. Frames without replots are not counted.
+*/
+
+/* end of documentation of inline functions */
+/* start of documentation of signals */
+
+/*! \fn void QCPReplotScheduler::frameFinished(int replotCount, double frameTime)
+  
+  This signal is emitted after each frame that replotted at least one plot. \a replotCount is the
+  number of replotted plots, \a frameTime the time in milliseconds the replots took.
+*/
+
+/*! \fn void QCPReplotScheduler::budgetMissed(double frameTime, int deferredCount)
+  
+  This signal is emitted when the replots of a frame took longer (\a frameTime, in milliseconds)
+  than the frame budget. \a deferredCount replots were deferred to the next frame.
+  
+  \see setFrameBudget
+*/
+
+/* end of documentation of signals */
+
+Q_GLOBAL_STATIC(QCPReplotScheduler, qcpReplotScheduler)
+
+/*!
+  Creates a replot scheduler with a frame rate of 60 frames per second. Use \ref instance to
+  access the process-wide scheduler.
+*/
+QCPReplotScheduler::QCPReplotScheduler(QObject *parent) :
+  QObject(parent),
+  mFrameRate(60),
+  mFrameBudget(0),
+  mFrameTimer(new QTimer(this))
+{
+  mFrameTimer->setSingleShot(true);
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
+  mFrameTimer->setTimerType(Qt::PreciseTimer);
+#endif
+  connect(mFrameTimer, SIGNAL(timeout()), this, SLOT(processFrame()));
+  resetStatistics();
+}
+
+QCPReplotScheduler::~QCPReplotScheduler()
+{
+  // let the plots fall back to replotting by themselves:
+  QList<QCustomPlot*> plots = this->plots();
+  for (int i=0; i<plots.size(); ++i)
+    plots.at(i)->setReplotScheduler(0);
+}
+
+/*!
+  Returns the process-wide scheduler instance. It is created on first use, which must happen in the
+  GUI thread.
+*/
+QCPReplotScheduler *QCPReplotScheduler::instance()
+{
+  return qcpReplotScheduler();
+}
+
+/*!
+  Returns the plots that use this scheduler.
+  
+  \see QCustomPlot::setReplotScheduler
+*/
+QList<QCustomPlot*> QCPReplotScheduler::plots() const
+{
+  QList<QCustomPlot*> result;
+  for (int i=0; i<mPlots.size(); ++i)
+  {
+    if (mPlots.at(i))
+      result.append(mPlots.at(i).data());
+  }
+  return result;
+}
+
+/*!
+  Returns the number of plots whose queued replot is waiting for the next frame, or waiting for
+  the plot to become visible again.
+*/
+int QCPReplotScheduler::pendingReplotCount() const
+{
+  return mPending.size()+mHidden.size();
+}
+
+/*!
+  Sets the maximum number of frames per second. Queued replots that are requested while a frame
+  interval is still running are performed at the start of the next interval. If \a
+  framesPerSecond is 0, frames are performed in the next event loop iteration, like queued replots
+  without scheduler.
+  
+  The default is 60 frames per second.
+*/
+void QCPReplotScheduler::setFrameRate(double framesPerSecond)
+{
+  mFrameRate = qMax(0.0, framesPerSecond);
+}
+
+/*!
+  Sets the time in \a milliseconds the replots of one frame should take at most. If this budget is
+  exhausted, the plots that weren't replotted yet are deferred to the next frame (but each frame
+  replots at least one plot), and the frame is counted as missed, see \ref missedFrameCount and
+  \ref budgetMissed.
+  
+  If \a milliseconds is 0 (the default), the budget is the frame interval given by \ref
+  setFrameRate. If that is 0 too, all plots are replotted in each frame.
+*/
+void QCPReplotScheduler::setFrameBudget(double milliseconds)
+{
+  mFrameBudget = qMax(0.0, milliseconds);
+}
+
+/*!
+  Resets the frame statistics, like \ref frameCount, \ref missedFrameCount and \ref maxFrameTime.
+*/
+void QCPReplotScheduler::resetStatistics()
+{
+  mFrameCount = 0;
+  mMissedFrameCount = 0;
+  mDeferredReplotCount = 0;
+  mSkippedReplotCount = 0;
+  mLastFrameTime = 0;
+  mMaxFrameTime = 0;
+  mTotalFrameTime = 0;
+}
+
+/*! \internal
+  
+  Replots hidden plots with a pending replot, once they receive a show or paint event (e.g. when
+  their window is restored, or an obscuring widget is moved away).
+*/
+bool QCPReplotScheduler::eventFilter(QObject *object, QEvent *event)
+{
+  if (event->type() == QEvent::Show || event->type() == QEvent::Paint)
+  {
+    for (int i=0; i<mHidden.size(); ++i)
+    {
+      if (mHidden.at(i).data() == object)
+      {
+        QCustomPlot *plot = mHidden.takeAt(i).data();
+        requestReplot(plot);
+        break;
+      }
+    }
+  }
+  return QObject::eventFilter(object, event);
+}
+
+/*! \internal
+  
+  Adds \a plot to the plots of this scheduler. Called by \ref QCustomPlot::setReplotScheduler.
+*/
+void QCPReplotScheduler::registerPlot(QCustomPlot *plot)
+{
+  if (!plot || mPlots.contains(plot))
+    return;
+  mPlots.append(plot);
+  plot->installEventFilter(this);
+}
+
+/*! \internal
+  
+  Removes \a plot and its pending replot from this scheduler. Called by \ref
+  QCustomPlot::setReplotScheduler and the QCustomPlot destructor.
+*/
+void QCPReplotScheduler::unregisterPlot(QCustomPlot *plot)
+{
+  mPlots.removeAll(plot);
+  mHidden.removeAll(plot);
+  for (int i=mPending.size()-1; i>=0; --i)
+  {
+    if (mPending.at(i).plot.data() == plot)
+      mPending.removeAt(i);
+  }
+  plot->removeEventFilter(this);
+}
+
+/*! \internal
+  
+  Queues a replot of \a plot for the next frame. Called by \ref QCustomPlot::replot with \ref
+  QCustomPlot::rpQueuedReplot.
+*/
+void QCPReplotScheduler::requestReplot(QCustomPlot *plot)
+{
+  if (mHidden.contains(plot))
+    return;
+  for (int i=0; i<mPending.size(); ++i)
+  {
+    if (mPending.at(i).plot.data() == plot)
+      return;
+  }
+  Request request;
+  request.plot = plot;
+  request.waitedFrames = 0;
+  mPending.append(request);
+  scheduleFrame();
+}
+
+/*! \internal
+  
+  Starts the frame timer such that the next frame begins one frame interval after the start of the
+  previous one, or immediately if that is already longer ago.
+*/
+void QCPReplotScheduler::scheduleFrame()
+{
+  if (mFrameTimer->isActive())
+    return;
+  const double interval = mFrameRate > 0 ? 1000.0/mFrameRate : 0;
+  const double sinceLastFrame = mFrameClock.isValid() ? mFrameClock.nsecsElapsed()/1e6 : interval;
+  mFrameTimer->start(qMax(0, qCeil(interval-sinceLastFrame)));
+}
+
+/*! \internal
+  
+  Returns the frame budget in milliseconds, or 0 if the frames have no budget.
+  
+  \see setFrameBudget
+*/
+double QCPReplotScheduler::effectiveFrameBudget() const
+{
+  if (mFrameBudget > 0)
+    return mFrameBudget;
+  return mFrameRate > 0 ? 1000.0/mFrameRate : 0;
+}
+
+/*! \internal
+  
+  Returns whether any part of \a plot is visible on screen.
+*/
+bool QCPReplotScheduler::isPlotExposed(QCustomPlot *plot) const
+{
+  return plot->isVisible() && !plot->window()->isMinimized() && !plot->visibleRegion().isEmpty();
+}
+
+/*! \internal
+  
+  Performs one frame: Replots the plots with pending requests in the order of their priority, until
+  the frame budget is exhausted. Plots that aren't visible are put aside until they receive a show or
+  paint event (see \ref eventFilter).
+*/
+void QCPReplotScheduler::processFrame()
+{
+  mFrameClock.start();
+  const double budget = effectiveFrameBudget();
+  
+  // take the pending requests, plots that request replots while this frame runs go to the next frame:
+  QList<Request> requests = mPending;
+  mPending.clear();
+  QVector<QPair<int, int> > order; // negative priority and request index, so sorting puts highest priority first and keeps the request order otherwise
+  for (int i=0; i<requests.size(); ++i)
+  {
+    QCustomPlot *plot = requests.at(i).plot.data();
+    if (!plot)
+      continue;
+    if (!isPlotExposed(plot))
+    {
+      mHidden.append(plot);
+      ++mSkippedReplotCount;
+      continue;
+    }
+    order.append(qMakePair(-(plot->replotPriority()+requests.at(i).waitedFrames), i));
+  }
+  std::sort(order.begin(), order.end());
+  
+  QElapsedTimer frameTimer;
+  frameTimer.start();
+  int replotCount = 0;
+  QList<Request> deferred;
+  for (int i=0; i<order.size(); ++i)
+  {
+    Request request = requests.at(order.at(i).second);
+    if (!request.plot) // plot was deleted by a slot connected to a previous replot
+      continue;
+    if (budget > 0 && replotCount > 0 && frameTimer.nsecsElapsed()/1e6 > budget)
+    {
+      ++request.waitedFrames;
+      deferred.append(request);
+      continue;
+    }
+    request.plot.data()->processQueuedReplot();
+    ++replotCount;
+  }
+  const int deferredCount = deferred.size();
+  mPending = deferred+mPending;
+  
+  if (replotCount > 0)
+  {
+    const double frameTime = frameTimer.nsecsElapsed()/1e6;
+    ++mFrameCount;
+    mDeferredReplotCount += deferredCount;
+    mLastFrameTime = frameTime;
+    mMaxFrameTime = qMax(mMaxFrameTime, frameTime);
+    mTotalFrameTime += frameTime;
+    if (budget > 0 && frameTime > budget)
+    {
+      ++mMissedFrameCount;
+      emit budgetMissed(frameTime, deferredCount);
+    }
+    emit frameFinished(replotCount, frameTime);
+  }
+  if (!mPending.isEmpty())
+    scheduleFrame();
+}
+/* end of 'src/replotscheduler.cpp' */
+
+//amalgamation: add plottable1d.cpp
+
+/* including file 'src/colorgradient.cpp', size 25342                        */
+/* commit ce344b3f96a62e5f652585e55f1ae7c7883cd45b 2018-06-25 01:03:39 +0200 */
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPColorGradient
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPColorGradient
+  \brief Defines a color gradient for use with e.g. \ref QCPColorMap
+  
+  This class describes a color gradient which can be used to encode data with color. For example,
+  QCPColorMap and QCPColorScale have \ref QCPColorMap::setGradient "setGradient" methods which
   take an instance of this class. Colors are set with \ref setColorStopAt(double position, const QColor &color)
   with a \a position from 0 to 1. In between these defined color positions, the
   color will be interpolated linearly either in RGB or HSV space, see \ref setColorInterpolation.
@@ -15779,6 +18241,11 @@ void QCustomPlot::toPainter(QCPPainter *painter, int width, int height)
   The total number of levels used in the gradient can be set with \ref setLevelCount. Whether the
   color gradient shall be applied periodically (wrapping around) to data values that lie outside
   the data range specified on the plottable instance can be controlled with \ref setPeriodic.
+  
+  The interpolated colors of all levels are shared between all gradient instances with the same
+  color stops, level count and color interpolation, via a process-wide cache. So creating many
+  plottables with the same gradient (or copying gradients around) doesn't repeat the
+  interpolation.
 */
 
 /*!
@@ -15906,119 +18373,505 @@ void QCPColorGradient::setPeriodic(bool enabled)
   mPeriodic = enabled;
 }
 
-/*! \overload
+/* Vectorized colorize kernels
+
+  The kernels below are used by QCPColorGradient::colorizeCells when the CPU supports them (see
+  QCPColorGradient::setSimdLevel). They are compiled with per-function target attributes, so the
+  library itself doesn't need to be built with -msse4.1 or -mavx2. Define QCUSTOMPLOT_NO_SIMD to
+  compile only the scalar loops.
+*/
+#if !defined(QCUSTOMPLOT_NO_SIMD) && (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#  define QCP_COLORIZE_SIMD
+#  define QCP_TARGET_SSE41 __attribute__((target("sse4.1")))
+#  define QCP_TARGET_AVX2 __attribute__((target("avx2")))
+#elif !defined(QCUSTOMPLOT_NO_SIMD) && defined(_MSC_VER) && (defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#  define QCP_COLORIZE_SIMD
+#  define QCP_TARGET_SSE41
+#  define QCP_TARGET_AVX2
+#  include <intrin.h>
+#endif
+#ifdef QCP_COLORIZE_SIMD
+#  include <immintrin.h>
+#  include <cfloat>
+#  include <cstring>
+
+/*! \internal
   
-  This method is used to quickly convert a \a data array to colors. The colors will be output in
-  the array \a scanLine. Both \a data and \a scanLine must have the length \a n when passed to this
-  function. The data range that shall be used for mapping the data value to the gradient is passed
-  in \a range. \a logarithmic indicates whether the data values shall be mapped to colors
-  logarithmically.
+  The parameters of one colorize call, as needed by the vectorized kernels.
+*/
+struct QCPColorizeParams
+{
+  const QRgb *colorBuffer;
+  int levelCount;
+  bool periodic;
+  bool logarithmic;
+  double lower;     // range.lower
+  double factor;    // linear: (levelCount-1)/range.size()
+  double logRange;  // logarithmic: ln(range.upper/range.lower)
+  double logFactor; // logarithmic, for the kernels: (levelCount-1)/logRange
+};
 
-  if \a data actually contains 2D-data linearized via <tt>[row*columnCount + column]</tt>, you can
-  set \a dataIndexFactor to <tt>columnCount</tt> to convert a column instead of a row of the data
-  array, in \a scanLine. \a scanLine will remain a regular (1D) array. This works because \a data
-  is addressed <tt>data[i*dataIndexFactor]</tt>.
+/*! \internal
   
-  Use the overloaded method to additionally provide alpha map data.
+  Returns the color buffer index of \a value, with exactly the same arithmetic as the scalar loops
+  of QCPColorGradient::colorizeCells. Used for the tail of a block and for cells the kernels can't
+  handle.
+*/
+static inline int qcpColorizeIndex(const QCPColorizeParams &p, double value)
+{
+  int index = p.logarithmic ? int(qLn(value/p.lower)/p.logRange*(p.levelCount-1)) : int((value-p.lower)*p.factor);
+  if (p.periodic)
+  {
+    index %= p.levelCount;
+    if (index < 0)
+      index += p.levelCount;
+  } else
+    index = qBound(0, index, p.levelCount-1);
+  return index;
+}
 
-  The QRgb values that are placed in \a scanLine have their r, g and b components premultiplied
-  with alpha (see QImage::Format_ARGB32_Premultiplied).
+/*! \internal
+  
+  Premultiplies \a rgb with \a alpha like the scalar loops of QCPColorGradient::colorizeCells.
 */
-void QCPColorGradient::colorize(const double *data, const QCPRange &range, QRgb *scanLine, int n, int dataIndexFactor, bool logarithmic)
+static inline QRgb qcpColorizePremultiply(QRgb rgb, unsigned char alpha)
 {
-  // If you change something here, make sure to also adapt color() and the other colorize() overload
-  if (!data)
+  if (alpha == 255)
+    return rgb;
+  const float alphaF = alpha/255.0f;
+  return qRgba(qRed(rgb)*alphaF, qGreen(rgb)*alphaF, qBlue(rgb)*alphaF, qAlpha(rgb)*alphaF);
+}
+
+/*! \internal
+  
+  Colorizes the cells \a begin to \a end (exclusive) of \a values with the scalar arithmetic.
+*/
+static inline void qcpColorizeScalarRange(const QCPColorizeParams &p, const double *values, const unsigned char *alpha, QRgb *scanLine, int begin, int end)
+{
+  for (int i=begin; i<end; ++i)
   {
-    qDebug() << Q_FUNC_INFO << "null pointer given as data";
-    return;
+    const QRgb rgb = p.colorBuffer[qcpColorizeIndex(p, values[i])];
+    scanLine[i] = alpha ? qcpColorizePremultiply(rgb, alpha[i]) : rgb;
   }
-  if (!scanLine)
+}
+
+/*! \internal
+  
+  Returns the four color buffer indices of \a values[0..3], computed by the scalar code. Kept out of
+  line, it's only used for cells the kernels can't handle.
+*/
+static __m128i qcpColorizeIndicesScalar(const QCPColorizeParams &p, const double *values)
+{
+  return _mm_set_epi32(qcpColorizeIndex(p, values[3]), qcpColorizeIndex(p, values[2]), qcpColorizeIndex(p, values[1]), qcpColorizeIndex(p, values[0]));
+}
+
+/*! \internal
+  
+  Natural logarithm of the two positive, normal, finite values in \a x.
+  
+  The value is split into exponent e and mantissa m in [sqrt(1/2), sqrt(2)), and ln(m) is evaluated
+  as 2*atanh(s) with s = (m-1)/(m+1), |s| <= 0.1716, using the series up to s^13. The first
+  omitted term is below 4e-13, so together with rounding the absolute error stays below 1e-12.
+  Relative to the spacing of the gradient levels this is negligible: an index computed with this
+  approximation differs from the one computed with qLn only if the exact value lies within about
+  1e-12*(levelCount-1)/ln(upper/lower) of a level boundary.
+*/
+QCP_TARGET_SSE41 static inline __m128d qcpLogSse41(__m128d x)
+{
+  const __m128i bits = _mm_castpd_si128(x);
+  // exponent as double: put the biased exponent into the mantissa of 2^52 and subtract 2^52+bias
+  __m128d exponent = _mm_sub_pd(_mm_castsi128_pd(_mm_or_si128(_mm_srli_epi64(bits, 52), _mm_set1_epi64x(0x4330000000000000LL))),
+                                _mm_set1_pd(4503599627370496.0+1023.0));
+  __m128d mantissa = _mm_castsi128_pd(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi64x(0x000FFFFFFFFFFFFFLL)), _mm_set1_epi64x(0x3FF0000000000000LL)));
+  const __m128d large = _mm_cmpgt_pd(mantissa, _mm_set1_pd(1.4142135623730951));
+  mantissa = _mm_blendv_pd(mantissa, _mm_mul_pd(mantissa, _mm_set1_pd(0.5)), large);
+  exponent = _mm_add_pd(exponent, _mm_and_pd(large, _mm_set1_pd(1.0)));
+  const __m128d one = _mm_set1_pd(1.0);
+  const __m128d s = _mm_div_pd(_mm_sub_pd(mantissa, one), _mm_add_pd(mantissa, one));
+  const __m128d z = _mm_mul_pd(s, s);
+  __m128d poly = _mm_set1_pd(2.0/13.0);
+  poly = _mm_add_pd(_mm_mul_pd(poly, z), _mm_set1_pd(2.0/11.0));
+  poly = _mm_add_pd(_mm_mul_pd(poly, z), _mm_set1_pd(2.0/9.0));
+  poly = _mm_add_pd(_mm_mul_pd(poly, z), _mm_set1_pd(2.0/7.0));
+  poly = _mm_add_pd(_mm_mul_pd(poly, z), _mm_set1_pd(2.0/5.0));
+  poly = _mm_add_pd(_mm_mul_pd(poly, z), _mm_set1_pd(2.0/3.0));
+  poly = _mm_add_pd(_mm_mul_pd(poly, z), _mm_set1_pd(2.0));
+  return _mm_add_pd(_mm_mul_pd(exponent, _mm_set1_pd(0.6931471805599453)), _mm_mul_pd(s, poly));
+}
+
+/*! \internal
+  
+  Reduces the level positions \a t to the color buffer range [0, levelCount) like the periodic
+  scalar loop: \a t is truncated to int first, so positions outside the int range and NaN become
+  INT_MIN (what the int conversion produces on x86) before the remainder is taken. The quotient is
+  formed with the reciprocal \a inverseLevels, it may be off by one, which the two corrections at
+  the end absorb.
+*/
+QCP_TARGET_SSE41 static inline __m128d qcpColorizePeriodicSse41(__m128d t, __m128d levels, __m128d inverseLevels)
+{
+  const __m128d q = _mm_cvtepi32_pd(_mm_cvttpd_epi32(t));
+  __m128d r = _mm_sub_pd(q, _mm_mul_pd(_mm_floor_pd(_mm_mul_pd(q, inverseLevels)), levels));
+  r = _mm_add_pd(r, _mm_and_pd(_mm_cmplt_pd(r, _mm_setzero_pd()), levels));
+  r = _mm_sub_pd(r, _mm_and_pd(_mm_cmpge_pd(r, levels), levels));
+  return r;
+}
+
+/*! \internal
+  
+  Returns the unclamped level positions of the two cells in \a v. Returns false if the logarithm
+  can't be approximated for one of them (non-positive, denormal, infinite or NaN ratio), in which
+  case the caller falls back to the scalar code.
+*/
+template <bool logarithmic>
+QCP_TARGET_SSE41 static inline bool qcpColorizePositionsSse41(const QCPColorizeParams &p, __m128d v, __m128d *t)
+{
+  if (logarithmic)
   {
-    qDebug() << Q_FUNC_INFO << "null pointer given as scanLine";
-    return;
-  }
-  if (mColorBufferInvalidated)
-    updateColorBuffer();
+    const __m128d x = _mm_div_pd(v, _mm_set1_pd(p.lower));
+    const __m128d valid = _mm_and_pd(_mm_cmpge_pd(x, _mm_set1_pd(DBL_MIN)), _mm_cmple_pd(x, _mm_set1_pd(DBL_MAX)));
+    if (_mm_movemask_pd(valid) != 0x3)
+      return false;
+    *t = _mm_mul_pd(qcpLogSse41(x), _mm_set1_pd(p.logFactor));
+  } else
+    *t = _mm_mul_pd(_mm_sub_pd(v, _mm_set1_pd(p.lower)), _mm_set1_pd(p.factor));
+  return true;
+}
+
+/*! \internal
   
-  if (!logarithmic)
+  Returns the color buffer indices of \a values[0..3]. The mapping is given by template parameters,
+  so each of the four loops compiles without per-cell branches.
+*/
+template <bool logarithmic, bool periodic>
+QCP_TARGET_SSE41 static inline __m128i qcpColorizeIndicesSse41(const QCPColorizeParams &p, const double *values)
+{
+  __m128d t0, t1;
+  if (!qcpColorizePositionsSse41<logarithmic>(p, _mm_loadu_pd(values), &t0) || !qcpColorizePositionsSse41<logarithmic>(p, _mm_loadu_pd(values+2), &t1))
+    return qcpColorizeIndicesScalar(p, values);
+  if (periodic)
   {
-    const double posToIndexFactor = (mLevelCount-1)/range.size();
-    if (mPeriodic)
-    {
-      for (int i=0; i<n; ++i)
-      {
-        int index = (int)((data[dataIndexFactor*i]-range.lower)*posToIndexFactor) % mLevelCount;
-        if (index < 0)
-          index += mLevelCount;
-        scanLine[i] = mColorBuffer.at(index);
-      }
-    } else
-    {
-      for (int i=0; i<n; ++i)
-      {
-        int index = (data[dataIndexFactor*i]-range.lower)*posToIndexFactor;
-        if (index < 0)
-          index = 0;
-        else if (index >= mLevelCount)
-          index = mLevelCount-1;
-        scanLine[i] = mColorBuffer.at(index);
-      }
-    }
-  } else // logarithmic == true
+    const __m128d levels = _mm_set1_pd(p.levelCount);
+    const __m128d inverseLevels = _mm_set1_pd(1.0/p.levelCount);
+    t0 = qcpColorizePeriodicSse41(t0, levels, inverseLevels);
+    t1 = qcpColorizePeriodicSse41(t1, levels, inverseLevels);
+    return _mm_unpacklo_epi64(_mm_cvttpd_epi32(t0), _mm_cvttpd_epi32(t1));
+  }
+  // truncating conversion, out of range and NaN give INT_MIN like the scalar int conversion, then clamp:
+  const __m128i index = _mm_unpacklo_epi64(_mm_cvttpd_epi32(t0), _mm_cvttpd_epi32(t1));
+  return _mm_min_epi32(_mm_max_epi32(index, _mm_setzero_si128()), _mm_set1_epi32(p.levelCount-1));
+}
+
+/*! \internal
+  
+  Multiplies the channel in the lowest byte of each element of \a channel with \a alphaF, using the
+  same float arithmetic (and truncation) as the scalar path.
+*/
+QCP_TARGET_SSE41 static inline __m128i qcpColorizeScaleChannelSse41(__m128i channel, __m128 alphaF)
+{
+  return _mm_cvttps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(channel, _mm_set1_epi32(0xFF))), alphaF));
+}
+
+/*! \internal
+  
+  Premultiplies the four colors in \a colors with the alpha values in \a alpha.
+*/
+QCP_TARGET_SSE41 static inline __m128i qcpColorizePremultiplySse41(__m128i colors, __m128i alpha)
+{
+  const __m128 alphaF = _mm_div_ps(_mm_cvtepi32_ps(alpha), _mm_set1_ps(255.0f));
+  return _mm_or_si128(_mm_or_si128(qcpColorizeScaleChannelSse41(colors, alphaF),
+                                   _mm_slli_epi32(qcpColorizeScaleChannelSse41(_mm_srli_epi32(colors, 8), alphaF), 8)),
+                      _mm_or_si128(_mm_slli_epi32(qcpColorizeScaleChannelSse41(_mm_srli_epi32(colors, 16), alphaF), 16),
+                                   _mm_slli_epi32(qcpColorizeScaleChannelSse41(_mm_srli_epi32(colors, 24), alphaF), 24)));
+}
+
+/*! \internal
+  
+  SSE4.1 kernel: colorizes the \a n contiguous \a values into \a scanLine, four cells per
+  iteration. If \a alpha is non-zero, the colors are premultiplied with it.
+*/
+template <bool logarithmic, bool periodic>
+QCP_TARGET_SSE41 static void qcpColorizeLoopSse41(const QCPColorizeParams &params, const double *values, const unsigned char *alpha, QRgb *scanLine, int n)
+{
+  const QCPColorizeParams p = params; // local copy, so stores to scanLine can't alias the parameters
+  int i = 0;
+  for (; i+4 <= n; i += 4)
   {
-    if (mPeriodic)
-    {
-      for (int i=0; i<n; ++i)
-      {
-        int index = (int)(qLn(data[dataIndexFactor*i]/range.lower)/qLn(range.upper/range.lower)*(mLevelCount-1)) % mLevelCount;
-        if (index < 0)
-          index += mLevelCount;
-        scanLine[i] = mColorBuffer.at(index);
-      }
-    } else
+    const __m128i index = qcpColorizeIndicesSse41<logarithmic, periodic>(p, values+i);
+    // SSE4.1 has no gather, look the colors up individually:
+    __m128i colors = _mm_set_epi32(p.colorBuffer[_mm_extract_epi32(index, 3)], p.colorBuffer[_mm_extract_epi32(index, 2)],
+                                   p.colorBuffer[_mm_extract_epi32(index, 1)], p.colorBuffer[_mm_extract_epi32(index, 0)]);
+    if (alpha)
     {
-      for (int i=0; i<n; ++i)
-      {
-        int index = qLn(data[dataIndexFactor*i]/range.lower)/qLn(range.upper/range.lower)*(mLevelCount-1);
-        if (index < 0)
-          index = 0;
-        else if (index >= mLevelCount)
-          index = mLevelCount-1;
-        scanLine[i] = mColorBuffer.at(index);
-      }
+      int alphaBytes;
+      memcpy(&alphaBytes, alpha+i, sizeof(alphaBytes));
+      colors = qcpColorizePremultiplySse41(colors, _mm_cvtepu8_epi32(_mm_cvtsi32_si128(alphaBytes)));
     }
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(scanLine+i), colors);
   }
+  qcpColorizeScalarRange(p, values, alpha, scanLine, i, n);
 }
 
-/*! \overload
+/*! \internal
+  
+  Calls the \ref qcpColorizeLoopSse41 instance for the mapping in \a p.
+*/
+static void qcpColorizeSse41(const QCPColorizeParams &p, const double *values, const unsigned char *alpha, QRgb *scanLine, int n)
+{
+  if (p.logarithmic)
+  {
+    if (p.periodic)
+      qcpColorizeLoopSse41<true, true>(p, values, alpha, scanLine, n);
+    else
+      qcpColorizeLoopSse41<true, false>(p, values, alpha, scanLine, n);
+  } else
+  {
+    if (p.periodic)
+      qcpColorizeLoopSse41<false, true>(p, values, alpha, scanLine, n);
+    else
+      qcpColorizeLoopSse41<false, false>(p, values, alpha, scanLine, n);
+  }
+}
 
-  Additionally to the other overload of \ref colorize, this method takes the array \a alpha, which
-  has the same size and structure as \a data and encodes the alpha information per data point.
+/*! \internal
+  
+  AVX2 version of \ref qcpLogSse41, with the same error bound.
+*/
+QCP_TARGET_AVX2 static inline __m256d qcpLogAvx2(__m256d x)
+{
+  const __m256i bits = _mm256_castpd_si256(x);
+  __m256d exponent = _mm256_sub_pd(_mm256_castsi256_pd(_mm256_or_si256(_mm256_srli_epi64(bits, 52), _mm256_set1_epi64x(0x4330000000000000LL))),
+                                   _mm256_set1_pd(4503599627370496.0+1023.0));
+  __m256d mantissa = _mm256_castsi256_pd(_mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi64x(0x000FFFFFFFFFFFFFLL)), _mm256_set1_epi64x(0x3FF0000000000000LL)));
+  const __m256d large = _mm256_cmp_pd(mantissa, _mm256_set1_pd(1.4142135623730951), _CMP_GT_OQ);
+  mantissa = _mm256_blendv_pd(mantissa, _mm256_mul_pd(mantissa, _mm256_set1_pd(0.5)), large);
+  exponent = _mm256_add_pd(exponent, _mm256_and_pd(large, _mm256_set1_pd(1.0)));
+  const __m256d one = _mm256_set1_pd(1.0);
+  const __m256d s = _mm256_div_pd(_mm256_sub_pd(mantissa, one), _mm256_add_pd(mantissa, one));
+  const __m256d z = _mm256_mul_pd(s, s);
+  __m256d poly = _mm256_set1_pd(2.0/13.0);
+  poly = _mm256_add_pd(_mm256_mul_pd(poly, z), _mm256_set1_pd(2.0/11.0));
+  poly = _mm256_add_pd(_mm256_mul_pd(poly, z), _mm256_set1_pd(2.0/9.0));
+  poly = _mm256_add_pd(_mm256_mul_pd(poly, z), _mm256_set1_pd(2.0/7.0));
+  poly = _mm256_add_pd(_mm256_mul_pd(poly, z), _mm256_set1_pd(2.0/5.0));
+  poly = _mm256_add_pd(_mm256_mul_pd(poly, z), _mm256_set1_pd(2.0/3.0));
+  poly = _mm256_add_pd(_mm256_mul_pd(poly, z), _mm256_set1_pd(2.0));
+  return _mm256_add_pd(_mm256_mul_pd(exponent, _mm256_set1_pd(0.6931471805599453)), _mm256_mul_pd(s, poly));
+}
 
-  The QRgb values that are placed in \a scanLine have their r, g and b components premultiplied
-  with alpha (see QImage::Format_ARGB32_Premultiplied).
+/*! \internal
+  
+  Returns the color buffer indices of \a values[0..3], see \ref qcpColorizeIndicesSse41.
 */
-void QCPColorGradient::colorize(const double *data, const unsigned char *alpha, const QCPRange &range, QRgb *scanLine, int n, int dataIndexFactor, bool logarithmic)
+template <bool logarithmic, bool periodic>
+QCP_TARGET_AVX2 static inline __m128i qcpColorizeIndicesAvx2(const QCPColorizeParams &p, const double *values)
 {
-  // If you change something here, make sure to also adapt color() and the other colorize() overload
-  if (!data)
+  const __m256d v = _mm256_loadu_pd(values);
+  __m256d t;
+  if (logarithmic)
   {
-    qDebug() << Q_FUNC_INFO << "null pointer given as data";
-    return;
+    const __m256d x = _mm256_div_pd(v, _mm256_set1_pd(p.lower));
+    const __m256d valid = _mm256_and_pd(_mm256_cmp_pd(x, _mm256_set1_pd(DBL_MIN), _CMP_GE_OQ), _mm256_cmp_pd(x, _mm256_set1_pd(DBL_MAX), _CMP_LE_OQ));
+    if (_mm256_movemask_pd(valid) != 0xF)
+      return qcpColorizeIndicesScalar(p, values);
+    t = _mm256_mul_pd(qcpLogAvx2(x), _mm256_set1_pd(p.logFactor));
+  } else
+    t = _mm256_mul_pd(_mm256_sub_pd(v, _mm256_set1_pd(p.lower)), _mm256_set1_pd(p.factor));
+  
+  if (periodic)
+  {
+    const __m256d levels = _mm256_set1_pd(p.levelCount);
+    const __m256d q = _mm256_cvtepi32_pd(_mm256_cvttpd_epi32(t)); // see qcpColorizePeriodicSse41
+    __m256d r = _mm256_sub_pd(q, _mm256_mul_pd(_mm256_floor_pd(_mm256_mul_pd(q, _mm256_set1_pd(1.0/p.levelCount))), levels));
+    r = _mm256_add_pd(r, _mm256_and_pd(_mm256_cmp_pd(r, _mm256_setzero_pd(), _CMP_LT_OQ), levels));
+    r = _mm256_sub_pd(r, _mm256_and_pd(_mm256_cmp_pd(r, levels, _CMP_GE_OQ), levels));
+    return _mm256_cvttpd_epi32(r);
   }
-  if (!alpha)
+  return _mm_min_epi32(_mm_max_epi32(_mm256_cvttpd_epi32(t), _mm_setzero_si128()), _mm_set1_epi32(p.levelCount-1));
+}
+
+/*! \internal
+  
+  AVX2 version of \ref qcpColorizeScaleChannelSse41.
+*/
+QCP_TARGET_AVX2 static inline __m256i qcpColorizeScaleChannelAvx2(__m256i channel, __m256 alphaF)
+{
+  return _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_and_si256(channel, _mm256_set1_epi32(0xFF))), alphaF));
+}
+
+/*! \internal
+  
+  AVX2 version of \ref qcpColorizePremultiplySse41, for eight colors.
+*/
+QCP_TARGET_AVX2 static inline __m256i qcpColorizePremultiplyAvx2(__m256i colors, __m256i alpha)
+{
+  const __m256 alphaF = _mm256_div_ps(_mm256_cvtepi32_ps(alpha), _mm256_set1_ps(255.0f));
+  return _mm256_or_si256(_mm256_or_si256(qcpColorizeScaleChannelAvx2(colors, alphaF),
+                                         _mm256_slli_epi32(qcpColorizeScaleChannelAvx2(_mm256_srli_epi32(colors, 8), alphaF), 8)),
+                         _mm256_or_si256(_mm256_slli_epi32(qcpColorizeScaleChannelAvx2(_mm256_srli_epi32(colors, 16), alphaF), 16),
+                                         _mm256_slli_epi32(qcpColorizeScaleChannelAvx2(_mm256_srli_epi32(colors, 24), alphaF), 24)));
+}
+
+/*! \internal
+  
+  AVX2 kernel: colorizes the \a n contiguous \a values into \a scanLine, eight cells per iteration,
+  looking up the colors with a gather. If \a alpha is non-zero, the colors are premultiplied with
+  it.
+*/
+template <bool logarithmic, bool periodic>
+QCP_TARGET_AVX2 static void qcpColorizeLoopAvx2(const QCPColorizeParams &params, const double *values, const unsigned char *alpha, QRgb *scanLine, int n)
+{
+  const QCPColorizeParams p = params; // local copy, so stores to scanLine can't alias the parameters
+  int i = 0;
+  for (; i+8 <= n; i += 8)
   {
-    qDebug() << Q_FUNC_INFO << "null pointer given as alpha";
-    return;
+    const __m128i lowIndex = qcpColorizeIndicesAvx2<logarithmic, periodic>(p, values+i);
+    const __m128i highIndex = qcpColorizeIndicesAvx2<logarithmic, periodic>(p, values+i+4);
+    const __m256i index = _mm256_inserti128_si256(_mm256_castsi128_si256(lowIndex), highIndex, 1);
+    __m256i colors = _mm256_i32gather_epi32(reinterpret_cast<const int*>(p.colorBuffer), index, 4);
+    if (alpha)
+      colors = qcpColorizePremultiplyAvx2(colors, _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(alpha+i))));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(scanLine+i), colors);
   }
-  if (!scanLine)
+  qcpColorizeScalarRange(p, values, alpha, scanLine, i, n);
+}
+
+/*! \internal
+  
+  Calls the \ref qcpColorizeLoopAvx2 instance for the mapping in \a p.
+*/
+static void qcpColorizeAvx2(const QCPColorizeParams &p, const double *values, const unsigned char *alpha, QRgb *scanLine, int n)
+{
+  if (p.logarithmic)
   {
-    qDebug() << Q_FUNC_INFO << "null pointer given as scanLine";
-    return;
+    if (p.periodic)
+      qcpColorizeLoopAvx2<true, true>(p, values, alpha, scanLine, n);
+    else
+      qcpColorizeLoopAvx2<true, false>(p, values, alpha, scanLine, n);
+  } else
+  {
+    if (p.periodic)
+      qcpColorizeLoopAvx2<false, true>(p, values, alpha, scanLine, n);
+    else
+      qcpColorizeLoopAvx2<false, false>(p, values, alpha, scanLine, n);
   }
+}
+
+/*! \internal
+  
+  Determines the instruction set extensions the CPU (and operating system) supports.
+*/
+static QCPColorGradient::SimdLevel qcpDetectSimdLevel()
+{
+#  ifdef _MSC_VER
+  int info[4];
+  __cpuid(info, 0);
+  const int maxLeaf = info[0];
+  __cpuid(info, 1);
+  const bool sse41 = (info[2] & (1<<19)) != 0;
+  const bool osAvx = (info[2] & (1<<27)) && (info[2] & (1<<28)) && (_xgetbv(0) & 0x6) == 0x6; // OSXSAVE, AVX, and OS saves the ymm registers
+  bool avx2 = false;
+  if (osAvx && maxLeaf >= 7)
+  {
+    __cpuidex(info, 7, 0);
+    avx2 = (info[1] & (1<<5)) != 0;
+  }
+#  else
+  __builtin_cpu_init();
+  const bool sse41 = __builtin_cpu_supports("sse4.1");
+  const bool avx2 = __builtin_cpu_supports("avx2");
+#  endif
+  if (avx2)
+    return QCPColorGradient::slAvx2;
+  else if (sse41)
+    return QCPColorGradient::slSse41;
+  else
+    return QCPColorGradient::slNone;
+}
+
+/*! \internal
+  
+  Overloads returning \a data if it can be passed to the kernels directly (contiguous doubles), and
+  null for other cell types, which are first converted into a block of doubles.
+*/
+static inline const double *qcpColorizeDirectValues(const double *data) { return data; }
+template <typename CellValueType>
+static inline const double *qcpColorizeDirectValues(const CellValueType *) { return 0; }
+#endif // QCP_COLORIZE_SIMD
+
+/*! \internal
+  
+  The simd level chosen with \ref QCPColorGradient::setSimdLevel, or -1 if none was chosen, i.e.
+  the supported level is used.
+*/
+static QAtomicInt qcpColorizeSimdLevel(-1);
+
+/*! \internal
+  
+  Implements all \ref colorize overloads. \a CellValueType is the type of the elements of \a data.
+  If \a scaled is true, the data value of an element is <tt>data[i]*scale + offset</tt>, otherwise
+  it's the element itself. If \a useAlpha is true, \a alpha holds the alpha information per data
+  point. Since these are template parameters, each combination compiles to loops without any
+  additional per-element branches.
+  
+  If a vectorized kernel is available (see \ref setSimdLevel), the cells are processed in blocks of
+  doubles by that kernel instead. Contiguous double data is passed to the kernel directly, other
+  cell types, scaled and strided data are first converted into a block buffer with the same
+  arithmetic as the scalar loops. The scalar loops below remain the fallback.
+*/
+template <typename CellValueType, bool scaled, bool useAlpha>
+void QCPColorGradient::colorizeCells(const CellValueType *data, double scale, double offset, const unsigned char *alpha, const QCPRange &range, QRgb *scanLine, int n, int dataIndexFactor, bool logarithmic)
+{
+  // If you change something here, make sure to also adapt color()
   if (mColorBufferInvalidated)
     updateColorBuffer();
   
+  const QRgb *colorBuffer = mColorBuffer.constData(); // raw access, QVector::at would assert the index range in every iteration in debug builds
+#ifdef QCP_COLORIZE_SIMD
+  const SimdLevel simd = simdLevel();
+  if (simd != slNone && n >= 8)
+  {
+    QCPColorizeParams params;
+    params.colorBuffer = colorBuffer;
+    params.levelCount = mLevelCount;
+    params.periodic = mPeriodic;
+    params.logarithmic = logarithmic;
+    params.lower = range.lower;
+    params.factor = logarithmic ? 0 : (mLevelCount-1)/range.size();
+    params.logRange = logarithmic ? qLn(range.upper/range.lower) : 0;
+    params.logFactor = logarithmic ? (mLevelCount-1)/params.logRange : 0;
+    const int blockSize = 256;
+    double valueBlock[blockSize];
+    unsigned char alphaBlock[blockSize];
+    for (int blockStart=0; blockStart<n; blockStart+=blockSize)
+    {
+      const int count = qMin(blockSize, n-blockStart);
+      const double *values = !scaled && dataIndexFactor == 1 ? qcpColorizeDirectValues(data+blockStart) : 0;
+      if (!values)
+      {
+        for (int i=0; i<count; ++i)
+          valueBlock[i] = scaled ? data[dataIndexFactor*(blockStart+i)]*scale+offset : data[dataIndexFactor*(blockStart+i)];
+        values = valueBlock;
+      }
+      const unsigned char *alphaValues = 0;
+      if (useAlpha)
+      {
+        if (dataIndexFactor == 1)
+          alphaValues = alpha+blockStart;
+        else
+        {
+          for (int i=0; i<count; ++i)
+            alphaBlock[i] = alpha[dataIndexFactor*(blockStart+i)];
+          alphaValues = alphaBlock;
+        }
+      }
+      if (simd == slAvx2)
+        qcpColorizeAvx2(params, values, alphaValues, scanLine+blockStart, count);
+      else
+        qcpColorizeSse41(params, values, alphaValues, scanLine+blockStart, count);
+    }
+    return;
+  }
+#endif
   if (!logarithmic)
   {
     const double posToIndexFactor = (mLevelCount-1)/range.size();
@@ -16026,15 +18879,16 @@ void QCPColorGradient::colorize(const double *data, const unsigned char *alpha,
     {
       for (int i=0; i<n; ++i)
       {
-        int index = (int)((data[dataIndexFactor*i]-range.lower)*posToIndexFactor) % mLevelCount;
+        const double value = scaled ? data[dataIndexFactor*i]*scale+offset : data[dataIndexFactor*i];
+        int index = (int)((value-range.lower)*posToIndexFactor) % mLevelCount;
         if (index < 0)
           index += mLevelCount;
-        if (alpha[dataIndexFactor*i] == 255)
+        if (!useAlpha || alpha[dataIndexFactor*i] == 255)
         {
-          scanLine[i] = mColorBuffer.at(index);
+          scanLine[i] = colorBuffer[index];
         } else
         {
-          const QRgb rgb = mColorBuffer.at(index);
+          const QRgb rgb = colorBuffer[index];
           const float alphaF = alpha[dataIndexFactor*i]/255.0f;
           scanLine[i] = qRgba(qRed(rgb)*alphaF, qGreen(rgb)*alphaF, qBlue(rgb)*alphaF, qAlpha(rgb)*alphaF);
         }
@@ -16043,17 +18897,18 @@ void QCPColorGradient::colorize(const double *data, const unsigned char *alpha,
     {
       for (int i=0; i<n; ++i)
       {
-        int index = (data[dataIndexFactor*i]-range.lower)*posToIndexFactor;
+        const double value = scaled ? data[dataIndexFactor*i]*scale+offset : data[dataIndexFactor*i];
+        int index = (value-range.lower)*posToIndexFactor;
         if (index < 0)
           index = 0;
         else if (index >= mLevelCount)
           index = mLevelCount-1;
-        if (alpha[dataIndexFactor*i] == 255)
+        if (!useAlpha || alpha[dataIndexFactor*i] == 255)
         {
-          scanLine[i] = mColorBuffer.at(index);
+          scanLine[i] = colorBuffer[index];
         } else
         {
-          const QRgb rgb = mColorBuffer.at(index);
+          const QRgb rgb = colorBuffer[index];
           const float alphaF = alpha[dataIndexFactor*i]/255.0f;
           scanLine[i] = qRgba(qRed(rgb)*alphaF, qGreen(rgb)*alphaF, qBlue(rgb)*alphaF, qAlpha(rgb)*alphaF);
         }
@@ -16061,19 +18916,21 @@ void QCPColorGradient::colorize(const double *data, const unsigned char *alpha,
     }
   } else // logarithmic == true
   {
+    const double logRange = qLn(range.upper/range.lower);
     if (mPeriodic)
     {
       for (int i=0; i<n; ++i)
       {
-        int index = (int)(qLn(data[dataIndexFactor*i]/range.lower)/qLn(range.upper/range.lower)*(mLevelCount-1)) % mLevelCount;
+        const double value = scaled ? data[dataIndexFactor*i]*scale+offset : data[dataIndexFactor*i];
+        int index = (int)(qLn(value/range.lower)/logRange*(mLevelCount-1)) % mLevelCount;
         if (index < 0)
           index += mLevelCount;
-        if (alpha[dataIndexFactor*i] == 255)
+        if (!useAlpha || alpha[dataIndexFactor*i] == 255)
         {
-          scanLine[i] = mColorBuffer.at(index);
+          scanLine[i] = colorBuffer[index];
         } else
         {
-          const QRgb rgb = mColorBuffer.at(index);
+          const QRgb rgb = colorBuffer[index];
           const float alphaF = alpha[dataIndexFactor*i]/255.0f;
           scanLine[i] = qRgba(qRed(rgb)*alphaF, qGreen(rgb)*alphaF, qBlue(rgb)*alphaF, qAlpha(rgb)*alphaF);
         }
@@ -16082,17 +18939,18 @@ void QCPColorGradient::colorize(const double *data, const unsigned char *alpha,
     {
       for (int i=0; i<n; ++i)
       {
-        int index = qLn(data[dataIndexFactor*i]/range.lower)/qLn(range.upper/range.lower)*(mLevelCount-1);
+        const double value = scaled ? data[dataIndexFactor*i]*scale+offset : data[dataIndexFactor*i];
+        int index = qLn(value/range.lower)/logRange*(mLevelCount-1);
         if (index < 0)
           index = 0;
         else if (index >= mLevelCount)
           index = mLevelCount-1;
-        if (alpha[dataIndexFactor*i] == 255)
+        if (!useAlpha || alpha[dataIndexFactor*i] == 255)
         {
-          scanLine[i] = mColorBuffer.at(index);
+          scanLine[i] = colorBuffer[index];
         } else
         {
-          const QRgb rgb = mColorBuffer.at(index);
+          const QRgb rgb = colorBuffer[index];
           const float alphaF = alpha[dataIndexFactor*i]/255.0f;
           scanLine[i] = qRgba(qRed(rgb)*alphaF, qGreen(rgb)*alphaF, qBlue(rgb)*alphaF, qAlpha(rgb)*alphaF);
         }
@@ -16101,74 +18959,230 @@ void QCPColorGradient::colorize(const double *data, const unsigned char *alpha,
   }
 }
 
-/*! \internal
+/*! \overload
+  
+  This method is used to quickly convert a \a data array to colors. The colors will be output in
+  the array \a scanLine. Both \a data and \a scanLine must have the length \a n when passed to this
+  function. The data range that shall be used for mapping the data value to the gradient is passed
+  in \a range. \a logarithmic indicates whether the data values shall be mapped to colors
+  logarithmically.
 
-  This method is used to colorize a single data value given in \a position, to colors. The data
-  range that shall be used for mapping the data value to the gradient is passed in \a range. \a
-  logarithmic indicates whether the data value shall be mapped to a color logarithmically.
+  if \a data actually contains 2D-data linearized via <tt>[row*columnCount + column]</tt>, you can
+  set \a dataIndexFactor to <tt>columnCount</tt> to convert a column instead of a row of the data
+  array, in \a scanLine. \a scanLine will remain a regular (1D) array. This works because \a data
+  is addressed <tt>data[i*dataIndexFactor]</tt>.
+  
+  Use the overloaded method to additionally provide alpha map data.
 
-  If an entire array of data values shall be converted, rather use \ref colorize, for better
-  performance.
+  The QRgb values that are placed in \a scanLine have their r, g and b components premultiplied
+  with alpha (see QImage::Format_ARGB32_Premultiplied).
+  
+  On x86 CPUs with SSE4.1 or AVX2, all overloads use vectorized kernels which process several cells
+  at once, see \ref setSimdLevel.
+*/
+void QCPColorGradient::colorize(const double *data, const QCPRange &range, QRgb *scanLine, int n, int dataIndexFactor, bool logarithmic)
+{
+  if (!data)
+  {
+    qDebug() << Q_FUNC_INFO << "null pointer given as data";
+    return;
+  }
+  if (!scanLine)
+  {
+    qDebug() << Q_FUNC_INFO << "null pointer given as scanLine";
+    return;
+  }
+  colorizeCells<double, false, false>(data, 1, 0, 0, range, scanLine, n, dataIndexFactor, logarithmic);
+}
 
-  The returned QRgb has its r, g and b components premultiplied with alpha (see
-  QImage::Format_ARGB32_Premultiplied).
+/*! \overload
+
+  Additionally to the other overload of \ref colorize, this method takes the array \a alpha, which
+  has the same size and structure as \a data and encodes the alpha information per data point.
+
+  The QRgb values that are placed in \a scanLine have their r, g and b components premultiplied
+  with alpha (see QImage::Format_ARGB32_Premultiplied).
 */
-QRgb QCPColorGradient::color(double position, const QCPRange &range, bool logarithmic)
+void QCPColorGradient::colorize(const double *data, const unsigned char *alpha, const QCPRange &range, QRgb *scanLine, int n, int dataIndexFactor, bool logarithmic)
 {
-  // If you change something here, make sure to also adapt ::colorize()
-  if (mColorBufferInvalidated)
-    updateColorBuffer();
-  int index = 0;
-  if (!logarithmic)
-    index = (position-range.lower)*(mLevelCount-1)/range.size();
-  else
-    index = qLn(position/range.lower)/qLn(range.upper/range.lower)*(mLevelCount-1);
-  if (mPeriodic)
+  if (!data)
   {
-    index = index % mLevelCount;
-    if (index < 0)
-      index += mLevelCount;
-  } else
+    qDebug() << Q_FUNC_INFO << "null pointer given as data";
+    return;
+  }
+  if (!alpha)
   {
-    if (index < 0)
-      index = 0;
-    else if (index >= mLevelCount)
-      index = mLevelCount-1;
+    qDebug() << Q_FUNC_INFO << "null pointer given as alpha";
+    return;
   }
-  return mColorBuffer.at(index);
+  if (!scanLine)
+  {
+    qDebug() << Q_FUNC_INFO << "null pointer given as scanLine";
+    return;
+  }
+  colorizeCells<double, false, true>(data, 1, 0, alpha, range, scanLine, n, dataIndexFactor, logarithmic);
 }
 
-/*!
-  Clears the current color stops and loads the specified \a preset. A preset consists of predefined
-  color stops and the corresponding color interpolation method.
+/*! \overload
   
-  The available presets are:
-  \image html QCPColorGradient.png
+  Colorizes the single precision \a data array. This avoids converting float data (e.g. of a \ref
+  QCPColorMapData with cell type \ref QCPColorMapData::ctFloat) to double before colorizing.
 */
-void QCPColorGradient::loadPreset(GradientPreset preset)
+void QCPColorGradient::colorize(const float *data, const QCPRange &range, QRgb *scanLine, int n, int dataIndexFactor, bool logarithmic)
 {
-  clearColorStops();
-  switch (preset)
+  if (!data)
   {
-    case gpGrayscale:
-      setColorInterpolation(ciRGB);
-      setColorStopAt(0, Qt::black);
-      setColorStopAt(1, Qt::white);
-      break;
-    case gpHot:
-      setColorInterpolation(ciRGB);
-      setColorStopAt(0, QColor(50, 0, 0));
-      setColorStopAt(0.2, QColor(180, 10, 0));
-      setColorStopAt(0.4, QColor(245, 50, 0));
-      setColorStopAt(0.6, QColor(255, 150, 10));
-      setColorStopAt(0.8, QColor(255, 255, 50));
-      setColorStopAt(1, QColor(255, 255, 255));
-      break;
-    case gpCold:
-      setColorInterpolation(ciRGB);
-      setColorStopAt(0, QColor(0, 0, 50));
-      setColorStopAt(0.2, QColor(0, 10, 180));
-      setColorStopAt(0.4, QColor(0, 50, 245));
+    qDebug() << Q_FUNC_INFO << "null pointer given as data";
+    return;
+  }
+  if (!scanLine)
+  {
+    qDebug() << Q_FUNC_INFO << "null pointer given as scanLine";
+    return;
+  }
+  colorizeCells<float, false, false>(data, 1, 0, 0, range, scanLine, n, dataIndexFactor, logarithmic);
+}
+
+/*! \overload
+  
+  Colorizes the single precision \a data array, with additional \a alpha information per data
+  point.
+*/
+void QCPColorGradient::colorize(const float *data, const unsigned char *alpha, const QCPRange &range, QRgb *scanLine, int n, int dataIndexFactor, bool logarithmic)
+{
+  if (!data)
+  {
+    qDebug() << Q_FUNC_INFO << "null pointer given as data";
+    return;
+  }
+  if (!alpha)
+  {
+    qDebug() << Q_FUNC_INFO << "null pointer given as alpha";
+    return;
+  }
+  if (!scanLine)
+  {
+    qDebug() << Q_FUNC_INFO << "null pointer given as scanLine";
+    return;
+  }
+  colorizeCells<float, false, true>(data, 1, 0, alpha, range, scanLine, n, dataIndexFactor, logarithmic);
+}
+
+/*! \overload
+  
+  Colorizes the 16 bit integer \a data array. The data value of each element is
+  <tt>data[i]*scale + offset</tt>, which is then mapped to the gradient like the other overloads do
+  with double values. This allows colorizing e.g. raw sensor frames or a \ref QCPColorMapData with
+  cell type \ref QCPColorMapData::ctUInt16 without converting them first.
+*/
+void QCPColorGradient::colorize(const quint16 *data, double scale, double offset, const QCPRange &range, QRgb *scanLine, int n, int dataIndexFactor, bool logarithmic)
+{
+  if (!data)
+  {
+    qDebug() << Q_FUNC_INFO << "null pointer given as data";
+    return;
+  }
+  if (!scanLine)
+  {
+    qDebug() << Q_FUNC_INFO << "null pointer given as scanLine";
+    return;
+  }
+  colorizeCells<quint16, true, false>(data, scale, offset, 0, range, scanLine, n, dataIndexFactor, logarithmic);
+}
+
+/*! \overload
+  
+  Colorizes the 16 bit integer \a data array with \a scale and \a offset, with additional \a alpha
+  information per data point.
+*/
+void QCPColorGradient::colorize(const quint16 *data, double scale, double offset, const unsigned char *alpha, const QCPRange &range, QRgb *scanLine, int n, int dataIndexFactor, bool logarithmic)
+{
+  if (!data)
+  {
+    qDebug() << Q_FUNC_INFO << "null pointer given as data";
+    return;
+  }
+  if (!alpha)
+  {
+    qDebug() << Q_FUNC_INFO << "null pointer given as alpha";
+    return;
+  }
+  if (!scanLine)
+  {
+    qDebug() << Q_FUNC_INFO << "null pointer given as scanLine";
+    return;
+  }
+  colorizeCells<quint16, true, true>(data, scale, offset, alpha, range, scanLine, n, dataIndexFactor, logarithmic);
+}
+
+/*! \internal
+
+  This method is used to colorize a single data value given in \a position, to colors. The data
+  range that shall be used for mapping the data value to the gradient is passed in \a range. \a
+  logarithmic indicates whether the data value shall be mapped to a color logarithmically.
+
+  If an entire array of data values shall be converted, rather use \ref colorize, for better
+  performance.
+
+  The returned QRgb has its r, g and b components premultiplied with alpha (see
+  QImage::Format_ARGB32_Premultiplied).
+*/
+QRgb QCPColorGradient::color(double position, const QCPRange &range, bool logarithmic)
+{
+  // If you change something here, make sure to also adapt ::colorize()
+  if (mColorBufferInvalidated)
+    updateColorBuffer();
+  int index = 0;
+  if (!logarithmic)
+    index = (position-range.lower)*(mLevelCount-1)/range.size();
+  else
+    index = qLn(position/range.lower)/qLn(range.upper/range.lower)*(mLevelCount-1);
+  if (mPeriodic)
+  {
+    index = index % mLevelCount;
+    if (index < 0)
+      index += mLevelCount;
+  } else
+  {
+    if (index < 0)
+      index = 0;
+    else if (index >= mLevelCount)
+      index = mLevelCount-1;
+  }
+  return mColorBuffer.at(index);
+}
+
+/*!
+  Clears the current color stops and loads the specified \a preset. A preset consists of predefined
+  color stops and the corresponding color interpolation method.
+  
+  The available presets are:
+  \image html QCPColorGradient.png
+*/
+void QCPColorGradient::loadPreset(GradientPreset preset)
+{
+  clearColorStops();
+  switch (preset)
+  {
+    case gpGrayscale:
+      setColorInterpolation(ciRGB);
+      setColorStopAt(0, Qt::black);
+      setColorStopAt(1, Qt::white);
+      break;
+    case gpHot:
+      setColorInterpolation(ciRGB);
+      setColorStopAt(0, QColor(50, 0, 0));
+      setColorStopAt(0.2, QColor(180, 10, 0));
+      setColorStopAt(0.4, QColor(245, 50, 0));
+      setColorStopAt(0.6, QColor(255, 150, 10));
+      setColorStopAt(0.8, QColor(255, 255, 50));
+      setColorStopAt(1, QColor(255, 255, 255));
+      break;
+    case gpCold:
+      setColorInterpolation(ciRGB);
+      setColorStopAt(0, QColor(0, 0, 50));
+      setColorStopAt(0.2, QColor(0, 10, 180));
+      setColorStopAt(0.4, QColor(0, 50, 245));
       setColorStopAt(0.6, QColor(10, 150, 255));
       setColorStopAt(0.8, QColor(50, 255, 255));
       setColorStopAt(1, QColor(255, 255, 255));
@@ -16275,6 +19289,69 @@ QCPColorGradient QCPColorGradient::inverted() const
   return result;
 }
 
+/*!
+  Returns a key which identifies the colors this gradient produces for its levels. Gradients with
+  equal keys have the same color stops, level count and color interpolation, and thus generate the
+  same colors.
+  
+  This key is used to share the color buffers and images rendered from gradients between instances
+  (see \ref QCPColorGradientCache). Since the periodicity (\ref setPeriodic) doesn't change the
+  colors of the levels, it's not part of the key.
+*/
+QByteArray QCPColorGradient::cacheKey() const
+{
+  QByteArray result;
+  QDataStream stream(&result, QIODevice::WriteOnly);
+  stream << mLevelCount << int(mColorInterpolation) << mColorStops;
+  return result;
+}
+
+/*!
+  Returns the most capable vectorized \ref colorize kernel this build and the running CPU support.
+  The CPU is queried once, at the first call.
+  
+  Builds for other architectures than x86, and builds with \c QCUSTOMPLOT_NO_SIMD defined, always
+  return \ref slNone.
+  
+  \see setSimdLevel
+*/
+QCPColorGradient::SimdLevel QCPColorGradient::supportedSimdLevel()
+{
+#ifdef QCP_COLORIZE_SIMD
+  static const SimdLevel level = qcpDetectSimdLevel();
+  return level;
+#else
+  return slNone;
+#endif
+}
+
+/*!
+  Returns the vectorized \ref colorize kernel currently in use. Unless changed with \ref
+  setSimdLevel, this is the \ref supportedSimdLevel.
+*/
+QCPColorGradient::SimdLevel QCPColorGradient::simdLevel()
+{
+  const int level = qcpColorizeSimdLevel.fetchAndAddRelaxed(0);
+  return level < 0 ? supportedSimdLevel() : SimdLevel(level);
+}
+
+/*!
+  Limits the vectorized \ref colorize kernels to \a level, for all gradients in the process. A
+  level beyond the \ref supportedSimdLevel is reduced to it. Setting \ref slNone uses only the
+  scalar loops, e.g. for comparisons in benchmarks.
+  
+  The kernels produce the same colors as the scalar loops, with one exception: for logarithmic
+  data ranges they use a polynomial approximation of the logarithm whose absolute error is below
+  1e-12. A cell can therefore end up one level off, but only if its exact level position lies within
+  about 1e-12*(levelCount-1)/ln(upper/lower) of a level boundary.
+  
+  This function is thread-safe.
+*/
+void QCPColorGradient::setSimdLevel(SimdLevel level)
+{
+  qcpColorizeSimdLevel.fetchAndStoreRelaxed(qMin(int(level), int(supportedSimdLevel())));
+}
+
 /*! \internal
   
   Returns true if the color gradient uses transparency, i.e. if any of the configured color stops
@@ -16297,6 +19374,13 @@ bool QCPColorGradient::stopsUseAlpha() const
 */
 void QCPColorGradient::updateColorBuffer()
 {
+  const QByteArray key = cacheKey();
+  if (QCPColorGradientCache::instance()->findColorBuffer(key, &mColorBuffer))
+  {
+    mColorBufferInvalidated = false;
+    return;
+  }
+  
   if (mColorBuffer.size() != mLevelCount)
     mColorBuffer.resize(mLevelCount);
   if (mColorStops.size() > 1)
@@ -16392,8 +19476,106 @@ void QCPColorGradient::updateColorBuffer()
   {
     mColorBuffer.fill(qRgb(0, 0, 0));
   }
+  QCPColorGradientCache::instance()->insertColorBuffer(key, mColorBuffer);
   mColorBufferInvalidated = false;
 }
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPColorGradientCache
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPColorGradientCache
+  \brief Process-wide cache of color gradient buffers and images (internal)
+  
+  This is an internal class. Dashboards with many color maps and color scales typically use the
+  same few gradients. Instead of each \ref QCPColorGradient instance interpolating its color stops
+  for every level, and each \ref QCPColorScale rendering its own gradient image, the results are
+  stored here, keyed by \ref QCPColorGradient::cacheKey (plus the image geometry for images).
+  
+  Color buffers are QVectors and images are QImages, so handing them out only creates shallow copies
+  that share the data with the cache. The cache is thread-safe and limits its memory usage by
+  evicting the least recently used entries.
+*/
+
+Q_GLOBAL_STATIC(QCPColorGradientCache, qcpColorGradientCache)
+
+/*!
+  Creates an empty cache. Use \ref instance to access the process-wide cache.
+*/
+QCPColorGradientCache::QCPColorGradientCache() :
+  mColorBuffers(4*1024*1024), // costs are in bytes
+  mImages(16*1024*1024)
+{
+}
+
+/*!
+  Returns the process-wide cache instance.
+*/
+QCPColorGradientCache *QCPColorGradientCache::instance()
+{
+  return qcpColorGradientCache();
+}
+
+/*!
+  If a color buffer for \a key is in the cache, sets \a colorBuffer to it and returns true.
+  Otherwise returns false and leaves \a colorBuffer untouched.
+*/
+bool QCPColorGradientCache::findColorBuffer(const QByteArray &key, QVector<QRgb> *colorBuffer)
+{
+  QMutexLocker locker(&mMutex);
+  if (const QVector<QRgb> *cached = mColorBuffers.object(key))
+  {
+    *colorBuffer = *cached;
+    return true;
+  }
+  return false;
+}
+
+/*!
+  Stores \a colorBuffer in the cache, with the key \a key.
+*/
+void QCPColorGradientCache::insertColorBuffer(const QByteArray &key, const QVector<QRgb> &colorBuffer)
+{
+  QMutexLocker locker(&mMutex);
+  mColorBuffers.insert(key, new QVector<QRgb>(colorBuffer), qMax(1, int(colorBuffer.size()*sizeof(QRgb))));
+}
+
+/*!
+  If an image for \a key is in the cache, sets \a image to it and returns true. Otherwise returns
+  false and leaves \a image untouched.
+*/
+bool QCPColorGradientCache::findImage(const QByteArray &key, QImage *image)
+{
+  QMutexLocker locker(&mMutex);
+  if (const QImage *cached = mImages.object(key))
+  {
+    *image = *cached;
+    return true;
+  }
+  return false;
+}
+
+/*!
+  Stores \a image in the cache, with the key \a key. Images that are larger than the entire cache
+  are not stored.
+*/
+void QCPColorGradientCache::insertImage(const QByteArray &key, const QImage &image)
+{
+  QMutexLocker locker(&mMutex);
+  mImages.insert(key, new QImage(image), qMax(1, image.bytesPerLine()*image.height()));
+}
+
+/*!
+  Removes all color buffers and images from the cache. Gradients and color scales that currently
+  use them keep their (shared) copies.
+*/
+void QCPColorGradientCache::clear()
+{
+  QMutexLocker locker(&mMutex);
+  mColorBuffers.clear();
+  mImages.clear();
+}
 /* end of 'src/colorgradient.cpp' */
 
 
@@ -16446,6 +19628,8 @@ QCPSelectionDecoratorBracket::~QCPSelectionDecoratorBracket()
 void QCPSelectionDecoratorBracket::setBracketPen(const QPen &pen)
 {
   mBracketPen = pen;
+  if (mPlottable)
+    mPlottable->markLayerDirty();
 }
 
 /*!
@@ -16455,6 +19639,8 @@ void QCPSelectionDecoratorBracket::setBracketPen(const QPen &pen)
 void QCPSelectionDecoratorBracket::setBracketBrush(const QBrush &brush)
 {
   mBracketBrush = brush;
+  if (mPlottable)
+    mPlottable->markLayerDirty();
 }
 
 /*!
@@ -16465,6 +19651,8 @@ void QCPSelectionDecoratorBracket::setBracketBrush(const QBrush &brush)
 void QCPSelectionDecoratorBracket::setBracketWidth(int width)
 {
   mBracketWidth = width;
+  if (mPlottable)
+    mPlottable->markLayerDirty();
 }
 
 /*!
@@ -16475,6 +19663,8 @@ void QCPSelectionDecoratorBracket::setBracketWidth(int width)
 void QCPSelectionDecoratorBracket::setBracketHeight(int height)
 {
   mBracketHeight = height;
+  if (mPlottable)
+    mPlottable->markLayerDirty();
 }
 
 /*!
@@ -16485,6 +19675,8 @@ void QCPSelectionDecoratorBracket::setBracketHeight(int height)
 void QCPSelectionDecoratorBracket::setBracketStyle(QCPSelectionDecoratorBracket::BracketStyle style)
 {
   mBracketStyle = style;
+  if (mPlottable)
+    mPlottable->markLayerDirty();
 }
 
 /*!
@@ -16497,6 +19689,8 @@ void QCPSelectionDecoratorBracket::setBracketStyle(QCPSelectionDecoratorBracket:
 void QCPSelectionDecoratorBracket::setTangentToData(bool enabled)
 {
   mTangentToData = enabled;
+  if (mPlottable)
+    mPlottable->markLayerDirty();
 }
 
 /*!
@@ -16512,6 +19706,8 @@ void QCPSelectionDecoratorBracket::setTangentAverage(int pointCount)
   mTangentAverage = pointCount;
   if (mTangentAverage < 1)
     mTangentAverage = 1;
+  if (mPlottable)
+    mPlottable->markLayerDirty();
 }
 
 /*!
@@ -16826,6 +20022,7 @@ QCPAxisRect::QCPAxisRect(QCustomPlot *parentPlot, bool setupDefaultAxes) :
   mRangeZoom(Qt::Horizontal|Qt::Vertical),
   mRangeZoomFactorHorz(0.85),
   mRangeZoomFactorVert(0.85),
+  mRangeDragFastPan(false),
   mDragging(false)
 {
   mInsetLayout->initializeParentPlot(mParentPlot);
@@ -17262,9 +20459,13 @@ void QCPAxisRect::update(UpdatePhase phase)
   {
     case upPreparation:
     {
+      QElapsedTimer tickTimer;
+      tickTimer.start();
       QList<QCPAxis*> allAxes = axes();
       for (int i=0; i<allAxes.size(); ++i)
         allAxes.at(i)->setupTickVectors();
+      if (mParentPlot->collectsReplotStatistics())
+        mParentPlot->mPendingStatistics.tickTime += tickTimer.nsecsElapsed()/1e6;
       break;
     }
     case upLayout:
@@ -17323,6 +20524,7 @@ void QCPAxisRect::setBackground(const QPixmap &pm)
 {
   mBackgroundPixmap = pm;
   mScaledBackgroundPixmap = QPixmap();
+  markLayerDirty();
 }
 
 /*! \overload
@@ -17341,6 +20543,7 @@ void QCPAxisRect::setBackground(const QPixmap &pm)
 void QCPAxisRect::setBackground(const QBrush &brush)
 {
   mBackgroundBrush = brush;
+  markLayerDirty();
 }
 
 /*! \overload
@@ -17356,6 +20559,7 @@ void QCPAxisRect::setBackground(const QPixmap &pm, bool scaled, Qt::AspectRatioM
   mScaledBackgroundPixmap = QPixmap();
   mBackgroundScaled = scaled;
   mBackgroundScaledMode = mode;
+  markLayerDirty();
 }
 
 /*!
@@ -17371,6 +20575,7 @@ void QCPAxisRect::setBackground(const QPixmap &pm, bool scaled, Qt::AspectRatioM
 void QCPAxisRect::setBackgroundScaled(bool scaled)
 {
   mBackgroundScaled = scaled;
+  markLayerDirty();
 }
 
 /*!
@@ -17381,6 +20586,7 @@ void QCPAxisRect::setBackgroundScaled(bool scaled)
 void QCPAxisRect::setBackgroundScaledMode(Qt::AspectRatioMode mode)
 {
   mBackgroundScaledMode = mode;
+  markLayerDirty();
 }
 
 /*!
@@ -17494,6 +20700,35 @@ void QCPAxisRect::setRangeDrag(Qt::Orientations orientations)
   mRangeDrag = orientations;
 }
 
+/*!
+  Sets whether range dragging uses fast panning. If enabled, replots during a range drag don't
+  redraw the layers that just move with the drag. Instead, their paint buffers are scrolled by the
+  pixel distance the drag axes moved, and only the strips of this axis rect that were newly exposed
+  are drawn. The frame time of a drag step is then roughly proportional to the width of the exposed
+  strips, rather than to the amount of visible data. When the mouse is released, a regular
+  full-quality replot is performed.
+  
+  A paint buffer is only scrolled if all visible layerables drawn into it inside this axis rect just
+  move with the drag: grids, plottables and items (clipped to this axis rect, with positions in plot
+  coordinates and without parent anchors) whose axes in the dragged orientations are range drag
+  axes of this axis rect, and this axis rect's background, if it has neither a background brush nor
+  pixmap. Since the axes, the legend and similar elements don't qualify, they must be on different
+  paint buffers than the content that shall be panned. For example, set the mode of the "main"
+  layer to \ref QCPLayer::lmBuffered, so the graphs get their own paint buffer, or use separate
+  buffered layers for the grid and the graphs. Buffers that don't qualify are redrawn as usual.
+  
+  Fast panning requires all range drag axes to be linear (\ref QCPAxis::stLinear) and a paint
+  buffer backend that supports scrolling (\ref QCPAbstractPaintBuffer::scroll), i.e. it isn't used
+  when OpenGL is enabled. Whenever one of the requirements isn't met in a drag step, that replot
+  falls back to the regular redraw.
+  
+  \see setRangeDrag, QCustomPlot::setNoAntialiasingOnDrag
+*/
+void QCPAxisRect::setRangeDragFastPan(bool enabled)
+{
+  mRangeDragFastPan = enabled;
+}
+
 /*!
   Sets which axis orientation may be zoomed by the user with the mouse wheel. What orientation
   corresponds to which specific axis can be set with \ref setRangeZoomAxes(QCPAxis *horizontal,
@@ -17724,6 +20959,26 @@ void QCPAxisRect::drawBackground(QCPPainter *painter)
   }
 }
 
+/*! \internal
+  
+  Determines whether all pixel distances in \a shifts, by which the content of the range drag axes
+  moved during a fast pan step, are the same whole number of pixels. If so, returns true and sets
+  \a shift to that number (zero if \a shifts is empty). Otherwise the buffer content can't be
+  scrolled to match the new ranges, and false is returned.
+  
+  \see setRangeDragFastPan
+*/
+bool QCPAxisRect::uniformPixelShift(const QVector<double> &shifts, int &shift) const
+{
+  shift = shifts.isEmpty() ? 0 : qRound(shifts.first());
+  for (int i=0; i<shifts.size(); ++i)
+  {
+    if (qAbs(shifts.at(i)-shift) > 0.01) // tolerance for rounding errors of the range arithmetic
+      return false;
+  }
+  return true;
+}
+
 /*! \internal
   
   This function makes sure multiple axes on the side specified with \a type don't collide, but are
@@ -17844,6 +21099,9 @@ void QCPAxisRect::mouseMoveEvent(QMouseEvent *event, const QPointF &startPos)
   // Mouse range dragging interaction:
   if (mDragging && mParentPlot->interactions().testFlag(QCP::iRangeDrag))
   {
+    // for fast panning, record by how many pixels the content of each drag axis moves:
+    bool fastPan = mRangeDragFastPan && mRangeDrag != 0 && mParentPlot->beginFastPanStep(this);
+    QVector<double> horzShifts, vertShifts;
     
     if (mRangeDrag.testFlag(Qt::Horizontal))
     {
@@ -17856,12 +21114,16 @@ void QCPAxisRect::mouseMoveEvent(QMouseEvent *event, const QPointF &startPos)
           break;
         if (ax->mScaleType == QCPAxis::stLinear)
         {
+          const double oldLower = ax->range().lower;
+          const double oldPixel = ax->coordToPixel(oldLower);
           double diff = ax->pixelToCoord(startPos.x()) - ax->pixelToCoord(event->pos().x());
           ax->setRange(mDragStartHorzRange.at(i).lower+diff, mDragStartHorzRange.at(i).upper+diff);
+          horzShifts.append(ax->coordToPixel(oldLower)-oldPixel);
         } else if (ax->mScaleType == QCPAxis::stLogarithmic)
         {
           double diff = ax->pixelToCoord(startPos.x()) / ax->pixelToCoord(event->pos().x());
           ax->setRange(mDragStartHorzRange.at(i).lower*diff, mDragStartHorzRange.at(i).upper*diff);
+          fastPan = false; // logarithmic axes don't shift their content uniformly
         }
       }
     }
@@ -17877,20 +21139,34 @@ void QCPAxisRect::mouseMoveEvent(QMouseEvent *event, const QPointF &startPos)
           break;
         if (ax->mScaleType == QCPAxis::stLinear)
         {
+          const double oldLower = ax->range().lower;
+          const double oldPixel = ax->coordToPixel(oldLower);
           double diff = ax->pixelToCoord(startPos.y()) - ax->pixelToCoord(event->pos().y());
           ax->setRange(mDragStartVertRange.at(i).lower+diff, mDragStartVertRange.at(i).upper+diff);
+          vertShifts.append(ax->coordToPixel(oldLower)-oldPixel);
         } else if (ax->mScaleType == QCPAxis::stLogarithmic)
         {
           double diff = ax->pixelToCoord(startPos.y()) / ax->pixelToCoord(event->pos().y());
           ax->setRange(mDragStartVertRange.at(i).lower*diff, mDragStartVertRange.at(i).upper*diff);
+          fastPan = false; // logarithmic axes don't shift their content uniformly
         }
       }
     }
     
+    if (mRangeDragFastPan && mRangeDrag != 0)
+    {
+      int horzShift, vertShift;
+      if (fastPan && uniformPixelShift(horzShifts, horzShift) && uniformPixelShift(vertShifts, vertShift))
+        mParentPlot->addFastPanStep(this, QPoint(horzShift, vertShift));
+      else
+        mParentPlot->cancelFastPan();
+    }
+    
     if (mRangeDrag != 0) // if either vertical or horizontal drag was enabled, do a replot
     {
       if (mParentPlot->noAntialiasingOnDrag())
         mParentPlot->setNotAntialiasedElements(QCP::aeAll);
+      mParentPlot->notifyInteraction();
       mParentPlot->replot(QCustomPlot::rpQueuedReplot);
     }
     
@@ -17902,6 +21178,13 @@ void QCPAxisRect::mouseReleaseEvent(QMouseEvent *event, const QPointF &startPos)
 {
   Q_UNUSED(event)
   Q_UNUSED(startPos)
+  if (mDragging && mRangeDragFastPan && mParentPlot->interactions().testFlag(QCP::iRangeDrag))
+  {
+    // replace the scrolled buffer contents by a full-quality replot:
+    mParentPlot->cancelFastPan();
+    mParentPlot->markAllLayersDirty();
+    mParentPlot->replot(QCustomPlot::rpQueuedReplot);
+  }
   mDragging = false;
   if (mParentPlot->noAntialiasingOnDrag())
   {
@@ -17951,6 +21234,7 @@ void QCPAxisRect::wheelEvent(QWheelEvent *event)
             mRangeZoomVertAxis.at(i)->scaleRange(factor, mRangeZoomVertAxis.at(i)->pixelToCoord(event->pos().y()));
         }
       }
+      mParentPlot->notifyInteraction();
       mParentPlot->replot();
     }
   }
@@ -18025,6 +21309,7 @@ QCPAbstractLegendItem::QCPAbstractLegendItem(QCPLegend *parent) :
 void QCPAbstractLegendItem::setFont(const QFont &font)
 {
   mFont = font;
+  markLayerDirty();
 }
 
 /*!
@@ -18035,6 +21320,7 @@ void QCPAbstractLegendItem::setFont(const QFont &font)
 void QCPAbstractLegendItem::setTextColor(const QColor &color)
 {
   mTextColor = color;
+  markLayerDirty();
 }
 
 /*!
@@ -18046,6 +21332,7 @@ void QCPAbstractLegendItem::setTextColor(const QColor &color)
 void QCPAbstractLegendItem::setSelectedFont(const QFont &font)
 {
   mSelectedFont = font;
+  markLayerDirty();
 }
 
 /*!
@@ -18057,6 +21344,7 @@ void QCPAbstractLegendItem::setSelectedFont(const QFont &font)
 void QCPAbstractLegendItem::setSelectedTextColor(const QColor &color)
 {
   mSelectedTextColor = color;
+  markLayerDirty();
 }
 
 /*!
@@ -18087,6 +21375,7 @@ void QCPAbstractLegendItem::setSelected(bool selected)
   {
     mSelected = selected;
     emit selectionChanged(mSelected);
+    markLayerDirty();
   }
 }
 
@@ -18184,6 +21473,17 @@ QCPPlottableLegendItem::QCPPlottableLegendItem(QCPLegend *parent, QCPAbstractPlo
   setAntialiased(false);
 }
 
+/*!
+  Additionally takes the plottable into account, because its name, pen, brush and (for some
+  plottables like \ref QCPColorMap) its data determine the appearance of this legend item.
+  
+  \seebaseclassmethod
+*/
+quint64 QCPPlottableLegendItem::contentRevision() const
+{
+  return QCPAbstractLegendItem::contentRevision() + mPlottable->contentRevision();
+}
+
 /*! \internal
   
   Returns the pen that shall be used to draw the icon border, taking into account the selection
@@ -18382,6 +21682,7 @@ QCPLegend::SelectableParts QCPLegend::selectedParts() const
 void QCPLegend::setBorderPen(const QPen &pen)
 {
   mBorderPen = pen;
+  markLayerDirty();
 }
 
 /*!
@@ -18390,6 +21691,7 @@ void QCPLegend::setBorderPen(const QPen &pen)
 void QCPLegend::setBrush(const QBrush &brush)
 {
   mBrush = brush;
+  markLayerDirty();
 }
 
 /*!
@@ -18409,6 +21711,7 @@ void QCPLegend::setFont(const QFont &font)
     if (item(i))
       item(i)->setFont(mFont);
   }
+  markLayerDirty();
 }
 
 /*!
@@ -18428,6 +21731,7 @@ void QCPLegend::setTextColor(const QColor &color)
     if (item(i))
       item(i)->setTextColor(color);
   }
+  markLayerDirty();
 }
 
 /*!
@@ -18437,6 +21741,7 @@ void QCPLegend::setTextColor(const QColor &color)
 void QCPLegend::setIconSize(const QSize &size)
 {
   mIconSize = size;
+  markLayerDirty();
 }
 
 /*! \overload
@@ -18445,6 +21750,7 @@ void QCPLegend::setIconSize(int width, int height)
 {
   mIconSize.setWidth(width);
   mIconSize.setHeight(height);
+  markLayerDirty();
 }
 
 /*!
@@ -18455,6 +21761,7 @@ void QCPLegend::setIconSize(int width, int height)
 void QCPLegend::setIconTextPadding(int padding)
 {
   mIconTextPadding = padding;
+  markLayerDirty();
 }
 
 /*!
@@ -18466,6 +21773,7 @@ void QCPLegend::setIconTextPadding(int padding)
 void QCPLegend::setIconBorderPen(const QPen &pen)
 {
   mIconBorderPen = pen;
+  markLayerDirty();
 }
 
 /*!
@@ -18531,6 +21839,7 @@ void QCPLegend::setSelectedParts(const SelectableParts &selected)
     mSelectedParts = newSelected;
     emit selectionChanged(mSelectedParts);
   }
+  markLayerDirty();
 }
 
 /*!
@@ -18542,6 +21851,7 @@ void QCPLegend::setSelectedParts(const SelectableParts &selected)
 void QCPLegend::setSelectedBorderPen(const QPen &pen)
 {
   mSelectedBorderPen = pen;
+  markLayerDirty();
 }
 
 /*!
@@ -18552,6 +21862,7 @@ void QCPLegend::setSelectedBorderPen(const QPen &pen)
 void QCPLegend::setSelectedIconBorderPen(const QPen &pen)
 {
   mSelectedIconBorderPen = pen;
+  markLayerDirty();
 }
 
 /*!
@@ -18563,6 +21874,7 @@ void QCPLegend::setSelectedIconBorderPen(const QPen &pen)
 void QCPLegend::setSelectedBrush(const QBrush &brush)
 {
   mSelectedBrush = brush;
+  markLayerDirty();
 }
 
 /*!
@@ -18580,6 +21892,7 @@ void QCPLegend::setSelectedFont(const QFont &font)
     if (item(i))
       item(i)->setSelectedFont(font);
   }
+  markLayerDirty();
 }
 
 /*!
@@ -18597,6 +21910,7 @@ void QCPLegend::setSelectedTextColor(const QColor &color)
     if (item(i))
       item(i)->setSelectedTextColor(color);
   }
+  markLayerDirty();
 }
 
 /*!
@@ -19041,6 +22355,7 @@ QCPTextElement::QCPTextElement(QCustomPlot *parentPlot, const QString &text, con
 void QCPTextElement::setText(const QString &text)
 {
   mText = text;
+  markLayerDirty();
 }
 
 /*!
@@ -19066,6 +22381,7 @@ void QCPTextElement::setText(const QString &text)
 void QCPTextElement::setTextFlags(int flags)
 {
   mTextFlags = flags;
+  markLayerDirty();
 }
 
 /*!
@@ -19076,6 +22392,7 @@ void QCPTextElement::setTextFlags(int flags)
 void QCPTextElement::setFont(const QFont &font)
 {
   mFont = font;
+  markLayerDirty();
 }
 
 /*!
@@ -19086,6 +22403,7 @@ void QCPTextElement::setFont(const QFont &font)
 void QCPTextElement::setTextColor(const QColor &color)
 {
   mTextColor = color;
+  markLayerDirty();
 }
 
 /*!
@@ -19096,6 +22414,7 @@ void QCPTextElement::setTextColor(const QColor &color)
 void QCPTextElement::setSelectedFont(const QFont &font)
 {
   mSelectedFont = font;
+  markLayerDirty();
 }
 
 /*!
@@ -19106,6 +22425,7 @@ void QCPTextElement::setSelectedFont(const QFont &font)
 void QCPTextElement::setSelectedTextColor(const QColor &color)
 {
   mSelectedTextColor = color;
+  markLayerDirty();
 }
 
 /*!
@@ -19136,6 +22456,7 @@ void QCPTextElement::setSelected(bool selected)
   {
     mSelected = selected;
     emit selectionChanged(mSelected);
+    markLayerDirty();
   }
 }
 
@@ -19542,7 +22863,10 @@ void QCPColorScale::setGradient(const QCPColorGradient &gradient)
   {
     mGradient = gradient;
     if (mAxisRect)
+    {
       mAxisRect.data()->mGradientImageInvalidated = true;
+      mAxisRect.data()->markLayerDirty();
+    }
     emit gradientChanged(mGradient);
   }
 }
@@ -19647,8 +22971,8 @@ void QCPColorScale::rescaleDataRange(bool onlyVisibleMaps)
     QCPRange mapRange;
     if (maps.at(i)->colorScale() == this)
     {
-      bool currentFoundRange = true;
       mapRange = maps.at(i)->data()->dataBounds();
+      bool currentFoundRange = !(mapRange.lower > mapRange.upper); // empty if all cells are ignored NaNs
       if (sign == QCP::sdPositive)
       {
         if (mapRange.lower <= 0 && mapRange.upper > 0)
@@ -19856,12 +23180,26 @@ void QCPColorScaleAxisRectPrivate::draw(QCPPainter *painter)
 
   Uses the current gradient of the parent \ref QCPColorScale (specified in the constructor) to
   generate a gradient image. This gradient image will be used in the \ref draw method.
+  
+  The image only depends on the gradient and the thickness of the color scale, so it is taken from
+  the \ref QCPColorGradientCache if another color scale already generated it.
 */
 void QCPColorScaleAxisRectPrivate::updateGradientImage()
 {
   if (rect().isEmpty())
     return;
   
+  // color scales with the same gradient and thickness share their gradient image:
+  const bool horizontal = mParentColorScale->mType == QCPAxis::atBottom || mParentColorScale->mType == QCPAxis::atTop;
+  QByteArray key = mParentColorScale->mGradient.cacheKey();
+  key += horizontal ? "/scale/h" : "/scale/v";
+  key += QByteArray::number(horizontal ? rect().height() : rect().width());
+  if (QCPColorGradientCache::instance()->findImage(key, &mGradientImage))
+  {
+    mGradientImageInvalidated = false;
+    return;
+  }
+  
   const QImage::Format format = QImage::Format_ARGB32_Premultiplied;
   int n = mParentColorScale->mGradient.levelCount();
   int w, h;
@@ -19892,6 +23230,7 @@ void QCPColorScaleAxisRectPrivate::updateGradientImage()
         pixels[x] = lineColor;
     }
   }
+  QCPColorGradientCache::instance()->insertImage(key, mGradientImage);
   mGradientImageInvalidated = false;
 }
 
@@ -20078,6 +23417,13 @@ QCPGraphData::QCPGraphData(double key, double value) :
   By default, a normal fill towards the zero-value-line will be drawn. To set up a channel fill
   between this graph and another one, call \ref setChannelFillGraph with the other graph as
   parameter.
+  
+  \section qcpgraph-progressive Huge data sets
+  
+  For graphs with hundreds of millions of data points, even the adaptive sampling of the visible
+  data can block the GUI thread for a noticeable time during each replot. With \ref
+  setProgressiveThreshold, such graphs first draw a coarse preview and reduce the data in the
+  background, then replot with the refined result.
 
   \see QCustomPlot::addGraph, QCustomPlot::graph
 */
@@ -20091,7 +23437,354 @@ QCPGraphData::QCPGraphData(double key, double value) :
   regular \ref setData or \ref addData methods.
 */
 
+/*! \fn bool QCPGraph::isRefining() const
+  
+  Returns whether the background refinement of progressive drawing is currently running.
+  
+  \see setProgressiveThreshold
+*/
+
 /* end of documentation of inline functions */
+/* start of documentation of signals */
+
+/*! \fn void QCPGraph::refinementProgress(double progress)
+  
+  This signal is emitted while the background refinement of progressive drawing runs, with \a
+  progress between 0 (just started) and 1 (finished, the refined data is drawn by the queued replot
+  that follows).
+  
+  \see setProgressiveThreshold
+*/
+
+/* end of documentation of signals */
+
+/*! \internal
+  
+  Holds the input and the results of a background refinement of a \ref QCPGraph, see \ref
+  QCPGraph::setProgressiveThreshold.
+  
+  The data within each of the data index ranges \a mLineRanges is reduced to the first, last,
+  minimum and maximum value per pixel column (the column boundaries are given as ascending keys in
+  \a mColumns). The data within \a mScatterRanges is reduced to one data point per pixel column and
+  pixel row (see \ref valueRow). Since the refinement works on a \ref QCPDataSnapshot and only
+  needs these boundaries, no axis or other object of the GUI thread is accessed. The snapshot is
+  typically incomplete (see \ref QCPDataContainer::deferredSnapshot), so copying the modified data
+  happens in \ref run, too.
+  
+  If \a mPrevious is set to a finished refinement that this one \ref extends, the pixel columns
+  whose data is unchanged since \a mPrevious (e.g. all but the last columns when data was appended)
+  take over its results instead of reducing the data again.
+  
+  The graph that started the refinement is notified of progress and completion by a queued call of
+  \ref QCPGraph::refinementUpdated, until \ref cancel is called.
+*/
+class QCPGraphRefinement
+{
+public:
+  QCPGraphRefinement() :
+    mContainer(0),
+    mRevision(0),
+    mValueLower(0),
+    mValueUpper(0),
+    mValueLogarithmic(false),
+    mRowCount(0),
+    mTarget(0),
+    mTotal(1)
+  {}
+  
+  bool matches(const QCPGraphRefinement &other) const
+  {
+    return mContainer == other.mContainer && mRevision == other.mRevision && mColumns == other.mColumns &&
+        mValueLower == other.mValueLower && mValueUpper == other.mValueUpper && mValueLogarithmic == other.mValueLogarithmic &&
+        mRowCount == other.mRowCount && mLineRanges == other.mLineRanges && mScatterRanges == other.mScatterRanges;
+  }
+  
+  /*
+    Returns whether this refinement is a later state of \a other, i.e. it has the same pixel columns
+    and rows and its data ranges start at the same indices, but may differ in the data and where the
+    ranges end (as is the case when data was appended).
+  */
+  bool extends(const QCPGraphRefinement &other) const
+  {
+    if (mContainer != other.mContainer || mColumns != other.mColumns || mValueLower != other.mValueLower || mValueUpper != other.mValueUpper ||
+        mValueLogarithmic != other.mValueLogarithmic || mRowCount != other.mRowCount ||
+        mLineRanges.size() != other.mLineRanges.size() || mScatterRanges.size() != other.mScatterRanges.size())
+      return false;
+    for (int i=0; i<mLineRanges.size(); ++i)
+    {
+      if (mLineRanges.at(i).begin() != other.mLineRanges.at(i).begin())
+        return false;
+    }
+    for (int i=0; i<mScatterRanges.size(); ++i)
+    {
+      if (mScatterRanges.at(i).begin() != other.mScatterRanges.at(i).begin())
+        return false;
+    }
+    return true;
+  }
+  
+  bool isCancelled() const { return mCancelled.loadAcquire() != 0; }
+  bool isFinished() const { return mFinished.loadAcquire() != 0; }
+  
+  /*
+    Returns the number of bytes allocated for the pixel columns and the results, not including the
+    snapshot (see \ref QCPDataContainer::snapshotMemoryUsage). Must only be called before the
+    refinement is started or after it is finished.
+  */
+  qint64 memoryUsage() const
+  {
+    qint64 result = qint64(mColumns.capacity())*sizeof(double);
+    for (int i=0; i<mLines.size(); ++i)
+      result += qint64(mLines.at(i).capacity())*sizeof(QCPGraphData);
+    for (int i=0; i<mScatters.size(); ++i)
+      result += qint64(mScatters.at(i).capacity())*sizeof(QCPGraphData);
+    for (int i=0; i<mColumnBegins.size(); ++i)
+      result += qint64(mColumnBegins.at(i).capacity()+mResultOffsets.at(i).capacity())*sizeof(int);
+    return result;
+  }
+  double progress() const { return qMin(1.0, mProcessed.loadAcquire()/(double)mTotal); }
+  
+  /*
+    Returns the pixel row of \a value, or -1 if it is outside the value range (or NaN).
+  */
+  int valueRow(double value) const
+  {
+    double row;
+    if (mValueLogarithmic)
+      row = value/mValueLower > 0 ? qLn(value/mValueLower)/qLn(mValueUpper/mValueLower)*mRowCount : -1;
+    else
+      row = (value-mValueLower)/(mValueUpper-mValueLower)*mRowCount;
+    return row >= 0 && row < mRowCount ? int(row) : -1;
+  }
+  
+  void start(QCPGraph *target)
+  {
+    mTarget = target;
+    mTotal = qMax(1, (mLineRanges.size()+mScatterRanges.size())*(mColumns.size()-1));
+  }
+  
+  void cancel()
+  {
+    mCancelled.storeRelease(1);
+    QMutexLocker locker(&mTargetMutex);
+    mTarget = 0;
+  }
+  
+  void addProgress(int columns)
+  {
+    const int percent = int(qint64(mProcessed.fetchAndAddOrdered(columns)+columns)*100/mTotal);
+    const int reported = mReportedPercent.loadAcquire();
+    if (percent > reported && mReportedPercent.testAndSetOrdered(reported, percent))
+      notifyTarget();
+  }
+  
+  void notifyTarget()
+  {
+    QMutexLocker locker(&mTargetMutex);
+    if (mTarget)
+      QMetaObject::invokeMethod(mTarget, "refinementUpdated", Qt::QueuedConnection);
+  }
+  
+  void run();
+  
+  // input:
+  const QCPGraphDataContainer *mContainer;
+  quint64 mRevision;
+  QCPDataSnapshot<QCPGraphData> mSnapshot;
+  QVector<double> mColumns;
+  double mValueLower, mValueUpper;
+  bool mValueLogarithmic;
+  int mRowCount;
+  QVector<QCPDataRange> mLineRanges, mScatterRanges;
+  QSharedPointer<QCPGraphRefinement> mPrevious;
+  
+  // results:
+  QVector<QVector<QCPGraphData> > mLines, mScatters;
+  QVector<QVector<int> > mColumnBegins, mResultOffsets; // per line range, then per scatter range: data index and result index of each column
+  
+private:
+  QMutex mTargetMutex;
+  QCPGraph *mTarget;
+  int mTotal;
+  QAtomicInt mCancelled, mFinished, mProcessed, mReportedPercent;
+  
+  Q_DISABLE_COPY(QCPGraphRefinement)
+};
+
+/*! \internal
+  
+  Reduces the data of the pixel columns [\a firstColumn+begin, \a firstColumn+end) as part of \ref
+  QCPGraphRefinement::run. The data index range of column i is given by [\a columnBegins[i], \a
+  columnBegins[i+1]), the reduced data of each column is stored in \a results[i]. Instances are
+  passed to \ref qcpParallelFor, so the columns are processed concurrently.
+*/
+class QCPGraphRefinementFunctor
+{
+public:
+  QCPGraphRefinementFunctor(QCPGraphRefinement *refinement, const QVector<int> &columnBegins, int firstColumn, bool scatters, QVector<QCPGraphData> *results) :
+    mRefinement(refinement), mColumnBegins(columnBegins), mFirstColumn(firstColumn), mScatters(scatters), mResults(results)
+  {}
+  
+  void operator()(int begin, int end) const
+  {
+    const QCPDataSnapshot<QCPGraphData> &data = mRefinement->mSnapshot;
+    QVector<int> rowColumns(mScatters ? mRefinement->mRowCount : 0, -1); // the last column that had a scatter in each pixel row
+    for (int column=mFirstColumn+begin; column<mFirstColumn+end; ++column)
+    {
+      const int dataBegin = mColumnBegins.at(column);
+      const int dataEnd = mColumnBegins.at(column+1);
+      if (dataBegin == dataEnd)
+        continue;
+      QVector<QCPGraphData> &result = mResults[column];
+      if (mScatters)
+      {
+        for (int i=dataBegin; i<dataEnd; ++i)
+        {
+          if ((i & 0xFFFF) == 0 && mRefinement->isCancelled())
+            return;
+          const int row = mRefinement->valueRow(data.at(i).value);
+          if (row >= 0 && rowColumns.at(row) != column)
+          {
+            rowColumns[row] = column;
+            result.append(data.at(i));
+          }
+        }
+      } else
+      {
+        // keep first and last data point, the extrema and the first NaN (so gaps stay visible), in their original order:
+        int minIndex = -1, maxIndex = -1, nanIndex = -1;
+        for (int i=dataBegin; i<dataEnd; ++i)
+        {
+          if ((i & 0xFFFF) == 0 && mRefinement->isCancelled())
+            return;
+          const double value = data.at(i).value;
+          if (qIsNaN(value))
+          {
+            if (nanIndex < 0)
+              nanIndex = i;
+          } else if (minIndex < 0)
+          {
+            minIndex = i;
+            maxIndex = i;
+          } else if (value < data.at(minIndex).value)
+            minIndex = i;
+          else if (value > data.at(maxIndex).value)
+            maxIndex = i;
+        }
+        int indices[] = {dataBegin, minIndex, maxIndex, nanIndex, dataEnd-1};
+        std::sort(indices, indices+5);
+        for (int k=0; k<5; ++k)
+        {
+          if (indices[k] >= 0 && (k == 0 || indices[k] != indices[k-1]))
+            result.append(data.at(indices[k]));
+        }
+      }
+    }
+    mRefinement->addProgress(end-begin);
+  }
+  
+private:
+  QCPGraphRefinement *mRefinement;
+  const QVector<int> &mColumnBegins;
+  int mFirstColumn;
+  bool mScatters;
+  QVector<QCPGraphData> *mResults;
+};
+
+/*! \internal
+  
+  Reduces the data of all line and scatter ranges, see \ref QCPGraphRefinement. This is called on
+  a thread of QThreadPool::globalInstance, and returns early when the refinement is cancelled.
+  
+  The snapshot is kept after the refinement finished, so the container can take over the chunks
+  copied here (see \ref QCPDataContainer::deferredSnapshot) and a later refinement can compare its
+  data to it.
+*/
+void QCPGraphRefinement::run()
+{
+  if (isCancelled())
+  {
+    mPrevious.clear();
+    return;
+  }
+  mSnapshot.complete();
+  // the leading data points that are unchanged since the previous refinement, their columns can take over its results:
+  const int stableCount = mPrevious ? mSnapshot.sharedPrefixSize(mPrevious->mSnapshot) : 0;
+  
+  const int columnCount = mColumns.size()-1;
+  const int rangeCount = mLineRanges.size()+mScatterRanges.size();
+  mLines.resize(mLineRanges.size());
+  mScatters.resize(mScatterRanges.size());
+  mColumnBegins.resize(rangeCount);
+  mResultOffsets.resize(rangeCount);
+  for (int r=0; r<rangeCount; ++r)
+  {
+    if (isCancelled())
+    {
+      mPrevious.clear();
+      return;
+    }
+    const bool scatters = r >= mLineRanges.size();
+    const QCPDataRange range = scatters ? mScatterRanges.at(r-mLineRanges.size()) : mLineRanges.at(r);
+    // find the data index ranges of the pixel columns, data beyond the outer column boundaries is added to the outer columns:
+    QVector<int> &columnBegins = mColumnBegins[r];
+    columnBegins.resize(columnCount+1);
+    columnBegins[0] = range.begin();
+    columnBegins[columnCount] = range.end();
+    for (int i=1; i<columnCount; ++i)
+      columnBegins[i] = qBound(range.begin(), mSnapshot.findBegin(mColumns.at(i), false), range.end());
+    
+    QVector<QCPGraphData> &result = scatters ? mScatters[r-mLineRanges.size()] : mLines[r];
+    QVector<int> &resultOffsets = mResultOffsets[r];
+    resultOffsets.resize(columnCount+1);
+    resultOffsets[0] = 0;
+    // take over the results of the leading columns whose data is unchanged:
+    int reusedColumns = 0;
+    if (stableCount > 0)
+    {
+      const QVector<int> &previousBegins = mPrevious->mColumnBegins.at(r);
+      const QVector<int> &previousOffsets = mPrevious->mResultOffsets.at(r);
+      while (reusedColumns < columnCount && columnBegins.at(reusedColumns+1) <= stableCount &&
+             columnBegins.at(reusedColumns) == previousBegins.at(reusedColumns) && columnBegins.at(reusedColumns+1) == previousBegins.at(reusedColumns+1))
+      {
+        resultOffsets[reusedColumns+1] = previousOffsets.at(reusedColumns+1);
+        ++reusedColumns;
+      }
+      const QVector<QCPGraphData> &previousResult = scatters ? mPrevious->mScatters.at(r-mLineRanges.size()) : mPrevious->mLines.at(r);
+      result = previousResult.mid(0, resultOffsets.at(reusedColumns));
+      if (reusedColumns > 0)
+        addProgress(reusedColumns);
+    }
+    
+    QVector<QVector<QCPGraphData> > columnResults(columnCount);
+    qcpParallelFor(columnCount-reusedColumns, 64, QCPGraphRefinementFunctor(this, columnBegins, reusedColumns, scatters, columnResults.data()));
+    for (int i=reusedColumns; i<columnCount; ++i)
+    {
+      result << columnResults.at(i);
+      resultOffsets[i+1] = result.size();
+    }
+  }
+  mPrevious.clear(); // the results were taken over, don't keep a chain of refinements alive
+  if (isCancelled())
+    return;
+  mFinished.storeRelease(1);
+  notifyTarget();
+}
+
+/*! \internal
+  
+  The runnable that is handed to QThreadPool::globalInstance to execute a \ref QCPGraphRefinement.
+  It shares ownership of the refinement, so a cancelled refinement stays valid until it returns.
+*/
+class QCPGraphRefinementRunnable : public QRunnable
+{
+public:
+  explicit QCPGraphRefinementRunnable(const QSharedPointer<QCPGraphRefinement> &refinement) : mRefinement(refinement) {}
+  virtual void run() Q_DECL_OVERRIDE { mRefinement->run(); }
+  
+private:
+  QSharedPointer<QCPGraphRefinement> mRefinement;
+};
 
 /*!
   Constructs a graph which uses \a keyAxis as its key axis ("x") and \a valueAxis as its value
@@ -20118,10 +23811,12 @@ QCPGraph::QCPGraph(QCPAxis *keyAxis, QCPAxis *valueAxis) :
   setScatterSkip(0);
   setChannelFillGraph(0);
   setAdaptiveSampling(true);
+  setProgressiveThreshold(0);
 }
 
 QCPGraph::~QCPGraph()
 {
+  cancelRefinement();
 }
 
 /*! \overload
@@ -20142,6 +23837,7 @@ QCPGraph::~QCPGraph()
 void QCPGraph::setData(QSharedPointer<QCPGraphDataContainer> data)
 {
   mDataContainer = data;
+  markLayerDirty();
 }
 
 /*! \overload
@@ -20159,6 +23855,7 @@ void QCPGraph::setData(const QVector<double> &keys, const QVector<double> &value
 {
   mDataContainer->clear();
   addData(keys, values, alreadySorted);
+  markLayerDirty();
 }
 
 /*!
@@ -20170,6 +23867,7 @@ void QCPGraph::setData(const QVector<double> &keys, const QVector<double> &value
 void QCPGraph::setLineStyle(LineStyle ls)
 {
   mLineStyle = ls;
+  markLayerDirty();
 }
 
 /*!
@@ -20181,6 +23879,7 @@ void QCPGraph::setLineStyle(LineStyle ls)
 void QCPGraph::setScatterStyle(const QCPScatterStyle &style)
 {
   mScatterStyle = style;
+  markLayerDirty();
 }
 
 /*!
@@ -20197,6 +23896,7 @@ void QCPGraph::setScatterStyle(const QCPScatterStyle &style)
 void QCPGraph::setScatterSkip(int skip)
 {
   mScatterSkip = qMax(0, skip);
+  markLayerDirty();
 }
 
 /*!
@@ -20210,6 +23910,7 @@ void QCPGraph::setScatterSkip(int skip)
 */
 void QCPGraph::setChannelFillGraph(QCPGraph *targetGraph)
 {
+  markLayerDirty();
   // prevent setting channel target to this graph itself:
   if (targetGraph == this)
   {
@@ -20262,6 +23963,41 @@ void QCPGraph::setChannelFillGraph(QCPGraph *targetGraph)
 void QCPGraph::setAdaptiveSampling(bool enabled)
 {
   mAdaptiveSampling = enabled;
+  markLayerDirty();
+}
+
+/*!
+  Enables progressive drawing for this graph, if the number of data points in the visible key
+  range exceeds \a dataCount. Set \a dataCount to 0 (the default) to always draw synchronously.
+  
+  With progressive drawing, the graph doesn't reduce its visible data during the replot, which may
+  take seconds for hundreds of millions of points. Instead, a coarse preview that only uses every
+  n-th visible data point is drawn immediately, while the data is reduced to what is visible at
+  the pixel resolution of the axis rect in the background, on the threads of
+  QThreadPool::globalInstance. Once this refinement is complete, the graph's layer is redrawn with
+  the refined data by a queued replot. This is indicated by the \ref refinementProgress signal,
+  which also reports the intermediate progress.
+  
+  The refinement works on a snapshot of the data (see \ref QCPDataContainer::snapshot), so the data
+  may be modified and the plot replotted while it runs. A replot with different axis ranges, axis
+  rect size, data or selection starts a new refinement, and cancels the one that has become stale.
+  The refined data is kept, so replots that don't change any of these (e.g. because other layers
+  changed) draw it directly. Exports like \ref QCustomPlot::savePng always draw synchronously.
+  
+  The refined data is independent of \ref setAdaptiveSampling: Lines keep the first, last,
+  minimum and maximum value of each pixel column, scatters keep one data point per pixel.
+  
+  \see cancelRefinement, isRefining
+*/
+void QCPGraph::setProgressiveThreshold(int dataCount)
+{
+  mProgressiveThreshold = qMax(0, dataCount);
+  if (mProgressiveThreshold == 0)
+  {
+    cancelRefinement();
+    mRefined.clear();
+  }
+  markLayerDirty();
 }
 
 /*! \overload
@@ -20307,6 +24043,35 @@ void QCPGraph::addData(double key, double value)
   mDataContainer->add(QCPGraphData(key, value));
 }
 
+/*!
+  Cancels the background refinement of progressive drawing, if one is running. The graph keeps
+  drawing the coarse preview until the next replot starts a new refinement.
+  
+  \see setProgressiveThreshold, isRefining
+*/
+void QCPGraph::cancelRefinement()
+{
+  if (mRefinement)
+  {
+    mRefinement->cancel();
+    mRefinement.clear();
+  }
+}
+
+/*!
+  Additionally takes the data of the channel fill graph (\ref setChannelFillGraph) into account,
+  because the fill changes with it.
+  
+  \seebaseclassmethod
+*/
+quint64 QCPGraph::contentRevision() const
+{
+  quint64 result = QCPAbstractPlottable1D<QCPGraphData>::contentRevision();
+  if (mChannelFillGraph)
+    result += mChannelFillGraph.data()->contentRevision();
+  return result;
+}
+
 /*!
   Implements a selectTest specific to this plottable's point geometry.
 
@@ -20348,6 +24113,93 @@ QCPRange QCPGraph::getValueRange(bool &foundRange, QCP::SignDomain inSignDomain,
   return mDataContainer->valueRange(foundRange, inSignDomain, inKeyRange);
 }
 
+/*!
+  Additionally accounts for the finished refinements of progressive drawing (see \ref
+  setProgressiveThreshold): their results and the chunks of their data snapshots that the data
+  container doesn't share. Both are reclaimable, see \ref releaseMemory. The data that a running
+  refinement copies is accounted for by the data container (\ref QCPDataContainer::memoryUsage).
+  
+  \seebaseclassmethod
+*/
+qint64 QCPGraph::memoryUsage(qint64 *reclaimableBytes) const
+{
+  qint64 result = QCPAbstractPlottable1D<QCPGraphData>::memoryUsage(reclaimableBytes);
+  qint64 refinementBytes = 0;
+  if (mRefined)
+    refinementBytes += mRefined->memoryUsage() + mDataContainer->snapshotMemoryUsage(mRefined->mSnapshot);
+  if (mRefinement && mRefinement->isFinished()) // finished, but not taken over by refinementUpdated yet
+    refinementBytes += mRefinement->memoryUsage() + mDataContainer->snapshotMemoryUsage(mRefinement->mSnapshot);
+  if (reclaimableBytes)
+    *reclaimableBytes += refinementBytes;
+  return result + refinementBytes;
+}
+
+/*!
+  Additionally cancels the running refinement of progressive drawing and discards the refined data
+  (see \ref setProgressiveThreshold). The next replot draws the coarse preview and refines the data
+  again.
+  
+  \seebaseclassmethod
+*/
+void QCPGraph::releaseMemory()
+{
+  cancelRefinement();
+  mRefined.clear();
+  QCPAbstractPlottable1D<QCPGraphData>::releaseMemory();
+}
+
+/*! \internal
+  
+  Starts the background refinement of progressive drawing (see \ref setProgressiveThreshold) for
+  the current view and data, unless the finished or the running refinement already covers it. A
+  running refinement that no longer fits is cancelled. \ref draw then only picks up the finished
+  refinement.
+  
+  If only the data changed but the view did not (e.g. when data is appended to a streaming graph),
+  the running refinement is kept instead of restarting it on each replot, and \ref draw shows the
+  last finished refinement until it is replaced. A refinement that follows up on a finished one only
+  reduces the pixel columns whose data changed, see \ref QCPGraphRefinement. Copying the data for
+  the refinement happens on the worker thread, see \ref QCPDataContainer::deferredSnapshot.
+  
+  \seebaseclassmethod
+*/
+void QCPGraph::prepareDraw()
+{
+  if (!mKeyAxis || !mValueAxis || mKeyAxis.data()->range().size() <= 0 || mDataContainer->isEmpty() || (mLineStyle == lsNone && mScatterStyle.isNone()))
+  {
+    cancelRefinement();
+    return;
+  }
+  
+  QList<QCPDataRange> selectedSegments, unselectedSegments, allSegments;
+  getDataSegments(selectedSegments, unselectedSegments);
+  allSegments << unselectedSegments << selectedSegments;
+  QVector<QCPDataRange> lineRanges, scatterRanges;
+  getDrawRanges(allSegments, unselectedSegments.size(), getClipDataRange(clipRect()), lineRanges, scatterRanges);
+  if (!getProgressiveRanges(lineRanges, scatterRanges))
+  {
+    cancelRefinement();
+    return;
+  }
+  
+  QSharedPointer<QCPGraphRefinement> refinement = createRefinement(lineRanges, scatterRanges);
+  if (mRefined && mRefined->matches(*refinement))
+  {
+    cancelRefinement();
+    return;
+  }
+  if (mRefinement && refinement->extends(*mRefinement)) // a running refinement that only lacks newer data is kept, see above
+    return;
+  cancelRefinement();
+  refinement->mSnapshot = mDataContainer->deferredSnapshot();
+  if (mRefined && refinement->extends(*mRefined))
+    refinement->mPrevious = mRefined;
+  refinement->start(this);
+  mRefinement = refinement;
+  QThreadPool::globalInstance()->start(new QCPGraphRefinementRunnable(refinement));
+  emit refinementProgress(0);
+}
+
 /* inherits documentation from base class */
 void QCPGraph::draw(QCPPainter *painter)
 {
@@ -20355,18 +24207,34 @@ void QCPGraph::draw(QCPPainter *painter)
   if (mKeyAxis.data()->range().size() <= 0 || mDataContainer->isEmpty()) return;
   if (mLineStyle == lsNone && mScatterStyle.isNone()) return;
   
-  QVector<QPointF> lines, scatters; // line and (if necessary) scatter pixel coordinates will be stored here while iterating over segments
+  QCPScratchVector<QPointF> lines, scatters; // line and (if necessary) scatter pixel coordinates will be stored here while iterating over segments
+  const QCPDataRange clipDataRange = painter->hasClipping() ? getClipDataRange(painter->clipBoundingRect()) : QCPDataRange(0, dataCount()); // only process data that can appear inside the painter's clip
   
-  // loop over and draw segments of unselected/selected data:
+  // determine the line and scatter data ranges of the segments of unselected/selected data:
   QList<QCPDataRange> selectedSegments, unselectedSegments, allSegments;
   getDataSegments(selectedSegments, unselectedSegments);
   allSegments << unselectedSegments << selectedSegments;
+  QVector<QCPDataRange> lineRanges, scatterRanges;
+  getDrawRanges(allSegments, unselectedSegments.size(), clipDataRange, lineRanges, scatterRanges);
+  
+  // with progressive drawing, use the refined data once it is available (see prepareDraw), and a coarse preview until then:
+  const bool progressive = !painter->modes().testFlag(QCPPainter::pmNoCaching) && getProgressiveRanges(lineRanges, scatterRanges); // exports are always drawn synchronously
+  QSharedPointer<QCPGraphRefinement> refined = mRefined;
+  if (progressive && refined && !createRefinement(lineRanges, scatterRanges)->extends(*refined)) // an outdated refinement of the same view is drawn until the new one is finished
+    refined.clear();
+  const int previewSampleCount = 2*(mKeyAxis->orientation() == Qt::Horizontal ? mKeyAxis->axisRect()->width() : mKeyAxis->axisRect()->height());
+  
+  // loop over and draw segments of unselected/selected data:
   for (int i=0; i<allSegments.size(); ++i)
   {
     bool isSelectedSegment = i >= unselectedSegments.size();
     // get line pixel points appropriate to line style:
-    QCPDataRange lineDataRange = isSelectedSegment ? allSegments.at(i) : allSegments.at(i).adjusted(-1, 1); // unselected segments extend lines to bordering selected data point (safe to exceed total data bounds in first/last segment, getLines takes care)
-    getLines(&lines, lineDataRange);
+    if (!progressive)
+      getLines(lines.data(), lineRanges.at(i));
+    else if (refined)
+      linesFromData(lines.data(), refined->mLines.at(i));
+    else
+      linesFromData(lines.data(), mLineStyle != lsNone ? getPreviewData(lineRanges.at(i), previewSampleCount) : QVector<QCPGraphData>());
     
     // check data validity if flag set:
 #ifdef QCUSTOMPLOT_CHECK_DATA
@@ -20384,7 +24252,7 @@ void QCPGraph::draw(QCPPainter *painter)
     else
       painter->setBrush(mBrush);
     painter->setPen(Qt::NoPen);
-    drawFill(painter, &lines);
+    drawFill(painter, lines.data());
     
     // draw line:
     if (mLineStyle != lsNone)
@@ -20395,9 +24263,9 @@ void QCPGraph::draw(QCPPainter *painter)
         painter->setPen(mPen);
       painter->setBrush(Qt::NoBrush);
       if (mLineStyle == lsImpulse)
-        drawImpulsePlot(painter, lines);
+        drawImpulsePlot(painter, *lines);
       else
-        drawLinePlot(painter, lines); // also step plots can be drawn as a line plot
+        drawLinePlot(painter, *lines); // also step plots can be drawn as a line plot
     }
     
     // draw scatters:
@@ -20406,8 +24274,13 @@ void QCPGraph::draw(QCPPainter *painter)
       finalScatterStyle = mSelectionDecorator->getFinalScatterStyle(mScatterStyle);
     if (!finalScatterStyle.isNone())
     {
-      getScatters(&scatters, allSegments.at(i));
-      drawScatterPlot(painter, scatters, finalScatterStyle);
+      if (!progressive)
+        getScatters(scatters.data(), scatterRanges.at(i));
+      else if (refined)
+        scattersFromData(scatters.data(), refined->mScatters.at(i));
+      else
+        scattersFromData(scatters.data(), getPreviewData(scatterRanges.at(i), previewSampleCount));
+      drawScatterPlot(painter, *scatters, finalScatterStyle);
     }
   }
   
@@ -20478,25 +24351,41 @@ void QCPGraph::getLines(QVector<QPointF> *lines, const QCPDataRange &dataRange)
   getVisibleDataBounds(begin, end, dataRange);
   if (begin == end)
   {
-    lines->clear();
+    lines->resize(0);
     return;
   }
   
-  QVector<QCPGraphData> lineData;
+  QCPScratchVector<QCPGraphData> lineData;
   if (mLineStyle != lsNone)
-    getOptimizedLineData(&lineData, begin, end);
-  
+  {
+    getOptimizedLineData(lineData.data(), begin, end);
+    if (mParentPlot->collectsReplotStatistics())
+      mParentPlot->addLayerablePointCounts(this, end-begin, lineData->size());
+  }
+  linesFromData(lines, *lineData); // shares the scratch buffer, only detaches if the data needs to be reversed
+}
+
+/*! \internal
+
+  Converts the data points \a lineData (in plot coordinates, sorted by key) to pixel points
+  according to the line style of the graph, and returns them in \a lines. This is the second half
+  of \ref getLines, and is also used when drawing the preview or refined data of progressive
+  drawing (see \ref setProgressiveThreshold).
+*/
+void QCPGraph::linesFromData(QVector<QPointF> *lines, QVector<QCPGraphData> lineData) const
+{
+  if (!lines) return;
   if (mKeyAxis->rangeReversed() != (mKeyAxis->orientation() == Qt::Vertical)) // make sure key pixels are sorted ascending in lineData (significantly simplifies following processing)
     std::reverse(lineData.begin(), lineData.end());
 
   switch (mLineStyle)
   {
-    case lsNone: lines->clear(); break;
-    case lsLine: *lines = dataToLines(lineData); break;
-    case lsStepLeft: *lines = dataToStepLeftLines(lineData); break;
-    case lsStepRight: *lines = dataToStepRightLines(lineData); break;
-    case lsStepCenter: *lines = dataToStepCenterLines(lineData); break;
-    case lsImpulse: *lines = dataToImpulseLines(lineData); break;
+    case lsNone: lines->resize(0); break;
+    case lsLine: dataToLines(lineData, lines); break;
+    case lsStepLeft: dataToStepLeftLines(lineData, lines); break;
+    case lsStepRight: dataToStepRightLines(lineData, lines); break;
+    case lsStepCenter: dataToStepCenterLines(lineData, lines); break;
+    case lsImpulse: dataToImpulseLines(lineData, lines); break;
   }
 }
 
@@ -20523,14 +24412,30 @@ void QCPGraph::getScatters(QVector<QPointF> *scatters, const QCPDataRange &dataR
   getVisibleDataBounds(begin, end, dataRange);
   if (begin == end)
   {
-    scatters->clear();
+    scatters->resize(0);
     return;
   }
   
-  QVector<QCPGraphData> data;
-  getOptimizedScatterData(&data, begin, end);
+  QCPScratchVector<QCPGraphData> data;
+  getOptimizedScatterData(data.data(), begin, end);
+  if (mParentPlot->collectsReplotStatistics() && mLineStyle == lsNone) // with lines, the line data already counts the visible points
+    mParentPlot->addLayerablePointCounts(this, end-begin, data->size());
+  scattersFromData(scatters, *data); // shares the scratch buffer, only detaches if the data needs to be reversed
+}
+
+/*! \internal
+
+  Converts the data points \a data (in plot coordinates, sorted by key) to pixel points and
+  returns them in \a scatters. This is the second half of \ref getScatters, and is also used when
+  drawing the preview or refined data of progressive drawing (see \ref setProgressiveThreshold).
+*/
+void QCPGraph::scattersFromData(QVector<QPointF> *scatters, QVector<QCPGraphData> data) const
+{
+  if (!scatters) return;
+  QCPAxis *keyAxis = mKeyAxis.data();
+  QCPAxis *valueAxis = mValueAxis.data();
   
-  if (mKeyAxis->rangeReversed() != (mKeyAxis->orientation() == Qt::Vertical)) // make sure key pixels are sorted ascending in data (significantly simplifies following processing)
+  if (keyAxis->rangeReversed() != (keyAxis->orientation() == Qt::Vertical)) // make sure key pixels are sorted ascending in data (significantly simplifies following processing)
     std::reverse(data.begin(), data.end());
   
   scatters->resize(data.size());
@@ -20559,20 +24464,20 @@ void QCPGraph::getScatters(QVector<QPointF> *scatters, const QCPDataRange &dataR
 
 /*! \internal
 
-  Takes raw data points in plot coordinates as \a data, and returns a vector containing pixel
-  coordinate points which are suitable for drawing the line style \ref lsLine.
+  Takes raw data points in plot coordinates as \a data, and writes the pixel coordinate points
+  which are suitable for drawing the line style \ref lsLine to \a lines.
   
   The source of \a data is usually \ref getOptimizedLineData, and this method is called in \a
   getLines if the line style is set accordingly.
 
   \see dataToStepLeftLines, dataToStepRightLines, dataToStepCenterLines, dataToImpulseLines, getLines, drawLinePlot
 */
-QVector<QPointF> QCPGraph::dataToLines(const QVector<QCPGraphData> &data) const
+void QCPGraph::dataToLines(const QVector<QCPGraphData> &data, QVector<QPointF> *lines) const
 {
-  QVector<QPointF> result;
+  QVector<QPointF> &result = *lines;
   QCPAxis *keyAxis = mKeyAxis.data();
   QCPAxis *valueAxis = mValueAxis.data();
-  if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return result; }
+  if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; result.resize(0); return; }
 
   result.resize(data.size());
   
@@ -20592,25 +24497,24 @@ QVector<QPointF> QCPGraph::dataToLines(const QVector<QCPGraphData> &data) const
       result[i].setY(valueAxis->coordToPixel(data.at(i).value));
     }
   }
-  return result;
 }
 
 /*! \internal
 
-  Takes raw data points in plot coordinates as \a data, and returns a vector containing pixel
-  coordinate points which are suitable for drawing the line style \ref lsStepLeft.
+  Takes raw data points in plot coordinates as \a data, and writes the pixel coordinate points
+  which are suitable for drawing the line style \ref lsStepLeft to \a lines.
   
   The source of \a data is usually \ref getOptimizedLineData, and this method is called in \a
   getLines if the line style is set accordingly.
 
   \see dataToLines, dataToStepRightLines, dataToStepCenterLines, dataToImpulseLines, getLines, drawLinePlot
 */
-QVector<QPointF> QCPGraph::dataToStepLeftLines(const QVector<QCPGraphData> &data) const
+void QCPGraph::dataToStepLeftLines(const QVector<QCPGraphData> &data, QVector<QPointF> *lines) const
 {
-  QVector<QPointF> result;
+  QVector<QPointF> &result = *lines;
   QCPAxis *keyAxis = mKeyAxis.data();
   QCPAxis *valueAxis = mValueAxis.data();
-  if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return result; }
+  if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; result.resize(0); return; }
   
   result.resize(data.size()*2);
   
@@ -20640,25 +24544,24 @@ QVector<QPointF> QCPGraph::dataToStepLeftLines(const QVector<QCPGraphData> &data
       result[i*2+1].setY(lastValue);
     }
   }
-  return result;
 }
 
 /*! \internal
 
-  Takes raw data points in plot coordinates as \a data, and returns a vector containing pixel
-  coordinate points which are suitable for drawing the line style \ref lsStepRight.
+  Takes raw data points in plot coordinates as \a data, and writes the pixel coordinate points
+  which are suitable for drawing the line style \ref lsStepRight to \a lines.
   
   The source of \a data is usually \ref getOptimizedLineData, and this method is called in \a
   getLines if the line style is set accordingly.
 
   \see dataToLines, dataToStepLeftLines, dataToStepCenterLines, dataToImpulseLines, getLines, drawLinePlot
 */
-QVector<QPointF> QCPGraph::dataToStepRightLines(const QVector<QCPGraphData> &data) const
+void QCPGraph::dataToStepRightLines(const QVector<QCPGraphData> &data, QVector<QPointF> *lines) const
 {
-  QVector<QPointF> result;
+  QVector<QPointF> &result = *lines;
   QCPAxis *keyAxis = mKeyAxis.data();
   QCPAxis *valueAxis = mValueAxis.data();
-  if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return result; }
+  if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; result.resize(0); return; }
   
   result.resize(data.size()*2);
   
@@ -20688,25 +24591,24 @@ QVector<QPointF> QCPGraph::dataToStepRightLines(const QVector<QCPGraphData> &dat
       result[i*2+1].setY(value);
     }
   }
-  return result;
 }
 
 /*! \internal
 
-  Takes raw data points in plot coordinates as \a data, and returns a vector containing pixel
-  coordinate points which are suitable for drawing the line style \ref lsStepCenter.
+  Takes raw data points in plot coordinates as \a data, and writes the pixel coordinate points
+  which are suitable for drawing the line style \ref lsStepCenter to \a lines.
   
   The source of \a data is usually \ref getOptimizedLineData, and this method is called in \a
   getLines if the line style is set accordingly.
 
   \see dataToLines, dataToStepLeftLines, dataToStepRightLines, dataToImpulseLines, getLines, drawLinePlot
 */
-QVector<QPointF> QCPGraph::dataToStepCenterLines(const QVector<QCPGraphData> &data) const
+void QCPGraph::dataToStepCenterLines(const QVector<QCPGraphData> &data, QVector<QPointF> *lines) const
 {
-  QVector<QPointF> result;
+  QVector<QPointF> &result = *lines;
   QCPAxis *keyAxis = mKeyAxis.data();
   QCPAxis *valueAxis = mValueAxis.data();
-  if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return result; }
+  if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; result.resize(0); return; }
   
   result.resize(data.size()*2);
   
@@ -20748,25 +24650,24 @@ QVector<QPointF> QCPGraph::dataToStepCenterLines(const QVector<QCPGraphData> &da
     result[data.size()*2-1].setX(lastKey);
     result[data.size()*2-1].setY(lastValue);
   }
-  return result;
 }
 
 /*! \internal
 
-  Takes raw data points in plot coordinates as \a data, and returns a vector containing pixel
-  coordinate points which are suitable for drawing the line style \ref lsImpulse.
+  Takes raw data points in plot coordinates as \a data, and writes the pixel coordinate points
+  which are suitable for drawing the line style \ref lsImpulse to \a lines.
   
   The source of \a data is usually \ref getOptimizedLineData, and this method is called in \a
   getLines if the line style is set accordingly.
 
   \see dataToLines, dataToStepLeftLines, dataToStepRightLines, dataToStepCenterLines, getLines, drawImpulsePlot
 */
-QVector<QPointF> QCPGraph::dataToImpulseLines(const QVector<QCPGraphData> &data) const
+void QCPGraph::dataToImpulseLines(const QVector<QCPGraphData> &data, QVector<QPointF> *lines) const
 {
-  QVector<QPointF> result;
+  QVector<QPointF> &result = *lines;
   QCPAxis *keyAxis = mKeyAxis.data();
   QCPAxis *valueAxis = mValueAxis.data();
-  if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return result; }
+  if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; result.resize(0); return; }
   
   result.resize(data.size()*2);
   
@@ -20792,7 +24693,6 @@ QVector<QPointF> QCPGraph::dataToImpulseLines(const QVector<QCPGraphData> &data)
       result[i*2+1].setY(valueAxis->coordToPixel(data.at(i).value));
     }
   }
-  return result;
 }
 
 /*! \internal
@@ -20816,25 +24716,33 @@ void QCPGraph::drawFill(QCPPainter *painter, QVector<QPointF> *lines) const
 {
   if (mLineStyle == lsImpulse) return; // fill doesn't make sense for impulse plot
   if (painter->brush().style() == Qt::NoBrush || painter->brush().color().alpha() == 0) return;
+  if (mParentPlot->activeInteractionDegradations().testFlag(QCP::idFills)) return; // fills are skipped during interactions to save time
   
   applyFillAntialiasingHint(painter);
   QVector<QCPDataRange> segments = getNonNanSegments(lines, keyAxis()->orientation());
   if (!mChannelFillGraph)
   {
     // draw base fill under graph, fill goes all the way to the zero-value-line:
+    QCPScratchVector<QPointF> polygon;
     for (int i=0; i<segments.size(); ++i)
-      painter->drawPolygon(getFillPolygon(lines, segments.at(i)));
+    {
+      getFillPolygon(polygon.data(), lines, segments.at(i));
+      painter->drawPolygon(polygon->constData(), polygon->size());
+    }
   } else
   {
     // draw fill between this graph and mChannelFillGraph:
-    QVector<QPointF> otherLines;
-    mChannelFillGraph->getLines(&otherLines, QCPDataRange(0, mChannelFillGraph->dataCount()));
-    if (!otherLines.isEmpty())
+    QCPScratchVector<QPointF> otherLines, polygon;
+    mChannelFillGraph->getLines(otherLines.data(), QCPDataRange(0, mChannelFillGraph->dataCount()));
+    if (!otherLines->isEmpty())
     {
-      QVector<QCPDataRange> otherSegments = getNonNanSegments(&otherLines, mChannelFillGraph->keyAxis()->orientation());
-      QVector<QPair<QCPDataRange, QCPDataRange> > segmentPairs = getOverlappingSegments(segments, lines, otherSegments, &otherLines);
+      QVector<QCPDataRange> otherSegments = getNonNanSegments(otherLines.data(), mChannelFillGraph->keyAxis()->orientation());
+      QVector<QPair<QCPDataRange, QCPDataRange> > segmentPairs = getOverlappingSegments(segments, lines, otherSegments, otherLines.data());
       for (int i=0; i<segmentPairs.size(); ++i)
-        painter->drawPolygon(getChannelFillPolygon(lines, segmentPairs.at(i).first, &otherLines, segmentPairs.at(i).second));
+      {
+        getChannelFillPolygon(polygon.data(), lines, segmentPairs.at(i).first, otherLines.data(), segmentPairs.at(i).second);
+        painter->drawPolygon(polygon->constData(), polygon->size());
+      }
     }
   }
 }
@@ -20906,21 +24814,26 @@ void QCPGraph::drawImpulsePlot(QCPPainter *painter, const QVector<QPointF> &line
 void QCPGraph::getOptimizedLineData(QVector<QCPGraphData> *lineData, const QCPGraphDataContainer::const_iterator &begin, const QCPGraphDataContainer::const_iterator &end) const
 {
   if (!lineData) return;
+  QCPTraceScope trace("QCPGraph::getOptimizedLineData", "sampling", this);
   QCPAxis *keyAxis = mKeyAxis.data();
   QCPAxis *valueAxis = mValueAxis.data();
   if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return; }
   if (begin == end) return;
   
+  // during interactions with QCP::idDecimation active, sample in intervals of several pixels (also if adaptive sampling is off):
+  const bool decimate = mParentPlot->activeInteractionDegradations().testFlag(QCP::idDecimation);
+  const bool adaptiveSampling = mAdaptiveSampling || decimate;
+  const double samplingWidth = decimate ? 4.0 : 1.0;
   int dataCount = end-begin;
   int maxCount = (std::numeric_limits<int>::max)();
-  if (mAdaptiveSampling)
+  if (adaptiveSampling)
   {
-    double keyPixelSpan = qAbs(keyAxis->coordToPixel(begin->key)-keyAxis->coordToPixel((end-1)->key));
+    double keyPixelSpan = qAbs(keyAxis->coordToPixel(begin->key)-keyAxis->coordToPixel((end-1)->key))/samplingWidth;
     if (2*keyPixelSpan+2 < static_cast<double>((std::numeric_limits<int>::max)()))
       maxCount = 2*keyPixelSpan+2;
   }
   
-  if (mAdaptiveSampling && dataCount >= maxCount) // use adaptive sampling only if there are at least two points per pixel on average
+  if (adaptiveSampling && dataCount >= maxCount) // use adaptive sampling only if there are at least two points per pixel on average
   {
     QCPGraphDataContainer::const_iterator it = begin;
     double minValue = it->value;
@@ -20930,7 +24843,7 @@ void QCPGraph::getOptimizedLineData(QVector<QCPGraphData> *lineData, const QCPGr
     int reversedRound = reversedFactor==-1 ? 1 : 0; // is used to switch between floor (normal) and ceil (reversed) rounding of currentIntervalStartKey
     double currentIntervalStartKey = keyAxis->pixelToCoord((int)(keyAxis->coordToPixel(begin->key)+reversedRound));
     double lastIntervalEndKey = currentIntervalStartKey;
-    double keyEpsilon = qAbs(currentIntervalStartKey-keyAxis->pixelToCoord(keyAxis->coordToPixel(currentIntervalStartKey)+1.0*reversedFactor)); // interval of one pixel on screen when mapped to plot key coordinates
+    double keyEpsilon = qAbs(currentIntervalStartKey-keyAxis->pixelToCoord(keyAxis->coordToPixel(currentIntervalStartKey)+samplingWidth*reversedFactor)); // interval of one pixel (or the decimation width) on screen when mapped to plot key coordinates
     bool keyEpsilonVariable = keyAxis->scaleType() == QCPAxis::stLogarithmic; // indicates whether keyEpsilon needs to be updated after every interval (for log axes)
     int intervalDataCount = 1;
     ++it; // advance iterator to second data point because adaptive sampling works in 1 point retrospect
@@ -20961,7 +24874,7 @@ void QCPGraph::getOptimizedLineData(QVector<QCPGraphData> *lineData, const QCPGr
         currentIntervalFirstPoint = it;
         currentIntervalStartKey = keyAxis->pixelToCoord((int)(keyAxis->coordToPixel(it->key)+reversedRound));
         if (keyEpsilonVariable)
-          keyEpsilon = qAbs(currentIntervalStartKey-keyAxis->pixelToCoord(keyAxis->coordToPixel(currentIntervalStartKey)+1.0*reversedFactor));
+          keyEpsilon = qAbs(currentIntervalStartKey-keyAxis->pixelToCoord(keyAxis->coordToPixel(currentIntervalStartKey)+samplingWidth*reversedFactor));
         intervalDataCount = 1;
       }
       ++it;
@@ -21002,8 +24915,9 @@ void QCPGraph::getOptimizedScatterData(QVector<QCPGraphData> *scatterData, QCPGr
   QCPAxis *valueAxis = mValueAxis.data();
   if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return; }
   
-  const int scatterModulo = mScatterSkip+1;
-  const bool doScatterSkip = mScatterSkip > 0;
+  // during interactions with QCP::idScatterThinning active, only every fourth of the otherwise drawn scatters is drawn:
+  const int scatterModulo = mParentPlot->activeInteractionDegradations().testFlag(QCP::idScatterThinning) ? (mScatterSkip+1)*4 : mScatterSkip+1;
+  const bool doScatterSkip = scatterModulo > 1;
   int beginIndex = begin-mDataContainer->constBegin();
   int endIndex = end-mDataContainer->constBegin();
   while (doScatterSkip && begin != end && beginIndex % scatterModulo != 0) // advance begin iterator to first non-skipped scatter
@@ -21195,26 +25109,187 @@ void QCPGraph::getVisibleDataBounds(QCPGraphDataContainer::const_iterator &begin
   }
 }
 
-/*!  \internal
-  
-  This method goes through the passed points in \a lineData and returns a list of the segments
-  which don't contain NaN data points.
+/*! \internal
   
-  \a keyOrientation defines whether the \a x or \a y member of the passed QPointF is used to check
-  for NaN. If \a keyOrientation is \c Qt::Horizontal, the \a y member is checked, if it is \c
-  Qt::Vertical, the \a x member is checked.
+  Returns the range of data indices whose keys lie inside the pixel rect \a clip, widened by the
+  scatter size and pen width, plus one data point beyond each end so lines connect to the points
+  outside.
   
-  \see getOverlappingSegments, drawFill
+  \ref draw restricts the processed data to this range for the clip of its painter. For regular
+  replots, the clip is the axis rect and the range equals the visible data. When only a part of the
+  axis rect is redrawn, e.g. the strip exposed during fast panning (\ref
+  QCPAxisRect::setRangeDragFastPan), this limits the work to the data that is actually shown in
+  that part.
 */
-QVector<QCPDataRange> QCPGraph::getNonNanSegments(const QVector<QPointF> *lineData, Qt::Orientation keyOrientation) const
+QCPDataRange QCPGraph::getClipDataRange(const QRectF &clip) const
 {
-  QVector<QCPDataRange> result;
-  const int n = lineData->size();
+  const double margin = mScatterStyle.size()+mPen.widthF()+1;
+  const QRectF widenedClip = clip.adjusted(-margin, -margin, margin, margin);
+  QCPAxis *keyAxis = mKeyAxis.data();
+  double lower, upper;
+  if (keyAxis->orientation() == Qt::Horizontal)
+  {
+    lower = keyAxis->pixelToCoord(widenedClip.left());
+    upper = keyAxis->pixelToCoord(widenedClip.right());
+  } else
+  {
+    lower = keyAxis->pixelToCoord(widenedClip.bottom());
+    upper = keyAxis->pixelToCoord(widenedClip.top());
+  }
+  if (lower > upper)
+    qSwap(lower, upper);
+  QCPGraphDataContainer::const_iterator begin = mDataContainer->findBegin(lower);
+  QCPGraphDataContainer::const_iterator end = mDataContainer->findEnd(upper);
+  return QCPDataRange(int(begin-mDataContainer->constBegin()), int(end-mDataContainer->constBegin()));
+}
+
+/*! \internal
   
-  QCPDataRange currentSegment(-1, -1);
-  int i = 0;
+  Determines the data ranges of the line and the scatters of each of the data \a segments, limited
+  to \a clipDataRange, and appends them to \a lineRanges and \a scatterRanges. The segments from
+  index \a firstSelectedSegment on are selected, the ones before are unselected. Empty ranges mark
+  segments without lines or scatters.
   
-  if (keyOrientation == Qt::Horizontal)
+  Unselected segments extend their line range to the bordering selected data points.
+*/
+void QCPGraph::getDrawRanges(const QList<QCPDataRange> &segments, int firstSelectedSegment, const QCPDataRange &clipDataRange, QVector<QCPDataRange> &lineRanges, QVector<QCPDataRange> &scatterRanges) const
+{
+  for (int i=0; i<segments.size(); ++i)
+  {
+    bool isSelectedSegment = i >= firstSelectedSegment;
+    QCPDataRange lineDataRange = isSelectedSegment ? segments.at(i) : segments.at(i).adjusted(-1, 1); // unselected segments extend lines to bordering selected data point (safe to exceed total data bounds in first/last segment, getLines takes care)
+    const QCPScatterStyle finalScatterStyle = isSelectedSegment && mSelectionDecorator ? mSelectionDecorator->getFinalScatterStyle(mScatterStyle) : mScatterStyle;
+    lineRanges << (mLineStyle != lsNone ? lineDataRange.intersection(clipDataRange) : QCPDataRange());
+    scatterRanges << (!finalScatterStyle.isNone() ? segments.at(i).intersection(clipDataRange) : QCPDataRange());
+  }
+}
+
+/*! \internal
+  
+  Decides whether the data ranges in \a lineRanges and \a scatterRanges (see \ref getDrawRanges)
+  are drawn progressively (see \ref setProgressiveThreshold) and returns true if so. In that case,
+  the ranges are limited to the visible data.
+*/
+bool QCPGraph::getProgressiveRanges(QVector<QCPDataRange> &lineRanges, QVector<QCPDataRange> &scatterRanges) const
+{
+  if (mProgressiveThreshold <= 0)
+    return false;
+  
+  QVector<QCPDataRange> visibleLineRanges(lineRanges.size()), visibleScatterRanges(scatterRanges.size());
+  int visibleCount = 0;
+  QCPGraphDataContainer::const_iterator begin, end;
+  for (int i=0; i<lineRanges.size(); ++i)
+  {
+    getVisibleDataBounds(begin, end, lineRanges.at(i));
+    visibleLineRanges[i] = QCPDataRange(int(begin-mDataContainer->constBegin()), int(end-mDataContainer->constBegin()));
+    getVisibleDataBounds(begin, end, scatterRanges.at(i));
+    visibleScatterRanges[i] = QCPDataRange(int(begin-mDataContainer->constBegin()), int(end-mDataContainer->constBegin()));
+    visibleCount += qMax(visibleLineRanges.at(i).size(), visibleScatterRanges.at(i).size());
+  }
+  if (visibleCount <= mProgressiveThreshold)
+    return false;
+  lineRanges = visibleLineRanges;
+  scatterRanges = visibleScatterRanges;
+  return true;
+}
+
+/*! \internal
+  
+  Returns a new refinement for the current view and the data ranges \a lineRanges and \a
+  scatterRanges, with pixel columns and rows at the resolution of the paint buffer. It isn't
+  started yet and has no snapshot, so it can also be used to compare the current state with
+  existing refinements (see \ref QCPGraphRefinement::matches and \ref
+  QCPGraphRefinement::extends).
+*/
+QSharedPointer<QCPGraphRefinement> QCPGraph::createRefinement(const QVector<QCPDataRange> &lineRanges, const QVector<QCPDataRange> &scatterRanges) const
+{
+  QCPAxis *keyAxis = mKeyAxis.data();
+  QCPAxis *valueAxis = mValueAxis.data();
+  const QRect axisRect = keyAxis->axisRect()->rect();
+  const double ratio = qMax(1.0, mParentPlot->bufferDevicePixelRatio());
+  const bool keyHorizontal = keyAxis->orientation() == Qt::Horizontal;
+  const double keyStart = keyHorizontal ? axisRect.left() : axisRect.top();
+  const double keyLength = keyHorizontal ? axisRect.width() : axisRect.height();
+  const int columnCount = qMax(1, qRound(keyLength*ratio));
+  QSharedPointer<QCPGraphRefinement> refinement(new QCPGraphRefinement);
+  refinement->mContainer = mDataContainer.data();
+  refinement->mRevision = mDataContainer->revision();
+  refinement->mColumns.resize(columnCount+1);
+  for (int i=0; i<=columnCount; ++i)
+    refinement->mColumns[i] = keyAxis->pixelToCoord(keyStart+i*keyLength/columnCount);
+  if (refinement->mColumns.first() > refinement->mColumns.last())
+    std::reverse(refinement->mColumns.begin(), refinement->mColumns.end());
+  refinement->mValueLower = valueAxis->range().lower;
+  refinement->mValueUpper = valueAxis->range().upper;
+  refinement->mValueLogarithmic = valueAxis->scaleType() == QCPAxis::stLogarithmic;
+  refinement->mRowCount = qMax(1, qRound((keyHorizontal ? axisRect.height() : axisRect.width())*ratio));
+  refinement->mLineRanges = lineRanges;
+  refinement->mScatterRanges = scatterRanges;
+  return refinement;
+}
+
+/*! \internal
+  
+  Returns about \a sampleCount data points of the data index range \a dataRange, by taking every
+  n-th data point. The last data point of the range is always included. This is the coarse preview
+  that is drawn while the refinement of progressive drawing runs.
+*/
+QVector<QCPGraphData> QCPGraph::getPreviewData(const QCPDataRange &dataRange, int sampleCount) const
+{
+  QVector<QCPGraphData> result;
+  if (dataRange.isEmpty())
+    return result;
+  const int stride = qMax(1, dataRange.size()/qMax(1, sampleCount));
+  result.reserve(dataRange.size()/stride+2);
+  const QCPGraphDataContainer::const_iterator begin = mDataContainer->constBegin();
+  for (int i=dataRange.begin(); i<dataRange.end(); i+=stride)
+    result.append(*(begin+i));
+  if ((dataRange.size()-1)%stride != 0)
+    result.append(*(begin+dataRange.end()-1));
+  return result;
+}
+
+/*! \internal
+  
+  Called (as queued call from the worker thread) when the running refinement of progressive
+  drawing made progress or finished. Emits \ref refinementProgress and, once the refinement is
+  finished, takes over its results and replots the layer of this graph.
+*/
+void QCPGraph::refinementUpdated()
+{
+  if (!mRefinement)
+    return;
+  if (mRefinement->isFinished())
+  {
+    mRefined = mRefinement;
+    mRefinement.clear();
+    emit refinementProgress(1.0);
+    markLayerDirty();
+    mParentPlot->replot(QCustomPlot::rpQueuedReplot);
+  } else
+    emit refinementProgress(mRefinement->progress());
+}
+
+/*!  \internal
+  
+  This method goes through the passed points in \a lineData and returns a list of the segments
+  which don't contain NaN data points.
+  
+  \a keyOrientation defines whether the \a x or \a y member of the passed QPointF is used to check
+  for NaN. If \a keyOrientation is \c Qt::Horizontal, the \a y member is checked, if it is \c
+  Qt::Vertical, the \a x member is checked.
+  
+  \see getOverlappingSegments, drawFill
+*/
+QVector<QCPDataRange> QCPGraph::getNonNanSegments(const QVector<QPointF> *lineData, Qt::Orientation keyOrientation) const
+{
+  QVector<QCPDataRange> result;
+  const int n = lineData->size();
+  
+  QCPDataRange currentSegment(-1, -1);
+  int i = 0;
+  
+  if (keyOrientation == Qt::Horizontal)
   {
     while (i < n)
     {
@@ -21405,67 +25480,71 @@ QPointF QCPGraph::getFillBasePoint(QPointF matchingDataPoint) const
 
 /*! \internal
   
-  Returns the polygon needed for drawing normal fills between this graph and the key axis.
+  Writes the polygon needed for drawing normal fills between this graph and the key axis to \a
+  polygon.
   
   Pass the graph's data points (in pixel coordinates) as \a lineData, and specify the \a segment
   which shall be used for the fill. The collection of \a lineData points described by \a segment
   must not contain NaN data points (see \ref getNonNanSegments).
   
-  The returned fill polygon will be closed at the key axis (the zero-value line) for linear value
-  axes. For logarithmic value axes the polygon will reach just beyond the corresponding axis rect
-  side (see \ref getFillBasePoint).
-
-  For increased performance (due to implicit sharing), keep the returned QPolygonF const.
+  The fill polygon will be closed at the key axis (the zero-value line) for linear value axes. For
+  logarithmic value axes the polygon will reach just beyond the corresponding axis rect side (see
+  \ref getFillBasePoint).
   
   \see drawFill, getNonNanSegments
 */
-const QPolygonF QCPGraph::getFillPolygon(const QVector<QPointF> *lineData, QCPDataRange segment) const
+void QCPGraph::getFillPolygon(QVector<QPointF> *polygon, const QVector<QPointF> *lineData, QCPDataRange segment) const
 {
   if (segment.size() < 2)
-    return QPolygonF();
-  QPolygonF result(segment.size()+2);
+  {
+    polygon->resize(0);
+    return;
+  }
+  QVector<QPointF> &result = *polygon;
+  result.resize(segment.size()+2);
   
   result[0] = getFillBasePoint(lineData->at(segment.begin()));
   std::copy(lineData->constBegin()+segment.begin(), lineData->constBegin()+segment.end(), result.begin()+1);
   result[result.size()-1] = getFillBasePoint(lineData->at(segment.end()-1));
-  
-  return result;
 }
 
 /*! \internal
   
-  Returns the polygon needed for drawing (partial) channel fills between this graph and the graph
-  specified by \ref setChannelFillGraph.
+  Writes the polygon needed for drawing (partial) channel fills between this graph and the graph
+  specified by \ref setChannelFillGraph to \a polygon. If no fill polygon can be formed, \a
+  polygon is left empty.
   
   The data points of this graph are passed as pixel coordinates via \a thisData, the data of the
-  other graph as \a otherData. The returned polygon will be calculated for the specified data
-  segments \a thisSegment and \a otherSegment, pertaining to the respective \a thisData and \a
-  otherData, respectively.
+  other graph as \a otherData. The polygon will be calculated for the specified data segments \a
+  thisSegment and \a otherSegment, pertaining to the respective \a thisData and \a otherData,
+  respectively.
   
   The passed \a thisSegment and \a otherSegment should correspond to the segment pairs returned by
   \ref getOverlappingSegments, to make sure only segments that actually have key coordinate overlap
   need to be processed here.
   
-  For increased performance due to implicit sharing, keep the returned QPolygonF const.
-  
   \see drawFill, getOverlappingSegments, getNonNanSegments
 */
-const QPolygonF QCPGraph::getChannelFillPolygon(const QVector<QPointF> *thisData, QCPDataRange thisSegment, const QVector<QPointF> *otherData, QCPDataRange otherSegment) const
+void QCPGraph::getChannelFillPolygon(QVector<QPointF> *polygon, const QVector<QPointF> *thisData, QCPDataRange thisSegment, const QVector<QPointF> *otherData, QCPDataRange otherSegment) const
 {
+  polygon->resize(0);
   if (!mChannelFillGraph)
-    return QPolygonF();
+    return;
   
   QCPAxis *keyAxis = mKeyAxis.data();
   QCPAxis *valueAxis = mValueAxis.data();
-  if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return QPolygonF(); }
-  if (!mChannelFillGraph.data()->mKeyAxis) { qDebug() << Q_FUNC_INFO << "channel fill target key axis invalid"; return QPolygonF(); }
+  if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return; }
+  if (!mChannelFillGraph.data()->mKeyAxis) { qDebug() << Q_FUNC_INFO << "channel fill target key axis invalid"; return; }
   
   if (mChannelFillGraph.data()->mKeyAxis.data()->orientation() != keyAxis->orientation())
-    return QPolygonF(); // don't have same axis orientation, can't fill that (Note: if keyAxis fits, valueAxis will fit too, because it's always orthogonal to keyAxis)
-  
-  if (thisData->isEmpty()) return QPolygonF();
-  QVector<QPointF> thisSegmentData(thisSegment.size());
-  QVector<QPointF> otherSegmentData(otherSegment.size());
+    return; // don't have same axis orientation, can't fill that (Note: if keyAxis fits, valueAxis will fit too, because it's always orthogonal to keyAxis)
+  
+  if (thisData->isEmpty()) return;
+  QCPScratchVector<QPointF> otherSegmentScratch;
+  QVector<QPointF> &thisSegmentData = *polygon; // the polygon is formed in place, starting with this segment
+  QVector<QPointF> &otherSegmentData = *otherSegmentScratch;
+  thisSegmentData.resize(thisSegment.size());
+  otherSegmentData.resize(otherSegment.size());
   std::copy(thisData->constBegin()+thisSegment.begin(), thisData->constBegin()+thisSegment.end(), thisSegmentData.begin());
   std::copy(otherData->constBegin()+otherSegment.begin(), otherData->constBegin()+otherSegment.end(), otherSegmentData.begin());
   // pointers to be able to swap them, depending which data range needs cropping:
@@ -21480,10 +25559,10 @@ const QPolygonF QCPGraph::getChannelFillPolygon(const QVector<QPointF> *thisData
     if (staticData->first().x() < croppedData->first().x()) // other one must be cropped
       qSwap(staticData, croppedData);
     const int lowBound = findIndexBelowX(croppedData, staticData->first().x());
-    if (lowBound == -1) return QPolygonF(); // key ranges have no overlap
+    if (lowBound == -1) { polygon->resize(0); return; } // key ranges have no overlap
     croppedData->remove(0, lowBound);
     // set lowest point of cropped data to fit exactly key position of first static data point via linear interpolation:
-    if (croppedData->size() < 2) return QPolygonF(); // need at least two points for interpolation
+    if (croppedData->size() < 2) { polygon->resize(0); return; } // need at least two points for interpolation
     double slope;
     if (!qFuzzyCompare(croppedData->at(1).x(), croppedData->at(0).x()))
       slope = (croppedData->at(1).y()-croppedData->at(0).y())/(croppedData->at(1).x()-croppedData->at(0).x());
@@ -21496,10 +25575,10 @@ const QPolygonF QCPGraph::getChannelFillPolygon(const QVector<QPointF> *thisData
     if (staticData->last().x() > croppedData->last().x()) // other one must be cropped
       qSwap(staticData, croppedData);
     int highBound = findIndexAboveX(croppedData, staticData->last().x());
-    if (highBound == -1) return QPolygonF(); // key ranges have no overlap
+    if (highBound == -1) { polygon->resize(0); return; } // key ranges have no overlap
     croppedData->remove(highBound+1, croppedData->size()-(highBound+1));
     // set highest point of cropped data to fit exactly key position of last static data point via linear interpolation:
-    if (croppedData->size() < 2) return QPolygonF(); // need at least two points for interpolation
+    if (croppedData->size() < 2) { polygon->resize(0); return; } // need at least two points for interpolation
     const int li = croppedData->size()-1; // last index
     if (!qFuzzyCompare(croppedData->at(li).x(), croppedData->at(li-1).x()))
       slope = (croppedData->at(li).y()-croppedData->at(li-1).y())/(croppedData->at(li).x()-croppedData->at(li-1).x());
@@ -21514,10 +25593,10 @@ const QPolygonF QCPGraph::getChannelFillPolygon(const QVector<QPointF> *thisData
     if (staticData->first().y() < croppedData->first().y()) // other one must be cropped
       qSwap(staticData, croppedData);
     int lowBound = findIndexBelowY(croppedData, staticData->first().y());
-    if (lowBound == -1) return QPolygonF(); // key ranges have no overlap
+    if (lowBound == -1) { polygon->resize(0); return; } // key ranges have no overlap
     croppedData->remove(0, lowBound);
     // set lowest point of cropped data to fit exactly key position of first static data point via linear interpolation:
-    if (croppedData->size() < 2) return QPolygonF(); // need at least two points for interpolation
+    if (croppedData->size() < 2) { polygon->resize(0); return; } // need at least two points for interpolation
     double slope;
     if (!qFuzzyCompare(croppedData->at(1).y(), croppedData->at(0).y())) // avoid division by zero in step plots
       slope = (croppedData->at(1).x()-croppedData->at(0).x())/(croppedData->at(1).y()-croppedData->at(0).y());
@@ -21530,10 +25609,10 @@ const QPolygonF QCPGraph::getChannelFillPolygon(const QVector<QPointF> *thisData
     if (staticData->last().y() > croppedData->last().y()) // other one must be cropped
       qSwap(staticData, croppedData);
     int highBound = findIndexAboveY(croppedData, staticData->last().y());
-    if (highBound == -1) return QPolygonF(); // key ranges have no overlap
+    if (highBound == -1) { polygon->resize(0); return; } // key ranges have no overlap
     croppedData->remove(highBound+1, croppedData->size()-(highBound+1));
     // set highest point of cropped data to fit exactly key position of last static data point via linear interpolation:
-    if (croppedData->size() < 2) return QPolygonF(); // need at least two points for interpolation
+    if (croppedData->size() < 2) { polygon->resize(0); return; } // need at least two points for interpolation
     int li = croppedData->size()-1; // last index
     if (!qFuzzyCompare(croppedData->at(li).y(), croppedData->at(li-1).y())) // avoid division by zero in step plots
       slope = (croppedData->at(li).x()-croppedData->at(li-1).x())/(croppedData->at(li).y()-croppedData->at(li-1).y());
@@ -21543,10 +25622,9 @@ const QPolygonF QCPGraph::getChannelFillPolygon(const QVector<QPointF> *thisData
     (*croppedData)[li].setY(staticData->last().y());
   }
   
-  // return joined:
+  // join other segment to this one in the polygon:
   for (int i=otherSegmentData.size()-1; i>=0; --i) // insert reversed, otherwise the polygon will be twisted
     thisSegmentData << otherSegmentData.at(i);
-  return QPolygonF(thisSegmentData);
 }
 
 /*! \internal
@@ -21662,13 +25740,13 @@ double QCPGraph::pointDistance(const QPointF &pixelPoint, QCPGraphDataContainer:
   if (mLineStyle != lsNone)
   {
     // line displayed, calculate distance to line segments:
-    QVector<QPointF> lineData;
-    getLines(&lineData, QCPDataRange(0, dataCount()));
+    QCPScratchVector<QPointF> lineData;
+    getLines(lineData.data(), QCPDataRange(0, dataCount()));
     QCPVector2D p(pixelPoint);
     const int step = mLineStyle==lsImpulse ? 2 : 1; // impulse plot differs from other line styles in that the lineData points are only pairwise connected
-    for (int i=0; i<lineData.size()-1; i+=step)
+    for (int i=0; i<lineData->size()-1; i+=step)
     {
-      const double currentDistSqr = p.distanceSquaredToLine(lineData.at(i), lineData.at(i+1));
+      const double currentDistSqr = p.distanceSquaredToLine(lineData->at(i), lineData->at(i+1));
       if (currentDistSqr < minDistSqr)
         minDistSqr = currentDistSqr;
     }
@@ -21894,6 +25972,7 @@ QCPCurve::~QCPCurve()
 void QCPCurve::setData(QSharedPointer<QCPCurveDataContainer> data)
 {
   mDataContainer = data;
+  markLayerDirty();
 }
 
 /*! \overload
@@ -21911,6 +25990,7 @@ void QCPCurve::setData(const QVector<double> &t, const QVector<double> &keys, co
 {
   mDataContainer->clear();
   addData(t, keys, values, alreadySorted);
+  markLayerDirty();
 }
 
 
@@ -21929,6 +26009,7 @@ void QCPCurve::setData(const QVector<double> &keys, const QVector<double> &value
 {
   mDataContainer->clear();
   addData(keys, values);
+  markLayerDirty();
 }
 
 /*!
@@ -21941,6 +26022,7 @@ void QCPCurve::setData(const QVector<double> &keys, const QVector<double> &value
 void QCPCurve::setScatterStyle(const QCPScatterStyle &style)
 {
   mScatterStyle = style;
+  markLayerDirty();
 }
 
 /*!
@@ -21957,6 +26039,7 @@ void QCPCurve::setScatterStyle(const QCPScatterStyle &style)
 void QCPCurve::setScatterSkip(int skip)
 {
   mScatterSkip = qMax(0, skip);
+  markLayerDirty();
 }
 
 /*!
@@ -21969,6 +26052,7 @@ void QCPCurve::setScatterSkip(int skip)
 void QCPCurve::setLineStyle(QCPCurve::LineStyle style)
 {
   mLineStyle = style;
+  markLayerDirty();
 }
 
 /*! \overload
@@ -22115,8 +26199,8 @@ void QCPCurve::draw(QCPPainter *painter)
 {
   if (mDataContainer->isEmpty()) return;
   
-  // allocate line vector:
-  QVector<QPointF> lines, scatters;
+  // borrow line and scatter vectors:
+  QCPScratchVector<QPointF> lines, scatters;
   
   // loop over and draw segments of unselected/selected data:
   QList<QCPDataRange> selectedSegments, unselectedSegments, allSegments;
@@ -22132,7 +26216,7 @@ void QCPCurve::draw(QCPPainter *painter)
       finalCurvePen = mSelectionDecorator->pen();
     
     QCPDataRange lineDataRange = isSelectedSegment ? allSegments.at(i) : allSegments.at(i).adjusted(-1, 1); // unselected segments extend lines to bordering selected data point (safe to exceed total data bounds in first/last segment, getCurveLines takes care)
-    getCurveLines(&lines, lineDataRange, finalCurvePen.widthF());
+    getCurveLines(lines.data(), lineDataRange, finalCurvePen.widthF());
     
     // check data validity if flag set:
   #ifdef QCUSTOMPLOT_CHECK_DATA
@@ -22152,14 +26236,14 @@ void QCPCurve::draw(QCPPainter *painter)
       painter->setBrush(mBrush);
     painter->setPen(Qt::NoPen);
     if (painter->brush().style() != Qt::NoBrush && painter->brush().color().alpha() != 0)
-      painter->drawPolygon(QPolygonF(lines));
+      painter->drawPolygon(lines->constData(), lines->size());
     
     // draw curve line:
     if (mLineStyle != lsNone)
     {
       painter->setPen(finalCurvePen);
       painter->setBrush(Qt::NoBrush);
-      drawCurveLine(painter, lines);
+      drawCurveLine(painter, *lines);
     }
     
     // draw scatters:
@@ -22168,8 +26252,8 @@ void QCPCurve::draw(QCPPainter *painter)
       finalScatterStyle = mSelectionDecorator->getFinalScatterStyle(mScatterStyle);
     if (!finalScatterStyle.isNone())
     {
-      getScatters(&scatters, allSegments.at(i), finalScatterStyle.size());
-      drawScatterPlot(painter, scatters, finalScatterStyle);
+      getScatters(scatters.data(), allSegments.at(i), finalScatterStyle.size());
+      drawScatterPlot(painter, *scatters, finalScatterStyle);
     }
   }
   
@@ -22276,7 +26360,7 @@ void QCPCurve::drawScatterPlot(QCPPainter *painter, const QVector<QPointF> &poin
 void QCPCurve::getCurveLines(QVector<QPointF> *lines, const QCPDataRange &dataRange, double penWidth) const
 {
   if (!lines) return;
-  lines->clear();
+  lines->resize(0);
   QCPAxis *keyAxis = mKeyAxis.data();
   QCPAxis *valueAxis = mValueAxis.data();
   if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return; }
@@ -22379,7 +26463,7 @@ void QCPCurve::getCurveLines(QVector<QPointF> *lines, const QCPDataRange &dataRa
 void QCPCurve::getScatters(QVector<QPointF> *scatters, const QCPDataRange &dataRange, double scatterWidth) const
 {
   if (!scatters) return;
-  scatters->clear();
+  scatters->resize(0);
   QCPAxis *keyAxis = mKeyAxis.data();
   QCPAxis *valueAxis = mValueAxis.data();
   if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return; }
@@ -23256,6 +27340,7 @@ QCPBarsGroup::~QCPBarsGroup()
 void QCPBarsGroup::setSpacingType(SpacingType spacingType)
 {
   mSpacingType = spacingType;
+  markBarsDirty();
 }
 
 /*!
@@ -23267,6 +27352,7 @@ void QCPBarsGroup::setSpacingType(SpacingType spacingType)
 void QCPBarsGroup::setSpacing(double spacing)
 {
   mSpacing = spacing;
+  markBarsDirty();
 }
 
 /*!
@@ -23340,6 +27426,7 @@ void QCPBarsGroup::insert(int i, QCPBars *bars)
     bars->setBarsGroup(this);
   // then move to according position:
   mBars.move(mBars.indexOf(bars), qBound(0, i, mBars.size()-1));
+  markBarsDirty();
 }
 
 /*!
@@ -23372,6 +27459,7 @@ void QCPBarsGroup::registerBars(QCPBars *bars)
 {
   if (!mBars.contains(bars))
     mBars.append(bars);
+  markBarsDirty();
 }
 
 /*! \internal
@@ -23384,6 +27472,18 @@ void QCPBarsGroup::registerBars(QCPBars *bars)
 void QCPBarsGroup::unregisterBars(QCPBars *bars)
 {
   mBars.removeOne(bars);
+  markBarsDirty();
+}
+
+/*! \internal
+  
+  Marks the layers of all bars in this group as dirty (see \ref QCPLayerable::markLayerDirty),
+  because the position of each bars plottable depends on the group settings and members.
+*/
+void QCPBarsGroup::markBarsDirty()
+{
+  foreach (QCPBars *bars, mBars)
+    bars->markLayerDirty();
 }
 
 /*! \internal
@@ -23688,6 +27788,7 @@ QCPBars::~QCPBars()
 void QCPBars::setData(QSharedPointer<QCPBarsDataContainer> data)
 {
   mDataContainer = data;
+  markLayerDirty();
 }
 
 /*! \overload
@@ -23705,6 +27806,7 @@ void QCPBars::setData(const QVector<double> &keys, const QVector<double> &values
 {
   mDataContainer->clear();
   addData(keys, values, alreadySorted);
+  markLayerDirty();
 }
 
 /*!
@@ -23716,6 +27818,7 @@ void QCPBars::setData(const QVector<double> &keys, const QVector<double> &values
 void QCPBars::setWidth(double width)
 {
   mWidth = width;
+  markLayerDirty();
 }
 
 /*!
@@ -23729,6 +27832,7 @@ void QCPBars::setWidth(double width)
 void QCPBars::setWidthType(QCPBars::WidthType widthType)
 {
   mWidthType = widthType;
+  markLayerDirty();
 }
 
 /*!
@@ -23763,6 +27867,7 @@ void QCPBars::setBarsGroup(QCPBarsGroup *barsGroup)
 void QCPBars::setBaseValue(double baseValue)
 {
   mBaseValue = baseValue;
+  markLayerDirty();
 }
 
 /*!
@@ -23773,6 +27878,7 @@ void QCPBars::setBaseValue(double baseValue)
 void QCPBars::setStackingGap(double pixels)
 {
   mStackingGap = pixels;
+  markLayerDirty();
 }
 
 /*! \overload
@@ -23833,6 +27939,7 @@ void QCPBars::addData(double key, double value)
 */
 void QCPBars::moveBelow(QCPBars *bars)
 {
+  markLayerDirty();
   if (bars == this) return;
   if (bars && (bars->keyAxis() != mKeyAxis.data() || bars->valueAxis() != mValueAxis.data()))
   {
@@ -23866,6 +27973,7 @@ void QCPBars::moveBelow(QCPBars *bars)
 */
 void QCPBars::moveAbove(QCPBars *bars)
 {
+  markLayerDirty();
   if (bars == this) return;
   if (bars && (bars->keyAxis() != mKeyAxis.data() || bars->valueAxis() != mValueAxis.data()))
   {
@@ -23906,6 +28014,20 @@ QCPDataSelection QCPBars::selectTestRect(const QRectF &rect, bool onlySelectable
   return result;
 }
 
+/*!
+  Additionally takes the bars below (\ref moveAbove) into account, because they determine the
+  base of this bars plottable.
+  
+  \seebaseclassmethod
+*/
+quint64 QCPBars::contentRevision() const
+{
+  quint64 result = QCPAbstractPlottable1D<QCPBarsData>::contentRevision();
+  if (mBarBelow)
+    result += mBarBelow.data()->contentRevision();
+  return result;
+}
+
 /*!
   Implements a selectTest specific to this plottable's point geometry.
 
@@ -24085,7 +28207,9 @@ void QCPBars::draw(QCPPainter *painter)
         painter->setPen(mPen);
       }
       applyDefaultAntialiasingHint(painter);
-      painter->drawPolygon(getBarRect(it->key, it->value));
+      const QRectF barRect = getBarRect(it->key, it->value);
+      const QPointF barPolygon[4] = {barRect.topLeft(), barRect.topRight(), barRect.bottomRight(), barRect.bottomLeft()}; // avoids a temporary QPolygonF per bar
+      painter->drawPolygon(barPolygon, 4);
     }
   }
   
@@ -24564,6 +28688,7 @@ QCPStatisticalBox::QCPStatisticalBox(QCPAxis *keyAxis, QCPAxis *valueAxis) :
 void QCPStatisticalBox::setData(QSharedPointer<QCPStatisticalBoxDataContainer> data)
 {
   mDataContainer = data;
+  markLayerDirty();
 }
 /*! \overload
   
@@ -24580,6 +28705,7 @@ void QCPStatisticalBox::setData(const QVector<double> &keys, const QVector<doubl
 {
   mDataContainer->clear();
   addData(keys, minimum, lowerQuartile, median, upperQuartile, maximum, alreadySorted);
+  markLayerDirty();
 }
 
 /*!
@@ -24590,6 +28716,7 @@ void QCPStatisticalBox::setData(const QVector<double> &keys, const QVector<doubl
 void QCPStatisticalBox::setWidth(double width)
 {
   mWidth = width;
+  markLayerDirty();
 }
 
 /*!
@@ -24603,6 +28730,7 @@ void QCPStatisticalBox::setWidth(double width)
 void QCPStatisticalBox::setWhiskerWidth(double width)
 {
   mWhiskerWidth = width;
+  markLayerDirty();
 }
 
 /*!
@@ -24619,6 +28747,7 @@ void QCPStatisticalBox::setWhiskerWidth(double width)
 void QCPStatisticalBox::setWhiskerPen(const QPen &pen)
 {
   mWhiskerPen = pen;
+  markLayerDirty();
 }
 
 /*!
@@ -24633,6 +28762,7 @@ void QCPStatisticalBox::setWhiskerPen(const QPen &pen)
 void QCPStatisticalBox::setWhiskerBarPen(const QPen &pen)
 {
   mWhiskerBarPen = pen;
+  markLayerDirty();
 }
 
 /*!
@@ -24644,6 +28774,7 @@ void QCPStatisticalBox::setWhiskerBarPen(const QPen &pen)
 void QCPStatisticalBox::setWhiskerAntialiased(bool enabled)
 {
   mWhiskerAntialiased = enabled;
+  markLayerDirty();
 }
 
 /*!
@@ -24652,6 +28783,7 @@ void QCPStatisticalBox::setWhiskerAntialiased(bool enabled)
 void QCPStatisticalBox::setMedianPen(const QPen &pen)
 {
   mMedianPen = pen;
+  markLayerDirty();
 }
 
 /*!
@@ -24663,6 +28795,7 @@ void QCPStatisticalBox::setMedianPen(const QPen &pen)
 void QCPStatisticalBox::setOutlierStyle(const QCPScatterStyle &style)
 {
   mOutlierStyle = style;
+  markLayerDirty();
 }
 
 /*! \overload
@@ -25031,7 +29164,30 @@ QVector<QLineF> QCPStatisticalBox::getWhiskerBarLines(QCPStatisticalBoxDataConta
   given by \ref recalculateDataBounds, such that you can decide when it is sensible to find the
   true current minimum and maximum. The method QCPColorMap::rescaleDataRange offers a convenience
   parameter \a recalculateDataBounds which may be set to true to automatically call \ref
-  recalculateDataBounds internally.
+  recalculateDataBounds internally. The map keeps track of whether a cell holding one of the
+  buffered extremes was overwritten, so \ref recalculateDataBounds only scans the data if the
+  buffered bounds may actually be outdated. How NaN cells are treated in the data bounds is
+  controlled with \ref setIgnoreNaN.
+  
+  Further, the bounding rectangle of all cells modified via \ref setCell, \ref setData or \ref
+  setAlpha is tracked. The \ref QCPColorMap then only recolorizes this part of its map image on the
+  next replot. So if only a few rows or columns change between replots (e.g. for live data), the
+  cost of the image update is proportional to the modified region instead of the entire map.
+  
+  For scrolling displays such as spectrogram waterfalls, use \ref appendRow. It replaces the oldest
+  key index with a new row of values and shifts the key range by one cell, without moving any of
+  the other cells in memory. The data is stored as a ring buffer in the key dimension for this
+  purpose, which is transparent to all accessors (they always use the logical key index). The
+  corresponding \ref QCPColorMap only colorizes the new row and draws its map image in two parts.
+  
+  By default, the cells are stored as double values. For large maps, the memory footprint and the
+  memory bandwidth needed to colorize the map can be reduced with \ref setCellType: \ref ctFloat
+  halves the size of the data array, and \ref ctUInt16 quarters it, with the cell values being
+  mapped to the 16 bit integers via a linear scaling (\ref setUInt16Scaling). The latter is
+  typically a natural fit for data acquired from sensors or cameras. All accessors keep working
+  with double values and convert on the fly, while the colorization and \ref recalculateDataBounds
+  work on the stored type directly. Frames in the native format can be copied into the map at
+  once with \ref setRawCells.
 */
 
 /* start of documentation of inline functions */
@@ -25042,6 +29198,20 @@ QVector<QLineF> QCPStatisticalBox::getWhiskerBarLines(QCPStatisticalBoxDataConta
   one of the dimensions is 0 (see \ref setSize).
 */
 
+/*! \fn CellType QCPColorMapData::cellType() const
+  
+  Returns the type in which the cells are stored.
+  
+  \see setCellType
+*/
+
+/*! \fn bool QCPColorMapData::ignoreNaN() const
+  
+  Returns whether NaN cells are skipped when determining the data bounds.
+  
+  \see setIgnoreNaN
+*/
+
 /* end of documentation of inline functions */
 
 /*!
@@ -25057,9 +29227,19 @@ QCPColorMapData::QCPColorMapData(int keySize, int valueSize, const QCPRange &key
   mKeyRange(keyRange),
   mValueRange(valueRange),
   mIsEmpty(true),
+  mCellType(ctDouble),
+  mUInt16Scale(1),
+  mUInt16Offset(0),
+  mIgnoreNaN(true),
   mData(0),
+  mFloatData(0),
+  mUInt16Data(0),
   mAlpha(0),
-  mDataModified(true)
+  mDataBoundsExact(false),
+  mDataModified(true),
+  mKeyIndexOffset(0),
+  mRevision(0),
+  mDisplayRevision(0)
 {
   setSize(keySize, valueSize);
   fill(0);
@@ -25067,8 +29247,7 @@ QCPColorMapData::QCPColorMapData(int keySize, int valueSize, const QCPRange &key
 
 QCPColorMapData::~QCPColorMapData()
 {
-  if (mData)
-    delete[] mData;
+  freeCells();
   if (mAlpha)
     delete[] mAlpha;
 }
@@ -25080,16 +29259,26 @@ QCPColorMapData::QCPColorMapData(const QCPColorMapData &other) :
   mKeySize(0),
   mValueSize(0),
   mIsEmpty(true),
+  mCellType(ctDouble),
+  mUInt16Scale(1),
+  mUInt16Offset(0),
+  mIgnoreNaN(true),
   mData(0),
+  mFloatData(0),
+  mUInt16Data(0),
   mAlpha(0),
-  mDataModified(true)
+  mDataBoundsExact(false),
+  mDataModified(true),
+  mKeyIndexOffset(0),
+  mRevision(0),
+  mDisplayRevision(0)
 {
   *this = other;
 }
 
 /*!
-  Overwrites this color map data instance with the data stored in \a other. The alpha map state is
-  transferred, too.
+  Overwrites this color map data instance with the data stored in \a other. The alpha map state and
+  the cell type are transferred, too.
 */
 QCPColorMapData &QCPColorMapData::operator=(const QCPColorMapData &other)
 {
@@ -25099,18 +29288,38 @@ QCPColorMapData &QCPColorMapData::operator=(const QCPColorMapData &other)
     const int valueSize = other.valueSize();
     if (!other.mAlpha && mAlpha)
       clearAlpha();
+    if (other.mCellType != mCellType)
+    {
+      // switch storage type without converting the current cells, they are overwritten below anyway:
+      freeCells();
+      mCellType = other.mCellType;
+      if (!isEmpty())
+        allocateCells();
+    }
+    mUInt16Scale = other.mUInt16Scale;
+    mUInt16Offset = other.mUInt16Offset;
+    mIgnoreNaN = other.mIgnoreNaN;
     setSize(keySize, valueSize);
     if (other.mAlpha && !mAlpha)
       createAlpha(false);
     setRange(other.keyRange(), other.valueRange());
     if (!isEmpty())
     {
-      memcpy(mData, other.mData, sizeof(mData[0])*keySize*valueSize);
+      if (mData && other.mData)
+        memcpy(mData, other.mData, sizeof(mData[0])*keySize*valueSize);
+      else if (mFloatData && other.mFloatData)
+        memcpy(mFloatData, other.mFloatData, sizeof(mFloatData[0])*keySize*valueSize);
+      else if (mUInt16Data && other.mUInt16Data)
+        memcpy(mUInt16Data, other.mUInt16Data, sizeof(mUInt16Data[0])*keySize*valueSize);
       if (mAlpha)
         memcpy(mAlpha, other.mAlpha, sizeof(mAlpha[0])*keySize*valueSize);
     }
     mDataBounds = other.mDataBounds;
+    mDataBoundsExact = other.mDataBoundsExact;
     mDataModified = true;
+    ++mRevision;
+    mDirtyCells = QRect(0, 0, mKeySize, mValueSize);
+    mKeyIndexOffset = other.mKeyIndexOffset;
   }
   return *this;
 }
@@ -25121,7 +29330,7 @@ double QCPColorMapData::data(double key, double value)
   int keyCell = (key-mKeyRange.lower)/(mKeyRange.upper-mKeyRange.lower)*(mKeySize-1)+0.5;
   int valueCell = (value-mValueRange.lower)/(mValueRange.upper-mValueRange.lower)*(mValueSize-1)+0.5;
   if (keyCell >= 0 && keyCell < mKeySize && valueCell >= 0 && valueCell < mValueSize)
-    return mData[valueCell*mKeySize + keyCell];
+    return storedCell(valueCell*mKeySize + storageKeyIndex(keyCell));
   else
     return 0;
 }
@@ -25130,7 +29339,7 @@ double QCPColorMapData::data(double key, double value)
 double QCPColorMapData::cell(int keyIndex, int valueIndex)
 {
   if (keyIndex >= 0 && keyIndex < mKeySize && valueIndex >= 0 && valueIndex < mValueSize)
-    return mData[valueIndex*mKeySize + keyIndex];
+    return storedCell(valueIndex*mKeySize + storageKeyIndex(keyIndex));
   else
     return 0;
 }
@@ -25146,7 +29355,7 @@ double QCPColorMapData::cell(int keyIndex, int valueIndex)
 unsigned char QCPColorMapData::alpha(int keyIndex, int valueIndex)
 {
   if (mAlpha && keyIndex >= 0 && keyIndex < mKeySize && valueIndex >= 0 && valueIndex < mValueSize)
-    return mAlpha[valueIndex*mKeySize + keyIndex];
+    return mAlpha[valueIndex*mKeySize + storageKeyIndex(keyIndex)];
   else
     return 255;
 }
@@ -25169,29 +29378,17 @@ void QCPColorMapData::setSize(int keySize, int valueSize)
   {
     mKeySize = keySize;
     mValueSize = valueSize;
-    if (mData)
-      delete[] mData;
     mIsEmpty = mKeySize == 0 || mValueSize == 0;
-    if (!mIsEmpty)
-    {
-#ifdef __EXCEPTIONS
-      try { // 2D arrays get memory intensive fast. So if the allocation fails, at least output debug message
-#endif
-      mData = new double[mKeySize*mValueSize];
-#ifdef __EXCEPTIONS
-      } catch (...) { mData = 0; }
-#endif
-      if (mData)
-        fill(0);
-      else
-        qDebug() << Q_FUNC_INFO << "out of memory for data dimensions "<< mKeySize << "*" << mValueSize;
-    } else
-      mData = 0;
+    if (allocateCells())
+      fill(0);
     
     if (mAlpha) // if we had an alpha map, recreate it with new size
       createAlpha();
     
     mDataModified = true;
+    ++mRevision;
+    mDirtyCells = QRect(0, 0, mKeySize, mValueSize);
+    mKeyIndexOffset = 0;
   }
 }
 
@@ -25254,6 +29451,7 @@ void QCPColorMapData::setRange(const QCPRange &keyRange, const QCPRange &valueRa
 void QCPColorMapData::setKeyRange(const QCPRange &keyRange)
 {
   mKeyRange = keyRange;
+  ++mDisplayRevision;
 }
 
 /*!
@@ -25269,6 +29467,7 @@ void QCPColorMapData::setKeyRange(const QCPRange &keyRange)
 void QCPColorMapData::setValueRange(const QCPRange &valueRange)
 {
   mValueRange = valueRange;
+  ++mDisplayRevision;
 }
 
 /*!
@@ -25289,12 +29488,14 @@ void QCPColorMapData::setData(double key, double value, double z)
   int valueCell = (value-mValueRange.lower)/(mValueRange.upper-mValueRange.lower)*(mValueSize-1)+0.5;
   if (keyCell >= 0 && keyCell < mKeySize && valueCell >= 0 && valueCell < mValueSize)
   {
-    mData[valueCell*mKeySize + keyCell] = z;
-    if (z < mDataBounds.lower)
-      mDataBounds.lower = z;
-    if (z > mDataBounds.upper)
-      mDataBounds.upper = z;
+    keyCell = storageKeyIndex(keyCell);
+    const int index = valueCell*mKeySize + keyCell;
+    const double oldZ = storedCell(index);
+    storeCell(index, z);
+    updateDataBounds(oldZ, storedCell(index));
      mDataModified = true;
+     ++mRevision;
+     mDirtyCells |= QRect(keyCell, valueCell, 1, 1);
   }
 }
 
@@ -25313,12 +29514,14 @@ void QCPColorMapData::setCell(int keyIndex, int valueIndex, double z)
 {
   if (keyIndex >= 0 && keyIndex < mKeySize && valueIndex >= 0 && valueIndex < mValueSize)
   {
-    mData[valueIndex*mKeySize + keyIndex] = z;
-    if (z < mDataBounds.lower)
-      mDataBounds.lower = z;
-    if (z > mDataBounds.upper)
-      mDataBounds.upper = z;
+    keyIndex = storageKeyIndex(keyIndex);
+    const int index = valueIndex*mKeySize + keyIndex;
+    const double oldZ = storedCell(index);
+    storeCell(index, z);
+    updateDataBounds(oldZ, storedCell(index));
      mDataModified = true;
+     ++mRevision;
+     mDirtyCells |= QRect(keyIndex, valueIndex, 1, 1);
   } else
     qDebug() << Q_FUNC_INFO << "index out of bounds:" << keyIndex << valueIndex;
 }
@@ -25344,13 +29547,171 @@ void QCPColorMapData::setAlpha(int keyIndex, int valueIndex, unsigned char alpha
   {
     if (mAlpha || createAlpha())
     {
+      keyIndex = storageKeyIndex(keyIndex);
       mAlpha[valueIndex*mKeySize + keyIndex] = alpha;
       mDataModified = true;
+      ++mDisplayRevision;
+      mDirtyCells |= QRect(keyIndex, valueIndex, 1, 1);
     }
   } else
     qDebug() << Q_FUNC_INFO << "index out of bounds:" << keyIndex << valueIndex;
 }
 
+/*!
+  Sets the type in which the cells are stored. The existing cell values are converted to the new
+  type, so values which can't be represented by the new type lose precision or are clamped. For
+  \ref ctUInt16, make sure to configure the scaling with \ref setUInt16Scaling before switching
+  the type, so the converted values are quantized sensibly.
+  
+  Smaller cell types reduce the memory footprint of the map and speed up the colorization, because
+  less data has to be read from memory. \ref QCPColorGradient::colorize and \ref
+  recalculateDataBounds process the stored type directly, without intermediate conversion.
+  
+  \see setRawCells
+*/
+void QCPColorMapData::setCellType(CellType type)
+{
+  if (type == mCellType)
+    return;
+  
+  const CellType oldType = mCellType;
+  double *oldData = mData;
+  float *oldFloatData = mFloatData;
+  quint16 *oldUInt16Data = mUInt16Data;
+  mData = 0;
+  mFloatData = 0;
+  mUInt16Data = 0;
+  mCellType = type;
+  if (!isEmpty())
+  {
+    if (!allocateCells())
+    {
+      // keep old storage, so the data isn't lost:
+      mCellType = oldType;
+      mData = oldData;
+      mFloatData = oldFloatData;
+      mUInt16Data = oldUInt16Data;
+      return;
+    }
+    const int dataCount = mKeySize*mValueSize;
+    if (oldData)
+    {
+      for (int i=0; i<dataCount; ++i)
+        storeCell(i, oldData[i]);
+    } else if (oldFloatData)
+    {
+      for (int i=0; i<dataCount; ++i)
+        storeCell(i, oldFloatData[i]);
+    } else if (oldUInt16Data)
+    {
+      for (int i=0; i<dataCount; ++i)
+        storeCell(i, oldUInt16Data[i]*mUInt16Scale+mUInt16Offset);
+    }
+    mDataBoundsExact = false; // conversion may have changed the extremes
+    recalculateDataBounds();
+  }
+  delete[] oldData;
+  delete[] oldFloatData;
+  delete[] oldUInt16Data;
+  mDataModified = true;
+  ++mRevision;
+  mDirtyCells = QRect(0, 0, mKeySize, mValueSize);
+}
+
+/*!
+  Sets the linear scaling which maps the stored 16 bit integers to cell values, if the cell type is
+  \ref ctUInt16: A stored value \a raw represents the cell value <tt>raw*scale + offset</tt>.
+  Accordingly, the representable cell values range from \a offset to <tt>65535*scale +
+  offset</tt>, in steps of \a scale. Cell values set via \ref setCell, \ref setData etc. are
+  rounded to the nearest step and clamped to this range.
+  
+  For camera or sensor frames, this typically is the conversion of the digital counts to the
+  physical unit. The default is a scale of 1 and an offset of 0, so the cells hold the integers
+  directly.
+  
+  The stored integers are not touched by this method, i.e. if the cell type already is \ref
+  ctUInt16, changing the scaling changes the cell values.
+  
+  \see setCellType
+*/
+void QCPColorMapData::setUInt16Scaling(double scale, double offset)
+{
+  if (scale == 0)
+  {
+    qDebug() << Q_FUNC_INFO << "scale must not be zero";
+    return;
+  }
+  mUInt16Scale = scale;
+  mUInt16Offset = offset;
+  if (mCellType == ctUInt16)
+  {
+    mDataBoundsExact = false;
+    recalculateDataBounds();
+    mDataModified = true;
+    ++mRevision;
+    mDirtyCells = QRect(0, 0, mKeySize, mValueSize);
+  }
+}
+
+/*!
+  Sets whether cells containing NaN are skipped when determining the data bounds (see \ref
+  dataBounds and \ref recalculateDataBounds).
+  
+  If \a enabled is true (the default), NaN cells are ignored, so the data bounds span the numeric
+  cells only. This is useful if NaN marks missing data. If all cells are NaN, the data bounds are
+  empty (lower is +infinity and upper is -infinity). Since that's not a valid range either, \ref
+  QCPColorMap::rescaleDataRange then leaves the data range untouched.
+  
+  If \a enabled is false, a single NaN cell makes both data bounds NaN. Since NaN is not a valid
+  range, \ref QCPColorMap::rescaleDataRange then leaves the data range untouched.
+  
+  This setting only affects the data bounds, not how NaN cells are drawn.
+*/
+void QCPColorMapData::setIgnoreNaN(bool enabled)
+{
+  if (mIgnoreNaN != enabled)
+  {
+    mIgnoreNaN = enabled;
+    mDataBoundsExact = false;
+  }
+}
+
+/*!
+  Copies \ref keySize * \ref valueSize cells from \a cells to the map at once. \a cells holds the
+  cells in the same order as the map, i.e. <tt>cells[valueIndex*keySize + keyIndex]</tt>, and is
+  copied into the internal storage without any conversion. Therefore the type of \a cells must
+  match the cell type (\ref setCellType).
+  
+  This is the fastest way to fill an entire map, e.g. with a new camera frame. Afterwards, the
+  data bounds are recalculated (see \ref recalculateDataBounds).
+  
+  \see setCell
+*/
+void QCPColorMapData::setRawCells(const double *cells)
+{
+  copyRawCells(ctDouble, mData, cells);
+}
+
+/*! \overload
+  
+  Copies the cells from the single precision array \a cells, the cell type must be \ref ctFloat.
+*/
+void QCPColorMapData::setRawCells(const float *cells)
+{
+  copyRawCells(ctFloat, mFloatData, cells);
+}
+
+/*! \overload
+  
+  Copies the cells from the 16 bit integer array \a cells, the cell type must be \ref ctUInt16.
+  The cell values are given by the integers with the scaling configured via \ref
+  setUInt16Scaling.
+*/
+void QCPColorMapData::setRawCells(const quint16 *cells)
+{
+  copyRawCells(ctUInt16, mUInt16Data, cells);
+}
+
 /*!
   Goes through the data and updates the buffered minimum and maximum data values.
   
@@ -25363,24 +29724,67 @@ void QCPColorMapData::setAlpha(int keyIndex, int valueIndex, unsigned char alpha
   Note that the method \ref QCPColorMap::rescaleDataRange provides a parameter \a
   recalculateDataBounds for convenience. Setting this to true will call this method for you, before
   doing the rescale.
+  
+  If no cell holding one of the buffered extremes was overwritten since the last scan, the buffered
+  bounds are still exact and this method returns immediately. Otherwise the cells are scanned in
+  their stored type (see \ref setCellType), distributed over multiple threads for large maps.
+  
+  If all cells are NaN and NaN cells are ignored (\ref setIgnoreNaN), the resulting bounds are
+  empty, see \ref setEmptyDataBounds.
 */
 void QCPColorMapData::recalculateDataBounds()
 {
-  if (mKeySize > 0 && mValueSize > 0)
+  if (mDataBoundsExact || isEmpty())
+    return;
+  
+  bool found = false;
+  bool hasNaN = false;
+  double lower = 0, upper = 0;
+  if (mData)
   {
-    double minHeight = mData[0];
-    double maxHeight = mData[0];
-    const int dataCount = mValueSize*mKeySize;
-    for (int i=0; i<dataCount; ++i)
+    found = cellBounds(mData, lower, upper, hasNaN);
+  } else if (mFloatData)
+  {
+    float minValue = 0, maxValue = 0;
+    if ((found = cellBounds(mFloatData, minValue, maxValue, hasNaN)))
     {
-      if (mData[i] > maxHeight)
-        maxHeight = mData[i];
-      if (mData[i] < minHeight)
-        minHeight = mData[i];
+      lower = minValue;
+      upper = maxValue;
     }
-    mDataBounds.lower = minHeight;
-    mDataBounds.upper = maxHeight;
-  }
+  } else if (mUInt16Data)
+  {
+    // find bounds of the raw integers and scale only those two:
+    quint16 minValue = 0, maxValue = 0;
+    if ((found = cellBounds(mUInt16Data, minValue, maxValue, hasNaN)))
+    {
+      lower = qMin(minValue*mUInt16Scale+mUInt16Offset, maxValue*mUInt16Scale+mUInt16Offset);
+      upper = qMax(minValue*mUInt16Scale+mUInt16Offset, maxValue*mUInt16Scale+mUInt16Offset);
+    }
+  } else
+    return; // no cell storage, allocation failed
+  
+  if (hasNaN && !mIgnoreNaN)
+    mDataBounds = QCPRange(qQNaN(), qQNaN());
+  else if (found)
+    mDataBounds = QCPRange(lower, upper);
+  else // all cells are NaN and ignored
+    setEmptyDataBounds();
+  mDataBoundsExact = true;
+}
+
+/*! \internal
+  
+  Sets the buffered data bounds to the empty range, lower +infinity and upper -infinity. This is
+  used when all cells are ignored NaNs. The range is invalid, so rescaling leaves data ranges
+  untouched, and \ref updateDataBounds replaces both bounds with the first numeric value that is
+  set, since any value is smaller than +infinity and larger than -infinity.
+  
+  The members are assigned directly, because the QCPRange constructor would swap them.
+*/
+void QCPColorMapData::setEmptyDataBounds()
+{
+  mDataBounds.lower = qInf();
+  mDataBounds.upper = -qInf();
 }
 
 /*!
@@ -25403,6 +29807,8 @@ void QCPColorMapData::clearAlpha()
     delete[] mAlpha;
     mAlpha = 0;
     mDataModified = true;
+    ++mDisplayRevision;
+    mDirtyCells = QRect(0, 0, mKeySize, mValueSize);
   }
 }
 
@@ -25412,10 +29818,36 @@ void QCPColorMapData::clearAlpha()
 void QCPColorMapData::fill(double z)
 {
   const int dataCount = mValueSize*mKeySize;
-  for (int i=0; i<dataCount; ++i)
-    mData[i] = z;
-  mDataBounds = QCPRange(z, z);
+  if (dataCount > 0 && (mData || mFloatData || mUInt16Data))
+  {
+    storeCell(0, z);
+    z = storedCell(0); // the value the cell type could represent
+    if (mData)
+    {
+      for (int i=1; i<dataCount; ++i)
+        mData[i] = z;
+    } else if (mFloatData)
+    {
+      const float value = mFloatData[0];
+      for (int i=1; i<dataCount; ++i)
+        mFloatData[i] = value;
+    } else
+    {
+      const quint16 value = mUInt16Data[0];
+      for (int i=1; i<dataCount; ++i)
+        mUInt16Data[i] = value;
+    }
+  }
+  if (!qIsNaN(z))
+    mDataBounds = QCPRange(z, z);
+  else if (!mIgnoreNaN)
+    mDataBounds = QCPRange(qQNaN(), qQNaN());
+  else
+    setEmptyDataBounds();
+  mDataBoundsExact = true;
   mDataModified = true;
+  ++mRevision;
+  mDirtyCells = QRect(0, 0, mKeySize, mValueSize);
 }
 
 /*!
@@ -25435,7 +29867,56 @@ void QCPColorMapData::fillAlpha(unsigned char alpha)
     for (int i=0; i<dataCount; ++i)
       mAlpha[i] = alpha;
     mDataModified = true;
+    ++mDisplayRevision;
+    mDirtyCells = QRect(0, 0, mKeySize, mValueSize);
+  }
+}
+
+/*!
+  Appends a new row of data at the upper end of the key range, dropping the row at key index 0.
+  This is typically used for scrolling displays like spectrogram waterfalls, where each new frame
+  (e.g. the result of an FFT) is added as the newest key index.
+  
+  \a values must point to \ref valueSize values, the value at position i is put into the cell at
+  value index i. The key range (\ref setKeyRange) is shifted by one cell width, so the existing cells
+  keep their plot coordinates and the new row is placed one cell beyond the previous upper key
+  range boundary. If an alpha map exists, the new cells are fully opaque.
+  
+  Internally, this doesn't move any data. The row at key index 0 is overwritten in place and the
+  storage is treated as a ring buffer, so the cost of this method is proportional to \ref
+  valueSize only. The color map accordingly only colorizes the new row on the next replot.
+  
+  Like \ref setCell, this method only expands the buffered data bounds, see \ref
+  recalculateDataBounds.
+*/
+void QCPColorMapData::appendRow(const double *values)
+{
+  if (isEmpty())
+    return;
+  if (!values)
+  {
+    qDebug() << Q_FUNC_INFO << "null pointer given as values";
+    return;
   }
+  const int keyIndex = mKeyIndexOffset; // storage position of the oldest row, which is replaced by the new one
+  for (int valueIndex=0; valueIndex<mValueSize; ++valueIndex)
+  {
+    const int index = valueIndex*mKeySize + keyIndex;
+    const double oldZ = storedCell(index);
+    storeCell(index, values[valueIndex]);
+    updateDataBounds(oldZ, storedCell(index));
+  }
+  if (mAlpha)
+  {
+    for (int valueIndex=0; valueIndex<mValueSize; ++valueIndex)
+      mAlpha[valueIndex*mKeySize + keyIndex] = 255;
+  }
+  mKeyIndexOffset = keyIndex+1 < mKeySize ? keyIndex+1 : 0;
+  if (mKeySize > 1)
+    mKeyRange += mKeyRange.size()/(double)(mKeySize-1);
+  mDataModified = true;
+  ++mRevision;
+  mDirtyCells |= QRect(keyIndex, 0, 1, mValueSize);
 }
 
 /*!
@@ -25486,6 +29967,25 @@ void QCPColorMapData::cellToCoord(int keyIndex, int valueIndex, double *key, dou
     *value = valueIndex/(double)(mValueSize-1)*(mValueRange.upper-mValueRange.lower)+mValueRange.lower;
 }
 
+/*!
+  Returns the number of bytes allocated for the cells (depending on the \ref setCellType) and the
+  alpha map.
+*/
+qint64 QCPColorMapData::memoryUsage() const
+{
+  const qint64 cellCount = qint64(mKeySize)*mValueSize;
+  qint64 result = 0;
+  if (mData)
+    result += cellCount*sizeof(double);
+  if (mFloatData)
+    result += cellCount*sizeof(float);
+  if (mUInt16Data)
+    result += cellCount*sizeof(quint16);
+  if (mAlpha)
+    result += cellCount;
+  return result;
+}
+
 /*! \internal
 
   Allocates the internal alpha map with the current data map key/value size and, if \a
@@ -25524,29 +30024,306 @@ bool QCPColorMapData::createAlpha(bool initializeOpaque)
   }
 }
 
+/*! \internal
 
-////////////////////////////////////////////////////////////////////////////////////////////////////
-//////////////////// QCPColorMap
-////////////////////////////////////////////////////////////////////////////////////////////////////
-
-/*! \class QCPColorMap
-  \brief A plottable representing a two-dimensional color map in a plot.
+  Allocates the cell storage of the current cell type (\ref setCellType) with the current key/value
+  size, freeing any previous cell storage first. The cells are not initialized.
 
-  \image html QCPColorMap.png
-  
-  The data is stored in the class \ref QCPColorMapData, which can be accessed via the data()
-  method.
+  Returns true if the map isn't empty and the storage was successfully allocated.
+*/
+bool QCPColorMapData::allocateCells()
+{
+  freeCells();
+  if (isEmpty())
+    return false;
   
-  A color map has three dimensions to represent a data point: The \a key dimension, the \a value
-  dimension and the \a data dimension. As with other plottables such as graphs, \a key and \a value
-  correspond to two orthogonal axes on the QCustomPlot surface that you specify in the QCPColorMap
-  constructor. The \a data dimension however is encoded as the color of the point at (\a key, \a
-  value).
+  const int dataCount = mKeySize*mValueSize;
+#ifdef __EXCEPTIONS
+  try { // 2D arrays get memory intensive fast. So if the allocation fails, at least output debug message
+#endif
+    switch (mCellType)
+    {
+      case ctDouble: mData = new double[dataCount]; break;
+      case ctFloat: mFloatData = new float[dataCount]; break;
+      case ctUInt16: mUInt16Data = new quint16[dataCount]; break;
+    }
+#ifdef __EXCEPTIONS
+  } catch (...) { freeCells(); }
+#endif
+  if (mData || mFloatData || mUInt16Data)
+    return true;
+  qDebug() << Q_FUNC_INFO << "out of memory for data dimensions "<< mKeySize << "*" << mValueSize;
+  return false;
+}
 
-  Set the number of points (or \a cells) in the key/value dimension via \ref
-  QCPColorMapData::setSize. The plot coordinate range over which these points will be displayed is
-  specified via \ref QCPColorMapData::setRange. The first cell will be centered on the lower range
-  boundary and the last cell will be centered on the upper range boundary. The data can be set by
+/*! \internal
+
+  Frees the cell storage, regardless of the cell type.
+*/
+void QCPColorMapData::freeCells()
+{
+  delete[] mData;
+  delete[] mFloatData;
+  delete[] mUInt16Data;
+  mData = 0;
+  mFloatData = 0;
+  mUInt16Data = 0;
+}
+
+/*! \internal
+
+  Returns the value of the cell at the storage position \a index (i.e. after the ring buffer offset
+  was applied, see \ref storageKeyIndex), converted from the cell type to double.
+*/
+double QCPColorMapData::storedCell(int index) const
+{
+  switch (mCellType)
+  {
+    case ctDouble: return mData[index];
+    case ctFloat: return mFloatData[index];
+    case ctUInt16: return mUInt16Data[index]*mUInt16Scale+mUInt16Offset;
+  }
+  return 0;
+}
+
+/*! \internal
+
+  Sets the cell at the storage position \a index to \a z, converted to the cell type. For \ref
+  ctUInt16, the value is rounded to the nearest integer step of the scaling and clamped to the
+  range of 16 bit unsigned integers. NaN is stored as 0.
+*/
+void QCPColorMapData::storeCell(int index, double z)
+{
+  switch (mCellType)
+  {
+    case ctDouble: mData[index] = z; break;
+    case ctFloat: mFloatData[index] = (float)z; break;
+    case ctUInt16:
+    {
+      const double raw = (z-mUInt16Offset)/mUInt16Scale+0.5;
+      mUInt16Data[index] = !(raw > 0) ? 0 : (raw >= 65535 ? 65535 : (quint16)raw); // negated comparison also catches NaN
+      break;
+    }
+  }
+}
+
+/*! \internal
+
+  Implements \ref setRawCells: Copies the cells from \a cells to \a storage, which is the cell
+  storage for the cell type \a type. Does nothing if the map has a different cell type.
+*/
+template <typename CellValueType>
+void QCPColorMapData::copyRawCells(CellType type, CellValueType *storage, const CellValueType *cells)
+{
+  if (!cells)
+  {
+    qDebug() << Q_FUNC_INFO << "null pointer given as cells";
+    return;
+  }
+  if (type != mCellType)
+  {
+    qDebug() << Q_FUNC_INFO << "type of cells doesn't match cell type" << mCellType;
+    return;
+  }
+  if (isEmpty() || !storage)
+    return;
+  
+  memcpy(storage, cells, sizeof(CellValueType)*mKeySize*mValueSize);
+  mKeyIndexOffset = 0; // the given cells are in logical order, so the ring buffer starts over
+  mDataBoundsExact = false;
+  recalculateDataBounds();
+  mDataModified = true;
+  ++mRevision;
+  mDirtyCells = QRect(0, 0, mKeySize, mValueSize);
+}
+
+/*! \internal
+
+  Updates the buffered data bounds after a cell which held \a oldZ was set to \a newZ. The bounds
+  are expanded to include \a newZ. If the old value was one of the buffered extremes and the new
+  value doesn't reach it anymore, the true bounds may have shrunk, so the bounds are marked as not
+  exact and the next \ref recalculateDataBounds performs a full scan.
+*/
+void QCPColorMapData::updateDataBounds(double oldZ, double newZ)
+{
+  if (mDataBoundsExact)
+  {
+    if (qIsNaN(oldZ))
+      mDataBoundsExact = mIgnoreNaN; // the NaN which made the bounds NaN might have been the last one
+    else if ((oldZ == mDataBounds.lower && !(newZ <= oldZ)) || (oldZ == mDataBounds.upper && !(newZ >= oldZ)))
+      mDataBoundsExact = false;
+  }
+  if (qIsNaN(newZ))
+  {
+    if (!mIgnoreNaN)
+      mDataBounds = QCPRange(qQNaN(), qQNaN());
+  } else
+  {
+    if (newZ < mDataBounds.lower)
+      mDataBounds.lower = newZ;
+    if (newZ > mDataBounds.upper)
+      mDataBounds.upper = newZ;
+  }
+}
+
+/*! \internal
+  
+  Determines the minimum and maximum of a block of color map cells, as part of \ref
+  QCPColorMapData::recalculateDataBounds. The cells are split into blocks of \ref blockSize
+  elements, and the function call operator processes the blocks [\a begin, \a end), so instances
+  can be passed to \ref qcpParallelFor. Each block writes its result to its own slot of the result
+  arrays, which are merged by the caller afterwards.
+*/
+template <typename CellValueType>
+class QCPColorMapBoundsFunctor
+{
+public:
+  QCPColorMapBoundsFunctor(const CellValueType *cells, int count, CellValueType *minValues, CellValueType *maxValues, char *found, char *hasNaN) :
+    mCells(cells), mCount(count), mMinValues(minValues), mMaxValues(maxValues), mFound(found), mHasNaN(hasNaN)
+  {}
+  
+  static int blockSize() { return 65536; }
+  
+  void operator()(int begin, int end) const
+  {
+    for (int block=begin; block<end; ++block)
+    {
+      const int first = block*blockSize();
+      bool hasNaN = false;
+      mFound[block] = scan(mCells+first, qMin(blockSize(), mCount-first), mMinValues[block], mMaxValues[block], hasNaN);
+      mHasNaN[block] = hasNaN;
+    }
+  }
+  
+  /*
+    Finds the minimum and maximum of the count elements of cells, ignoring NaN. Returns false if
+    there are no numeric elements. hasNaN is set to whether NaN elements were encountered.
+    
+    The elements are processed in a number of independent lanes with branchless min/max updates,
+    which the compiler turns into SIMD min/max instructions. A NaN element never replaces a lane
+    value, because all comparisons with NaN are false. Therefore the lanes only have to be
+    initialized with a number.
+  */
+  static bool scan(const CellValueType *cells, int count, CellValueType &minValue, CellValueType &maxValue, bool &hasNaN)
+  {
+    const int laneCount = 8;
+    int i = 0;
+    while (i < count && isNaN(cells[i])) // skip leading NaNs
+      ++i;
+    hasNaN = i > 0;
+    if (i == count)
+      return false;
+    
+    CellValueType lower[laneCount], upper[laneCount];
+    bool nan[laneCount];
+    for (int lane=0; lane<laneCount; ++lane)
+    {
+      lower[lane] = cells[i];
+      upper[lane] = cells[i];
+      nan[lane] = false;
+    }
+    const int vectorEnd = i+(count-i)/laneCount*laneCount;
+    for (; i<vectorEnd; i+=laneCount)
+    {
+      for (int lane=0; lane<laneCount; ++lane)
+      {
+        const CellValueType value = cells[i+lane];
+        lower[lane] = value < lower[lane] ? value : lower[lane];
+        upper[lane] = value > upper[lane] ? value : upper[lane];
+        nan[lane] |= isNaN(value);
+      }
+    }
+    for (; i<count; ++i)
+    {
+      const CellValueType value = cells[i];
+      lower[0] = value < lower[0] ? value : lower[0];
+      upper[0] = value > upper[0] ? value : upper[0];
+      nan[0] |= isNaN(value);
+    }
+    minValue = lower[0];
+    maxValue = upper[0];
+    for (int lane=0; lane<laneCount; ++lane)
+    {
+      if (lower[lane] < minValue)
+        minValue = lower[lane];
+      if (upper[lane] > maxValue)
+        maxValue = upper[lane];
+      hasNaN |= nan[lane];
+    }
+    return true;
+  }
+  
+private:
+  static bool isNaN(double value) { return qIsNaN(value); }
+  static bool isNaN(float value) { return qIsNaN(value); }
+  static bool isNaN(quint16) { return false; }
+  
+  const CellValueType *mCells;
+  int mCount;
+  CellValueType *mMinValues, *mMaxValues;
+  char *mFound, *mHasNaN;
+};
+
+/*! \internal
+
+  Determines the minimum and maximum of the \ref keySize * \ref valueSize elements of \a cells,
+  in the native cell type (i.e. without scaling of \ref ctUInt16 cells), ignoring NaN. Returns
+  false if there are no numeric cells. \a hasNaN is set to whether NaN cells were encountered.
+  
+  Large maps are split into blocks which are scanned concurrently, see \ref
+  QCPColorMapBoundsFunctor.
+*/
+template <typename CellValueType>
+bool QCPColorMapData::cellBounds(const CellValueType *cells, CellValueType &minValue, CellValueType &maxValue, bool &hasNaN) const
+{
+  typedef QCPColorMapBoundsFunctor<CellValueType> Functor;
+  const int dataCount = mValueSize*mKeySize;
+  const int blockCount = (dataCount+Functor::blockSize()-1)/Functor::blockSize();
+  if (blockCount <= 1)
+    return Functor::scan(cells, dataCount, minValue, maxValue, hasNaN);
+  
+  QVector<CellValueType> minValues(blockCount), maxValues(blockCount);
+  QVector<char> found(blockCount), blockHasNaN(blockCount);
+  qcpParallelFor(blockCount, 1, Functor(cells, dataCount, minValues.data(), maxValues.data(), found.data(), blockHasNaN.data()));
+  bool anyFound = false;
+  hasNaN = false;
+  for (int block=0; block<blockCount; ++block)
+  {
+    hasNaN |= blockHasNaN.at(block) != 0;
+    if (!found.at(block))
+      continue;
+    if (!anyFound || minValues.at(block) < minValue)
+      minValue = minValues.at(block);
+    if (!anyFound || maxValues.at(block) > maxValue)
+      maxValue = maxValues.at(block);
+    anyFound = true;
+  }
+  return anyFound;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPColorMap
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPColorMap
+  \brief A plottable representing a two-dimensional color map in a plot.
+
+  \image html QCPColorMap.png
+  
+  The data is stored in the class \ref QCPColorMapData, which can be accessed via the data()
+  method.
+  
+  A color map has three dimensions to represent a data point: The \a key dimension, the \a value
+  dimension and the \a data dimension. As with other plottables such as graphs, \a key and \a value
+  correspond to two orthogonal axes on the QCustomPlot surface that you specify in the QCPColorMap
+  constructor. The \a data dimension however is encoded as the color of the point at (\a key, \a
+  value).
+
+  Set the number of points (or \a cells) in the key/value dimension via \ref
+  QCPColorMapData::setSize. The plot coordinate range over which these points will be displayed is
+  specified via \ref QCPColorMapData::setRange. The first cell will be centered on the lower range
+  boundary and the last cell will be centered on the upper range boundary. The data can be set by
   either accessing the cells directly with QCPColorMapData::setCell or by addressing the cells via
   their plot coordinates with \ref QCPColorMapData::setData. If possible, you should prefer
   setCell, since it doesn't need to do any coordinate transformation and thus performs a bit
@@ -25655,7 +30432,8 @@ QCPColorMap::QCPColorMap(QCPAxis *keyAxis, QCPAxis *valueAxis) :
   mGradient(QCPColorGradient::gpCold),
   mInterpolate(true),
   mTightBoundary(false),
-  mMapImageInvalidated(true)
+  mMapImageInvalidated(true),
+  mMapImageTransposed(false)
 {
 }
 
@@ -25673,6 +30451,7 @@ QCPColorMap::~QCPColorMap()
 */
 void QCPColorMap::setData(QCPColorMapData *data, bool copy)
 {
+  markLayerDirty();
   if (mMapData == data)
   {
     qDebug() << Q_FUNC_INFO << "The data pointer is already in (and owned by) this plottable" << reinterpret_cast<quintptr>(data);
@@ -25707,6 +30486,7 @@ void QCPColorMap::setDataRange(const QCPRange &dataRange)
     else
       mDataRange = dataRange.sanitizedForLinScale();
     mMapImageInvalidated = true;
+    markLayerDirty();
     emit dataRangeChanged(mDataRange);
   }
 }
@@ -25725,6 +30505,7 @@ void QCPColorMap::setDataScaleType(QCPAxis::ScaleType scaleType)
     emit dataScaleTypeChanged(mDataScaleType);
     if (mDataScaleType == QCPAxis::stLogarithmic)
       setDataRange(mDataRange.sanitizedForLogScale());
+    markLayerDirty();
   }
 }
 
@@ -25746,6 +30527,7 @@ void QCPColorMap::setGradient(const QCPColorGradient &gradient)
     mGradient = gradient;
     mMapImageInvalidated = true;
     emit gradientChanged(mGradient);
+    markLayerDirty();
   }
 }
 
@@ -25759,6 +30541,7 @@ void QCPColorMap::setInterpolate(bool enabled)
 {
   mInterpolate = enabled;
   mMapImageInvalidated = true; // because oversampling factors might need to change
+  markLayerDirty();
 }
 
 /*!
@@ -25775,6 +30558,7 @@ void QCPColorMap::setInterpolate(bool enabled)
 void QCPColorMap::setTightBoundary(bool enabled)
 {
   mTightBoundary = enabled;
+  markLayerDirty();
 }
 
 /*!
@@ -25815,6 +30599,7 @@ void QCPColorMap::setColorScale(QCPColorScale *colorScale)
     connect(mColorScale.data(), SIGNAL(gradientChanged(QCPColorGradient)), this, SLOT(setGradient(QCPColorGradient)));
     connect(mColorScale.data(), SIGNAL(dataScaleTypeChanged(QCPAxis::ScaleType)), this, SLOT(setDataScaleType(QCPAxis::ScaleType)));
   }
+  markLayerDirty();
 }
 
 /*!
@@ -25867,10 +30652,58 @@ void QCPColorMap::updateLegendIcon(Qt::TransformationMode transformMode, const Q
   {
     bool mirrorX = (keyAxis()->orientation() == Qt::Horizontal ? keyAxis() : valueAxis())->rangeReversed();
     bool mirrorY = (valueAxis()->orientation() == Qt::Vertical ? valueAxis() : keyAxis())->rangeReversed();
-    mLegendIcon = QPixmap::fromImage(mMapImage.mirrored(mirrorX, mirrorY)).scaled(thumbSize, Qt::KeepAspectRatio, transformMode);
+    if (mMapData->mKeyIndexOffset == 0)
+    {
+      mLegendIcon = QPixmap::fromImage(mMapImage.mirrored(mirrorX, mirrorY)).scaled(thumbSize, Qt::KeepAspectRatio, transformMode);
+    } else // map data is a scrolled ring buffer, put the two parts of the map image back in order first
+    {
+      QImage orderedImage(mMapImage.size(), mMapImage.format());
+      orderedImage.fill(Qt::transparent);
+      QPainter imagePainter(&orderedImage);
+      drawWrappedMapImage(&imagePainter, orderedImage.rect(), mirrorX, mirrorY);
+      imagePainter.end();
+      mLegendIcon = QPixmap::fromImage(orderedImage).scaled(thumbSize, Qt::KeepAspectRatio, transformMode);
+    }
   }
 }
 
+/*!
+  Additionally takes the revision of the color map data into account, so modifications of the
+  cells, the alpha map or the ranges via \ref data are detected.
+  
+  \seebaseclassmethod
+*/
+quint64 QCPColorMap::contentRevision() const
+{
+  return QCPAbstractPlottable::contentRevision() + mMapData->mRevision + mMapData->mDisplayRevision;
+}
+
+/*!
+  Accounts for the cells of the color map data, the map image and the legend icon. The undersampled
+  map image, which is only needed while the map image is generated for small data sizes (see \ref
+  setInterpolate), is reclaimable.
+  
+  \seebaseclassmethod
+*/
+qint64 QCPColorMap::memoryUsage(qint64 *reclaimableBytes) const
+{
+  const qint64 undersampledBytes = qint64(mUndersampledMapImage.bytesPerLine())*mUndersampledMapImage.height();
+  if (reclaimableBytes)
+    *reclaimableBytes = undersampledBytes;
+  return mMapData->memoryUsage() + qint64(mMapImage.bytesPerLine())*mMapImage.height() + undersampledBytes +
+      qint64(mLegendIcon.width())*mLegendIcon.height()*mLegendIcon.depth()/8;
+}
+
+/*!
+  Frees the undersampled map image. It is recreated when the map image is regenerated.
+  
+  \seebaseclassmethod
+*/
+void QCPColorMap::releaseMemory()
+{
+  mUndersampledMapImage = QImage();
+}
+
 /* inherits documentation from base class */
 double QCPColorMap::selectTest(const QPointF &pos, bool onlySelectable, QVariant *details) const
 {
@@ -25949,184 +30782,1802 @@ QCPRange QCPColorMap::getValueRange(bool &foundRange, QCP::SignDomain inSignDoma
 
 /*! \internal
   
-  Updates the internal map image buffer by going through the internal \ref QCPColorMapData and
-  turning the data values into color pixels with \ref QCPColorGradient::colorize.
-  
-  This method is called by \ref QCPColorMap::draw if either the data has been modified or the map image
-  has been invalidated for a different reason (e.g. a change of the data range with \ref
-  setDataRange).
+  Colorizes a range of image lines of a color map, as part of \ref QCPColorMap::updateMapImage.
+  Only the cells inside the rectangle \a cells are processed (x being the key index and y the value
+  index). The function call operator takes the range of lines [\a begin, \a end), counted from the
+  first image line that intersects \a cells, so instances can be passed to \ref qcpParallelFor to
+  distribute the lines over multiple threads. Every image line is written by exactly one call, and
+  the writes go directly to the image memory passed as \a imageBits, so no QImage method is called
+  concurrently.
+  
+  If \a transposed is false, image lines correspond to value indices and the data of each line is
+  contiguous in memory. If \a transposed is true (vertical key axis), image lines correspond to
+  key indices and the data of one line is spread with a stride of the key size. In that case the
+  data is first copied tile by tile into a small contiguous buffer, so that the reads from the
+  large data array are sequential. Since every cell is still converted by the same \ref
+  QCPColorGradient::colorize call, the result is identical to a plain line by line colorization.
+  
+  The cells are passed to \ref QCPColorGradient::colorize in the cell type of \a data (see \ref
+  QCPColorMapData::setCellType), so no conversion to double happens here.
+  
+  The \a gradient must have an up to date color buffer when the functor is invoked, such that the
+  concurrent \ref QCPColorGradient::colorize calls only read from it.
+*/
+class QCPColorMapColorizeFunctor
+{
+public:
+  QCPColorMapColorizeFunctor(QCPColorGradient *gradient, const QCPColorMapData *data, const QCPRange &range, bool logarithmic,
+                             const QRect &cells, bool transposed, uchar *imageBits, int bytesPerLine) :
+    mGradient(gradient), mMapData(data), mRange(range), mLogarithmic(logarithmic),
+    mKeySize(data->keySize()), mValueSize(data->valueSize()), mCells(cells), mTransposed(transposed), mImageBits(imageBits), mBytesPerLine(bytesPerLine)
+  {}
+  
+  static int tileSize() { return 64; }
+  int lineCount() const { return mTransposed ? mCells.width() : mCells.height(); }
+  int cellsPerLine() const { return mTransposed ? mCells.height() : mCells.width(); }
+  
+  void operator()(int begin, int end) const
+  {
+    if (mMapData->mData)
+      colorizeLines(mMapData->mData, begin, end);
+    else if (mMapData->mFloatData)
+      colorizeLines(mMapData->mFloatData, begin, end);
+    else if (mMapData->mUInt16Data)
+      colorizeLines(mMapData->mUInt16Data, begin, end);
+  }
+  
+private:
+  QRgb *scanLine(int index) const { return reinterpret_cast<QRgb*>(mImageBits+qint64(index)*mBytesPerLine); }
+  
+  void colorize(const double *data, const unsigned char *alpha, QRgb *pixels, int n) const
+  {
+    if (alpha)
+      mGradient->colorize(data, alpha, mRange, pixels, n, 1, mLogarithmic);
+    else
+      mGradient->colorize(data, mRange, pixels, n, 1, mLogarithmic);
+  }
+  
+  void colorize(const float *data, const unsigned char *alpha, QRgb *pixels, int n) const
+  {
+    if (alpha)
+      mGradient->colorize(data, alpha, mRange, pixels, n, 1, mLogarithmic);
+    else
+      mGradient->colorize(data, mRange, pixels, n, 1, mLogarithmic);
+  }
+  
+  void colorize(const quint16 *data, const unsigned char *alpha, QRgb *pixels, int n) const
+  {
+    if (alpha)
+      mGradient->colorize(data, mMapData->mUInt16Scale, mMapData->mUInt16Offset, alpha, mRange, pixels, n, 1, mLogarithmic);
+    else
+      mGradient->colorize(data, mMapData->mUInt16Scale, mMapData->mUInt16Offset, mRange, pixels, n, 1, mLogarithmic);
+  }
+  
+  template <typename CellValueType>
+  void colorizeLines(const CellValueType *data, int begin, int end) const
+  {
+    const unsigned char *alpha = mMapData->mAlpha;
+    if (!mTransposed)
+    {
+      const int keyBegin = mCells.left();
+      const int keyCount = mCells.width();
+      for (int line=mCells.top()+begin; line<mCells.top()+end; ++line)
+      {
+        QRgb *pixels = scanLine(mValueSize-1-line)+keyBegin; // invert scanline index because QImage counts scanlines from top, but our vertical index counts from bottom (mathematical coordinate system)
+        const int offset = line*mKeySize+keyBegin;
+        colorize(data+offset, alpha ? alpha+offset : 0, pixels, keyCount);
+      }
+    } else
+    {
+      const int tile = tileSize();
+      QVector<CellValueType> dataTile(tile*tile);
+      QVector<unsigned char> alphaTile(alpha ? tile*tile : 0);
+      const int valueRangeBegin = mCells.top();
+      const int valueRangeEnd = mCells.top()+mCells.height();
+      for (int keyBegin=mCells.left()+begin; keyBegin<mCells.left()+end; keyBegin+=tile)
+      {
+        const int keyEnd = qMin(keyBegin+tile, mCells.left()+end);
+        for (int valueBegin=valueRangeBegin; valueBegin<valueRangeEnd; valueBegin+=tile)
+        {
+          const int valueEnd = qMin(valueBegin+tile, valueRangeEnd);
+          const int valueCount = valueEnd-valueBegin;
+          // transpose the tile, reading the data rows sequentially:
+          for (int value=valueBegin; value<valueEnd; ++value)
+          {
+            const CellValueType *dataRow = data+value*mKeySize;
+            for (int key=keyBegin; key<keyEnd; ++key)
+              dataTile[(key-keyBegin)*tile+value-valueBegin] = dataRow[key];
+            if (alpha)
+            {
+              const unsigned char *alphaRow = alpha+value*mKeySize;
+              for (int key=keyBegin; key<keyEnd; ++key)
+                alphaTile[(key-keyBegin)*tile+value-valueBegin] = alphaRow[key];
+            }
+          }
+          // colorize the now contiguous tile lines into the respective scanline sections:
+          for (int key=keyBegin; key<keyEnd; ++key)
+          {
+            QRgb *pixels = scanLine(mKeySize-1-key)+valueBegin; // invert scanline index, see above
+            colorize(dataTile.constData()+(key-keyBegin)*tile, alpha ? alphaTile.constData()+(key-keyBegin)*tile : 0, pixels, valueCount);
+          }
+        }
+      }
+    }
+  }
+  
+  QCPColorGradient *mGradient;
+  const QCPColorMapData *mMapData;
+  QCPRange mRange;
+  bool mLogarithmic;
+  int mKeySize, mValueSize;
+  QRect mCells;
+  bool mTransposed;
+  uchar *mImageBits;
+  int mBytesPerLine;
+};
+
+/*! \internal
+  
+  Resamples the map image of a color map to the pixel grid of the target image, as part of \ref
+  QCPColorMap::drawResampledMapImage. The source position of each target column and row is
+  precomputed by sampleTable, including mirroring and the ring buffer layout of scrolled maps
+  (see \ref QCPColorMapData::appendRow). The function call operator processes the target rows
+  [\a begin, \a end), so instances can be passed to \ref qcpParallelFor.
+  
+  If \a interpolate is true, the pixels are interpolated bilinearly between the four nearest source
+  pixels, otherwise the nearest source pixel is used.
+*/
+class QCPColorMapResampleFunctor
+{
+public:
+  QCPColorMapResampleFunctor(const uchar *sourceBits, int sourceBytesPerLine, uchar *targetBits, int targetBytesPerLine, bool interpolate,
+                             const QVector<int> &columns0, const QVector<int> &columns1, const QVector<int> &columnWeights,
+                             const QVector<int> &rows0, const QVector<int> &rows1, const QVector<int> &rowWeights) :
+    mSourceBits(sourceBits), mSourceBytesPerLine(sourceBytesPerLine), mTargetBits(targetBits), mTargetBytesPerLine(targetBytesPerLine), mInterpolate(interpolate),
+    mColumns0(columns0.constData()), mColumns1(columns1.constData()), mColumnWeights(columnWeights.constData()), mColumnCount(columns0.size()),
+    mRows0(rows0.constData()), mRows1(rows1.constData()), mRowWeights(rowWeights.constData())
+  {}
+  
+  /*
+    Fills index0, index1 and weight (each of size targetCount) with the source pixel indices and
+    interpolation weights (0 to 256, weight of index1) for the target pixels starting at
+    targetBegin. The source image with sourceSize pixels covers the target pixels from imageBegin
+    to imageBegin+imageSize (fractional). wrapOffset is the storage position of the first source
+    pixel in a ring buffer layout.
+  */
+  static void sampleTable(int targetBegin, int targetCount, double imageBegin, double imageSize, int sourceSize, int wrapOffset, bool mirror, bool interpolate,
+                          QVector<int> &index0, QVector<int> &index1, QVector<int> &weight)
+  {
+    index0.resize(targetCount);
+    index1.resize(targetCount);
+    weight.resize(targetCount);
+    for (int i=0; i<targetCount; ++i)
+    {
+      double position = (targetBegin+i+0.5-imageBegin)/imageSize; // fraction of image at pixel center
+      if (mirror)
+        position = 1.0-position;
+      position *= sourceSize;
+      int i0, i1, w;
+      if (interpolate)
+      {
+        position -= 0.5; // pixel centers of the source are at half-integer positions
+        i0 = qFloor(position);
+        w = qRound((position-i0)*256);
+        i1 = qBound(0, i0+1, sourceSize-1);
+        i0 = qBound(0, i0, sourceSize-1);
+      } else
+      {
+        i0 = qBound(0, qFloor(position), sourceSize-1);
+        i1 = i0;
+        w = 0;
+      }
+      index0[i] = (i0+wrapOffset) % sourceSize;
+      index1[i] = (i1+wrapOffset) % sourceSize;
+      weight[i] = w;
+    }
+  }
+  
+  void operator()(int begin, int end) const
+  {
+    for (int y=begin; y<end; ++y)
+    {
+      const QRgb *sourceLine0 = reinterpret_cast<const QRgb*>(mSourceBits+qint64(mRows0[y])*mSourceBytesPerLine);
+      QRgb *targetLine = reinterpret_cast<QRgb*>(mTargetBits+qint64(y)*mTargetBytesPerLine);
+      if (!mInterpolate)
+      {
+        for (int x=0; x<mColumnCount; ++x)
+          targetLine[x] = sourceLine0[mColumns0[x]];
+      } else
+      {
+        const QRgb *sourceLine1 = reinterpret_cast<const QRgb*>(mSourceBits+qint64(mRows1[y])*mSourceBytesPerLine);
+        const uint rowWeight = mRowWeights[y];
+        for (int x=0; x<mColumnCount; ++x)
+        {
+          const uint columnWeight = mColumnWeights[x];
+          targetLine[x] = interpolated(interpolated(sourceLine0[mColumns0[x]], sourceLine0[mColumns1[x]], columnWeight),
+                                       interpolated(sourceLine1[mColumns0[x]], sourceLine1[mColumns1[x]], columnWeight), rowWeight);
+        }
+      }
+    }
+  }
+  
+private:
+  // interpolates all four channels of the premultiplied colors a and b, with weight (0 to 256) of b. Two channels are processed per multiplication:
+  static QRgb interpolated(QRgb a, QRgb b, uint weight)
+  {
+    const uint inverseWeight = 256-weight;
+    const quint32 redBlue = ((((a & 0x00ff00ff)*inverseWeight + (b & 0x00ff00ff)*weight)) >> 8) & 0x00ff00ff;
+    const quint32 alphaGreen = ((((a >> 8) & 0x00ff00ff)*inverseWeight + ((b >> 8) & 0x00ff00ff)*weight)) & 0xff00ff00;
+    return redBlue | alphaGreen;
+  }
+  
+  const uchar *mSourceBits;
+  int mSourceBytesPerLine;
+  uchar *mTargetBits;
+  int mTargetBytesPerLine;
+  bool mInterpolate;
+  const int *mColumns0, *mColumns1, *mColumnWeights;
+  int mColumnCount;
+  const int *mRows0, *mRows1, *mRowWeights;
+};
+
+/*! \internal
+  
+  Updates the internal map image buffer by going through the internal \ref QCPColorMapData and
+  turning the data values into color pixels with \ref QCPColorGradient::colorize.
+  
+  This method is called by \ref QCPColorMap::draw if either the data has been modified or the map image
+  has been invalidated for a different reason (e.g. a change of the data range with \ref
+  setDataRange).
+  
+  If neither the map image was invalidated nor its size or orientation changed, only the cells that
+  were modified since the last update (as tracked by \ref QCPColorMapData) are recolorized.
+  
+  The colorization is distributed over the threads of QThreadPool::globalInstance (see \ref
+  qcpParallelFor), if the map is large enough for this to pay off. Each thread colorizes complete
+  image lines, so the resulting image is the same as when colorizing serially.
+  
+  If the map cell count is low, the image created will be oversampled in order to avoid a
+  QPainter::drawImage bug which makes inner pixel boundaries jitter when stretch-drawing images
+  without smooth transform enabled. Accordingly, oversampling isn't performed if \ref
+  setInterpolate is true.
+*/
+void QCPColorMap::updateMapImage()
+{
+  QCPTraceScope trace("QCPColorMap::updateMapImage", "render", this);
+  QCPAxis *keyAxis = mKeyAxis.data();
+  if (!keyAxis) return;
+  if (mMapData->isEmpty()) return;
+  
+  const QImage::Format format = QImage::Format_ARGB32_Premultiplied;
+  const int keySize = mMapData->keySize();
+  const int valueSize = mMapData->valueSize();
+  int keyOversamplingFactor = mInterpolate ? 1 : (int)(1.0+100.0/(double)keySize); // make mMapImage have at least size 100, factor becomes 1 if size > 200 or interpolation is on
+  int valueOversamplingFactor = mInterpolate ? 1 : (int)(1.0+100.0/(double)valueSize); // make mMapImage have at least size 100, factor becomes 1 if size > 200 or interpolation is on
+  const bool transposed = keyAxis->orientation() == Qt::Vertical;
+  // a partial update of only the modified cells is possible if the existing image content is still valid in all other cells:
+  bool fullUpdate = mMapImageInvalidated || transposed != mMapImageTransposed || keyOversamplingFactor > 1 || valueOversamplingFactor > 1;
+  
+  // resize mMapImage to correct dimensions including possible oversampling factors, according to key/value axes orientation:
+  if (keyAxis->orientation() == Qt::Horizontal && (mMapImage.width() != keySize*keyOversamplingFactor || mMapImage.height() != valueSize*valueOversamplingFactor))
+  {
+    mMapImage = QImage(QSize(keySize*keyOversamplingFactor, valueSize*valueOversamplingFactor), format);
+    fullUpdate = true;
+  } else if (keyAxis->orientation() == Qt::Vertical && (mMapImage.width() != valueSize*valueOversamplingFactor || mMapImage.height() != keySize*keyOversamplingFactor))
+  {
+    mMapImage = QImage(QSize(valueSize*valueOversamplingFactor, keySize*keyOversamplingFactor), format);
+    fullUpdate = true;
+  }
+  
+  if (mMapImage.isNull())
+  {
+    qDebug() << Q_FUNC_INFO << "Couldn't create map image (possibly too large for memory)";
+    mMapImage = QImage(QSize(10, 10), format);
+    mMapImage.fill(Qt::black);
+  } else
+  {
+    QImage *localMapImage = &mMapImage; // this is the image on which the colorization operates. Either the final mMapImage, or if we need oversampling, mUndersampledMapImage
+    if (keyOversamplingFactor > 1 || valueOversamplingFactor > 1)
+    {
+      // resize undersampled map image to actual key/value cell sizes:
+      if (keyAxis->orientation() == Qt::Horizontal && (mUndersampledMapImage.width() != keySize || mUndersampledMapImage.height() != valueSize))
+        mUndersampledMapImage = QImage(QSize(keySize, valueSize), format);
+      else if (keyAxis->orientation() == Qt::Vertical && (mUndersampledMapImage.width() != valueSize || mUndersampledMapImage.height() != keySize))
+        mUndersampledMapImage = QImage(QSize(valueSize, keySize), format);
+      localMapImage = &mUndersampledMapImage; // make the colorization run on the undersampled image
+    } else if (!mUndersampledMapImage.isNull())
+      mUndersampledMapImage = QImage(); // don't need oversampling mechanism anymore (map size has changed) but mUndersampledMapImage still has nonzero size, free it
+    
+    const QRect allCells(0, 0, keySize, valueSize);
+    const QRect cells = fullUpdate ? allCells : mMapData->mDirtyCells.intersected(allCells);
+    if (!cells.isEmpty())
+    {
+      if (mGradient.mColorBufferInvalidated)
+        mGradient.updateColorBuffer(); // must happen before the parallel section, so the concurrent colorize calls only read the color buffer
+      QCPColorMapColorizeFunctor colorizer(&mGradient, mMapData, mDataRange, mDataScaleType==QCPAxis::stLogarithmic,
+                                           cells, transposed, localMapImage->bits(), localMapImage->bytesPerLine());
+      const int minLinesPerChunk = qMax(1, 32768/colorizer.cellsPerLine()); // don't hand out chunks with less than about 32k cells, thread overhead would dominate
+      qcpParallelFor(colorizer.lineCount(), minLinesPerChunk, colorizer);
+    }
+    
+    if (keyOversamplingFactor > 1 || valueOversamplingFactor > 1)
+    {
+      if (keyAxis->orientation() == Qt::Horizontal)
+        mMapImage = mUndersampledMapImage.scaled(keySize*keyOversamplingFactor, valueSize*valueOversamplingFactor, Qt::IgnoreAspectRatio, Qt::FastTransformation);
+      else
+        mMapImage = mUndersampledMapImage.scaled(valueSize*valueOversamplingFactor, keySize*keyOversamplingFactor, Qt::IgnoreAspectRatio, Qt::FastTransformation);
+    }
+  }
+  mMapData->mDataModified = false;
+  mMapData->mDirtyCells = QRect();
+  mMapImageInvalidated = false;
+  mMapImageTransposed = transposed;
+}
+
+/* inherits documentation from base class */
+void QCPColorMap::draw(QCPPainter *painter)
+{
+  if (mMapData->isEmpty()) return;
+  if (!mKeyAxis || !mValueAxis) return;
+  applyDefaultAntialiasingHint(painter);
+  
+  if (mMapData->mDataModified || mMapImageInvalidated)
+    updateMapImage();
+  
+  // use buffer if painting vectorized (PDF):
+  const bool useBuffer = painter->modes().testFlag(QCPPainter::pmVectorized);
+  QCPPainter *localPainter = painter; // will be redirected to paint on mapBuffer if painting vectorized
+  QRectF mapBufferTarget; // the rect in absolute widget coordinates where the visible map portion/buffer will end up in
+  QPixmap mapBuffer;
+  if (useBuffer)
+  {
+    const double mapBufferPixelRatio = 3; // factor by which DPI is increased in embedded bitmaps
+    mapBufferTarget = painter->clipRegion().boundingRect();
+    mapBuffer = QPixmap((mapBufferTarget.size()*mapBufferPixelRatio).toSize());
+    mapBuffer.fill(Qt::transparent);
+    localPainter = new QCPPainter(&mapBuffer);
+    localPainter->scale(mapBufferPixelRatio, mapBufferPixelRatio);
+    localPainter->translate(-mapBufferTarget.topLeft());
+  }
+  
+  QRectF imageRect = QRectF(coordsToPixels(mMapData->keyRange().lower, mMapData->valueRange().lower),
+                            coordsToPixels(mMapData->keyRange().upper, mMapData->valueRange().upper)).normalized();
+  // extend imageRect to contain outer halves/quarters of bordering/cornering pixels (cells are centered on map range boundary):
+  double halfCellWidth = 0; // in pixels
+  double halfCellHeight = 0; // in pixels
+  if (keyAxis()->orientation() == Qt::Horizontal)
+  {
+    if (mMapData->keySize() > 1)
+      halfCellWidth = 0.5*imageRect.width()/(double)(mMapData->keySize()-1);
+    if (mMapData->valueSize() > 1)
+      halfCellHeight = 0.5*imageRect.height()/(double)(mMapData->valueSize()-1);
+  } else // keyAxis orientation is Qt::Vertical
+  {
+    if (mMapData->keySize() > 1)
+      halfCellHeight = 0.5*imageRect.height()/(double)(mMapData->keySize()-1);
+    if (mMapData->valueSize() > 1)
+      halfCellWidth = 0.5*imageRect.width()/(double)(mMapData->valueSize()-1);
+  }
+  imageRect.adjust(-halfCellWidth, -halfCellHeight, halfCellWidth, halfCellHeight);
+  const bool mirrorX = (keyAxis()->orientation() == Qt::Horizontal ? keyAxis() : valueAxis())->rangeReversed();
+  const bool mirrorY = (valueAxis()->orientation() == Qt::Vertical ? valueAxis() : keyAxis())->rangeReversed();
+  const bool smoothBackup = localPainter->renderHints().testFlag(QPainter::SmoothPixmapTransform);
+  localPainter->setRenderHint(QPainter::SmoothPixmapTransform, mInterpolate);
+  QRegion clipBackup;
+  if (mTightBoundary)
+  {
+    clipBackup = localPainter->clipRegion();
+    QRectF tightClipRect = QRectF(coordsToPixels(mMapData->keyRange().lower, mMapData->valueRange().lower),
+                                  coordsToPixels(mMapData->keyRange().upper, mMapData->valueRange().upper)).normalized();
+    localPainter->setClipRect(tightClipRect, Qt::IntersectClip);
+  }
+  // when painting to a pixel buffer, only resample the visible part of the map at the target resolution:
+  bool resample = !useBuffer && localPainter->transform().type() <= QTransform::TxTranslate;
+#ifndef QCP_DEVICEPIXELRATIO_SUPPORTED
+  resample = resample && qFuzzyCompare(1.0, mParentPlot->bufferDevicePixelRatio());
+#endif
+  if (resample)
+    drawResampledMapImage(localPainter, imageRect, mirrorX, mirrorY);
+  else if (mMapData->mKeyIndexOffset == 0)
+    localPainter->drawImage(imageRect, mMapImage.mirrored(mirrorX, mirrorY));
+  else
+    drawWrappedMapImage(localPainter, imageRect, mirrorX, mirrorY);
+  if (mTightBoundary)
+    localPainter->setClipRegion(clipBackup);
+  localPainter->setRenderHint(QPainter::SmoothPixmapTransform, smoothBackup);
+  
+  if (useBuffer) // localPainter painted to mapBuffer, so now draw buffer with original painter
+  {
+    delete localPainter;
+    painter->drawPixmap(mapBufferTarget.toRect(), mapBuffer);
+  }
+}
+
+/* inherits documentation from base class */
+void QCPColorMap::drawLegendIcon(QCPPainter *painter, const QRectF &rect) const
+{
+  applyDefaultAntialiasingHint(painter);
+  // draw map thumbnail:
+  if (!mLegendIcon.isNull())
+  {
+    QPixmap scaledIcon = mLegendIcon.scaled(rect.size().toSize(), Qt::KeepAspectRatio, Qt::FastTransformation);
+    QRectF iconRect = QRectF(0, 0, scaledIcon.width(), scaledIcon.height());
+    iconRect.moveCenter(rect.center());
+    painter->drawPixmap(iconRect.topLeft(), scaledIcon);
+  }
+  /*
+  // draw frame:
+  painter->setBrush(Qt::NoBrush);
+  painter->setPen(Qt::black);
+  painter->drawRect(rect.adjusted(1, 1, 0, 0));
+  */
+}
+
+/*! \internal
+  
+  Draws the map image into \a targetRect, for the case that the map data is a scrolled ring buffer
+  (see \ref QCPColorMapData::appendRow). The map image then has the same ring buffer layout in the
+  key dimension, so it is drawn in two parts which are put next to each other in the correct
+  order. \a mirrorX and \a mirrorY mirror the image like QImage::mirrored, but via the painter
+  transform, so no copy of the image is necessary.
+*/
+void QCPColorMap::drawWrappedMapImage(QPainter *painter, const QRectF &targetRect, bool mirrorX, bool mirrorY) const
+{
+  const int width = mMapImage.width();
+  const int height = mMapImage.height();
+  if (width == 0 || height == 0)
+    return;
+  // map the pixel coordinates of the (ordered, unmirrored) image to targetRect:
+  QTransform imageTransform;
+  imageTransform.translate(mirrorX ? targetRect.right() : targetRect.left(), mirrorY ? targetRect.bottom() : targetRect.top());
+  imageTransform.scale((mirrorX ? -1 : 1)*targetRect.width()/(double)width, (mirrorY ? -1 : 1)*targetRect.height()/(double)height);
+  painter->save();
+  painter->setTransform(imageTransform, true);
+  if (mMapImageTransposed) // key axis is vertical, key indices run along the scanlines from bottom to top
+  {
+    const int offset = mMapData->mKeyIndexOffset*height/mMapData->keySize(); // also correct if image is oversampled
+    painter->drawImage(QRectF(0, offset, width, height-offset), mMapImage, QRectF(0, 0, width, height-offset));
+    painter->drawImage(QRectF(0, 0, width, offset), mMapImage, QRectF(0, height-offset, width, offset));
+  } else // key axis is horizontal, key indices run along the columns from left to right
+  {
+    const int offset = mMapData->mKeyIndexOffset*width/mMapData->keySize(); // also correct if image is oversampled
+    painter->drawImage(QRectF(0, 0, width-offset, height), mMapImage, QRectF(offset, 0, width-offset, height));
+    painter->drawImage(QRectF(width-offset, 0, offset, height), mMapImage, QRectF(0, 0, offset, height));
+  }
+  painter->restore();
+}
+
+/*! \internal
+  
+  Draws the visible part of the map image, which would be stretched to \a imageRect, by resampling
+  it directly to the pixel grid of the paint buffer. Only the part of \a imageRect inside the clip
+  rect is processed, so the cost is proportional to the number of visible target pixels and
+  independent of the map size. \a mirrorX and \a mirrorY as well as the ring buffer layout of
+  scrolled maps (see \ref QCPColorMapData::appendRow) are handled in the sample index calculation,
+  so no transformed copies of the map image are created.
+  
+  If \ref setInterpolate is true, the target pixels are interpolated bilinearly, otherwise the
+  nearest map image pixel is used.
+  
+  This method is used by \ref draw if \a painter paints on a pixel buffer without a scaling
+  transform. For vectorized export, the full map image is embedded instead.
+*/
+void QCPColorMap::drawResampledMapImage(QCPPainter *painter, const QRectF &imageRect, bool mirrorX, bool mirrorY) const
+{
+  const int width = mMapImage.width();
+  const int height = mMapImage.height();
+  const QRectF visibleRect = imageRect.intersected(QRectF(clipRect()));
+  if (width == 0 || height == 0 || visibleRect.isEmpty())
+    return;
+  const double ratio = mParentPlot->bufferDevicePixelRatio();
+  const QRect targetRect(QPoint(qRound(visibleRect.left()*ratio), qRound(visibleRect.top()*ratio)),
+                         QPoint(qRound(visibleRect.right()*ratio)-1, qRound(visibleRect.bottom()*ratio)-1)); // in device pixels
+  if (targetRect.isEmpty())
+    return;
+  QImage targetImage(targetRect.size(), QImage::Format_ARGB32_Premultiplied);
+  if (targetImage.isNull())
+  {
+    qDebug() << Q_FUNC_INFO << "Couldn't create target image";
+    return;
+  }
+  
+  // storage position of the first (ordered) image column/row, if map data is a scrolled ring buffer:
+  const int keyOffset = mMapData->mKeyIndexOffset;
+  const int columnOffset = mMapImageTransposed ? 0 : keyOffset*width/mMapData->keySize();
+  const int rowOffset = mMapImageTransposed ? (height-keyOffset*height/mMapData->keySize()) % height : 0; // key indices run from bottom to top in transposed image
+  
+  QVector<int> columns0, columns1, columnWeights, rows0, rows1, rowWeights;
+  QCPColorMapResampleFunctor::sampleTable(targetRect.left(), targetRect.width(), imageRect.left()*ratio, imageRect.width()*ratio, width, columnOffset, mirrorX, mInterpolate,
+                                          columns0, columns1, columnWeights);
+  QCPColorMapResampleFunctor::sampleTable(targetRect.top(), targetRect.height(), imageRect.top()*ratio, imageRect.height()*ratio, height, rowOffset, mirrorY, mInterpolate,
+                                          rows0, rows1, rowWeights);
+  QCPColorMapResampleFunctor resampler(mMapImage.constBits(), mMapImage.bytesPerLine(), targetImage.bits(), targetImage.bytesPerLine(), mInterpolate,
+                                       columns0, columns1, columnWeights, rows0, rows1, rowWeights);
+  qcpParallelFor(targetRect.height(), qMax(1, 32768/targetRect.width()), resampler);
+  
+#ifdef QCP_DEVICEPIXELRATIO_SUPPORTED
+  targetImage.setDevicePixelRatio(ratio);
+#endif
+  painter->drawImage(QPointF(targetRect.left()/ratio, targetRect.top()/ratio), targetImage);
+}
+/* end of 'src/plottables/plottable-colormap.cpp' */
+
+
+/* including file 'src/plottables/plottable-tiledcolormap.cpp'              */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPColorMapTileSource
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPColorMapTileSource
+  \brief Abstract base class for the cell data sources of a QCPTiledColorMap
+  
+  A \ref QCPTiledColorMap doesn't hold its data itself. Instead, it requests the cells it needs for
+  the currently visible map window and zoom level from a tile source. This allows displaying
+  matrices which are much larger than the available memory, e.g. with \ref
+  QCPColorMapFileTileSource, or generating cells on demand.
+  
+  To create an own source, subclass QCPColorMapTileSource and implement \ref keySize, \ref
+  valueSize and \ref readCells.
+*/
+
+/* start of documentation of pure virtual functions */
+
+/*! \fn int QCPColorMapTileSource::keySize() const = 0
+  
+  Returns the number of cells in the key dimension.
+*/
+
+/*! \fn int QCPColorMapTileSource::valueSize() const = 0
+  
+  Returns the number of cells in the value dimension.
+*/
+
+/*! \fn void QCPColorMapTileSource::readCells(int keyIndex, int valueIndex, int keyCount, int valueCount, int step, double *target) const = 0
+  
+  Reads \a keyCount times \a valueCount cells into \a target. The cell at key index <tt>keyIndex +
+  i*step</tt> and value index <tt>valueIndex + j*step</tt> must be written to
+  <tt>target[j*keyCount + i]</tt>. So if \a step is greater than one, only every \a step-th cell in
+  each dimension is read, which is how the coarser mip levels of a \ref QCPTiledColorMap are
+  generated.
+  
+  The requested cells are always within the bounds given by \ref keySize and \ref valueSize.
+  
+  This method is called concurrently from multiple threads, so implementations must be
+  thread-safe.
+*/
+
+/* end of documentation of pure virtual functions */
+
+QCPColorMapTileSource::QCPColorMapTileSource()
+{
+}
+
+QCPColorMapTileSource::~QCPColorMapTileSource()
+{
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPColorMapDataTileSource
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPColorMapDataTileSource
+  \brief A tile source for QCPTiledColorMap which reads from a QCPColorMapData instance
+  
+  This source allows displaying the cells of an in-memory \ref QCPColorMapData with a \ref
+  QCPTiledColorMap. The data instance isn't owned by the source and must stay valid as long as the
+  source is used. If the data is modified, call \ref QCPTiledColorMap::invalidateTiles.
+*/
+
+/*!
+  Creates a tile source that reads the cells of \a data.
+*/
+QCPColorMapDataTileSource::QCPColorMapDataTileSource(QCPColorMapData *data) :
+  mData(data)
+{
+}
+
+/* inherits documentation from base class */
+void QCPColorMapDataTileSource::readCells(int keyIndex, int valueIndex, int keyCount, int valueCount, int step, double *target) const
+{
+  for (int j=0; j<valueCount; ++j)
+  {
+    for (int i=0; i<keyCount; ++i)
+      target[j*keyCount + i] = mData->cell(keyIndex+i*step, valueIndex+j*step);
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPColorMapFileTileSource
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPColorMapFileTileSource
+  \brief A file-backed tile source for QCPTiledColorMap
+  
+  This source memory-maps a binary file which holds the cells of a matrix in row-major order, i.e.
+  all cells with value index 0 first (ordered by key index), then all cells with value index 1, and
+  so on. This is the same layout as used internally by \ref QCPColorMapData. The cell type is
+  given by \ref CellType, in the byte order of the host. The cells may be preceded by a header of
+  arbitrary size, which is skipped.
+  
+  Only the pages of the file that are actually needed for the visible tiles are loaded by the
+  operating system, so matrices larger than the available memory can be displayed.
+  
+  Check \ref isValid after construction to find out whether the file could be mapped.
+*/
+
+/*!
+  Creates a tile source that maps the file \a fileName. The file must contain at least \a keySize
+  times \a valueSize cells of type \a cellType, after the first \a headerSize bytes.
+*/
+QCPColorMapFileTileSource::QCPColorMapFileTileSource(const QString &fileName, int keySize, int valueSize, CellType cellType, qint64 headerSize) :
+  mFile(fileName),
+  mKeySize(qMax(0, keySize)),
+  mValueSize(qMax(0, valueSize)),
+  mCellType(cellType),
+  mCells(0)
+{
+  qint64 cellBytes = 0;
+  switch (mCellType)
+  {
+    case ctDouble: cellBytes = sizeof(double); break;
+    case ctFloat: cellBytes = sizeof(float); break;
+    case ctInt16: cellBytes = sizeof(qint16); break;
+    case ctUInt16: cellBytes = sizeof(quint16); break;
+  }
+  const qint64 dataBytes = qint64(mKeySize)*qint64(mValueSize)*cellBytes;
+  if (dataBytes == 0)
+    return;
+  if (!mFile.open(QIODevice::ReadOnly))
+  {
+    qDebug() << Q_FUNC_INFO << "couldn't open file" << fileName << mFile.errorString();
+    return;
+  }
+  if (mFile.size() < headerSize+dataBytes)
+  {
+    qDebug() << Q_FUNC_INFO << "file" << fileName << "is too small for the given dimensions" << mKeySize << "*" << mValueSize;
+    return;
+  }
+  mCells = mFile.map(headerSize, dataBytes);
+  if (!mCells)
+    qDebug() << Q_FUNC_INFO << "couldn't map file" << fileName << mFile.errorString();
+}
+
+QCPColorMapFileTileSource::~QCPColorMapFileTileSource()
+{
+  if (mCells)
+    mFile.unmap(const_cast<uchar*>(mCells));
+}
+
+/* inherits documentation from base class */
+void QCPColorMapFileTileSource::readCells(int keyIndex, int valueIndex, int keyCount, int valueCount, int step, double *target) const
+{
+  if (!mCells)
+  {
+    std::fill(target, target+keyCount*valueCount, 0.0);
+    return;
+  }
+  switch (mCellType)
+  {
+    case ctDouble: readTypedCells<double>(keyIndex, valueIndex, keyCount, valueCount, step, target); break;
+    case ctFloat: readTypedCells<float>(keyIndex, valueIndex, keyCount, valueCount, step, target); break;
+    case ctInt16: readTypedCells<qint16>(keyIndex, valueIndex, keyCount, valueCount, step, target); break;
+    case ctUInt16: readTypedCells<quint16>(keyIndex, valueIndex, keyCount, valueCount, step, target); break;
+  }
+}
+
+/*! \internal
+  
+  Implements \ref readCells for the cell type \a CellValueType. The cells are copied with memcpy
+  because the header size may leave them unaligned in the mapped memory.
+*/
+template <typename CellValueType>
+void QCPColorMapFileTileSource::readTypedCells(int keyIndex, int valueIndex, int keyCount, int valueCount, int step, double *target) const
+{
+  for (int j=0; j<valueCount; ++j)
+  {
+    const uchar *row = mCells + (qint64(valueIndex+j*step)*mKeySize + keyIndex)*qint64(sizeof(CellValueType));
+    for (int i=0; i<keyCount; ++i)
+    {
+      CellValueType cellValue;
+      memcpy(&cellValue, row + qint64(i)*step*qint64(sizeof(CellValueType)), sizeof(CellValueType));
+      target[j*keyCount + i] = cellValue;
+    }
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPTiledColorMap
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPTiledColorMap
+  \brief A color map for very large matrices, rendered from lazily generated, cached tiles
+  
+  Like \ref QCPColorMap, this plottable displays a two-dimensional matrix of cells as a color coded
+  image. But instead of holding all cells in a \ref QCPColorMapData and colorizing them into one
+  image, it only reads and colorizes the cells that are needed for the currently visible map window
+  at the current zoom level. The cells are read from a \ref QCPColorMapTileSource (see \ref
+  setSource), for example a \ref QCPColorMapFileTileSource for matrices that don't fit into memory.
+  
+  The map is divided into square tiles of \ref setTileSize image pixels. At mip level 0, each tile
+  pixel represents one cell. At mip level n, each tile pixel represents 2^n by 2^n cells, sampled
+  from the first cell of that block. When drawing, the mip level is chosen such that a tile pixel
+  is about as large as a screen pixel, so the number of tiles that are generated and drawn is
+  bounded by the size of the axis rect, independent of the matrix size.
+  
+  Generated tiles are held in a least recently used cache whose size can be set with \ref
+  setCacheSize. Missing tiles are generated in parallel on the threads of
+  QThreadPool::globalInstance. If the source data changes, call \ref invalidateTiles.
+  
+  The coordinates of the cells are defined by \ref setKeyRange and \ref setValueRange, with the
+  same convention as \ref QCPColorMapData::setRange: the outer cells are centered on the range
+  boundaries.
+  
+  A QCPTiledColorMap isn't connected to a \ref QCPColorScale automatically. To use a color scale,
+  set the same gradient and data range on both, or connect the respective change signals.
+*/
+
+/* start of documentation of inline functions */
+
+/*! \fn QCPColorMapTileSource *QCPTiledColorMap::source() const
+  
+  Returns the tile source which provides the cells of this map, or 0 if none was set yet.
+  
+  \see setSource
+*/
+
+/* end of documentation of inline functions */
+
+/* start of documentation of signals */
+
+/*! \fn void QCPTiledColorMap::dataRangeChanged(const QCPRange &newRange);
+  
+  This signal is emitted when the data range changes.
+  
+  \see setDataRange
+*/
+
+/*! \fn void QCPTiledColorMap::dataScaleTypeChanged(QCPAxis::ScaleType scaleType);
+  
+  This signal is emitted when the data scale type changes.
+  
+  \see setDataScaleType
+*/
+
+/*! \fn void QCPTiledColorMap::gradientChanged(const QCPColorGradient &newGradient);
+  
+  This signal is emitted when the gradient changes.
+  
+  \see setGradient
+*/
+
+/* end of documentation of signals */
+
+/*!
+  Constructs a tiled color map with the specified \a keyAxis and \a valueAxis.
+  
+  The created QCPTiledColorMap is automatically registered with the QCustomPlot instance inferred
+  from \a keyAxis. This QCustomPlot instance takes ownership of the QCPTiledColorMap, so do not
+  delete it manually but use QCustomPlot::removePlottable() instead.
+  
+  The map has no tile source initially, set one with \ref setSource.
+*/
+QCPTiledColorMap::QCPTiledColorMap(QCPAxis *keyAxis, QCPAxis *valueAxis) :
+  QCPAbstractPlottable(keyAxis, valueAxis),
+  mSource(0),
+  mKeyRange(0, 5),
+  mValueRange(0, 5),
+  mDataScaleType(QCPAxis::stLinear),
+  mGradient(QCPColorGradient::gpCold),
+  mInterpolate(true),
+  mTileSize(256)
+{
+  setCacheSize(256);
+}
+
+QCPTiledColorMap::~QCPTiledColorMap()
+{
+  delete mSource;
+}
+
+/*!
+  Sets the tile source which provides the cells of this map. The map takes ownership of \a source
+  and deletes the previous source.
+*/
+void QCPTiledColorMap::setSource(QCPColorMapTileSource *source)
+{
+  if (mSource == source)
+    return;
+  delete mSource;
+  mSource = source;
+  invalidateTiles();
+}
+
+/*!
+  Sets the coordinate range in the key dimension over which the cells are distributed. The outer
+  cells are centered on the range boundaries, see \ref QCPColorMapData::setKeyRange.
+  
+  \see setValueRange
+*/
+void QCPTiledColorMap::setKeyRange(const QCPRange &keyRange)
+{
+  mKeyRange = keyRange;
+  markLayerDirty();
+}
+
+/*!
+  Sets the coordinate range in the value dimension over which the cells are distributed. The outer
+  cells are centered on the range boundaries, see \ref QCPColorMapData::setValueRange.
+  
+  \see setKeyRange
+*/
+void QCPTiledColorMap::setValueRange(const QCPRange &valueRange)
+{
+  mValueRange = valueRange;
+  markLayerDirty();
+}
+
+/*!
+  Sets the data range of this map to \a dataRange. The data range defines which data values are
+  mapped to the color gradient.
+  
+  \see QCPColorMap::setDataRange
+*/
+void QCPTiledColorMap::setDataRange(const QCPRange &dataRange)
+{
+  if (!QCPRange::validRange(dataRange)) return;
+  if (mDataRange.lower != dataRange.lower || mDataRange.upper != dataRange.upper)
+  {
+    if (mDataScaleType == QCPAxis::stLogarithmic)
+      mDataRange = dataRange.sanitizedForLogScale();
+    else
+      mDataRange = dataRange.sanitizedForLinScale();
+    invalidateTiles();
+    emit dataRangeChanged(mDataRange);
+  }
+}
+
+/*!
+  Sets whether the data is correlated with the color gradient linearly or logarithmically.
+  
+  \see QCPColorMap::setDataScaleType
+*/
+void QCPTiledColorMap::setDataScaleType(QCPAxis::ScaleType scaleType)
+{
+  if (mDataScaleType != scaleType)
+  {
+    mDataScaleType = scaleType;
+    invalidateTiles();
+    emit dataScaleTypeChanged(mDataScaleType);
+    if (mDataScaleType == QCPAxis::stLogarithmic)
+      setDataRange(mDataRange.sanitizedForLogScale());
+  }
+}
+
+/*!
+  Sets the color gradient that is used to represent the data.
+  
+  \see QCPColorMap::setGradient
+*/
+void QCPTiledColorMap::setGradient(const QCPColorGradient &gradient)
+{
+  if (mGradient != gradient)
+  {
+    mGradient = gradient;
+    invalidateTiles();
+    emit gradientChanged(mGradient);
+  }
+}
+
+/*!
+  Sets whether the tiles shall be drawn with bilinear interpolation when they are displayed
+  enlarged or shrunk.
+*/
+void QCPTiledColorMap::setInterpolate(bool enabled)
+{
+  mInterpolate = enabled;
+  markLayerDirty();
+}
+
+/*!
+  Sets the edge length of the square tiles in pixels. Each tile image has at most \a size by \a
+  size pixels. Smaller tiles make the generation of newly visible regions more fine grained when
+  panning, larger tiles reduce the per-tile overhead. The default is 256.
+*/
+void QCPTiledColorMap::setTileSize(int size)
+{
+  size = qBound(16, size, 4096);
+  if (mTileSize != size)
+  {
+    mTileSize = size;
+    invalidateTiles();
+  }
+}
+
+/*!
+  Sets the maximum amount of memory in megabytes which the cached tile images may occupy. When the
+  cache is full, the least recently used tiles are discarded. The default is 256.
+*/
+void QCPTiledColorMap::setCacheSize(int megabytes)
+{
+  mTileCache.setMaxCost(qMax(1, megabytes)*1024); // cost unit is kilobytes
+}
+
+/*!
+  Discards all cached tiles, so they are generated again from the tile source on the next replot.
+  Call this method if the data of the source has changed.
+  
+  Changes of the gradient, data range or data scale type invalidate the tiles automatically.
+*/
+void QCPTiledColorMap::invalidateTiles()
+{
+  mTileCache.clear();
+  markLayerDirty();
+}
+
+/* inherits documentation from base class */
+double QCPTiledColorMap::selectTest(const QPointF &pos, bool onlySelectable, QVariant *details) const
+{
+  Q_UNUSED(details)
+  if ((onlySelectable && mSelectable == QCP::stNone) || !mSource)
+    return -1;
+  if (!mKeyAxis || !mValueAxis)
+    return -1;
+  
+  if (mKeyAxis.data()->axisRect()->rect().contains(pos.toPoint()))
+  {
+    double posKey, posValue;
+    pixelsToCoords(pos, posKey, posValue);
+    if (mKeyRange.contains(posKey) && mValueRange.contains(posValue))
+    {
+      if (details)
+        details->setValue(QCPDataSelection(QCPDataRange(0, 1))); // whole-plottable selection, same as QCPColorMap
+      return mParentPlot->selectionTolerance()*0.99;
+    }
+  }
+  return -1;
+}
+
+/* inherits documentation from base class */
+QCPRange QCPTiledColorMap::getKeyRange(bool &foundRange, QCP::SignDomain inSignDomain) const
+{
+  foundRange = true;
+  QCPRange result = mKeyRange;
+  result.normalize();
+  if (inSignDomain == QCP::sdPositive)
+  {
+    if (result.lower <= 0 && result.upper > 0)
+      result.lower = result.upper*1e-3;
+    else if (result.lower <= 0 && result.upper <= 0)
+      foundRange = false;
+  } else if (inSignDomain == QCP::sdNegative)
+  {
+    if (result.upper >= 0 && result.lower < 0)
+      result.upper = result.lower*1e-3;
+    else if (result.upper >= 0 && result.lower >= 0)
+      foundRange = false;
+  }
+  return result;
+}
+
+/* inherits documentation from base class */
+QCPRange QCPTiledColorMap::getValueRange(bool &foundRange, QCP::SignDomain inSignDomain, const QCPRange &inKeyRange) const
+{
+  if (inKeyRange != QCPRange())
+  {
+    if (mKeyRange.upper < inKeyRange.lower || mKeyRange.lower > inKeyRange.upper)
+    {
+      foundRange = false;
+      return QCPRange();
+    }
+  }
+  
+  foundRange = true;
+  QCPRange result = mValueRange;
+  result.normalize();
+  if (inSignDomain == QCP::sdPositive)
+  {
+    if (result.lower <= 0 && result.upper > 0)
+      result.lower = result.upper*1e-3;
+    else if (result.lower <= 0 && result.upper <= 0)
+      foundRange = false;
+  } else if (inSignDomain == QCP::sdNegative)
+  {
+    if (result.upper >= 0 && result.lower < 0)
+      result.upper = result.lower*1e-3;
+    else if (result.upper >= 0 && result.lower >= 0)
+      foundRange = false;
+  }
+  return result;
+}
+
+/*!
+  Returns the size of the tile cache, all of which is freed by \ref releaseMemory. The tile source
+  (\ref setSource) isn't owned by the map and therefore not included.
+  
+  \seebaseclassmethod
+*/
+qint64 QCPTiledColorMap::memoryUsage(qint64 *reclaimableBytes) const
+{
+  const qint64 cacheBytes = qint64(mTileCache.totalCost())*1024; // cost unit is kilobytes
+  if (reclaimableBytes)
+    *reclaimableBytes = cacheBytes;
+  return cacheBytes;
+}
+
+/*!
+  Clears the tile cache. Tiles are regenerated from the source when they are drawn again.
+  
+  \seebaseclassmethod
+*/
+void QCPTiledColorMap::releaseMemory()
+{
+  mTileCache.clear();
+}
+
+/*! \internal
+  
+  Generates the tiles at the positions \a tiles[\a missing[i]] for i in [\a begin, \a end) and
+  stores them in \a images[\a missing[i]], as part of \ref QCPTiledColorMap::draw. Instances are
+  passed to \ref qcpParallelFor, so the tiles are generated concurrently.
+*/
+class QCPTiledColorMapTileFunctor
+{
+public:
+  QCPTiledColorMapTileFunctor(QCPTiledColorMap *map, int level, const QVector<QPoint> &tiles, const QVector<int> &missing, QImage *images) :
+    mMap(map), mLevel(level), mTiles(tiles), mMissing(missing), mImages(images)
+  {}
+  
+  void operator()(int begin, int end) const
+  {
+    for (int i=begin; i<end; ++i)
+    {
+      const QPoint tile = mTiles.at(mMissing.at(i));
+      mImages[mMissing.at(i)] = mMap->createTile(mLevel, tile.x(), tile.y());
+    }
+  }
+  
+private:
+  QCPTiledColorMap *mMap;
+  int mLevel;
+  const QVector<QPoint> &mTiles;
+  const QVector<int> &mMissing;
+  QImage *mImages;
+};
+
+/* inherits documentation from base class */
+void QCPTiledColorMap::draw(QCPPainter *painter)
+{
+  if (!mSource || mSource->keySize() <= 0 || mSource->valueSize() <= 0) return;
+  if (!mKeyAxis || !mValueAxis) return;
+  applyDefaultAntialiasingHint(painter);
+  
+  const int keySize = mSource->keySize();
+  const int valueSize = mSource->valueSize();
+  const double keyStep = keySize > 1 ? mKeyRange.size()/(double)(keySize-1) : mKeyRange.size();
+  const double valueStep = valueSize > 1 ? mValueRange.size()/(double)(valueSize-1) : mValueRange.size();
+  if (keyStep == 0 || valueStep == 0)
+    return;
+  
+  // determine the visible window in cell edge indices (edge i is the lower edge of cell i):
+  const QRect clip = clipRect();
+  double key1, value1, key2, value2;
+  pixelsToCoords(clip.topLeft(), key1, value1);
+  pixelsToCoords(clip.bottomRight(), key2, value2);
+  const double keyEdge1 = (key1-mKeyRange.lower)/keyStep+0.5;
+  const double keyEdge2 = (key2-mKeyRange.lower)/keyStep+0.5;
+  const double valueEdge1 = (value1-mValueRange.lower)/valueStep+0.5;
+  const double valueEdge2 = (value2-mValueRange.lower)/valueStep+0.5;
+  const int keyBegin = qBound(0, qFloor(qMin(keyEdge1, keyEdge2)), keySize);
+  const int keyEnd = qBound(0, qCeil(qMax(keyEdge1, keyEdge2)), keySize);
+  const int valueBegin = qBound(0, qFloor(qMin(valueEdge1, valueEdge2)), valueSize);
+  const int valueEnd = qBound(0, qCeil(qMax(valueEdge1, valueEdge2)), valueSize);
+  if (keyBegin >= keyEnd || valueBegin >= valueEnd)
+    return;
+  
+  // choose the mip level such that a tile pixel roughly corresponds to a device pixel:
+  const QPointF windowOrigin = cellEdgeToPixel(keyBegin, valueBegin);
+  const QPointF windowKeyEnd = cellEdgeToPixel(keyEnd, valueBegin);
+  const QPointF windowValueEnd = cellEdgeToPixel(keyBegin, valueEnd);
+  const double keyPixels = qMax(1.0, QCPVector2D(windowKeyEnd-windowOrigin).length()*mParentPlot->bufferDevicePixelRatio());
+  const double valuePixels = qMax(1.0, QCPVector2D(windowValueEnd-windowOrigin).length()*mParentPlot->bufferDevicePixelRatio());
+  const int level = mipLevel(qMin((keyEnd-keyBegin)/keyPixels, (valueEnd-valueBegin)/valuePixels));
+  const int step = 1 << level;
+  const int tileCells = mTileSize*step;
+  
+  // collect visible tiles, take what's available from the cache:
+  QVector<QPoint> tiles;
+  QVector<QImage> images;
+  QVector<int> missing;
+  for (int valueTile=valueBegin/tileCells; valueTile<=(valueEnd-1)/tileCells; ++valueTile)
+  {
+    for (int keyTile=keyBegin/tileCells; keyTile<=(keyEnd-1)/tileCells; ++keyTile)
+    {
+      tiles.append(QPoint(keyTile, valueTile));
+      if (QImage *cachedTile = mTileCache.object(tileCacheKey(level, keyTile, valueTile)))
+      {
+        images.append(*cachedTile);
+      } else
+      {
+        images.append(QImage());
+        missing.append(tiles.size()-1);
+      }
+    }
+  }
+  
+  // generate missing tiles in parallel and add them to the cache:
+  if (!missing.isEmpty())
+  {
+    if (mGradient.mColorBufferInvalidated)
+      mGradient.updateColorBuffer(); // must happen before the parallel section, so the concurrent colorize calls only read the color buffer
+    qcpParallelFor(missing.size(), 1, QCPTiledColorMapTileFunctor(this, level, tiles, missing, images.data()));
+    for (int i=0; i<missing.size(); ++i)
+    {
+      const QImage &tileImage = images.at(missing.at(i));
+      if (!tileImage.isNull())
+        mTileCache.insert(tileCacheKey(level, tiles.at(missing.at(i)).x(), tiles.at(missing.at(i)).y()), new QImage(tileImage), qMax(1, tileImage.bytesPerLine()*tileImage.height()/1024));
+    }
+  }
+  
+  // draw tiles, each with a transform that maps its pixels onto the covered cells:
+  const bool smoothBackup = painter->renderHints().testFlag(QPainter::SmoothPixmapTransform);
+  painter->setRenderHint(QPainter::SmoothPixmapTransform, mInterpolate);
+  for (int i=0; i<tiles.size(); ++i)
+  {
+    const QImage &tileImage = images.at(i);
+    if (tileImage.isNull())
+      continue;
+    const int keyStart = tiles.at(i).x()*tileCells;
+    const int valueStart = tiles.at(i).y()*tileCells;
+    const int width = tileImage.width();
+    const int height = tileImage.height();
+    // at mip levels > 0, the last tile pixel of a partial tile may stand for fewer than step cells, so end at the map border:
+    const int keyTileEnd = qMin(keyStart+width*step, keySize);
+    const int valueTileEnd = qMin(valueStart+height*step, valueSize);
+    // image row 0 holds the highest value indices, so the image origin is at the upper value edge:
+    const QPointF origin = cellEdgeToPixel(keyStart, valueTileEnd);
+    const QPointF keyCorner = cellEdgeToPixel(keyTileEnd, valueTileEnd);
+    const QPointF valueCorner = cellEdgeToPixel(keyStart, valueStart);
+    const QTransform tileTransform((keyCorner.x()-origin.x())/width, (keyCorner.y()-origin.y())/width,
+                                   (valueCorner.x()-origin.x())/height, (valueCorner.y()-origin.y())/height,
+                                   origin.x(), origin.y());
+    painter->save();
+    painter->setTransform(tileTransform, true);
+    painter->drawImage(QPointF(0, 0), tileImage);
+    painter->restore();
+  }
+  painter->setRenderHint(QPainter::SmoothPixmapTransform, smoothBackup);
+}
+
+/* inherits documentation from base class */
+void QCPTiledColorMap::drawLegendIcon(QCPPainter *painter, const QRectF &rect) const
+{
+  applyDefaultAntialiasingHint(painter);
+  // draw the gradient, since there is no map image to make a thumbnail of:
+  QLinearGradient legendGradient(rect.topLeft(), rect.topRight());
+  const QMap<double, QColor> colorStops = mGradient.colorStops();
+  for (QMap<double, QColor>::const_iterator it=colorStops.constBegin(); it!=colorStops.constEnd(); ++it)
+    legendGradient.setColorAt(it.key(), it.value());
+  painter->setPen(Qt::NoPen);
+  painter->setBrush(QBrush(legendGradient));
+  painter->drawRect(rect);
+}
+
+/*! \internal
+  
+  Returns the mip level at which one tile pixel represents about \a cellsPerPixel cells in each
+  dimension, i.e. the largest level n with 2^n not exceeding \a cellsPerPixel. The level is limited
+  such that a single tile pixel never spans more cells than the map has.
+*/
+int QCPTiledColorMap::mipLevel(double cellsPerPixel) const
+{
+  const int maxSize = mSource ? qMax(mSource->keySize(), mSource->valueSize()) : 1;
+  int level = 0;
+  while (level < 30 && (2 << level) <= cellsPerPixel && (2 << level) <= maxSize)
+    ++level;
+  return level;
+}
+
+/*! \internal
+  
+  Returns the key under which the tile at \a level with tile indices \a keyTile and \a valueTile is
+  stored in the tile cache.
+*/
+quint64 QCPTiledColorMap::tileCacheKey(int level, int keyTile, int valueTile) const
+{
+  return (quint64(level) << 56) | (quint64(keyTile) << 28) | quint64(valueTile);
+}
+
+/*! \internal
+  
+  Reads the cells of the tile at \a level with tile indices \a keyTile and \a valueTile from the
+  tile source and colorizes them into a new tile image. At level n, every 2^n-th cell in each
+  dimension is used. Image row 0 corresponds to the highest value index of the tile, like in the
+  map image of \ref QCPColorMap.
+  
+  This method is called concurrently for different tiles. It only reads from the map's state, which
+  requires the color buffer of the gradient to be up to date.
+*/
+QImage QCPTiledColorMap::createTile(int level, int keyTile, int valueTile)
+{
+  const int step = 1 << level;
+  const int tileCells = mTileSize*step;
+  const int keyStart = keyTile*tileCells;
+  const int valueStart = valueTile*tileCells;
+  const int width = (qMin(tileCells, mSource->keySize()-keyStart)+step-1)/step;
+  const int height = (qMin(tileCells, mSource->valueSize()-valueStart)+step-1)/step;
+  if (width <= 0 || height <= 0)
+    return QImage();
+  
+  QVector<double> cells(width*height);
+  mSource->readCells(keyStart, valueStart, width, height, step, cells.data());
+  QImage tileImage(width, height, QImage::Format_ARGB32_Premultiplied);
+  if (tileImage.isNull())
+  {
+    qDebug() << Q_FUNC_INFO << "Couldn't create tile image";
+    return tileImage;
+  }
+  for (int row=0; row<height; ++row)
+    mGradient.colorize(cells.constData()+(height-1-row)*width, mDataRange, reinterpret_cast<QRgb*>(tileImage.scanLine(row)), width, 1, mDataScaleType==QCPAxis::stLogarithmic);
+  return tileImage;
+}
+
+/*! \internal
+  
+  Returns the pixel position of the corner between cells, where \a keyIndex and \a valueIndex are
+  cell edge indices: edge i is the lower edge of cell i, and edge i+1 its upper edge.
+*/
+QPointF QCPTiledColorMap::cellEdgeToPixel(int keyIndex, int valueIndex) const
+{
+  const int keySize = mSource->keySize();
+  const int valueSize = mSource->valueSize();
+  const double keyStep = keySize > 1 ? mKeyRange.size()/(double)(keySize-1) : mKeyRange.size();
+  const double valueStep = valueSize > 1 ? mValueRange.size()/(double)(valueSize-1) : mValueRange.size();
+  return coordsToPixels(mKeyRange.lower+(keyIndex-0.5)*keyStep, mValueRange.lower+(valueIndex-0.5)*valueStep);
+}
+/* end of 'src/plottables/plottable-tiledcolormap.cpp' */
+
+
+/* including file 'src/plottables/plottable-colormapcontours.cpp'           */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPColorMapContours
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPColorMapContours
+  \brief A plottable that draws contour lines (isolines) of the data of a QCPColorMap
+  
+  This plottable is typically placed on top of a \ref QCPColorMap, with the same key and value
+  axes. It reads the cells of the color map's \ref QCPColorMapData directly (see \ref
+  setColorMap) and draws the lines along which the data crosses each of the configured contour
+  levels (see \ref setLevels). All lines are drawn with the plottable's pen.
+  
+  The lines are extracted with the marching squares algorithm, where the cell centers form the
+  grid. The map is split into bands of rows which are processed concurrently on the threads of
+  QThreadPool::globalInstance. Afterwards, the line segments are stitched into polylines, again
+  concurrently for the different levels. Ambiguous grid squares (saddle points) are resolved by
+  the average of their four corners. Squares with a NaN corner don't produce any lines.
+  
+  The extracted lines are cached until the levels or the cells of the color map change. The color
+  map data tracks modifications of its cells, so the contours are updated automatically on the next
+  replot after the data was changed. Changing only the key or value range of the color map data
+  doesn't require a new extraction. When drawing, only the parts of the lines which lie inside
+  the visible part of the map are drawn, so zooming into a large map with many contours is fast.
+  
+  The entire plottable is selected as a whole, like \ref QCPColorMap.
+*/
+
+/* start of documentation of inline functions */
+
+/*! \fn QCPColorMap *QCPColorMapContours::colorMap() const
+  
+  Returns the color map whose data is used to generate the contour lines, or 0 if none is set.
+  
+  \see setColorMap
+*/
+
+/* end of documentation of inline functions */
+
+/*!
+  Constructs a contour plottable with the specified \a keyAxis and \a valueAxis. Typically, these
+  are the same axes as the ones of the color map passed to \ref setColorMap.
+  
+  The created QCPColorMapContours is automatically registered with the QCustomPlot instance
+  inferred from \a keyAxis. This QCustomPlot instance takes ownership of the QCPColorMapContours,
+  so do not delete it manually but use QCustomPlot::removePlottable() instead.
+*/
+QCPColorMapContours::QCPColorMapContours(QCPAxis *keyAxis, QCPAxis *valueAxis) :
+  QCPAbstractPlottable(keyAxis, valueAxis),
+  mContoursInvalidated(true),
+  mContourData(0),
+  mContourRevision(0)
+{
+}
+
+QCPColorMapContours::~QCPColorMapContours()
+{
+}
+
+/*!
+  Sets the color map whose data shall be used to generate the contour lines. The color map isn't
+  owned by this plottable. If it's removed from the plot, no contours are drawn anymore.
+*/
+void QCPColorMapContours::setColorMap(QCPColorMap *colorMap)
+{
+  if (mColorMap.data() != colorMap)
+  {
+    mColorMap = colorMap;
+    invalidateContours();
+  }
+}
+
+/*!
+  Sets the data values at which contour lines are generated.
+  
+  \see setLevels(int count, const QCPRange &range)
+*/
+void QCPColorMapContours::setLevels(const QVector<double> &levels)
+{
+  mLevels = levels;
+  invalidateContours();
+  markLayerDirty();
+}
+
+/*! \overload
+  
+  Sets \a count contour levels, evenly spaced inside \a range. The boundaries of \a range themselves
+  are not used as levels, since contours at the data extremes degenerate to single points. For
+  example, <tt>setLevels(4, QCPRange(0, 10))</tt> sets the levels 2, 4, 6 and 8.
+*/
+void QCPColorMapContours::setLevels(int count, const QCPRange &range)
+{
+  QVector<double> levels;
+  for (int i=0; i<count; ++i)
+    levels.append(range.lower+(i+1)*range.size()/(double)(count+1));
+  setLevels(levels);
+}
+
+/*!
+  Discards the cached contour lines, so they are extracted again on the next replot.
+  
+  Normally, this isn't necessary, since changes of the levels and of the color map's cells are
+  detected automatically.
+*/
+void QCPColorMapContours::invalidateContours()
+{
+  mContoursInvalidated = true;
+  markLayerDirty();
+}
+
+/*!
+  Additionally takes the revision of the source color map (\ref setColorMap) into account, because
+  the contours are derived from its data.
+  
+  \seebaseclassmethod
+*/
+quint64 QCPColorMapContours::contentRevision() const
+{
+  quint64 result = QCPAbstractPlottable::contentRevision();
+  if (mColorMap)
+    result += mColorMap.data()->contentRevision();
+  return result;
+}
+
+/* inherits documentation from base class */
+double QCPColorMapContours::selectTest(const QPointF &pos, bool onlySelectable, QVariant *details) const
+{
+  if ((onlySelectable && mSelectable == QCP::stNone) || mPieces.isEmpty())
+    return -1;
+  if (!mKeyAxis || !mValueAxis)
+    return -1;
+  const QCPColorMapData *data = mColorMap ? mColorMap.data()->data() : 0;
+  if (!data || data != mContourData)
+    return -1;
+  
+  if (mKeyAxis.data()->axisRect()->rect().contains(pos.toPoint()))
+  {
+    const QCPVector2D posVec(pos);
+    double minDistSqr = (std::numeric_limits<double>::max)();
+    for (int i=0; i<mPieces.size(); ++i)
+    {
+      const QPolygonF &points = mPieces.at(i).points;
+      QCPVector2D lastPixel(cellToPixel(points.first(), data));
+      for (int j=1; j<points.size(); ++j)
+      {
+        const QCPVector2D pixel(cellToPixel(points.at(j), data));
+        const double distSqr = posVec.distanceSquaredToLine(lastPixel, pixel);
+        if (distSqr < minDistSqr)
+          minDistSqr = distSqr;
+        lastPixel = pixel;
+      }
+    }
+    if (details)
+      details->setValue(QCPDataSelection(QCPDataRange(0, 1))); // whole-plottable selection, same as QCPColorMap
+    return qSqrt(minDistSqr);
+  }
+  return -1;
+}
+
+/* inherits documentation from base class */
+QCPRange QCPColorMapContours::getKeyRange(bool &foundRange, QCP::SignDomain inSignDomain) const
+{
+  if (mColorMap)
+    return mColorMap.data()->getKeyRange(foundRange, inSignDomain);
+  foundRange = false;
+  return QCPRange();
+}
+
+/* inherits documentation from base class */
+QCPRange QCPColorMapContours::getValueRange(bool &foundRange, QCP::SignDomain inSignDomain, const QCPRange &inKeyRange) const
+{
+  if (mColorMap)
+    return mColorMap.data()->getValueRange(foundRange, inSignDomain, inKeyRange);
+  foundRange = false;
+  return QCPRange();
+}
+
+/*!
+  Returns the memory held by the extracted contour lines. The source color map (\ref setColorMap)
+  reports its own memory.
+  
+  \seebaseclassmethod
+*/
+qint64 QCPColorMapContours::memoryUsage(qint64 *reclaimableBytes) const
+{
+  if (reclaimableBytes)
+    *reclaimableBytes = 0;
+  qint64 result = qint64(mPieces.capacity())*sizeof(ContourPiece);
+  for (int i=0; i<mPieces.size(); ++i)
+    result += qint64(mPieces.at(i).points.capacity())*sizeof(QPointF);
+  return result;
+}
+
+/*! \internal
+  
+  Extracts the contour line segments of a range of row bands of a \ref QCPColorMapData, as part of
+  \ref QCPColorMapContours::updateContours. Band i consists of the grid squares between the value
+  indices [i*\a bandRows, (i+1)*\a bandRows] (the last band may be smaller). The function call
+  operator processes the bands [\a begin, \a end), so instances can be passed to \ref
+  qcpParallelFor. The segments of band i and level j are appended to \a
+  bandSegments[i*levelCount + j], so every vector is written by exactly one call.
   
-  If the map cell count is low, the image created will be oversampled in order to avoid a
-  QPainter::drawImage bug which makes inner pixel boundaries jitter when stretch-drawing images
-  without smooth transform enabled. Accordingly, oversampling isn't performed if \ref
-  setInterpolate is true.
+  A segment connects two points on grid edges. Each edge has an id which is shared by the two grid
+  squares adjacent to it, and the crossing point on an edge is calculated identically from both
+  sides. The stitching (see \ref QCPColorMapContourStitchFunctor) uses the ids to connect the
+  segments to polylines.
 */
-void QCPColorMap::updateMapImage()
+class QCPColorMapContourBandFunctor
 {
-  QCPAxis *keyAxis = mKeyAxis.data();
-  if (!keyAxis) return;
-  if (mMapData->isEmpty()) return;
-  
-  const QImage::Format format = QImage::Format_ARGB32_Premultiplied;
-  const int keySize = mMapData->keySize();
-  const int valueSize = mMapData->valueSize();
-  int keyOversamplingFactor = mInterpolate ? 1 : (int)(1.0+100.0/(double)keySize); // make mMapImage have at least size 100, factor becomes 1 if size > 200 or interpolation is on
-  int valueOversamplingFactor = mInterpolate ? 1 : (int)(1.0+100.0/(double)valueSize); // make mMapImage have at least size 100, factor becomes 1 if size > 200 or interpolation is on
+public:
+  struct Segment
+  {
+    qint64 edge1, edge2;
+    QPointF point1, point2;
+  };
   
-  // resize mMapImage to correct dimensions including possible oversampling factors, according to key/value axes orientation:
-  if (keyAxis->orientation() == Qt::Horizontal && (mMapImage.width() != keySize*keyOversamplingFactor || mMapImage.height() != valueSize*valueOversamplingFactor))
-    mMapImage = QImage(QSize(keySize*keyOversamplingFactor, valueSize*valueOversamplingFactor), format);
-  else if (keyAxis->orientation() == Qt::Vertical && (mMapImage.width() != valueSize*valueOversamplingFactor || mMapImage.height() != keySize*keyOversamplingFactor))
-    mMapImage = QImage(QSize(valueSize*valueOversamplingFactor, keySize*keyOversamplingFactor), format);
+  QCPColorMapContourBandFunctor(const QCPColorMapData *data, const QVector<double> &levels, int bandRows, QVector<Segment> *bandSegments) :
+    mData(data), mLevels(levels), mBandRows(bandRows), mBandSegments(bandSegments)
+  {}
   
-  if (mMapImage.isNull())
-  {
-    qDebug() << Q_FUNC_INFO << "Couldn't create map image (possibly too large for memory)";
-    mMapImage = QImage(QSize(10, 10), format);
-    mMapImage.fill(Qt::black);
-  } else
+  void operator()(int begin, int end) const
   {
-    QImage *localMapImage = &mMapImage; // this is the image on which the colorization operates. Either the final mMapImage, or if we need oversampling, mUndersampledMapImage
-    if (keyOversamplingFactor > 1 || valueOversamplingFactor > 1)
-    {
-      // resize undersampled map image to actual key/value cell sizes:
-      if (keyAxis->orientation() == Qt::Horizontal && (mUndersampledMapImage.width() != keySize || mUndersampledMapImage.height() != valueSize))
-        mUndersampledMapImage = QImage(QSize(keySize, valueSize), format);
-      else if (keyAxis->orientation() == Qt::Vertical && (mUndersampledMapImage.width() != valueSize || mUndersampledMapImage.height() != keySize))
-        mUndersampledMapImage = QImage(QSize(valueSize, keySize), format);
-      localMapImage = &mUndersampledMapImage; // make the colorization run on the undersampled image
-    } else if (!mUndersampledMapImage.isNull())
-      mUndersampledMapImage = QImage(); // don't need oversampling mechanism anymore (map size has changed) but mUndersampledMapImage still has nonzero size, free it
-    
-    const double *rawData = mMapData->mData;
-    const unsigned char *rawAlpha = mMapData->mAlpha;
-    if (keyAxis->orientation() == Qt::Horizontal)
+    const int keySize = mData->mKeySize;
+    QVector<double> lowerRow(keySize), upperRow(keySize);
+    for (int band=begin; band<end; ++band)
     {
-      const int lineCount = valueSize;
-      const int rowCount = keySize;
-      for (int line=0; line<lineCount; ++line)
+      const int rowBegin = band*mBandRows;
+      const int rowEnd = qMin(rowBegin+mBandRows, mData->mValueSize-1);
+      QVector<Segment> *segments = mBandSegments+qint64(band)*mLevels.size();
+      readRow(rowBegin, lowerRow.data());
+      for (int valueIndex=rowBegin; valueIndex<rowEnd; ++valueIndex)
       {
-        QRgb* pixels = reinterpret_cast<QRgb*>(localMapImage->scanLine(lineCount-1-line)); // invert scanline index because QImage counts scanlines from top, but our vertical index counts from bottom (mathematical coordinate system)
-        if (rawAlpha)
-          mGradient.colorize(rawData+line*rowCount, rawAlpha+line*rowCount, mDataRange, pixels, rowCount, 1, mDataScaleType==QCPAxis::stLogarithmic);
-        else
-          mGradient.colorize(rawData+line*rowCount, mDataRange, pixels, rowCount, 1, mDataScaleType==QCPAxis::stLogarithmic);
+        readRow(valueIndex+1, upperRow.data());
+        for (int level=0; level<mLevels.size(); ++level)
+          processRow(valueIndex, lowerRow.constData(), upperRow.constData(), mLevels.at(level), segments[level]);
+        qSwap(lowerRow, upperRow);
       }
-    } else // keyAxis->orientation() == Qt::Vertical
-    {
-      const int lineCount = keySize;
-      const int rowCount = valueSize;
-      for (int line=0; line<lineCount; ++line)
+    }
+  }
+  
+private:
+  const QCPColorMapData *mData;
+  const QVector<double> &mLevels;
+  int mBandRows;
+  QVector<Segment> *mBandSegments;
+  
+  /*
+    Copies the cells with the given value index to target, in logical key order (i.e. resolving the
+    ring buffer offset of appendRow) and converted to double.
+  */
+  void readRow(int valueIndex, double *target) const
+  {
+    const int keySize = mData->mKeySize;
+    const int rowOffset = valueIndex*keySize;
+    for (int keyIndex=0; keyIndex<keySize; ++keyIndex)
+      target[keyIndex] = mData->storedCell(rowOffset+mData->storageKeyIndex(keyIndex));
+  }
+  
+  /*
+    Runs marching squares on the grid squares between the value indices valueIndex and valueIndex+1
+    (with the cell rows lower and upper) and appends the segments for level to segments.
+  */
+  void processRow(int valueIndex, const double *lower, const double *upper, double level, QVector<Segment> &segments) const
+  {
+    // sides of a grid square: 0 bottom, 1 right, 2 top, 3 left. Pairs of sides connected by a segment, for each corner configuration:
+    static const int sideTable[16][4] = {{-1, -1, -1, -1}, {3, 0, -1, -1}, {0, 1, -1, -1}, {3, 1, -1, -1},
+                                         {1, 2, -1, -1},   {3, 0, 1, 2},   {0, 2, -1, -1}, {3, 2, -1, -1},
+                                         {2, 3, -1, -1},   {0, 2, -1, -1}, {0, 1, 2, 3},   {1, 2, -1, -1},
+                                         {1, 3, -1, -1},   {0, 1, -1, -1}, {3, 0, -1, -1}, {-1, -1, -1, -1}};
+    static const int saddleSidesAround13[4] = {0, 1, 2, 3}; // segments cut off corners 1 and 3
+    static const int saddleSidesAround02[4] = {3, 0, 1, 2}; // segments cut off corners 0 and 2
+    const int keySize = mData->mKeySize;
+    for (int keyIndex=0; keyIndex<keySize-1; ++keyIndex)
+    {
+      // corners counter-clockwise, starting at the lower left:
+      const double corners[4] = {lower[keyIndex], lower[keyIndex+1], upper[keyIndex+1], upper[keyIndex]};
+      const int configuration = (corners[0] >= level) | (corners[1] >= level) << 1 | (corners[2] >= level) << 2 | (corners[3] >= level) << 3;
+      if (configuration == 0 || configuration == 15)
+        continue;
+      if (qIsNaN(corners[0]) || qIsNaN(corners[1]) || qIsNaN(corners[2]) || qIsNaN(corners[3]))
+        continue;
+      const int *sides = sideTable[configuration];
+      if (configuration == 5 || configuration == 10) // saddle, decide by the center which corners are connected
       {
-        QRgb* pixels = reinterpret_cast<QRgb*>(localMapImage->scanLine(lineCount-1-line)); // invert scanline index because QImage counts scanlines from top, but our vertical index counts from bottom (mathematical coordinate system)
-        if (rawAlpha)
-          mGradient.colorize(rawData+line, rawAlpha+line, mDataRange, pixels, rowCount, lineCount, mDataScaleType==QCPAxis::stLogarithmic);
-        else
-          mGradient.colorize(rawData+line, mDataRange, pixels, rowCount, lineCount, mDataScaleType==QCPAxis::stLogarithmic);
+        const bool centerAbove = (corners[0]+corners[1]+corners[2]+corners[3])*0.25 >= level;
+        sides = (configuration == 5) == centerAbove ? saddleSidesAround13 : saddleSidesAround02;
+      }
+      for (int i=0; i<4 && sides[i] >= 0; i+=2)
+      {
+        Segment segment;
+        edgePoint(keyIndex, valueIndex, sides[i], corners, level, segment.edge1, segment.point1);
+        edgePoint(keyIndex, valueIndex, sides[i+1], corners, level, segment.edge2, segment.point2);
+        segments.append(segment);
       }
     }
-    
-    if (keyOversamplingFactor > 1 || valueOversamplingFactor > 1)
+  }
+  
+  /*
+    Returns the id and the crossing point (in cell index coordinates) of the given side of the grid
+    square with the lower left cell (keyIndex, valueIndex). Horizontal edges have even ids, vertical
+    edges odd ids. The interpolation always goes from the lower to the higher index, so both
+    squares adjacent to an edge calculate the same point.
+  */
+  void edgePoint(int keyIndex, int valueIndex, int side, const double *corners, double level, qint64 &id, QPointF &point) const
+  {
+    const qint64 keySize = mData->mKeySize;
+    switch (side)
     {
-      if (keyAxis->orientation() == Qt::Horizontal)
-        mMapImage = mUndersampledMapImage.scaled(keySize*keyOversamplingFactor, valueSize*valueOversamplingFactor, Qt::IgnoreAspectRatio, Qt::FastTransformation);
-      else
-        mMapImage = mUndersampledMapImage.scaled(valueSize*valueOversamplingFactor, keySize*keyOversamplingFactor, Qt::IgnoreAspectRatio, Qt::FastTransformation);
+      case 0:
+        id = 2*(valueIndex*keySize+keyIndex);
+        point = QPointF(keyIndex+(level-corners[0])/(corners[1]-corners[0]), valueIndex);
+        break;
+      case 1:
+        id = 2*(valueIndex*keySize+keyIndex+1)+1;
+        point = QPointF(keyIndex+1, valueIndex+(level-corners[1])/(corners[2]-corners[1]));
+        break;
+      case 2:
+        id = 2*((valueIndex+1)*keySize+keyIndex);
+        point = QPointF(keyIndex+(level-corners[3])/(corners[2]-corners[3]), valueIndex+1);
+        break;
+      default:
+        id = 2*(valueIndex*keySize+keyIndex)+1;
+        point = QPointF(keyIndex, valueIndex+(level-corners[0])/(corners[3]-corners[0]));
+        break;
     }
   }
-  mMapData->mDataModified = false;
-  mMapImageInvalidated = false;
-}
+};
 
-/* inherits documentation from base class */
-void QCPColorMap::draw(QCPPainter *painter)
+/*! \internal
+  
+  Stitches the segments generated by \ref QCPColorMapContourBandFunctor into polylines, as part of
+  \ref QCPColorMapContours::updateContours. The function call operator processes the levels
+  [\a begin, \a end), so instances can be passed to \ref qcpParallelFor. The polylines of level j
+  are split into pieces of limited length (for culling when drawing) and stored in \a pieces[j].
+  
+  Every segment end lies on a grid edge, and at most two segment ends share an edge. So after
+  sorting the segment ends by edge id, each end finds its continuation next to it. Open polylines
+  are then followed from one of their ends, closed polylines from an arbitrary segment.
+*/
+class QCPColorMapContourStitchFunctor
 {
-  if (mMapData->isEmpty()) return;
-  if (!mKeyAxis || !mValueAxis) return;
-  applyDefaultAntialiasingHint(painter);
+public:
+  typedef QCPColorMapContourBandFunctor::Segment Segment;
   
-  if (mMapData->mDataModified || mMapImageInvalidated)
-    updateMapImage();
+  QCPColorMapContourStitchFunctor(const QVector<QVector<Segment> > &bandSegments, int bandCount, int levelCount, QVector<QCPColorMapContours::ContourPiece> *pieces) :
+    mBandSegments(bandSegments), mBandCount(bandCount), mLevelCount(levelCount), mPieces(pieces)
+  {}
   
-  // use buffer if painting vectorized (PDF):
-  const bool useBuffer = painter->modes().testFlag(QCPPainter::pmVectorized);
-  QCPPainter *localPainter = painter; // will be redirected to paint on mapBuffer if painting vectorized
-  QRectF mapBufferTarget; // the rect in absolute widget coordinates where the visible map portion/buffer will end up in
-  QPixmap mapBuffer;
-  if (useBuffer)
-  {
-    const double mapBufferPixelRatio = 3; // factor by which DPI is increased in embedded bitmaps
-    mapBufferTarget = painter->clipRegion().boundingRect();
-    mapBuffer = QPixmap((mapBufferTarget.size()*mapBufferPixelRatio).toSize());
-    mapBuffer.fill(Qt::transparent);
-    localPainter = new QCPPainter(&mapBuffer);
-    localPainter->scale(mapBufferPixelRatio, mapBufferPixelRatio);
-    localPainter->translate(-mapBufferTarget.topLeft());
-  }
+  static int maxPieceSize() { return 256; }
   
-  QRectF imageRect = QRectF(coordsToPixels(mMapData->keyRange().lower, mMapData->valueRange().lower),
-                            coordsToPixels(mMapData->keyRange().upper, mMapData->valueRange().upper)).normalized();
-  // extend imageRect to contain outer halves/quarters of bordering/cornering pixels (cells are centered on map range boundary):
-  double halfCellWidth = 0; // in pixels
-  double halfCellHeight = 0; // in pixels
-  if (keyAxis()->orientation() == Qt::Horizontal)
+  void operator()(int begin, int end) const
   {
-    if (mMapData->keySize() > 1)
-      halfCellWidth = 0.5*imageRect.width()/(double)(mMapData->keySize()-1);
-    if (mMapData->valueSize() > 1)
-      halfCellHeight = 0.5*imageRect.height()/(double)(mMapData->valueSize()-1);
-  } else // keyAxis orientation is Qt::Vertical
-  {
-    if (mMapData->keySize() > 1)
-      halfCellHeight = 0.5*imageRect.height()/(double)(mMapData->keySize()-1);
-    if (mMapData->valueSize() > 1)
-      halfCellWidth = 0.5*imageRect.width()/(double)(mMapData->valueSize()-1);
+    for (int level=begin; level<end; ++level)
+    {
+      // gather the segments of this level from all bands:
+      QVector<Segment> segments;
+      for (int band=0; band<mBandCount; ++band)
+        segments += mBandSegments.at(band*mLevelCount+level);
+      if (segments.isEmpty())
+        continue;
+      
+      // find the partner of each segment end (index segment*2+end), i.e. the end of the adjacent segment on the same edge:
+      const int endCount = segments.size()*2;
+      QVector<QPair<qint64, int> > ends(endCount);
+      for (int i=0; i<segments.size(); ++i)
+      {
+        ends[i*2] = qMakePair(segments.at(i).edge1, i*2);
+        ends[i*2+1] = qMakePair(segments.at(i).edge2, i*2+1);
+      }
+      std::sort(ends.begin(), ends.end());
+      QVector<int> partner(endCount, -1);
+      for (int i=0; i<endCount-1; ++i)
+      {
+        if (ends.at(i).first == ends.at(i+1).first)
+        {
+          partner[ends.at(i).second] = ends.at(i+1).second;
+          partner[ends.at(i+1).second] = ends.at(i).second;
+          ++i;
+        }
+      }
+      
+      // follow the polylines:
+      QVector<bool> visited(segments.size(), false);
+      QPolygonF polyline;
+      for (int i=0; i<segments.size(); ++i)
+      {
+        if (visited.at(i))
+          continue;
+        // walk backwards to the start of the polyline (stays at i for closed polylines):
+        int start = i;
+        int startEnd = 0; // the end of the start segment at which the polyline begins
+        int next = partner.at(i*2);
+        while (next >= 0 && next/2 != i)
+        {
+          start = next/2;
+          startEnd = 1-next%2;
+          next = partner.at(start*2+startEnd);
+        }
+        // walk forward and collect the points:
+        polyline.clear();
+        int current = start;
+        int entry = startEnd;
+        polyline << endPoint(segments.at(current), entry);
+        forever
+        {
+          visited[current] = true;
+          polyline << endPoint(segments.at(current), 1-entry);
+          next = partner.at(current*2+1-entry);
+          if (next < 0 || next/2 == start)
+            break;
+          current = next/2;
+          entry = next%2;
+        }
+        appendPieces(level, polyline);
+      }
+    }
   }
-  imageRect.adjust(-halfCellWidth, -halfCellHeight, halfCellWidth, halfCellHeight);
-  const bool mirrorX = (keyAxis()->orientation() == Qt::Horizontal ? keyAxis() : valueAxis())->rangeReversed();
-  const bool mirrorY = (valueAxis()->orientation() == Qt::Vertical ? valueAxis() : keyAxis())->rangeReversed();
-  const bool smoothBackup = localPainter->renderHints().testFlag(QPainter::SmoothPixmapTransform);
-  localPainter->setRenderHint(QPainter::SmoothPixmapTransform, mInterpolate);
-  QRegion clipBackup;
-  if (mTightBoundary)
+  
+private:
+  const QVector<QVector<Segment> > &mBandSegments;
+  int mBandCount, mLevelCount;
+  QVector<QCPColorMapContours::ContourPiece> *mPieces;
+  
+  static QPointF endPoint(const Segment &segment, int end) { return end == 0 ? segment.point1 : segment.point2; }
+  
+  /*
+    Splits polyline into pieces of at most maxPieceSize points (consecutive pieces share a point)
+    and appends them to the pieces of level.
+  */
+  void appendPieces(int level, const QPolygonF &polyline) const
   {
-    clipBackup = localPainter->clipRegion();
-    QRectF tightClipRect = QRectF(coordsToPixels(mMapData->keyRange().lower, mMapData->valueRange().lower),
-                                  coordsToPixels(mMapData->keyRange().upper, mMapData->valueRange().upper)).normalized();
-    localPainter->setClipRect(tightClipRect, Qt::IntersectClip);
+    for (int first=0; first<polyline.size()-1; first+=maxPieceSize()-1)
+    {
+      QCPColorMapContours::ContourPiece piece;
+      piece.level = level;
+      piece.points = polyline.mid(first, maxPieceSize());
+      piece.bounds = piece.points.boundingRect();
+      mPieces[level].append(piece);
+    }
   }
-  localPainter->drawImage(imageRect, mMapImage.mirrored(mirrorX, mirrorY));
-  if (mTightBoundary)
-    localPainter->setClipRegion(clipBackup);
-  localPainter->setRenderHint(QPainter::SmoothPixmapTransform, smoothBackup);
+};
+
+/* inherits documentation from base class */
+void QCPColorMapContours::draw(QCPPainter *painter)
+{
+  if (!mKeyAxis || !mValueAxis) return;
+  const QCPColorMapData *data = mColorMap ? mColorMap.data()->data() : 0;
+  if (mContoursInvalidated || data != mContourData || (data && data->mRevision != mContourRevision))
+    updateContours();
+  if (!data || mPieces.isEmpty()) return;
+  
+  // determine the visible window in cell index coordinates, to skip pieces outside of it:
+  const QCPRange keyRange = data->keyRange();
+  const QCPRange valueRange = data->valueRange();
+  const double keyStep = keyRange.size()/(double)(data->keySize()-1);
+  const double valueStep = valueRange.size()/(double)(data->valueSize()-1);
+  if (keyStep == 0 || valueStep == 0)
+    return;
+  const QRect clip = clipRect();
+  double key1, value1, key2, value2;
+  pixelsToCoords(clip.topLeft(), key1, value1);
+  pixelsToCoords(clip.bottomRight(), key2, value2);
+  const QRectF window = QRectF(QPointF((key1-keyRange.lower)/keyStep, (value1-valueRange.lower)/valueStep),
+                               QPointF((key2-keyRange.lower)/keyStep, (value2-valueRange.lower)/valueStep)).normalized();
   
-  if (useBuffer) // localPainter painted to mapBuffer, so now draw buffer with original painter
+  applyDefaultAntialiasingHint(painter);
+  if (selected() && mSelectionDecorator)
+    mSelectionDecorator->applyPen(painter);
+  else
+    painter->setPen(mPen);
+  painter->setBrush(Qt::NoBrush);
+  QPolygonF pixels;
+  for (int i=0; i<mPieces.size(); ++i)
   {
-    delete localPainter;
-    painter->drawPixmap(mapBufferTarget.toRect(), mapBuffer);
+    const ContourPiece &piece = mPieces.at(i);
+    // compare manually, QRectF::intersects is false for the degenerate bounds of straight pieces:
+    if (piece.bounds.right() < window.left() || piece.bounds.left() > window.right() ||
+        piece.bounds.bottom() < window.top() || piece.bounds.top() > window.bottom())
+      continue;
+    pixels.resize(piece.points.size());
+    for (int j=0; j<piece.points.size(); ++j)
+      pixels[j] = cellToPixel(piece.points.at(j), data);
+    painter->drawPolyline(pixels);
   }
 }
 
 /* inherits documentation from base class */
-void QCPColorMap::drawLegendIcon(QCPPainter *painter, const QRectF &rect) const
+void QCPColorMapContours::drawLegendIcon(QCPPainter *painter, const QRectF &rect) const
 {
   applyDefaultAntialiasingHint(painter);
-  // draw map thumbnail:
-  if (!mLegendIcon.isNull())
-  {
-    QPixmap scaledIcon = mLegendIcon.scaled(rect.size().toSize(), Qt::KeepAspectRatio, Qt::FastTransformation);
-    QRectF iconRect = QRectF(0, 0, scaledIcon.width(), scaledIcon.height());
-    iconRect.moveCenter(rect.center());
-    painter->drawPixmap(iconRect.topLeft(), scaledIcon);
-  }
-  /*
-  // draw frame:
-  painter->setBrush(Qt::NoBrush);
-  painter->setPen(Qt::black);
-  painter->drawRect(rect.adjusted(1, 1, 0, 0));
-  */
+  painter->setPen(mPen);
+  painter->drawLine(QLineF(rect.left(), rect.top()+rect.height()/2.0, rect.right()+5, rect.top()+rect.height()/2.0)); // +5 on x2 else last segment is missing from dashed/dotted pens
 }
-/* end of 'src/plottables/plottable-colormap.cpp' */
+
+/*! \internal
+  
+  Extracts the contour lines of the current color map data for all levels and stores them as
+  pieces in cell index coordinates. The extraction runs in parallel over row bands, the stitching
+  in parallel over levels.
+*/
+void QCPColorMapContours::updateContours()
+{
+  mPieces.clear();
+  const QCPColorMapData *data = mColorMap ? mColorMap.data()->data() : 0;
+  mContourData = data;
+  mContourRevision = data ? data->mRevision : 0;
+  mContoursInvalidated = false;
+  if (!data || data->keySize() < 2 || data->valueSize() < 2 || mLevels.isEmpty())
+    return;
+  
+  const int levelCount = mLevels.size();
+  const int squareRows = data->valueSize()-1;
+  const int bandRows = qMax(1, 65536/data->keySize()); // bands of about 64k grid squares
+  const int bandCount = (squareRows+bandRows-1)/bandRows;
+  QVector<QVector<QCPColorMapContourBandFunctor::Segment> > bandSegments(bandCount*levelCount);
+  qcpParallelFor(bandCount, 1, QCPColorMapContourBandFunctor(data, mLevels, bandRows, bandSegments.data()));
+  
+  QVector<QVector<ContourPiece> > levelPieces(levelCount);
+  qcpParallelFor(levelCount, 1, QCPColorMapContourStitchFunctor(bandSegments, bandCount, levelCount, levelPieces.data()));
+  for (int level=0; level<levelCount; ++level)
+    mPieces += levelPieces.at(level);
+}
+
+/*! \internal
+  
+  Transforms the point \a cell given in cell index coordinates of \a data (fractional key and
+  value indices) to pixel coordinates.
+*/
+QPointF QCPColorMapContours::cellToPixel(const QPointF &cell, const QCPColorMapData *data) const
+{
+  const QCPRange keyRange = data->keyRange();
+  const QCPRange valueRange = data->valueRange();
+  return coordsToPixels(keyRange.lower+cell.x()*keyRange.size()/(double)(data->keySize()-1),
+                        valueRange.lower+cell.y()*valueRange.size()/(double)(data->valueSize()-1));
+}
+/* end of 'src/plottables/plottable-colormapcontours.cpp' */
 
 
 /* including file 'src/plottables/plottable-financial.cpp', size 42827       */
@@ -26341,6 +32792,7 @@ QCPFinancial::~QCPFinancial()
 void QCPFinancial::setData(QSharedPointer<QCPFinancialDataContainer> data)
 {
   mDataContainer = data;
+  markLayerDirty();
 }
 
 /*! \overload
@@ -26358,6 +32810,7 @@ void QCPFinancial::setData(const QVector<double> &keys, const QVector<double> &o
 {
   mDataContainer->clear();
   addData(keys, open, high, low, close, alreadySorted);
+  markLayerDirty();
 }
 
 /*!
@@ -26366,6 +32819,7 @@ void QCPFinancial::setData(const QVector<double> &keys, const QVector<double> &o
 void QCPFinancial::setChartStyle(QCPFinancial::ChartStyle style)
 {
   mChartStyle = style;
+  markLayerDirty();
 }
 
 /*!
@@ -26376,6 +32830,7 @@ void QCPFinancial::setChartStyle(QCPFinancial::ChartStyle style)
 void QCPFinancial::setWidth(double width)
 {
   mWidth = width;
+  markLayerDirty();
 }
 
 /*!
@@ -26389,6 +32844,7 @@ void QCPFinancial::setWidth(double width)
 void QCPFinancial::setWidthType(QCPFinancial::WidthType widthType)
 {
   mWidthType = widthType;
+  markLayerDirty();
 }
 
 /*!
@@ -26403,6 +32859,7 @@ void QCPFinancial::setWidthType(QCPFinancial::WidthType widthType)
 void QCPFinancial::setTwoColored(bool twoColored)
 {
   mTwoColored = twoColored;
+  markLayerDirty();
 }
 
 /*!
@@ -26417,6 +32874,7 @@ void QCPFinancial::setTwoColored(bool twoColored)
 void QCPFinancial::setBrushPositive(const QBrush &brush)
 {
   mBrushPositive = brush;
+  markLayerDirty();
 }
 
 /*!
@@ -26431,6 +32889,7 @@ void QCPFinancial::setBrushPositive(const QBrush &brush)
 void QCPFinancial::setBrushNegative(const QBrush &brush)
 {
   mBrushNegative = brush;
+  markLayerDirty();
 }
 
 /*!
@@ -26445,6 +32904,7 @@ void QCPFinancial::setBrushNegative(const QBrush &brush)
 void QCPFinancial::setPenPositive(const QPen &pen)
 {
   mPenPositive = pen;
+  markLayerDirty();
 }
 
 /*!
@@ -26459,6 +32919,7 @@ void QCPFinancial::setPenPositive(const QPen &pen)
 void QCPFinancial::setPenNegative(const QPen &pen)
 {
   mPenNegative = pen;
+  markLayerDirty();
 }
 
 /*! \overload
@@ -27235,6 +33696,7 @@ QCPErrorBars::~QCPErrorBars()
 void QCPErrorBars::setData(QSharedPointer<QCPErrorBarsDataContainer> data)
 {
   mDataContainer = data;
+  markLayerDirty();
 }
 
 /*! \overload
@@ -27250,6 +33712,7 @@ void QCPErrorBars::setData(const QVector<double> &error)
 {
   mDataContainer->clear();
   addData(error);
+  markLayerDirty();
 }
 
 /*! \overload
@@ -27266,6 +33729,7 @@ void QCPErrorBars::setData(const QVector<double> &errorMinus, const QVector<doub
 {
   mDataContainer->clear();
   addData(errorMinus, errorPlus);
+  markLayerDirty();
 }
 
 /*!
@@ -27284,6 +33748,7 @@ void QCPErrorBars::setData(const QVector<double> &errorMinus, const QVector<doub
 */
 void QCPErrorBars::setDataPlottable(QCPAbstractPlottable *plottable)
 {
+  markLayerDirty();
   if (plottable && qobject_cast<QCPErrorBars*>(plottable))
   {
     mDataPlottable = 0;
@@ -27307,6 +33772,7 @@ void QCPErrorBars::setDataPlottable(QCPAbstractPlottable *plottable)
 void QCPErrorBars::setErrorType(ErrorType type)
 {
   mErrorType = type;
+  markLayerDirty();
 }
 
 /*!
@@ -27316,6 +33782,7 @@ void QCPErrorBars::setErrorType(ErrorType type)
 void QCPErrorBars::setWhiskerWidth(double pixels)
 {
   mWhiskerWidth = pixels;
+  markLayerDirty();
 }
 
 /*!
@@ -27326,6 +33793,7 @@ void QCPErrorBars::setWhiskerWidth(double pixels)
 void QCPErrorBars::setSymbolGap(double pixels)
 {
   mSymbolGap = pixels;
+  markLayerDirty();
 }
 
 /*! \overload
@@ -27340,6 +33808,7 @@ void QCPErrorBars::setSymbolGap(double pixels)
 void QCPErrorBars::addData(const QVector<double> &error)
 {
   addData(error, error);
+  markLayerDirty();
 }
 
 /*! \overload
@@ -27360,6 +33829,7 @@ void QCPErrorBars::addData(const QVector<double> &errorMinus, const QVector<doub
   mDataContainer->reserve(n);
   for (int i=0; i<n; ++i)
     mDataContainer->append(QCPErrorBarsData(errorMinus.at(i), errorPlus.at(i)));
+  markLayerDirty();
 }
 
 /*! \overload
@@ -27374,6 +33844,7 @@ void QCPErrorBars::addData(const QVector<double> &errorMinus, const QVector<doub
 void QCPErrorBars::addData(double error)
 {
   mDataContainer->append(QCPErrorBarsData(error));
+  markLayerDirty();
 }
 
 /*! \overload
@@ -27389,6 +33860,7 @@ void QCPErrorBars::addData(double error)
 void QCPErrorBars::addData(double errorMinus, double errorPlus)
 {
   mDataContainer->append(QCPErrorBarsData(errorMinus, errorPlus));
+  markLayerDirty();
 }
 
 /* inherits documentation from base class */
@@ -27534,6 +34006,42 @@ int QCPErrorBars::findEnd(double sortKey, bool expandedRange) const
   return 0;
 }
 
+/*!
+  Additionally takes the data plottable (\ref setDataPlottable) into account, because the error
+  bars are positioned at its data points.
+  
+  \seebaseclassmethod
+*/
+quint64 QCPErrorBars::contentRevision() const
+{
+  quint64 result = QCPAbstractPlottable::contentRevision();
+  if (mDataPlottable)
+    result += mDataPlottable.data()->contentRevision();
+  return result;
+}
+
+/*!
+  Accounts for the error bar data, including unused reserved capacity, which is reclaimable.
+  
+  \seebaseclassmethod
+*/
+qint64 QCPErrorBars::memoryUsage(qint64 *reclaimableBytes) const
+{
+  if (reclaimableBytes)
+    *reclaimableBytes = qint64(mDataContainer->capacity()-mDataContainer->size())*sizeof(QCPErrorBarsData);
+  return qint64(mDataContainer->capacity())*sizeof(QCPErrorBarsData);
+}
+
+/*!
+  Frees the unused reserved capacity of the error bar data.
+  
+  \seebaseclassmethod
+*/
+void QCPErrorBars::releaseMemory()
+{
+  mDataContainer->squeeze();
+}
+
 /*!
   Implements a selectTest specific to this plottable's point geometry.
 
@@ -27592,7 +34100,7 @@ void QCPErrorBars::draw(QCPPainter *painter)
   QList<QCPDataRange> selectedSegments, unselectedSegments, allSegments;
   getDataSegments(selectedSegments, unselectedSegments);
   allSegments << unselectedSegments << selectedSegments;
-  QVector<QLineF> backbones, whiskers;
+  QCPScratchVector<QLineF> backbones, whiskers;
   for (int i=0; i<allSegments.size(); ++i)
   {
     QCPErrorBarsDataContainer::const_iterator begin, end;
@@ -27611,15 +34119,15 @@ void QCPErrorBars::draw(QCPPainter *painter)
       capFixPen.setCapStyle(Qt::FlatCap);
       painter->setPen(capFixPen);
     }
-    backbones.clear();
-    whiskers.clear();
+    backbones->resize(0);
+    whiskers->resize(0);
     for (QCPErrorBarsDataContainer::const_iterator it=begin; it!=end; ++it)
     {
       if (!checkPointVisibility || errorBarVisible(it-mDataContainer->constBegin()))
-        getErrorBarLines(it, backbones, whiskers);
+        getErrorBarLines(it, *backbones, *whiskers);
     }
-    painter->drawLines(backbones);
-    painter->drawLines(whiskers);
+    painter->drawLines(*backbones);
+    painter->drawLines(*whiskers);
   }
   
   // draw other selection decoration that isn't just line/scatter pens and brushes:
@@ -28104,6 +34612,7 @@ QCPItemStraightLine::~QCPItemStraightLine()
 void QCPItemStraightLine::setPen(const QPen &pen)
 {
   mPen = pen;
+  markLayerDirty();
 }
 
 /*!
@@ -28114,6 +34623,7 @@ void QCPItemStraightLine::setPen(const QPen &pen)
 void QCPItemStraightLine::setSelectedPen(const QPen &pen)
 {
   mSelectedPen = pen;
+  markLayerDirty();
 }
 
 /* inherits documentation from base class */
@@ -28287,6 +34797,7 @@ QCPItemLine::~QCPItemLine()
 void QCPItemLine::setPen(const QPen &pen)
 {
   mPen = pen;
+  markLayerDirty();
 }
 
 /*!
@@ -28297,6 +34808,7 @@ void QCPItemLine::setPen(const QPen &pen)
 void QCPItemLine::setSelectedPen(const QPen &pen)
 {
   mSelectedPen = pen;
+  markLayerDirty();
 }
 
 /*!
@@ -28310,6 +34822,7 @@ void QCPItemLine::setSelectedPen(const QPen &pen)
 void QCPItemLine::setHead(const QCPLineEnding &head)
 {
   mHead = head;
+  markLayerDirty();
 }
 
 /*!
@@ -28323,6 +34836,7 @@ void QCPItemLine::setHead(const QCPLineEnding &head)
 void QCPItemLine::setTail(const QCPLineEnding &tail)
 {
   mTail = tail;
+  markLayerDirty();
 }
 
 /* inherits documentation from base class */
@@ -28529,6 +35043,7 @@ QCPItemCurve::~QCPItemCurve()
 void QCPItemCurve::setPen(const QPen &pen)
 {
   mPen = pen;
+  markLayerDirty();
 }
 
 /*!
@@ -28539,6 +35054,7 @@ void QCPItemCurve::setPen(const QPen &pen)
 void QCPItemCurve::setSelectedPen(const QPen &pen)
 {
   mSelectedPen = pen;
+  markLayerDirty();
 }
 
 /*!
@@ -28552,6 +35068,7 @@ void QCPItemCurve::setSelectedPen(const QPen &pen)
 void QCPItemCurve::setHead(const QCPLineEnding &head)
 {
   mHead = head;
+  markLayerDirty();
 }
 
 /*!
@@ -28565,6 +35082,7 @@ void QCPItemCurve::setHead(const QCPLineEnding &head)
 void QCPItemCurve::setTail(const QCPLineEnding &tail)
 {
   mTail = tail;
+  markLayerDirty();
 }
 
 /* inherits documentation from base class */
@@ -28692,6 +35210,7 @@ QCPItemRect::~QCPItemRect()
 void QCPItemRect::setPen(const QPen &pen)
 {
   mPen = pen;
+  markLayerDirty();
 }
 
 /*!
@@ -28702,6 +35221,7 @@ void QCPItemRect::setPen(const QPen &pen)
 void QCPItemRect::setSelectedPen(const QPen &pen)
 {
   mSelectedPen = pen;
+  markLayerDirty();
 }
 
 /*!
@@ -28713,6 +35233,7 @@ void QCPItemRect::setSelectedPen(const QPen &pen)
 void QCPItemRect::setBrush(const QBrush &brush)
 {
   mBrush = brush;
+  markLayerDirty();
 }
 
 /*!
@@ -28724,6 +35245,7 @@ void QCPItemRect::setBrush(const QBrush &brush)
 void QCPItemRect::setSelectedBrush(const QBrush &brush)
 {
   mSelectedBrush = brush;
+  markLayerDirty();
 }
 
 /* inherits documentation from base class */
@@ -28859,6 +35381,7 @@ QCPItemText::~QCPItemText()
 void QCPItemText::setColor(const QColor &color)
 {
   mColor = color;
+  markLayerDirty();
 }
 
 /*!
@@ -28867,6 +35390,7 @@ void QCPItemText::setColor(const QColor &color)
 void QCPItemText::setSelectedColor(const QColor &color)
 {
   mSelectedColor = color;
+  markLayerDirty();
 }
 
 /*!
@@ -28878,6 +35402,7 @@ void QCPItemText::setSelectedColor(const QColor &color)
 void QCPItemText::setPen(const QPen &pen)
 {
   mPen = pen;
+  markLayerDirty();
 }
 
 /*!
@@ -28889,6 +35414,7 @@ void QCPItemText::setPen(const QPen &pen)
 void QCPItemText::setSelectedPen(const QPen &pen)
 {
   mSelectedPen = pen;
+  markLayerDirty();
 }
 
 /*!
@@ -28900,6 +35426,7 @@ void QCPItemText::setSelectedPen(const QPen &pen)
 void QCPItemText::setBrush(const QBrush &brush)
 {
   mBrush = brush;
+  markLayerDirty();
 }
 
 /*!
@@ -28911,6 +35438,7 @@ void QCPItemText::setBrush(const QBrush &brush)
 void QCPItemText::setSelectedBrush(const QBrush &brush)
 {
   mSelectedBrush = brush;
+  markLayerDirty();
 }
 
 /*!
@@ -28921,6 +35449,7 @@ void QCPItemText::setSelectedBrush(const QBrush &brush)
 void QCPItemText::setFont(const QFont &font)
 {
   mFont = font;
+  markLayerDirty();
 }
 
 /*!
@@ -28931,6 +35460,7 @@ void QCPItemText::setFont(const QFont &font)
 void QCPItemText::setSelectedFont(const QFont &font)
 {
   mSelectedFont = font;
+  markLayerDirty();
 }
 
 /*!
@@ -28942,6 +35472,7 @@ void QCPItemText::setSelectedFont(const QFont &font)
 void QCPItemText::setText(const QString &text)
 {
   mText = text;
+  markLayerDirty();
 }
 
 /*!
@@ -28959,6 +35490,7 @@ void QCPItemText::setText(const QString &text)
 void QCPItemText::setPositionAlignment(Qt::Alignment alignment)
 {
   mPositionAlignment = alignment;
+  markLayerDirty();
 }
 
 /*!
@@ -28967,6 +35499,7 @@ void QCPItemText::setPositionAlignment(Qt::Alignment alignment)
 void QCPItemText::setTextAlignment(Qt::Alignment alignment)
 {
   mTextAlignment = alignment;
+  markLayerDirty();
 }
 
 /*!
@@ -28976,6 +35509,7 @@ void QCPItemText::setTextAlignment(Qt::Alignment alignment)
 void QCPItemText::setRotation(double degrees)
 {
   mRotation = degrees;
+  markLayerDirty();
 }
 
 /*!
@@ -28985,6 +35519,7 @@ void QCPItemText::setRotation(double degrees)
 void QCPItemText::setPadding(const QMargins &padding)
 {
   mPadding = padding;
+  markLayerDirty();
 }
 
 /* inherits documentation from base class */
@@ -29200,6 +35735,7 @@ QCPItemEllipse::~QCPItemEllipse()
 void QCPItemEllipse::setPen(const QPen &pen)
 {
   mPen = pen;
+  markLayerDirty();
 }
 
 /*!
@@ -29210,6 +35746,7 @@ void QCPItemEllipse::setPen(const QPen &pen)
 void QCPItemEllipse::setSelectedPen(const QPen &pen)
 {
   mSelectedPen = pen;
+  markLayerDirty();
 }
 
 /*!
@@ -29221,6 +35758,7 @@ void QCPItemEllipse::setSelectedPen(const QPen &pen)
 void QCPItemEllipse::setBrush(const QBrush &brush)
 {
   mBrush = brush;
+  markLayerDirty();
 }
 
 /*!
@@ -29232,6 +35770,7 @@ void QCPItemEllipse::setBrush(const QBrush &brush)
 void QCPItemEllipse::setSelectedBrush(const QBrush &brush)
 {
   mSelectedBrush = brush;
+  markLayerDirty();
 }
 
 /* inherits documentation from base class */
@@ -29394,6 +35933,7 @@ void QCPItemPixmap::setPixmap(const QPixmap &pixmap)
   mScaledPixmapInvalidated = true;
   if (mPixmap.isNull())
     qDebug() << Q_FUNC_INFO << "pixmap is null";
+  markLayerDirty();
 }
 
 /*!
@@ -29406,6 +35946,7 @@ void QCPItemPixmap::setScaled(bool scaled, Qt::AspectRatioMode aspectRatioMode,
   mAspectRatioMode = aspectRatioMode;
   mTransformationMode = transformationMode;
   mScaledPixmapInvalidated = true;
+  markLayerDirty();
 }
 
 /*!
@@ -29416,6 +35957,7 @@ void QCPItemPixmap::setScaled(bool scaled, Qt::AspectRatioMode aspectRatioMode,
 void QCPItemPixmap::setPen(const QPen &pen)
 {
   mPen = pen;
+  markLayerDirty();
 }
 
 /*!
@@ -29426,6 +35968,7 @@ void QCPItemPixmap::setPen(const QPen &pen)
 void QCPItemPixmap::setSelectedPen(const QPen &pen)
 {
   mSelectedPen = pen;
+  markLayerDirty();
 }
 
 /* inherits documentation from base class */
@@ -29438,6 +35981,18 @@ double QCPItemPixmap::selectTest(const QPointF &pos, bool onlySelectable, QVaria
   return rectDistance(getFinalRect(), pos, true);
 }
 
+/*!
+  Additionally accounts for the pixmap and its scaled copy.
+  
+  \seebaseclassmethod
+*/
+qint64 QCPItemPixmap::memoryUsage() const
+{
+  return QCPAbstractItem::memoryUsage() +
+      qint64(mPixmap.width())*mPixmap.height()*mPixmap.depth()/8 +
+      qint64(mScaledPixmap.width())*mScaledPixmap.height()*mScaledPixmap.depth()/8;
+}
+
 /* inherits documentation from base class */
 void QCPItemPixmap::draw(QCPPainter *painter)
 {
@@ -29674,6 +36229,7 @@ QCPItemTracer::~QCPItemTracer()
 void QCPItemTracer::setPen(const QPen &pen)
 {
   mPen = pen;
+  markLayerDirty();
 }
 
 /*!
@@ -29684,6 +36240,7 @@ void QCPItemTracer::setPen(const QPen &pen)
 void QCPItemTracer::setSelectedPen(const QPen &pen)
 {
   mSelectedPen = pen;
+  markLayerDirty();
 }
 
 /*!
@@ -29694,6 +36251,7 @@ void QCPItemTracer::setSelectedPen(const QPen &pen)
 void QCPItemTracer::setBrush(const QBrush &brush)
 {
   mBrush = brush;
+  markLayerDirty();
 }
 
 /*!
@@ -29704,6 +36262,7 @@ void QCPItemTracer::setBrush(const QBrush &brush)
 void QCPItemTracer::setSelectedBrush(const QBrush &brush)
 {
   mSelectedBrush = brush;
+  markLayerDirty();
 }
 
 /*!
@@ -29713,6 +36272,7 @@ void QCPItemTracer::setSelectedBrush(const QBrush &brush)
 void QCPItemTracer::setSize(double size)
 {
   mSize = size;
+  markLayerDirty();
 }
 
 /*!
@@ -29724,6 +36284,7 @@ void QCPItemTracer::setSize(double size)
 void QCPItemTracer::setStyle(QCPItemTracer::TracerStyle style)
 {
   mStyle = style;
+  markLayerDirty();
 }
 
 /*!
@@ -29752,6 +36313,7 @@ void QCPItemTracer::setGraph(QCPGraph *graph)
   {
     mGraph = 0;
   }
+  markLayerDirty();
 }
 
 /*!
@@ -29766,6 +36328,7 @@ void QCPItemTracer::setGraph(QCPGraph *graph)
 void QCPItemTracer::setGraphKey(double key)
 {
   mGraphKey = key;
+  markLayerDirty();
 }
 
 /*!
@@ -29782,6 +36345,21 @@ void QCPItemTracer::setGraphKey(double key)
 void QCPItemTracer::setInterpolating(bool enabled)
 {
   mInterpolating = enabled;
+  markLayerDirty();
+}
+
+/*!
+  Additionally takes the graph this tracer is attached to (\ref setGraph) into account, because
+  the tracer position follows its data.
+  
+  \seebaseclassmethod
+*/
+quint64 QCPItemTracer::contentRevision() const
+{
+  quint64 result = QCPAbstractItem::contentRevision();
+  if (mGraph && mParentPlot->hasPlottable(mGraph))
+    result += mGraph->contentRevision();
+  return result;
 }
 
 /* inherits documentation from base class */
@@ -30036,6 +36614,7 @@ QCPItemBracket::~QCPItemBracket()
 void QCPItemBracket::setPen(const QPen &pen)
 {
   mPen = pen;
+  markLayerDirty();
 }
 
 /*!
@@ -30046,6 +36625,7 @@ void QCPItemBracket::setPen(const QPen &pen)
 void QCPItemBracket::setSelectedPen(const QPen &pen)
 {
   mSelectedPen = pen;
+  markLayerDirty();
 }
 
 /*!
@@ -30059,6 +36639,7 @@ void QCPItemBracket::setSelectedPen(const QPen &pen)
 void QCPItemBracket::setLength(double length)
 {
   mLength = length;
+  markLayerDirty();
 }
 
 /*!
@@ -30069,6 +36650,7 @@ void QCPItemBracket::setLength(double length)
 void QCPItemBracket::setStyle(QCPItemBracket::BracketStyle style)
 {
   mStyle = style;
+  markLayerDirty();
 }
 
 /* inherits documentation from base class */
@@ -51,6 +51,7 @@
 #include <QtCore/QPointer>
 #include <QtCore/QSharedPointer>
 #include <QtCore/QTimer>
+#include <QtCore/QElapsedTimer>
 #include <QtGui/QPainter>
 #include <QtGui/QPaintEvent>
 #include <QtGui/QMouseEvent>
@@ -64,10 +65,20 @@
 #include <QtCore/QDebug>
 #include <QtCore/QStack>
 #include <QtCore/QCache>
+#include <QtCore/QFile>
 #include <QtCore/QMargins>
+#include <QtCore/QThread>
+#include <QtCore/QThreadPool>
+#include <QtCore/QRunnable>
+#include <QtCore/QSemaphore>
+#include <QtCore/QAtomicInt>
+#include <QtCore/QMutex>
+#include <QtCore/QThreadStorage>
+#include <QtCore/QDataStream>
 #include <qmath.h>
 #include <limits>
 #include <algorithm>
+#include <utility>
 #ifdef QCP_OPENGL_FBO
 #  include <QtGui/QOpenGLContext>
 #  include <QtGui/QOpenGLFramebufferObject>
@@ -111,6 +122,7 @@ class QCPSelectionRect;
 class QCPColorMap;
 class QCPColorScale;
 class QCPBars;
+class QCPReplotScheduler;
 
 /* including file 'src/global.h', size 16357                                 */
 /* commit ce344b3f96a62e5f652585e55f1ae7c7883cd45b 2018-06-25 01:03:39 +0200 */
@@ -154,6 +166,8 @@ class QCP { // when in moc-run, make it look like a class, so we get Q_GADGET, Q
   Q_FLAGS(AntialiasedElements)
   Q_ENUMS(PlottingHint)
   Q_FLAGS(PlottingHints)
+  Q_ENUMS(InteractionDegradation)
+  Q_FLAGS(InteractionDegradations)
   Q_ENUMS(Interaction)
   Q_FLAGS(Interactions)
   Q_ENUMS(SelectionRectMode)
@@ -243,9 +257,31 @@ enum PlottingHint { phNone              = 0x000 ///< <tt>0x000</tt> No hints are
                     ,phImmediateRefresh = 0x002 ///< <tt>0x002</tt> causes an immediate repaint() instead of a soft update() when QCustomPlot::replot() is called with parameter \ref QCustomPlot::rpRefreshHint.
                                                 ///<                This is set by default to prevent the plot from freezing on fast consecutive replots (e.g. user drags ranges with mouse).
                     ,phCacheLabels      = 0x004 ///< <tt>0x004</tt> axis (tick) labels will be cached as pixmaps, increasing replot performance.
+                    ,phParallelRasterization = 0x008 ///< <tt>0x008</tt> paint buffers are QImages (\ref QCPPaintBufferImage) and the layers of different paint buffers are drawn concurrently
+                                                ///<                during \ref QCustomPlot::replot. Only has an effect if OpenGL is disabled. See \ref QCustomPlot::setPlottingHints for details.
                   };
 Q_DECLARE_FLAGS(PlottingHints, PlottingHint)
 
+/*!
+  Defines the measures QCustomPlot may take to reduce the cost of replots while the user interacts
+  with the plot, e.g. drags or zooms the axis ranges. They are applied step by step in the order of
+  this enum, depending on the measured replot times. When the interaction stops, the plot is
+  replotted in full quality.
+  
+  \c InteractionDegradations is a flag of or-combined elements of this enum type.
+  
+  \see QCustomPlot::setInteractionDegradations
+*/
+enum InteractionDegradation { idNone              = 0x00 ///< <tt>0x00</tt> The plot is always drawn in full quality
+                              ,idAntialiasing     = 0x01 ///< <tt>0x01</tt> Antialiasing is disabled for all elements
+                              ,idFills            = 0x02 ///< <tt>0x02</tt> Graph fills (\ref QCPGraph::setBrush) are skipped
+                              ,idDecimation       = 0x04 ///< <tt>0x04</tt> Graphs use adaptive sampling (\ref QCPGraph::setAdaptiveSampling, even if disabled) with intervals of four pixels instead of one
+                              ,idScatterThinning  = 0x08 ///< <tt>0x08</tt> Graphs only draw every fourth of the scatter points they would otherwise draw
+                              ,idDevicePixelRatio = 0x10 ///< <tt>0x10</tt> The paint buffers use a device pixel ratio of 1, if \ref QCustomPlot::setBufferDevicePixelRatio is higher
+                              ,idAll              = 0xFF ///< <tt>0xFF</tt> All measures may be taken
+                            };
+Q_DECLARE_FLAGS(InteractionDegradations, InteractionDegradation)
+
 /*!
   Defines the mouse interactions possible with QCustomPlot.
   
@@ -366,6 +402,7 @@ extern const QMetaObject staticMetaObject; // in moc-run we create a static meta
 } // end of namespace QCP
 Q_DECLARE_OPERATORS_FOR_FLAGS(QCP::AntialiasedElements)
 Q_DECLARE_OPERATORS_FOR_FLAGS(QCP::PlottingHints)
+Q_DECLARE_OPERATORS_FOR_FLAGS(QCP::InteractionDegradations)
 Q_DECLARE_OPERATORS_FOR_FLAGS(QCP::MarginSides)
 Q_DECLARE_OPERATORS_FOR_FLAGS(QCP::Interactions)
 Q_DECLARE_METATYPE(QCP::ExportPen)
@@ -374,10 +411,97 @@ Q_DECLARE_METATYPE(QCP::SignDomain)
 Q_DECLARE_METATYPE(QCP::MarginSide)
 Q_DECLARE_METATYPE(QCP::AntialiasedElement)
 Q_DECLARE_METATYPE(QCP::PlottingHint)
+Q_DECLARE_METATYPE(QCP::InteractionDegradation)
 Q_DECLARE_METATYPE(QCP::Interaction)
 Q_DECLARE_METATYPE(QCP::SelectionRectMode)
 Q_DECLARE_METATYPE(QCP::SelectionType)
 
+/*! \internal
+  
+  Holds the state shared between the calling thread and the worker threads of one \ref
+  qcpParallelFor invocation. The index range is split into chunks which are claimed by the
+  participating threads via an atomic counter, so threads that start late simply find no work
+  left.
+*/
+template <class Function>
+class QCPParallelForState
+{
+public:
+  QCPParallelForState(const Function &function, int count, int chunkSize) :
+    mFunction(function),
+    mCount(count),
+    mChunkSize(chunkSize),
+    mChunkCount((count+chunkSize-1)/chunkSize),
+    mNextChunk(0)
+  {
+  }
+  
+  void work()
+  {
+    int chunk;
+    while ((chunk = mNextChunk.fetchAndAddOrdered(1)) < mChunkCount)
+    {
+      const int begin = chunk*mChunkSize;
+      mFunction(begin, qMin(begin+mChunkSize, mCount));
+      mFinishedChunks.release();
+    }
+  }
+  
+  const Function mFunction;
+  const int mCount, mChunkSize, mChunkCount;
+  QAtomicInt mNextChunk;
+  QSemaphore mFinishedChunks;
+};
+
+/*! \internal
+  
+  The runnable that is handed to the global thread pool by \ref qcpParallelFor.
+*/
+template <class Function>
+class QCPParallelForRunnable : public QRunnable
+{
+public:
+  explicit QCPParallelForRunnable(const QSharedPointer<QCPParallelForState<Function> > &state) : mState(state) {}
+  virtual void run() Q_DECL_OVERRIDE { mState->work(); }
+  
+private:
+  QSharedPointer<QCPParallelForState<Function> > mState;
+};
+
+/*! \internal
+  
+  Calls \a function (a functor with a const <tt>operator()(int begin, int end)</tt>) for
+  consecutive, non-overlapping chunks that together cover the index range [0, \a count). The
+  chunks are processed concurrently by the calling thread and the threads of
+  QThreadPool::globalInstance. Chunks are never smaller than \a minChunkSize (except for the last
+  one). The function returns when all chunks have been processed.
+  
+  The calling thread participates in the work and only waits for chunks that are already being
+  processed by other threads. It is therefore safe to call this function from within a thread
+  pool thread, even if the pool is fully occupied.
+*/
+template <class Function>
+void qcpParallelFor(int count, int minChunkSize, const Function &function)
+{
+  if (count <= 0)
+    return;
+  const int threadCount = qMax(1, QThread::idealThreadCount());
+  const int chunkSize = qMax(qMax(1, minChunkSize), int((qint64(count)+threadCount*4-1)/(threadCount*4))); // aim for a few chunks per thread, for load balancing
+  const int chunkCount = (count+chunkSize-1)/chunkSize;
+  if (threadCount == 1 || chunkCount == 1)
+  {
+    function(0, count);
+    return;
+  }
+  
+  QSharedPointer<QCPParallelForState<Function> > state(new QCPParallelForState<Function>(function, count, chunkSize));
+  const int helperCount = qMin(threadCount, chunkCount)-1;
+  for (int i=0; i<helperCount; ++i)
+    QThreadPool::globalInstance()->start(new QCPParallelForRunnable<Function>(state));
+  state->work();
+  state->mFinishedChunks.acquire(chunkCount);
+}
+
 /* end of 'src/global.h' */
 
 
@@ -455,6 +579,318 @@ inline QDebug operator<< (QDebug d, const QCPVector2D &vec)
 /* end of 'src/vector2d.h' */
 
 
+/* including file 'src/tracer.h'                                             */
+
+class QCP_LIB_DECL QCPTracer
+{
+public:
+  QCPTracer();
+  
+  static QCPTracer *instance();
+  
+  // getters:
+  bool isEnabled() const { return mEnabled.loadAcquire() != 0; }
+  int capacity() const;
+  int eventCount() const;
+  int droppedEventCount() const;
+  
+  // setters:
+  void setEnabled(bool enabled);
+  void setCapacity(int capacity);
+  
+  // non-property methods:
+  void clear();
+  qint64 timestamp() const { return mClock.nsecsElapsed(); }
+  void addEvent(const char *name, const char *category, const void *object, qint64 start, qint64 end);
+  QByteArray toChromeTraceJson() const;
+  bool saveChromeTrace(const QString &fileName) const;
+  
+protected:
+  struct Event
+  {
+    const char *name;
+    const char *category;
+    const void *object;
+    Qt::HANDLE thread;
+    qint64 start, duration;
+  };
+  
+  // property members:
+  QAtomicInt mEnabled;
+  
+  // non-property members:
+  QElapsedTimer mClock;
+  mutable QMutex mMutex;
+  QVector<Event> mEvents;
+  int mNextEvent, mEventCount, mDroppedEventCount;
+  
+  inline static bool lessThanStart(const Event &a, const Event &b) { return a.start < b.start || (a.start == b.start && a.duration > b.duration); }
+  
+private:
+  Q_DISABLE_COPY(QCPTracer)
+};
+
+class QCP_LIB_DECL QCPTraceScope
+{
+public:
+  QCPTraceScope(const char *name, const char *category, const void *object=0);
+  ~QCPTraceScope();
+  
+private:
+  const char *mName;
+  const char *mCategory;
+  const void *mObject;
+  qint64 mStart;
+  
+  Q_DISABLE_COPY(QCPTraceScope)
+};
+
+/* end of 'src/tracer.h' */
+
+
+/* including file 'src/scratch.h'                                            */
+
+class QCP_LIB_DECL QCPScratchPool
+{
+public:
+  QCPScratchPool();
+  virtual ~QCPScratchPool();
+  
+  static qint64 totalMemoryUsage();
+  static void trimAll();
+  
+protected:
+  // non-property members:
+  mutable QMutex mMutex;
+  
+  // introduced virtual methods:
+  virtual qint64 memoryUsage() const = 0;
+  virtual void trim() = 0;
+  
+  // non-virtual methods:
+  void registerPool();
+  void unregisterPool();
+  
+private:
+  Q_DISABLE_COPY(QCPScratchPool)
+};
+
+template <class T>
+class QCPScratchVector // no QCP_LIB_DECL, template class ends up in header (cpp included below)
+{
+public:
+  QCPScratchVector();
+  ~QCPScratchVector();
+  
+  // getters:
+  QVector<T> *data() const { return mVector; }
+  QVector<T> &operator*() const { return *mVector; }
+  QVector<T> *operator->() const { return mVector; }
+  
+  static int maximumPoolSize() { return 16; }
+  static int maximumPooledBytes() { return 4*1024*1024; }
+  
+protected:
+  class Pool : public QCPScratchPool
+  {
+  public:
+    Pool() { registerPool(); }
+    virtual ~Pool() { unregisterPool(); qDeleteAll(mVectors); }
+    
+    QVector<T> *take();
+    void give(QVector<T> *vector);
+    
+  protected:
+    QList<QVector<T>*> mVectors;
+    
+    virtual qint64 memoryUsage() const Q_DECL_OVERRIDE;
+    virtual void trim() Q_DECL_OVERRIDE;
+  };
+  
+  // non-property members:
+  QVector<T> *mVector;
+  
+  // non-virtual methods:
+  static Pool *pool();
+  
+private:
+  Q_DISABLE_COPY(QCPScratchVector)
+};
+
+
+
+// include implementation in header since it is a class template:
+
+/* including file 'src/scratch.cpp'                                          */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPScratchVector
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPScratchVector
+  \brief Borrows a reusable temporary vector from a per-thread pool
+
+  Drawing a plottable needs several temporary vectors per segment and replot, e.g. the optimized
+  data points, the resulting pixel coordinates and the fill polygons. Creating them as local
+  QVectors means each replot allocates and frees this memory again. A QCPScratchVector instead
+  takes a vector out of a pool that is kept per thread and per element type \a T, and puts it back
+  when the QCPScratchVector goes out of scope. The vector is handed out empty, but keeps the
+  capacity it had when it was returned, so consecutive replots of a similar amount of data perform
+  (almost) no heap allocations for their temporaries.
+
+  \code
+  QCPScratchVector<QPointF> lines;
+  getLines(lines.data(), dataRange);
+  drawLinePlot(painter, *lines);
+  \endcode
+
+  Because the pool is thread-local, scratch vectors can safely be used in code that runs
+  concurrently on the parallel rasterization threads (see \ref
+  QCP::phParallelRasterization). Several scratch vectors of the same type may be borrowed
+  at the same time, each one gets its own vector. At most \ref maximumPoolSize vectors are kept per
+  pool, additional ones are deleted upon return. So are vectors whose capacity exceeds \ref
+  maximumPooledBytes, so a single replot of unusually much data doesn't occupy the memory for good.
+  
+  The memory held by the pools of all threads is part of \ref QCustomPlot::memoryReport, and \ref
+  QCustomPlot::releaseMemory frees it (see \ref QCPScratchPool).
+
+  Don't keep references or implicitly shared copies of the borrowed vector beyond the lifetime of
+  the QCPScratchVector.
+*/
+
+/* start documentation of inline functions */
+
+/*! \fn QVector<T> *QCPScratchVector<T>::data() const
+  
+  Returns a pointer to the borrowed vector. It is valid as long as this QCPScratchVector exists.
+*/
+
+/*! \fn QVector<T> &QCPScratchVector<T>::operator*() const
+  
+  Returns a reference to the borrowed vector.
+*/
+
+/*! \fn QVector<T> *QCPScratchVector<T>::operator->() const
+  
+  Gives access to the methods of the borrowed vector.
+*/
+
+/*! \fn static int QCPScratchVector<T>::maximumPoolSize()
+  
+  Returns the maximum number of vectors which are kept in the pool of each thread and element type
+  for reuse.
+*/
+
+/*! \fn static int QCPScratchVector<T>::maximumPooledBytes()
+  
+  Returns the capacity in bytes up to which a returned vector is kept in the pool. Larger vectors
+  are deleted upon return.
+*/
+
+/* end documentation of inline functions */
+
+/*!
+  Borrows an empty vector from the pool of the calling thread, or creates a new one if the pool is
+  empty.
+*/
+template <class T>
+QCPScratchVector<T>::QCPScratchVector() :
+  mVector(pool()->take())
+{
+}
+
+/*!
+  Empties the borrowed vector without releasing its capacity, and returns it to the pool of the
+  calling thread.
+*/
+template <class T>
+QCPScratchVector<T>::~QCPScratchVector()
+{
+  pool()->give(mVector);
+}
+
+/*! \internal
+  
+  Takes a vector out of the pool, or creates a new one if the pool is empty.
+*/
+template <class T>
+QVector<T> *QCPScratchVector<T>::Pool::take()
+{
+  QMutexLocker locker(&mMutex); // only contended while the pools are trimmed or measured
+  return mVectors.isEmpty() ? new QVector<T> : mVectors.takeLast();
+}
+
+/*! \internal
+  
+  Empties \a vector and puts it into the pool, or deletes it if the pool is full or \a vector is
+  larger than \ref maximumPooledBytes.
+*/
+template <class T>
+void QCPScratchVector<T>::Pool::give(QVector<T> *vector)
+{
+  if (qint64(vector->capacity())*qint64(sizeof(T)) > maximumPooledBytes())
+  {
+    delete vector;
+    return;
+  }
+  QMutexLocker locker(&mMutex);
+  if (mVectors.size() < maximumPoolSize())
+  {
+#if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
+    vector->reserve(vector->capacity()); // Qt4 only keeps the capacity on shrinking if it was explicitly reserved
+#endif
+    vector->resize(0);
+    mVectors.append(vector);
+  } else
+  {
+    locker.unlock();
+    delete vector;
+  }
+}
+
+/*! \internal
+  
+  Returns the capacity of the pooled vectors in bytes. Called with the mutex locked.
+*/
+template <class T>
+qint64 QCPScratchVector<T>::Pool::memoryUsage() const
+{
+  qint64 result = 0;
+  for (int i=0; i<mVectors.size(); ++i)
+    result += qint64(mVectors.at(i)->capacity())*sizeof(T);
+  return result;
+}
+
+/*! \internal
+  
+  Deletes all pooled vectors. Called with the mutex locked.
+*/
+template <class T>
+void QCPScratchVector<T>::Pool::trim()
+{
+  qDeleteAll(mVectors);
+  mVectors.clear();
+}
+
+/*! \internal
+  
+  Returns the vector pool of the calling thread. It is created on first use, and deleted together
+  with all pooled vectors when the thread finishes.
+*/
+template <class T>
+typename QCPScratchVector<T>::Pool *QCPScratchVector<T>::pool()
+{
+  static QThreadStorage<Pool*> threadPools;
+  if (!threadPools.hasLocalData())
+    threadPools.setLocalData(new Pool);
+  return threadPools.localData();
+}
+/* end of 'src/scratch.cpp' */
+
+
+/* end of 'src/scratch.h' */
+
+
 /* including file 'src/painter.h', size 4035                                 */
 /* commit ce344b3f96a62e5f652585e55f1ae7c7883cd45b 2018-06-25 01:03:39 +0200 */
 
@@ -538,6 +974,7 @@ public:
   virtual void donePainting() {}
   virtual void draw(QCPPainter *painter) const = 0;
   virtual void clear(const QColor &color) = 0;
+  virtual bool scroll(const QRect &rect, int dx, int dy);
   
 protected:
   // property members:
@@ -549,6 +986,9 @@ protected:
   
   // introduced virtual methods:
   virtual void reallocateBuffer() = 0;
+  
+  // non-virtual methods:
+  void clearExposedArea(QPainter *painter, const QRect &rect, int dx, int dy) const;
 };
 
 
@@ -562,6 +1002,7 @@ public:
   virtual QCPPainter *startPainting() Q_DECL_OVERRIDE;
   virtual void draw(QCPPainter *painter) const Q_DECL_OVERRIDE;
   void clear(const QColor &color) Q_DECL_OVERRIDE;
+  virtual bool scroll(const QRect &rect, int dx, int dy) Q_DECL_OVERRIDE;
   
 protected:
   // non-property members:
@@ -572,6 +1013,27 @@ protected:
 };
 
 
+class QCP_LIB_DECL QCPPaintBufferImage : public QCPAbstractPaintBuffer
+{
+public:
+  explicit QCPPaintBufferImage(const QSize &size, double devicePixelRatio);
+  virtual ~QCPPaintBufferImage();
+  
+  // reimplemented virtual methods:
+  virtual QCPPainter *startPainting() Q_DECL_OVERRIDE;
+  virtual void draw(QCPPainter *painter) const Q_DECL_OVERRIDE;
+  void clear(const QColor &color) Q_DECL_OVERRIDE;
+  virtual bool scroll(const QRect &rect, int dx, int dy) Q_DECL_OVERRIDE;
+  
+protected:
+  // non-property members:
+  QImage mBuffer;
+  
+  // reimplemented virtual methods:
+  virtual void reallocateBuffer() Q_DECL_OVERRIDE;
+};
+
+
 #ifdef QCP_OPENGL_PBUFFER
 class QCP_LIB_DECL QCPPaintBufferGlPbuffer : public QCPAbstractPaintBuffer
 {
@@ -660,6 +1122,7 @@ public:
   QList<QCPLayerable*> children() const { return mChildren; }
   bool visible() const { return mVisible; }
   LayerMode mode() const { return mMode; }
+  bool dirty() const { return mDirty; }
   
   // setters:
   void setVisible(bool visible);
@@ -667,6 +1130,7 @@ public:
   
   // non-virtual methods:
   void replot();
+  void markDirty();
   
 protected:
   // property members:
@@ -679,10 +1143,13 @@ protected:
   
   // non-property members:
   QWeakPointer<QCPAbstractPaintBuffer> mPaintBuffer;
+  bool mDirty;
   
   // non-virtual methods:
   void draw(QCPPainter *painter);
   void drawToPaintBuffer();
+  void drawToPaintBuffer(const QRect &rect);
+  void drawChild(QCPPainter *painter, QCPLayerable *child);
   void addChild(QCPLayerable *layerable, bool prepend);
   void removeChild(QCPLayerable *layerable);
   
@@ -691,6 +1158,7 @@ private:
   
   friend class QCustomPlot;
   friend class QCPLayerable;
+  friend class QCPLayerGroupDrawFunctor;
 };
 Q_DECLARE_METATYPE(QCPLayer::LayerMode)
 
@@ -723,9 +1191,11 @@ public:
   
   // introduced virtual methods:
   virtual double selectTest(const QPointF &pos, bool onlySelectable, QVariant *details=0) const;
+  virtual quint64 contentRevision() const;
 
   // non-property methods:
   bool realVisibility() const;
+  void markLayerDirty();
   
 signals:
   void layerChanged(QCPLayer *newLayer);
@@ -738,6 +1208,9 @@ protected:
   QCPLayer *mLayer;
   bool mAntialiased;
   
+  // non-property members:
+  quint64 mContentRevision, mDrawnContentRevision;
+  
   // introduced virtual methods:
   virtual void parentPlotInitialized(QCustomPlot *parentPlot);
   virtual QCP::Interaction selectionCategory() const;
@@ -2230,6 +2703,7 @@ public:
   virtual void draw(QCPPainter *painter);
   virtual int size() const;
   void clearCache();
+  qint64 cacheMemoryUsage() const;
   
   QRect axisSelectionBox() const { return mAxisSelectionBox; }
   QRect tickLabelsSelectionBox() const { return mTickLabelsSelectionBox; }
@@ -2408,26 +2882,254 @@ Q_DECLARE_METATYPE(QCPScatterStyle::ScatterShape)
 template <class DataType>
 inline bool qcpLessThanSortKey(const DataType &a, const DataType &b) { return a.sortKey() < b.sortKey(); }
 
+/*! \internal
+  
+  Returns whether the lower bound of \a a is smaller than the lower bound of \a b.
+  
+  \see QCPDataContainer::remove(const QVector<QCPRange> &sortKeyRanges)
+*/
+inline bool qcpLessThanRangeLower(const QCPRange &a, const QCPRange &b) { return a.lower < b.lower; }
+
+/*! \internal
+  
+  Describes one independent unit of work of the parallel sort and merge in \ref QCPDataContainer:
+  The sorted source ranges [\a aBegin, \a aEnd) and [\a bBegin, \a bEnd) are merged into the
+  target buffer, starting at index \a outBegin. An empty second range turns the task into a plain
+  copy.
+*/
+struct QCPDataMergeTask
+{
+  int aBegin, aEnd, bBegin, bEnd, outBegin;
+};
+Q_DECLARE_TYPEINFO(QCPDataMergeTask, Q_PRIMITIVE_TYPE);
+
+/*! \internal
+  
+  Functor for \ref qcpParallelFor which sorts the independent runs of \a data that are delimited
+  by the consecutive indices in \a runs.
+*/
 template <class DataType>
-class QCPDataContainer // no QCP_LIB_DECL, template class ends up in header (cpp included below)
+class QCPDataSortRunsFunctor
 {
 public:
-  typedef typename QVector<DataType>::const_iterator const_iterator;
-  typedef typename QVector<DataType>::iterator iterator;
+  QCPDataSortRunsFunctor(DataType *data, const QVector<int> &runs) : mData(data), mRuns(runs) {}
+  void operator()(int begin, int end) const
+  {
+    for (int i=begin; i<end; ++i)
+      std::sort(mData+mRuns.at(i), mData+mRuns.at(i+1), qcpLessThanSortKey<DataType>);
+  }
   
-  QCPDataContainer();
+private:
+  DataType *mData;
+  const QVector<int> &mRuns;
+};
+
+/*! \internal
   
-  // getters:
-  int size() const { return mData.size()-mPreallocSize; }
-  bool isEmpty() const { return size() == 0; }
-  bool autoSqueeze() const { return mAutoSqueeze; }
+  Functor for \ref qcpParallelFor which executes the \ref QCPDataMergeTask "merge tasks" in the
+  index range it is called with, reading from \a source and writing to \a target.
+*/
+template <class DataType>
+class QCPDataMergeFunctor
+{
+public:
+  QCPDataMergeFunctor(const DataType *source, DataType *target, const QVector<QCPDataMergeTask> &tasks) : mSource(source), mTarget(target), mTasks(tasks) {}
+  void operator()(int begin, int end) const
+  {
+    for (int i=begin; i<end; ++i)
+    {
+      const QCPDataMergeTask &task = mTasks.at(i);
+      std::merge(mSource+task.aBegin, mSource+task.aEnd, mSource+task.bBegin, mSource+task.bEnd, mTarget+task.outBegin, qcpLessThanSortKey<DataType>);
+    }
+  }
   
-  // setters:
-  void setAutoSqueeze(bool enabled);
+private:
+  const DataType *mSource;
+  DataType *mTarget;
+  const QVector<QCPDataMergeTask> &mTasks;
+};
+
+/*! \internal
   
-  // non-virtual methods:
-  void set(const QCPDataContainer<DataType> &data);
-  void set(const QVector<DataType> &data, bool alreadySorted=false);
+  Functor for \ref qcpParallelFor which checks whether the (sort-)keys of \a data are in
+  ascending and/or descending order. Each chunk also compares its first element with the last
+  element of the preceding chunk. Order violations are reported by setting \a notAscending
+  and \a notDescending to one.
+*/
+template <class DataType>
+class QCPDataOrderCheckFunctor
+{
+public:
+  QCPDataOrderCheckFunctor(const DataType *data, QAtomicInt *notAscending, QAtomicInt *notDescending) : mData(data), mNotAscending(notAscending), mNotDescending(notDescending) {}
+  void operator()(int begin, int end) const
+  {
+    bool ascending = mNotAscending->fetchAndAddRelaxed(0) == 0;
+    bool descending = mNotDescending->fetchAndAddRelaxed(0) == 0;
+    for (int i=qMax(begin, 1); i<end && (ascending || descending); ++i)
+    {
+      const double previousKey = mData[i-1].sortKey();
+      const double key = mData[i].sortKey();
+      if (key < previousKey)
+        ascending = false;
+      else if (key > previousKey)
+        descending = false;
+    }
+    if (!ascending)
+      mNotAscending->fetchAndStoreRelaxed(1);
+    if (!descending)
+      mNotDescending->fetchAndStoreRelaxed(1);
+  }
+  
+private:
+  const DataType *mData;
+  QAtomicInt *mNotAscending, *mNotDescending;
+};
+
+template <class DataType>
+class QCPDataContainer;
+
+/*! \internal
+  
+  Holds the copying of the chunks [\a mFirstChunk, \a mLastChunk) that a snapshot from \ref
+  QCPDataContainer::deferredSnapshot still shares with its container. The snapshot holds it, and
+  the container refers to it without keeping it alive. The chunks are copied one at a time by
+  whichever thread needs them first: the thread reading the snapshot (\ref
+  QCPDataSnapshot::complete), or the thread modifying the container, before the modification. Once
+  all chunks are copied, the reference to the container's data is released, so modifications of
+  the container don't need to detach (i.e. copy) all of its data.
+  
+  All members are guarded by \a mMutex.
+*/
+template <class DataType>
+class QCPDataSnapshotCopy
+{
+public:
+  QCPDataSnapshotCopy(const QVector<DataType> &data, int chunkSize, int firstChunk, int lastChunk) :
+    mData(data),
+    mChunks(lastChunk),
+    mChunkSize(chunkSize),
+    mFirstChunk(firstChunk),
+    mNextChunk(firstChunk),
+    mLastChunk(lastChunk)
+  {
+  }
+  
+  /*
+    Copies the next chunk that isn't copied yet and returns true. Returns false if all chunks are
+    copied, and releases the container's data in that case.
+  */
+  bool copyNextChunk()
+  {
+    QMutexLocker locker(&mMutex);
+    if (mNextChunk >= mLastChunk)
+    {
+      mData = QVector<DataType>();
+      return false;
+    }
+    const int begin = mNextChunk*mChunkSize;
+    mChunks[mNextChunk] = mData.mid(begin, qMin(mChunkSize, mData.size()-begin));
+    ++mNextChunk;
+    return true;
+  }
+  
+  /*
+    Copies all remaining chunks, and sets the according elements of \a chunks to them.
+  */
+  void finish(QVector<QVector<DataType> > &chunks)
+  {
+    while (copyNextChunk()) {}
+    QMutexLocker locker(&mMutex);
+    const int lastChunk = qMin(mLastChunk, chunks.size());
+    for (int i=mFirstChunk; i<lastChunk; ++i)
+      chunks[i] = mChunks.at(i);
+  }
+  
+  /*
+    Returns the number of bytes allocated by the chunks that were copied so far.
+  */
+  qint64 copiedBytes()
+  {
+    QMutexLocker locker(&mMutex);
+    qint64 result = 0;
+    for (int i=mFirstChunk; i<mNextChunk; ++i)
+      result += qint64(mChunks.at(i).capacity())*sizeof(DataType);
+    return result;
+  }
+  
+  QMutex mMutex;
+  QVector<DataType> mData;
+  QVector<QVector<DataType> > mChunks;
+  const int mChunkSize, mFirstChunk;
+  int mNextChunk;
+  const int mLastChunk;
+};
+
+template <class DataType>
+class QCPDataSnapshot // no QCP_LIB_DECL, template class ends up in header (cpp included below)
+{
+public:
+  QCPDataSnapshot();
+  
+  // getters:
+  int version() const { return mVersion; }
+  int size() const { return mSize; }
+  bool isEmpty() const { return mSize == 0; }
+  bool isComplete() const { return mComplete; }
+  
+  // non-virtual methods:
+  void complete();
+  const DataType &at(int index) const { const int position = mOffset+index; return mChunks.at(position/chunkSize()).at(position%chunkSize()); }
+  int findBegin(double sortKey, bool expandedRange=true) const;
+  int findEnd(double sortKey, bool expandedRange=true) const;
+  int sharedPrefixSize(const QCPDataSnapshot<DataType> &other) const;
+  QVector<DataType> toVector() const;
+  
+  static int chunkSize() { return 65536; }
+  
+protected:
+  // non-property members:
+  QVector<QVector<DataType> > mChunks;
+  int mOffset;
+  int mSize;
+  int mVersion;
+  bool mComplete;
+  QSharedPointer<QCPDataSnapshotCopy<DataType> > mCopy;
+  
+  // non-virtual methods:
+  int lowerBound(double sortKey) const;
+  int upperBound(double sortKey) const;
+  
+  friend class QCPDataContainer<DataType>;
+};
+
+template <class DataType>
+class QCPDataContainer // no QCP_LIB_DECL, template class ends up in header (cpp included below)
+{
+public:
+  typedef typename QVector<DataType>::const_iterator const_iterator;
+  typedef typename QVector<DataType>::iterator iterator;
+  
+  QCPDataContainer();
+  QCPDataContainer(const QCPDataContainer<DataType> &other);
+  QCPDataContainer<DataType> &operator=(const QCPDataContainer<DataType> &other);
+  
+  // getters:
+  int size() const { return mData.size()-mPreallocSize; }
+  bool isEmpty() const { return size() == 0; }
+  bool autoSqueeze() const { return mAutoSqueeze; }
+  int parallelThreshold() const { return mParallelThreshold; }
+  quint64 revision() const { return mRevision; }
+  
+  // setters:
+  void setAutoSqueeze(bool enabled);
+  void setParallelThreshold(int threshold);
+  
+  // non-virtual methods:
+  void set(const QCPDataContainer<DataType> &data);
+  void set(const QVector<DataType> &data, bool alreadySorted=false);
+#ifdef Q_COMPILER_RVALUE_REFS
+  void set(QVector<DataType> &&data, bool alreadySorted=false);
+#endif
   void add(const QCPDataContainer<DataType> &data);
   void add(const QVector<DataType> &data, bool alreadySorted=false);
   void add(const DataType &data);
@@ -2435,14 +3137,19 @@ public:
   void removeAfter(double sortKey);
   void remove(double sortKeyFrom, double sortKeyTo);
   void remove(double sortKey);
+  void remove(const QVector<QCPRange> &sortKeyRanges);
+  template <class Predicate> void removeIf(Predicate predicate);
   void clear();
   void sort();
   void squeeze(bool preAllocation=true, bool postAllocation=true);
+  void releaseSnapshot();
+  qint64 memoryUsage(qint64 *reclaimableBytes=0) const;
+  qint64 snapshotMemoryUsage(const QCPDataSnapshot<DataType> &snapshot) const;
   
   const_iterator constBegin() const { return mData.constBegin()+mPreallocSize; }
   const_iterator constEnd() const { return mData.constEnd(); }
-  iterator begin() { return mData.begin()+mPreallocSize; }
-  iterator end() { return mData.end(); }
+  iterator begin() { completePendingSnapshot(); markSnapshotDirty(0, mData.size()); return mData.begin()+mPreallocSize; }
+  iterator end() { completePendingSnapshot(); markSnapshotDirty(0, mData.size()); return mData.end(); }
   const_iterator findBegin(double sortKey, bool expandedRange=true) const;
   const_iterator findEnd(double sortKey, bool expandedRange=true) const;
   const_iterator at(int index) const { return constBegin()+qBound(0, index, size()); }
@@ -2450,19 +3157,80 @@ public:
   QCPRange valueRange(bool &foundRange, QCP::SignDomain signDomain=QCP::sdBoth, const QCPRange &inKeyRange=QCPRange());
   QCPDataRange dataRange() const { return QCPDataRange(0, size()); }
   void limitIteratorsToDataRange(const_iterator &begin, const_iterator &end, const QCPDataRange &dataRange) const;
+  QCPDataSnapshot<DataType> snapshot();
+  QCPDataSnapshot<DataType> deferredSnapshot();
   
 protected:
   // property members:
   bool mAutoSqueeze;
+  int mParallelThreshold;
   
   // non-property memebers:
   QVector<DataType> mData;
   int mPreallocSize;
   int mPreallocIteration;
+  QVector<QVector<DataType> > mSnapshotChunks;
+  int mSnapshotDirtyBegin, mSnapshotDirtyEnd;
+  int mSnapshotPendingBegin, mSnapshotPendingEnd;
+  QWeakPointer<QCPDataSnapshotCopy<DataType> > mSnapshotCopy;
+  int mSnapshotVersion;
+  quint64 mSnapshotRevision;
+  quint64 mRevision;
   
   // non-virtual methods:
+  iterator dataBegin() { return mData.begin()+mPreallocSize; }
+  iterator dataEnd() { return mData.end(); }
+  void markSnapshotDirty(int begin, int end);
+  void markSnapshotDirty(const_iterator begin, const_iterator end) { markSnapshotDirty(int(begin-mData.constBegin()), int(end-mData.constBegin())); }
+  void completePendingSnapshot();
+  void snapshotChunksToCopy(int &firstChunk, int &lastChunk) const;
+  void updateSnapshotVersion();
+  QCPDataSnapshot<DataType> createSnapshot() const;
   void preallocateGrow(int minimumPreallocSize);
   void performAutoSqueeze();
+  void sortRange(iterator begin, iterator end);
+  void mergeRanges(iterator begin, iterator middle, iterator end);
+  void parallelMerge(DataType *source, DataType *target, const QVector<int> &runs) const;
+};
+
+template <class DataType>
+class QCPDataIngestChannel // no QCP_LIB_DECL, template class ends up in header (cpp included below)
+{
+public:
+  explicit QCPDataIngestChannel(int capacity=1024);
+  ~QCPDataIngestChannel();
+  
+  // getters:
+  int capacity() const { return mCapacity.loadAcquire(); }
+  int depth() const { return mDepth.loadAcquire(); }
+  int droppedBatchCount() const { return mDroppedBatches.loadAcquire(); }
+  int droppedDataCount() const { return mDroppedData.loadAcquire(); }
+  
+  // setters:
+  void setCapacity(int capacity);
+  
+  // non-virtual methods:
+  bool push(const QVector<DataType> &data, bool alreadySorted=false);
+  int drainInto(QCPDataContainer<DataType> *container);
+  void resetCounters();
+  
+protected:
+  struct Batch
+  {
+    QVector<DataType> data;
+    bool sorted;
+    Batch *next;
+  };
+  
+  // property members:
+  QAtomicInt mCapacity;
+  
+  // non-property members:
+  QAtomicPointer<Batch> mHead;
+  QAtomicInt mDepth, mDroppedBatches, mDroppedData;
+  
+private:
+  Q_DISABLE_COPY(QCPDataIngestChannel)
 };
 
 // include implementation in header since it is a class template:
@@ -2553,6 +3321,15 @@ protected:
   Returns whether this container holds no data points.
 */
 
+/*! \fn quint64 QCPDataContainer<DataType>::revision() const
+  
+  Returns a counter that is incremented by every operation that may modify the data points, including
+  requests for non-const iterators (\ref begin, \ref end). Plottables use it to detect that their
+  data changed and their layer needs to be redrawn (see \ref QCPLayerable::contentRevision).
+  
+  Reading the data through \ref constBegin and \ref constEnd doesn't change the revision.
+*/
+
 /*! \fn QCPDataContainer::const_iterator QCPDataContainer<DataType>::constBegin() const
   
   Returns a const iterator to the first data point in this container.
@@ -2570,6 +3347,11 @@ protected:
   You can manipulate the data points in-place through the non-const iterators, but great care must
   be taken when manipulating the sort key of a data point, see \ref sort, or the detailed
   description of this class.
+  
+  Since modifications through the returned iterator can't be tracked, calling this method counts as
+  a modification of all data points: It increments the \ref revision (so plottables using this
+  container are redrawn), and the next \ref snapshot copies the entire data. Only use it if you
+  actually modify data, and use \ref constBegin and \ref constEnd for read-only access.
 */
 
 /*! \fn QCPDataContainer::iterator QCPDataContainer<DataType>::end() const
@@ -2579,6 +3361,9 @@ protected:
   You can manipulate the data points in-place through the non-const iterators, but great care must
   be taken when manipulating the sort key of a data point, see \ref sort, or the detailed
   description of this class.
+  
+  Like \ref begin, this counts as a modification of all data points. Use \ref constEnd for
+  read-only access.
 */
 
 /*! \fn QCPDataContainer::const_iterator QCPDataContainer<DataType>::at(int index) const
@@ -2606,11 +3391,64 @@ protected:
 template <class DataType>
 QCPDataContainer<DataType>::QCPDataContainer() :
   mAutoSqueeze(true),
+  mParallelThreshold(200000),
   mPreallocSize(0),
-  mPreallocIteration(0)
+  mPreallocIteration(0),
+  mSnapshotDirtyBegin(0),
+  mSnapshotDirtyEnd(0),
+  mSnapshotPendingBegin(0),
+  mSnapshotPendingEnd(0),
+  mSnapshotVersion(0),
+  mSnapshotRevision(0),
+  mRevision(0)
+{
+}
+
+/*!
+  Constructs a copy of the container \a other.
+  
+  The data is shared with \a other via Qt's implicit sharing until either container is modified.
+  The snapshot state isn't copied: The first \ref snapshot of the new container copies its
+  entire data and has its own version numbering, independent of \a other.
+*/
+template <class DataType>
+QCPDataContainer<DataType>::QCPDataContainer(const QCPDataContainer<DataType> &other) :
+  mAutoSqueeze(other.mAutoSqueeze),
+  mParallelThreshold(other.mParallelThreshold),
+  mData(other.mData),
+  mPreallocSize(other.mPreallocSize),
+  mPreallocIteration(other.mPreallocIteration),
+  mSnapshotDirtyBegin(0),
+  mSnapshotDirtyEnd(0),
+  mSnapshotPendingBegin(0),
+  mSnapshotPendingEnd(0),
+  mSnapshotVersion(0),
+  mSnapshotRevision(0),
+  mRevision(0)
 {
 }
 
+/*!
+  Replaces the data and the properties of this container with the ones of \a other.
+  
+  This container keeps its own \ref revision and snapshot version numbering, both continue to
+  increase. Since all data points changed, the next \ref snapshot copies the entire data.
+*/
+template <class DataType>
+QCPDataContainer<DataType> &QCPDataContainer<DataType>::operator=(const QCPDataContainer<DataType> &other)
+{
+  if (&other == this)
+    return *this;
+  completePendingSnapshot();
+  mAutoSqueeze = other.mAutoSqueeze;
+  mParallelThreshold = other.mParallelThreshold;
+  mData = other.mData;
+  mPreallocSize = other.mPreallocSize;
+  mPreallocIteration = other.mPreallocIteration;
+  markSnapshotDirty(0, mData.size());
+  return *this;
+}
+
 /*!
   Sets whether the container automatically decides when to release memory from its post- and
   preallocation pools when data points are removed. By default this is enabled and for typical
@@ -2630,6 +3468,22 @@ void QCPDataContainer<DataType>::setAutoSqueeze(bool enabled)
   }
 }
 
+/*!
+  Sets the minimum number of data points that a sort or merge operation must involve, for the
+  container to distribute the work across multiple threads (using QThreadPool::globalInstance).
+  Smaller operations are always performed on the calling thread, because for them the threading
+  overhead outweighs the gain.
+  
+  Set \a threshold to zero or a negative value to disable multi-threaded sorting and merging.
+  
+  \see add, set, sort
+*/
+template <class DataType>
+void QCPDataContainer<DataType>::setParallelThreshold(int threshold)
+{
+  mParallelThreshold = threshold;
+}
+
 /*! \overload
   
   Replaces the current data in this container with the provided \a data.
@@ -2655,12 +3509,39 @@ void QCPDataContainer<DataType>::set(const QCPDataContainer<DataType> &data)
 template <class DataType>
 void QCPDataContainer<DataType>::set(const QVector<DataType> &data, bool alreadySorted)
 {
+  completePendingSnapshot();
   mData = data;
   mPreallocSize = 0;
   mPreallocIteration = 0;
+  markSnapshotDirty(0, mData.size());
+  if (!alreadySorted)
+    sort();
+}
+
+#ifdef Q_COMPILER_RVALUE_REFS
+/*! \overload
+  
+  Replaces the current data in this container with the provided \a data, taking over its memory
+  instead of sharing it. Use this overload to hand over large, freshly built data sets: Since \a
+  data is not shared with the caller anymore, sorting it doesn't require a copy.
+  
+  If you can guarantee that the data points in \a data have ascending order with respect to the
+  DataType's sort key, set \a alreadySorted to true to avoid an unnecessary sorting run.
+  
+  \see add, remove
+*/
+template <class DataType>
+void QCPDataContainer<DataType>::set(QVector<DataType> &&data, bool alreadySorted)
+{
+  completePendingSnapshot();
+  mData = std::move(data);
+  mPreallocSize = 0;
+  mPreallocIteration = 0;
+  markSnapshotDirty(0, mData.size());
   if (!alreadySorted)
     sort();
 }
+#endif
 
 /*! \overload
   
@@ -2673,6 +3554,7 @@ void QCPDataContainer<DataType>::add(const QCPDataContainer<DataType> &data)
 {
   if (data.isEmpty())
     return;
+  completePendingSnapshot();
   
   const int n = data.size();
   const int oldSize = size();
@@ -2682,13 +3564,15 @@ void QCPDataContainer<DataType>::add(const QCPDataContainer<DataType> &data)
     if (mPreallocSize < n)
       preallocateGrow(n);
     mPreallocSize -= n;
-    std::copy(data.constBegin(), data.constEnd(), begin());
+    std::copy(data.constBegin(), data.constEnd(), dataBegin());
+    markSnapshotDirty(mPreallocSize, mPreallocSize+n);
   } else // don't need to prepend, so append and merge if necessary
   {
     mData.resize(mData.size()+n);
-    std::copy(data.constBegin(), data.constEnd(), end()-n);
+    std::copy(data.constBegin(), data.constEnd(), dataEnd()-n);
+    markSnapshotDirty(mData.size()-n, mData.size());
     if (oldSize > 0 && !qcpLessThanSortKey<DataType>(*(constEnd()-n-1), *(constEnd()-n))) // if appended range keys aren't all greater than existing ones, merge the two partitions
-      std::inplace_merge(begin(), end()-n, end(), qcpLessThanSortKey<DataType>);
+      mergeRanges(dataBegin(), dataEnd()-n, dataEnd());
   }
 }
 
@@ -2705,6 +3589,7 @@ void QCPDataContainer<DataType>::add(const QVector<DataType> &data, bool already
 {
   if (data.isEmpty())
     return;
+  completePendingSnapshot();
   if (isEmpty())
   {
     set(data, alreadySorted);
@@ -2719,15 +3604,17 @@ void QCPDataContainer<DataType>::add(const QVector<DataType> &data, bool already
     if (mPreallocSize < n)
       preallocateGrow(n);
     mPreallocSize -= n;
-    std::copy(data.constBegin(), data.constEnd(), begin());
+    std::copy(data.constBegin(), data.constEnd(), dataBegin());
+    markSnapshotDirty(mPreallocSize, mPreallocSize+n);
   } else // don't need to prepend, so append and then sort and merge if necessary
   {
     mData.resize(mData.size()+n);
-    std::copy(data.constBegin(), data.constEnd(), end()-n);
+    std::copy(data.constBegin(), data.constEnd(), dataEnd()-n);
+    markSnapshotDirty(mData.size()-n, mData.size());
     if (!alreadySorted) // sort appended subrange if it wasn't already sorted
-      std::sort(end()-n, end(), qcpLessThanSortKey<DataType>);
+      sortRange(dataEnd()-n, dataEnd());
     if (oldSize > 0 && !qcpLessThanSortKey<DataType>(*(constEnd()-n-1), *(constEnd()-n))) // if appended range keys aren't all greater than existing ones, merge the two partitions
-      std::inplace_merge(begin(), end()-n, end(), qcpLessThanSortKey<DataType>);
+      mergeRanges(dataBegin(), dataEnd()-n, dataEnd());
   }
 }
 
@@ -2740,18 +3627,22 @@ void QCPDataContainer<DataType>::add(const QVector<DataType> &data, bool already
 template <class DataType>
 void QCPDataContainer<DataType>::add(const DataType &data)
 {
+  completePendingSnapshot();
   if (isEmpty() || !qcpLessThanSortKey<DataType>(data, *(constEnd()-1))) // quickly handle appends if new data key is greater or equal to existing ones
   {
     mData.append(data);
+    markSnapshotDirty(mData.size()-1, mData.size());
   } else if (qcpLessThanSortKey<DataType>(data, *constBegin()))  // quickly handle prepends using preallocated space
   {
     if (mPreallocSize < 1)
       preallocateGrow(1);
     --mPreallocSize;
-    *begin() = data;
+    *dataBegin() = data;
+    markSnapshotDirty(mPreallocSize, mPreallocSize+1);
   } else // handle inserts, maintaining sorted keys
   {
-    QCPDataContainer<DataType>::iterator insertionPoint = std::lower_bound(begin(), end(), data, qcpLessThanSortKey<DataType>);
+    QCPDataContainer<DataType>::iterator insertionPoint = std::lower_bound(dataBegin(), dataEnd(), data, qcpLessThanSortKey<DataType>);
+    markSnapshotDirty(int(insertionPoint-mData.begin()), mData.size()+1);
     mData.insert(insertionPoint, data);
   }
 }
@@ -2764,9 +3655,12 @@ void QCPDataContainer<DataType>::add(const DataType &data)
 template <class DataType>
 void QCPDataContainer<DataType>::removeBefore(double sortKey)
 {
-  QCPDataContainer<DataType>::iterator it = begin();
-  QCPDataContainer<DataType>::iterator itEnd = std::lower_bound(begin(), end(), DataType::fromSortKey(sortKey), qcpLessThanSortKey<DataType>);
+  completePendingSnapshot();
+  QCPDataContainer<DataType>::iterator it = dataBegin();
+  QCPDataContainer<DataType>::iterator itEnd = std::lower_bound(dataBegin(), dataEnd(), DataType::fromSortKey(sortKey), qcpLessThanSortKey<DataType>);
   mPreallocSize += itEnd-it; // don't actually delete, just add it to the preallocated block (if it gets too large, squeeze will take care of it)
+  if (it != itEnd)
+    ++mRevision;
   if (mAutoSqueeze)
     performAutoSqueeze();
 }
@@ -2779,8 +3673,10 @@ void QCPDataContainer<DataType>::removeBefore(double sortKey)
 template <class DataType>
 void QCPDataContainer<DataType>::removeAfter(double sortKey)
 {
-  QCPDataContainer<DataType>::iterator it = std::upper_bound(begin(), end(), DataType::fromSortKey(sortKey), qcpLessThanSortKey<DataType>);
-  QCPDataContainer<DataType>::iterator itEnd = end();
+  completePendingSnapshot();
+  QCPDataContainer<DataType>::iterator it = std::upper_bound(dataBegin(), dataEnd(), DataType::fromSortKey(sortKey), qcpLessThanSortKey<DataType>);
+  QCPDataContainer<DataType>::iterator itEnd = dataEnd();
+  markSnapshotDirty(it, itEnd);
   mData.erase(it, itEnd); // typically adds it to the postallocated block
   if (mAutoSqueeze)
     performAutoSqueeze();
@@ -2798,9 +3694,11 @@ void QCPDataContainer<DataType>::remove(double sortKeyFrom, double sortKeyTo)
 {
   if (sortKeyFrom >= sortKeyTo || isEmpty())
     return;
+  completePendingSnapshot();
   
-  QCPDataContainer<DataType>::iterator it = std::lower_bound(begin(), end(), DataType::fromSortKey(sortKeyFrom), qcpLessThanSortKey<DataType>);
-  QCPDataContainer<DataType>::iterator itEnd = std::upper_bound(it, end(), DataType::fromSortKey(sortKeyTo), qcpLessThanSortKey<DataType>);
+  QCPDataContainer<DataType>::iterator it = std::lower_bound(dataBegin(), dataEnd(), DataType::fromSortKey(sortKeyFrom), qcpLessThanSortKey<DataType>);
+  QCPDataContainer<DataType>::iterator itEnd = std::upper_bound(it, dataEnd(), DataType::fromSortKey(sortKeyTo), qcpLessThanSortKey<DataType>);
+  markSnapshotDirty(it, constEnd());
   mData.erase(it, itEnd);
   if (mAutoSqueeze)
     performAutoSqueeze();
@@ -2818,14 +3716,125 @@ void QCPDataContainer<DataType>::remove(double sortKeyFrom, double sortKeyTo)
 template <class DataType>
 void QCPDataContainer<DataType>::remove(double sortKey)
 {
-  QCPDataContainer::iterator it = std::lower_bound(begin(), end(), DataType::fromSortKey(sortKey), qcpLessThanSortKey<DataType>);
-  if (it != end() && it->sortKey() == sortKey)
+  completePendingSnapshot();
+  QCPDataContainer::iterator it = std::lower_bound(dataBegin(), dataEnd(), DataType::fromSortKey(sortKey), qcpLessThanSortKey<DataType>);
+  if (it != dataEnd() && it->sortKey() == sortKey)
   {
-    if (it == begin())
+    if (it == dataBegin())
+    {
       ++mPreallocSize; // don't actually delete, just add it to the preallocated block (if it gets too large, squeeze will take care of it)
-    else
+      ++mRevision;
+    } else
+    {
+      markSnapshotDirty(it, constEnd());
       mData.erase(it);
+    }
+  }
+  if (mAutoSqueeze)
+    performAutoSqueeze();
+}
+
+/*! \overload
+  
+  Removes all data points with (sort-)keys inside any of the ranges in \a sortKeyRanges, where the
+  bounds of each range are included like in \ref remove(double sortKeyFrom, double sortKeyTo).
+  Ranges whose lower bound is greater or equal to their upper bound are ignored. The ranges may be
+  given in any order and may overlap.
+  
+  Compared to calling \ref remove(double sortKeyFrom, double sortKeyTo) for each range, which moves
+  all data behind the removed range every time, this method compacts the container in a single
+  pass, and applies the auto squeeze (\ref setAutoSqueeze) only once at the end. Its cost is thus
+  linear in the number of data points, plus a binary search per range.
+  
+  \see removeIf
+*/
+template <class DataType>
+void QCPDataContainer<DataType>::remove(const QVector<QCPRange> &sortKeyRanges)
+{
+  if (sortKeyRanges.isEmpty() || isEmpty())
+    return;
+  completePendingSnapshot();
+  
+  // sort ranges by lower bound and join overlapping ones:
+  QVector<QCPRange> ranges;
+  ranges.reserve(sortKeyRanges.size());
+  for (int i=0; i<sortKeyRanges.size(); ++i)
+  {
+    if (sortKeyRanges.at(i).lower < sortKeyRanges.at(i).upper)
+      ranges.append(sortKeyRanges.at(i));
+  }
+  if (ranges.isEmpty())
+    return;
+  std::sort(ranges.begin(), ranges.end(), qcpLessThanRangeLower);
+  int joinedCount = 1;
+  for (int i=1; i<ranges.size(); ++i)
+  {
+    if (ranges.at(i).lower <= ranges.at(joinedCount-1).upper)
+      ranges[joinedCount-1].upper = qMax(ranges.at(joinedCount-1).upper, ranges.at(i).upper);
+    else
+      ranges[joinedCount++] = ranges.at(i);
+  }
+  
+  // compact, moving each block of kept data points only once:
+  iterator itEnd = dataEnd();
+  iterator writeIt = std::lower_bound(dataBegin(), itEnd, DataType::fromSortKey(ranges.first().lower), qcpLessThanSortKey<DataType>);
+  iterator readIt = writeIt;
+  const iterator firstRemoved = writeIt;
+  for (int i=0; i<joinedCount && readIt != itEnd; ++i)
+  {
+    iterator removeBegin = std::lower_bound(readIt, itEnd, DataType::fromSortKey(ranges.at(i).lower), qcpLessThanSortKey<DataType>);
+    iterator removeEnd = std::upper_bound(removeBegin, itEnd, DataType::fromSortKey(ranges.at(i).upper), qcpLessThanSortKey<DataType>);
+    if (writeIt != readIt)
+      writeIt = std::copy(readIt, removeBegin, writeIt);
+    else
+      writeIt = removeBegin;
+    readIt = removeEnd;
+  }
+  if (writeIt != readIt)
+  {
+    writeIt = std::copy(readIt, itEnd, writeIt);
+    markSnapshotDirty(firstRemoved, itEnd);
+    mData.erase(writeIt, itEnd);
+  }
+  if (mAutoSqueeze)
+    performAutoSqueeze();
+}
+
+/*!
+  Removes all data points for which \a predicate returns true. The predicate is called exactly once
+  for each data point with a <tt>const DataType &</tt> argument, in ascending key order, and all
+  calls go to the same predicate object, so it may keep state (e.g. count the removed data points). It may be a function
+  pointer, a functor or a lambda.
+  
+  The remaining data points are compacted in a single pass, and the auto squeeze (\ref
+  setAutoSqueeze) is applied once at the end. This makes it much faster to remove many scattered
+  data points (e.g. outliers) at once with this method, than with repeated calls to \ref remove.
+  
+  The predicate must not modify the container.
+  
+  \see remove(const QVector<QCPRange> &sortKeyRanges)
+*/
+template <class DataType>
+template <class Predicate>
+void QCPDataContainer<DataType>::removeIf(Predicate predicate)
+{
+  completePendingSnapshot();
+  // not via std::find_if and std::remove_if, which would evaluate the first removed data point twice and may copy the predicate:
+  iterator itEnd = dataEnd();
+  iterator it = dataBegin();
+  while (it != itEnd && !predicate(*it))
+    ++it;
+  if (it == itEnd)
+    return;
+  const iterator firstRemoved = it;
+  iterator writeIt = it;
+  for (++it; it != itEnd; ++it)
+  {
+    if (!predicate(*it))
+      *writeIt++ = *it;
   }
+  markSnapshotDirty(firstRemoved, itEnd);
+  mData.erase(writeIt, itEnd);
   if (mAutoSqueeze)
     performAutoSqueeze();
 }
@@ -2838,6 +3847,8 @@ void QCPDataContainer<DataType>::remove(double sortKey)
 template <class DataType>
 void QCPDataContainer<DataType>::clear()
 {
+  completePendingSnapshot();
+  markSnapshotDirty(0, mData.size());
   mData.clear();
   mPreallocIteration = 0;
   mPreallocSize = 0;
@@ -2853,11 +3864,16 @@ void QCPDataContainer<DataType>::clear()
   is your responsibility to bring the container back into a sorted state before any other methods
   are called on it. This can be achieved by calling this method immediately after finishing the
   sort key manipulation.
+  
+  If the data is already in ascending or descending key order, it is brought into sorted state in
+  linear time. Large unsorted data sets are sorted using multiple threads, see \ref
+  setParallelThreshold.
 */
 template <class DataType>
 void QCPDataContainer<DataType>::sort()
 {
-  std::sort(begin(), end(), qcpLessThanSortKey<DataType>);
+  completePendingSnapshot();
+  sortRange(dataBegin(), dataEnd());
 }
 
 /*!
@@ -2873,11 +3889,13 @@ void QCPDataContainer<DataType>::sort()
 template <class DataType>
 void QCPDataContainer<DataType>::squeeze(bool preAllocation, bool postAllocation)
 {
+  completePendingSnapshot();
   if (preAllocation)
   {
     if (mPreallocSize > 0)
     {
-      std::copy(begin(), end(), mData.begin());
+      markSnapshotDirty(0, mData.size());
+      std::copy(dataBegin(), dataEnd(), mData.begin());
       mData.resize(size());
       mPreallocSize = 0;
     }
@@ -2887,6 +3905,81 @@ void QCPDataContainer<DataType>::squeeze(bool preAllocation, bool postAllocation
     mData.squeeze();
 }
 
+/*!
+  Frees the copy of the data that is kept for \ref snapshot. The next call of \ref snapshot
+  recreates it completely, so this is only useful if no snapshots are needed anymore, or to relieve
+  memory pressure.
+*/
+template <class DataType>
+void QCPDataContainer<DataType>::releaseSnapshot()
+{
+  completePendingSnapshot();
+  mSnapshotChunks.clear();
+  // not via markSnapshotDirty, since the data itself doesn't change:
+  mSnapshotDirtyBegin = 0;
+  mSnapshotDirtyEnd = mData.size();
+  mSnapshotPendingBegin = 0;
+  mSnapshotPendingEnd = 0;
+}
+
+/*!
+  Returns the number of bytes allocated by this container for its data points, including the
+  unused pre- and post-allocation pools, the copy kept for \ref snapshot, and the chunks copied so
+  far for an incomplete \ref deferredSnapshot.
+  
+  If \a reclaimableBytes is not zero, it is set to the number of bytes that \ref squeeze and \ref
+  releaseSnapshot would free. Chunks of the snapshot copy that are still shared with snapshots
+  aren't reclaimable, since releasing the snapshot copy doesn't free them.
+  
+  \see snapshotMemoryUsage
+*/
+template <class DataType>
+qint64 QCPDataContainer<DataType>::memoryUsage(qint64 *reclaimableBytes) const
+{
+  qint64 snapshotBytes = 0, exclusiveSnapshotBytes = 0;
+  for (int i=0; i<mSnapshotChunks.size(); ++i)
+  {
+    const QVector<DataType> &chunk = mSnapshotChunks.at(i);
+    if (chunk.constData() == mData.constData()) // a chunk spanning all data points may share them with mData
+      continue;
+    const qint64 bytes = qint64(chunk.capacity())*sizeof(DataType);
+    snapshotBytes += bytes;
+    if (chunk.isDetached())
+      exclusiveSnapshotBytes += bytes;
+  }
+  QSharedPointer<QCPDataSnapshotCopy<DataType> > copy = mSnapshotCopy.toStrongRef();
+  if (copy)
+    snapshotBytes += copy->copiedBytes();
+  if (reclaimableBytes)
+    *reclaimableBytes = qint64(mData.capacity()-size())*sizeof(DataType) + exclusiveSnapshotBytes;
+  return qint64(mData.capacity())*sizeof(DataType) + snapshotBytes;
+}
+
+/*!
+  Returns the number of bytes allocated by the chunks of \a snapshot that aren't accounted for by
+  \ref memoryUsage of this container, i.e. the chunks that \a snapshot doesn't share with the
+  snapshot copy of this container. This is the memory that is freed when \a snapshot (and all
+  copies of it) are destroyed.
+  
+  \a snapshot must be complete (\ref QCPDataSnapshot::isComplete), or it must not be accessed by
+  another thread during this call.
+*/
+template <class DataType>
+qint64 QCPDataContainer<DataType>::snapshotMemoryUsage(const QCPDataSnapshot<DataType> &snapshot) const
+{
+  QSharedPointer<QCPDataSnapshotCopy<DataType> > copy = mSnapshotCopy.toStrongRef();
+  if (copy && copy == snapshot.mCopy) // the chunks it copied are counted by memoryUsage, the others are shared with the snapshot copy
+    return 0;
+  qint64 result = 0;
+  for (int i=0; i<snapshot.mChunks.size(); ++i)
+  {
+    const QVector<DataType> &chunk = snapshot.mChunks.at(i);
+    if (i >= mSnapshotChunks.size() || chunk.constData() != mSnapshotChunks.at(i).constData())
+      result += qint64(chunk.capacity())*sizeof(DataType);
+  }
+  return result;
+}
+
 /*!
   Returns an iterator to the data point with a (sort-)key that is equal to, just below, or just
   above \a sortKey. If \a expandedRange is true, the data point just below \a sortKey will be
@@ -3176,6 +4269,90 @@ void QCPDataContainer<DataType>::limitIteratorsToDataRange(const_iterator &begin
   end = constBegin()+iteratorRange.end();
 }
 
+/*!
+  Returns an immutable snapshot of the current data in this container.
+  
+  The snapshot may be handed to and read by any number of other threads, while this container
+  continues to be modified (e.g. by the GUI thread, which also renders from it). Readers don't need
+  any locking and always see the consistent state of the data at the time the snapshot was taken.
+  
+  Snapshots are cheap to create repeatedly: Internally, the container keeps a copy of its data in
+  chunks of \ref QCPDataSnapshot::chunkSize data points, which are shared (via Qt's implicit
+  sharing) between all snapshots and the container. When taking a new snapshot, only the chunks
+  that were modified since the last snapshot are copied. Appending data or removing data from the
+  front thus only copies the last chunk, while e.g. inserting data in the middle copies all chunks
+  behind the insertion point. Note that since modifications through the non-const iterators (\ref
+  begin, \ref end) can't be tracked, obtaining them marks all chunks as modified. Read-only
+  access should therefore use \ref constBegin and \ref constEnd.
+  
+  Each snapshot that reflects a new state of the data carries a higher \ref
+  QCPDataSnapshot::version. Calling this method again without intermediate modifications returns
+  a snapshot of the same version, without copying anything.
+  
+  This method must be called from the thread that owns and modifies this container. If many chunks
+  were modified, e.g. on the first call or after \ref set, \ref deferredSnapshot moves the copying
+  to another thread.
+*/
+template <class DataType>
+QCPDataSnapshot<DataType> QCPDataContainer<DataType>::snapshot()
+{
+  completePendingSnapshot();
+  const int chunkSize = QCPDataSnapshot<DataType>::chunkSize();
+  int firstChunk, lastChunk;
+  snapshotChunksToCopy(firstChunk, lastChunk);
+  mSnapshotChunks.resize((mData.size()+chunkSize-1)/chunkSize);
+  for (int i=firstChunk; i<lastChunk; ++i)
+    mSnapshotChunks[i] = mData.mid(i*chunkSize, qMin(chunkSize, mData.size()-i*chunkSize));
+  mSnapshotDirtyBegin = 0;
+  mSnapshotDirtyEnd = 0;
+  mSnapshotPendingBegin = 0;
+  mSnapshotPendingEnd = 0;
+  updateSnapshotVersion();
+  return createSnapshot();
+}
+
+/*!
+  Returns a snapshot of the current data like \ref snapshot, but leaves copying the modified chunks
+  to \ref QCPDataSnapshot::complete, which may be called from any thread. This keeps the cost of
+  the call independent of the amount of modified data: instead of copying, the snapshot shares the
+  data of this container (via Qt's implicit sharing) until it is completed.
+  
+  If only a few chunks were modified, they are copied right away and the returned snapshot is
+  already complete.
+  
+  Call \ref QCPDataSnapshot::complete before reading the snapshot. If this container is modified
+  (or a new snapshot is taken) before the snapshot is complete, the chunks that weren't copied yet
+  are copied first, in the modifying thread, so the modification never has to copy the entire
+  data. The chunks copied for the snapshot, in either thread, are reused by later snapshots of this
+  container, as long as the snapshot still exists when the container is modified next.
+  
+  This method must be called from the thread that owns and modifies this container.
+*/
+template <class DataType>
+QCPDataSnapshot<DataType> QCPDataContainer<DataType>::deferredSnapshot()
+{
+  completePendingSnapshot();
+  const int chunkSize = QCPDataSnapshot<DataType>::chunkSize();
+  int firstChunk, lastChunk;
+  snapshotChunksToCopy(firstChunk, lastChunk);
+  if (lastChunk-firstChunk <= 2) // copying a few chunks right away is cheaper than sharing the data
+    return snapshot();
+  
+  mSnapshotChunks.resize((mData.size()+chunkSize-1)/chunkSize);
+  // the chunks [firstChunk, lastChunk) of mSnapshotChunks are outdated until the copy is finished, see completePendingSnapshot:
+  mSnapshotPendingBegin = firstChunk*chunkSize;
+  mSnapshotPendingEnd = qMin(mData.size(), lastChunk*chunkSize);
+  mSnapshotDirtyBegin = 0;
+  mSnapshotDirtyEnd = 0;
+  updateSnapshotVersion();
+  
+  QCPDataSnapshot<DataType> result = createSnapshot();
+  result.mComplete = false;
+  result.mCopy = QSharedPointer<QCPDataSnapshotCopy<DataType> >(new QCPDataSnapshotCopy<DataType>(mData, chunkSize, firstChunk, lastChunk));
+  mSnapshotCopy = result.mCopy;
+  return result;
+}
+
 /*! \internal
   
   Increases the preallocation pool to have a size of at least \a minimumPreallocSize. Depending on
@@ -3197,6 +4374,7 @@ void QCPDataContainer<DataType>::preallocateGrow(int minimumPreallocSize)
   
   int sizeDifference = newPreallocSize-mPreallocSize;
   mData.resize(mData.size()+sizeDifference);
+  markSnapshotDirty(0, mData.size());
   std::copy_backward(mData.begin()+mPreallocSize, mData.end()-sizeDifference, mData.end());
   mPreallocSize = newPreallocSize;
 }
@@ -3236,36 +4414,699 @@ void QCPDataContainer<DataType>::performAutoSqueeze()
   if (shrinkPreAllocation || shrinkPostAllocation)
     squeeze(shrinkPreAllocation, shrinkPostAllocation);
 }
-/* end of 'src/datacontainer.cpp' */
-
-
-/* end of 'src/datacontainer.h' */
 
-
-/* including file 'src/plottable.h', size 8433                               */
-/* commit ce344b3f96a62e5f652585e55f1ae7c7883cd45b 2018-06-25 01:03:39 +0200 */
-
-class QCP_LIB_DECL QCPSelectionDecorator
-{
-  Q_GADGET
-public:
-  QCPSelectionDecorator();
-  virtual ~QCPSelectionDecorator();
-  
-  // getters:
-  QPen pen() const { return mPen; }
-  QBrush brush() const { return mBrush; }
-  QCPScatterStyle scatterStyle() const { return mScatterStyle; }
-  QCPScatterStyle::ScatterProperties usedScatterProperties() const { return mUsedScatterProperties; }
+/*! \internal
   
-  // setters:
-  void setPen(const QPen &pen);
-  void setBrush(const QBrush &brush);
-  void setScatterStyle(const QCPScatterStyle &scatterStyle, QCPScatterStyle::ScatterProperties usedProperties=QCPScatterStyle::spPen);
-  void setUsedScatterProperties(const QCPScatterStyle::ScatterProperties &properties);
+  Records that the elements of the internal data vector in the index range [\a begin, \a end)
+  (including the preallocation) were modified, so the next \ref snapshot copies the chunks that
+  cover this range. It also increments the \ref revision.
   
-  // non-virtual methods:
-  void applyPen(QCPPainter *painter) const;
+  Since indices refer to the internal vector and not the data points, operations that merely move
+  the boundary of the preallocation (e.g. \ref removeBefore) don't need to mark anything, but must
+  increment the revision themselves.
+*/
+template <class DataType>
+void QCPDataContainer<DataType>::markSnapshotDirty(int begin, int end)
+{
+  ++mRevision;
+  if (begin >= end)
+    return;
+  if (mSnapshotDirtyBegin < mSnapshotDirtyEnd)
+  {
+    mSnapshotDirtyBegin = qMin(mSnapshotDirtyBegin, begin);
+    mSnapshotDirtyEnd = qMax(mSnapshotDirtyEnd, end);
+  } else
+  {
+    mSnapshotDirtyBegin = begin;
+    mSnapshotDirtyEnd = end;
+  }
+}
+
+/*! \internal
+  
+  Finishes copying the chunks of the most recent \ref deferredSnapshot that aren't copied yet, and
+  takes over all of its copied chunks for later snapshots. This releases the reference of the
+  snapshot to the data of this container, so it must be called before the data is modified, or
+  the modification would have to detach (i.e. copy) all of the data.
+  
+  If the snapshot was discarded before it was completed, nothing is copied, and the next snapshot
+  copies the pending chunks instead (see \ref snapshotChunksToCopy).
+*/
+template <class DataType>
+void QCPDataContainer<DataType>::completePendingSnapshot()
+{
+  if (mSnapshotPendingBegin >= mSnapshotPendingEnd)
+    return;
+  QSharedPointer<QCPDataSnapshotCopy<DataType> > copy = mSnapshotCopy.toStrongRef();
+  mSnapshotCopy.clear();
+  if (!copy)
+    return;
+  copy->finish(mSnapshotChunks);
+  mSnapshotPendingBegin = 0;
+  mSnapshotPendingEnd = 0;
+}
+
+/*! \internal
+  
+  Determines the chunks [\a firstChunk, \a lastChunk) that a snapshot of the current data must copy:
+  the ones covering the modified range, the ones still pending from a \ref deferredSnapshot that
+  was discarded before it was completed, and a tail chunk whose size changed outside of these ranges (e.g. due to an erase
+  at a chunk boundary). Before the first snapshot, all chunks must be copied.
+*/
+template <class DataType>
+void QCPDataContainer<DataType>::snapshotChunksToCopy(int &firstChunk, int &lastChunk) const
+{
+  const int chunkSize = QCPDataSnapshot<DataType>::chunkSize();
+  const int chunkCount = (mData.size()+chunkSize-1)/chunkSize;
+  if (mSnapshotVersion == 0)
+  {
+    firstChunk = 0;
+    lastChunk = chunkCount;
+    return;
+  }
+  int begin = mSnapshotDirtyBegin, end = mSnapshotDirtyEnd;
+  if (mSnapshotPendingBegin < mSnapshotPendingEnd)
+  {
+    begin = begin < end ? qMin(begin, mSnapshotPendingBegin) : mSnapshotPendingBegin;
+    end = qMax(end, mSnapshotPendingEnd);
+  }
+  firstChunk = begin < end ? begin/chunkSize : chunkCount;
+  lastChunk = begin < end ? qMin(chunkCount, (end+chunkSize-1)/chunkSize) : chunkCount;
+  if (mSnapshotChunks.size() < chunkCount) // grown by chunks that weren't marked, copy them too
+  {
+    firstChunk = qMin(firstChunk, mSnapshotChunks.size());
+    lastChunk = chunkCount;
+  } else if (chunkCount > 0 && mSnapshotChunks.at(chunkCount-1).size() != mData.size()-(chunkCount-1)*chunkSize)
+  {
+    firstChunk = qMin(firstChunk, chunkCount-1);
+    lastChunk = chunkCount;
+  }
+}
+
+/*! \internal
+  
+  Increases the snapshot version if the data was modified since the last snapshot (or if there was
+  no snapshot yet), so snapshots of the same state carry the same version.
+*/
+template <class DataType>
+void QCPDataContainer<DataType>::updateSnapshotVersion()
+{
+  if (mSnapshotVersion == 0 || mSnapshotRevision != mRevision)
+  {
+    ++mSnapshotVersion;
+    mSnapshotRevision = mRevision;
+  }
+}
+
+/*! \internal
+  
+  Returns a snapshot sharing the current chunks, see \ref snapshot.
+*/
+template <class DataType>
+QCPDataSnapshot<DataType> QCPDataContainer<DataType>::createSnapshot() const
+{
+  QCPDataSnapshot<DataType> result;
+  result.mChunks = mSnapshotChunks;
+  result.mOffset = mPreallocSize;
+  result.mSize = size();
+  result.mVersion = mSnapshotVersion;
+  return result;
+}
+
+/*! \internal
+  
+  Sorts the data points in the range [\a begin, \a end) by their sort key.
+  
+  The range is first checked for existing order, which is cheap compared to a sort: If the keys
+  are already ascending, nothing is done, and if they are descending, the range is just reversed.
+  Otherwise, ranges with at least \ref setParallelThreshold data points are sorted with a parallel
+  merge sort: One run per thread is sorted concurrently, and the runs are then merged pairwise,
+  with each pair merge again being split into independent tasks (see \ref parallelMerge).
+*/
+template <class DataType>
+void QCPDataContainer<DataType>::sortRange(iterator begin, iterator end)
+{
+  const int n = end-begin;
+  if (n < 2)
+    return;
+  DataType *data = &(*begin);
+  const bool parallel = mParallelThreshold > 0 && n >= mParallelThreshold && QThread::idealThreadCount() > 1;
+  
+  QAtomicInt notAscending(0), notDescending(0);
+  qcpParallelFor(n, parallel ? 65536 : n, QCPDataOrderCheckFunctor<DataType>(data, &notAscending, &notDescending));
+  if (notAscending.fetchAndAddRelaxed(0) == 0) // already sorted
+    return;
+  markSnapshotDirty(begin, end);
+  if (notDescending.fetchAndAddRelaxed(0) == 0) // sorted in reverse order
+  {
+    std::reverse(data, data+n);
+    return;
+  }
+  
+  if (!parallel)
+  {
+    std::sort(data, data+n, qcpLessThanSortKey<DataType>);
+    return;
+  }
+  
+  const int runCount = qMin(n, QThread::idealThreadCount());
+  QVector<int> runs(runCount+1);
+  for (int i=0; i<=runCount; ++i)
+    runs[i] = int(qint64(n)*i/runCount);
+  qcpParallelFor(runCount, 1, QCPDataSortRunsFunctor<DataType>(data, runs));
+  
+  QVector<DataType> buffer(n);
+  DataType *source = data;
+  DataType *target = buffer.data();
+  while (runs.size() > 2) // merge neighbouring runs, ping-ponging between data and buffer, until one run is left
+  {
+    parallelMerge(source, target, runs);
+    QVector<int> mergedRuns;
+    for (int i=0; i<runs.size()-1; i+=2)
+      mergedRuns.append(runs.at(i));
+    mergedRuns.append(runs.last());
+    runs = mergedRuns;
+    qSwap(source, target);
+  }
+  if (source != data) // result ended up in buffer, copy it back
+  {
+    runs.clear();
+    runs << 0 << n;
+    parallelMerge(source, data, runs);
+  }
+}
+
+/*! \internal
+  
+  Merges the two adjacent, individually sorted ranges [\a begin, \a middle) and [\a middle, \a
+  end) into one sorted range.
+  
+  Data points at the start of the first range that are not greater than the first point of the
+  second range, and data points at the end of the second range that are not smaller than the last
+  point of the first range, are already in their final position and are excluded from the merge. If the
+  remaining overlap has at least \ref setParallelThreshold data points, it is merged concurrently
+  into a temporary buffer, otherwise std::inplace_merge is used.
+*/
+template <class DataType>
+void QCPDataContainer<DataType>::mergeRanges(iterator begin, iterator middle, iterator end)
+{
+  if (begin == middle || middle == end)
+    return;
+  begin = std::upper_bound(begin, middle, *middle, qcpLessThanSortKey<DataType>);
+  end = std::lower_bound(middle, end, *(middle-1), qcpLessThanSortKey<DataType>);
+  if (begin == middle || middle == end)
+    return;
+  markSnapshotDirty(begin, end);
+  
+  const int n = end-begin;
+  if (mParallelThreshold <= 0 || n < mParallelThreshold || QThread::idealThreadCount() < 2)
+  {
+    std::inplace_merge(begin, middle, end, qcpLessThanSortKey<DataType>);
+    return;
+  }
+  
+  DataType *data = &(*begin);
+  QVector<DataType> buffer(n);
+  QVector<int> runs;
+  runs << 0 << int(middle-begin) << n;
+  parallelMerge(data, buffer.data(), runs);
+  runs.clear();
+  runs << 0 << n;
+  parallelMerge(buffer.data(), data, runs);
+}
+
+/*! \internal
+  
+  Merges each pair of neighbouring sorted runs in \a source, delimited by the consecutive indices
+  in \a runs, into the same index range of \a target. A trailing run without partner is copied.
+  If \a runs only describes a single run, it is copied from \a source to \a target.
+  
+  To keep all threads busy even when only few pairs are left, each pair merge is split into
+  several independent tasks: The first run of the pair is cut into equally sized pieces, and the
+  matching cut positions in the second run are found by binary search.
+*/
+template <class DataType>
+void QCPDataContainer<DataType>::parallelMerge(DataType *source, DataType *target, const QVector<int> &runs) const
+{
+  const int runCount = runs.size()-1;
+  const int pairCount = (runCount+1)/2;
+  const int splitCount = qMax(1, QThread::idealThreadCount()*2/pairCount);
+  QVector<QCPDataMergeTask> tasks;
+  tasks.reserve(pairCount*splitCount);
+  for (int i=0; i<runCount; i+=2)
+  {
+    const int lower = runs.at(i);
+    const int middle = runs.at(i+1);
+    const int upper = i+2 <= runCount ? runs.at(i+2) : middle; // trailing single run gets merged with an empty range, i.e. copied
+    int previousA = lower;
+    int previousB = middle;
+    for (int k=1; k<=splitCount; ++k)
+    {
+      int a, b;
+      if (k == splitCount)
+      {
+        a = middle;
+        b = upper;
+      } else
+      {
+        a = lower+int(qint64(middle-lower)*k/splitCount);
+        b = a < middle ? int(std::lower_bound(source+middle, source+upper, source[a], qcpLessThanSortKey<DataType>)-source) : upper;
+      }
+      QCPDataMergeTask task;
+      task.aBegin = previousA;
+      task.aEnd = a;
+      task.bBegin = previousB;
+      task.bEnd = b;
+      task.outBegin = previousA+(previousB-middle);
+      if (task.aBegin < task.aEnd || task.bBegin < task.bEnd)
+        tasks.append(task);
+      previousA = a;
+      previousB = b;
+    }
+  }
+  qcpParallelFor(tasks.size(), 1, QCPDataMergeFunctor<DataType>(source, target, tasks));
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPDataSnapshot
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPDataSnapshot
+  \brief An immutable view of the data of a \ref QCPDataContainer at one point in time
+
+  Snapshots are created with \ref QCPDataContainer::snapshot. They are implicitly shared value
+  types, so copying and passing them around (also to other threads, e.g. as signal arguments or to
+  QtConcurrent functions) is cheap. A snapshot never changes, regardless of what happens to the
+  container it was taken from, so threads that export or analyze data can read it without any
+  locking.
+  
+  The data points are stored in chunks that are shared with other snapshots of the same container,
+  see \ref QCPDataContainer::snapshot for details. Access them by index with \ref at, and use \ref
+  findBegin and \ref findEnd to find the index range of a key interval.
+  
+  Snapshots from \ref QCPDataContainer::deferredSnapshot are incomplete at first: they must be
+  completed with \ref complete, typically by the thread that reads them, before their data is
+  accessed.
+*/
+
+/* start documentation of inline functions */
+
+/*! \fn int QCPDataSnapshot<DataType>::version() const
+  
+  Returns the version of the data this snapshot shows. Snapshots of the same container with the same
+  version hold identical data, and a higher version means a newer state. Default-constructed
+  snapshots have version zero.
+*/
+
+/*! \fn const DataType &QCPDataSnapshot<DataType>::at(int index) const
+  
+  Returns the data point at \a index, which must be in the range 0 to \ref size-1.
+*/
+
+/*! \fn bool QCPDataSnapshot<DataType>::isComplete() const
+  
+  Returns whether the data of this snapshot can be read. Only snapshots from \ref
+  QCPDataContainer::deferredSnapshot may be incomplete, until \ref complete is called.
+*/
+
+/*! \fn int QCPDataSnapshot<DataType>::chunkSize()
+  
+  Returns the number of data points per chunk of the internal storage that is shared between
+  snapshots and their container.
+*/
+
+/* end documentation of inline functions */
+
+/*!
+  Constructs an empty snapshot with version zero.
+*/
+template <class DataType>
+QCPDataSnapshot<DataType>::QCPDataSnapshot() :
+  mOffset(0),
+  mSize(0),
+  mVersion(0),
+  mComplete(true)
+{
+}
+
+/*!
+  Copies the chunks that a snapshot obtained from \ref QCPDataContainer::deferredSnapshot still
+  shares with its container, and releases the reference to the container's data. Chunks that the
+  container already copied because it was modified in the meantime are taken over instead. Does
+  nothing if the snapshot is already complete (\ref isComplete), which is always the case for
+  snapshots from \ref QCPDataContainer::snapshot.
+  
+  This may be called from any thread, but not concurrently with other accesses to the same snapshot
+  instance. The data of an incomplete snapshot must not be read before this method was called.
+*/
+template <class DataType>
+void QCPDataSnapshot<DataType>::complete()
+{
+  if (mComplete)
+    return;
+  mCopy->finish(mChunks);
+  mComplete = true;
+}
+
+/*!
+  Returns the index of the data point with a (sort-)key that is equal to, just below, or just
+  above \a sortKey. If \a expandedRange is true, the data point just below \a sortKey will be
+  considered, otherwise the one just above.
+  
+  This behaves like \ref QCPDataContainer::findBegin, but returns an index instead of an iterator.
+  
+  \see findEnd
+*/
+template <class DataType>
+int QCPDataSnapshot<DataType>::findBegin(double sortKey, bool expandedRange) const
+{
+  int index = lowerBound(sortKey);
+  if (expandedRange && index > 0)
+    --index;
+  return index;
+}
+
+/*!
+  Returns the index after the data point with a (sort-)key that is equal to, just above or just
+  below \a sortKey. If \a expandedRange is true, the data point just above \a sortKey will be
+  considered, otherwise the one just below.
+  
+  This behaves like \ref QCPDataContainer::findEnd, but returns an index instead of an iterator.
+  
+  \see findBegin
+*/
+template <class DataType>
+int QCPDataSnapshot<DataType>::findEnd(double sortKey, bool expandedRange) const
+{
+  int index = upperBound(sortKey);
+  if (expandedRange && index < mSize)
+    ++index;
+  return index;
+}
+
+/*!
+  Returns the number of leading data points that are identical in this snapshot and \a other,
+  judging by the chunks both share. For two snapshots of the same container, these are at least
+  the data points in front of the first chunk that was modified between them. Since unmodified
+  chunks aren't compared element by element, this takes time proportional to the number of
+  chunks, not data points.
+  
+  Returns 0 if either snapshot is incomplete (\ref isComplete), or if the data of the two snapshots
+  starts at a different position within the chunks (e.g. after data was added in front).
+*/
+template <class DataType>
+int QCPDataSnapshot<DataType>::sharedPrefixSize(const QCPDataSnapshot<DataType> &other) const
+{
+  if (!isComplete() || !other.isComplete() || mOffset != other.mOffset)
+    return 0;
+  const int chunkCount = qMin(mChunks.size(), other.mChunks.size());
+  int sharedChunks = 0;
+  while (sharedChunks < chunkCount && mChunks.at(sharedChunks).constData() == other.mChunks.at(sharedChunks).constData() &&
+         mChunks.at(sharedChunks).size() == other.mChunks.at(sharedChunks).size())
+    ++sharedChunks;
+  return qBound(0, sharedChunks*chunkSize()-mOffset, qMin(mSize, other.mSize));
+}
+
+/*!
+  Returns a contiguous copy of all data points of this snapshot.
+*/
+template <class DataType>
+QVector<DataType> QCPDataSnapshot<DataType>::toVector() const
+{
+  QVector<DataType> result;
+  result.reserve(mSize);
+  for (int i=0; i<mSize; ++i)
+    result.append(at(i));
+  return result;
+}
+
+/*! \internal
+  
+  Returns the index of the first data point whose sort key is not smaller than \a sortKey, or \ref
+  size if there is none.
+*/
+template <class DataType>
+int QCPDataSnapshot<DataType>::lowerBound(double sortKey) const
+{
+  int lower = 0;
+  int count = mSize;
+  while (count > 0)
+  {
+    const int step = count/2;
+    if (at(lower+step).sortKey() < sortKey)
+    {
+      lower += step+1;
+      count -= step+1;
+    } else
+      count = step;
+  }
+  return lower;
+}
+
+/*! \internal
+  
+  Returns the index of the first data point whose sort key is greater than \a sortKey, or \ref
+  size if there is none.
+*/
+template <class DataType>
+int QCPDataSnapshot<DataType>::upperBound(double sortKey) const
+{
+  int lower = 0;
+  int count = mSize;
+  while (count > 0)
+  {
+    const int step = count/2;
+    if (!(sortKey < at(lower+step).sortKey()))
+    {
+      lower += step+1;
+      count -= step+1;
+    } else
+      count = step;
+  }
+  return lower;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPDataIngestChannel
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPDataIngestChannel
+  \brief A lock-free queue through which other threads can feed data into a \ref QCPDataContainer
+
+  \ref QCPDataContainer is not thread-safe, and it is read by the plottables while the plot is
+  being replotted. Threads other than the GUI thread thus may not modify it. Instead, data
+  acquisition threads can push their batches of data points into a QCPDataIngestChannel with \ref
+  push. This never blocks, and any number of threads may push concurrently.
+  
+  The owner of the container (usually the GUI thread) periodically calls \ref drainInto, which
+  takes all pending batches at once and adds them to the container with a single sorted merge.
+  One-dimensional plottables have their own ingest channel (see \ref
+  QCPAbstractPlottable1D::ingestChannel) which is drained automatically at the beginning of each
+  \ref QCustomPlot::replot, right after the \ref QCustomPlot::beforeReplot signal was emitted.
+  
+  To bound the memory consumption when the consumer can't keep up, the channel holds at most \ref
+  capacity batches. Batches pushed to a full channel are discarded, which is reported by the return
+  value of \ref push and counted in \ref droppedBatchCount and \ref droppedDataCount. The number of
+  batches currently waiting is available via \ref depth.
+*/
+
+/* start documentation of inline functions */
+
+/*! \fn int QCPDataIngestChannel<DataType>::depth() const
+  
+  Returns the number of batches that were pushed but not yet drained.
+*/
+
+/*! \fn int QCPDataIngestChannel<DataType>::droppedBatchCount() const
+  
+  Returns the number of batches that were discarded by \ref push because the channel was full,
+  since construction or the last call to \ref resetCounters.
+  
+  \see droppedDataCount
+*/
+
+/*! \fn int QCPDataIngestChannel<DataType>::droppedDataCount() const
+  
+  Returns the total number of data points in the batches that were discarded by \ref push because
+  the channel was full, since construction or the last call to \ref resetCounters.
+  
+  \see droppedBatchCount
+*/
+
+/* end documentation of inline functions */
+
+/*!
+  Constructs an empty ingest channel which holds at most \a capacity pending batches.
+*/
+template <class DataType>
+QCPDataIngestChannel<DataType>::QCPDataIngestChannel(int capacity) :
+  mCapacity(qMax(1, capacity)),
+  mHead(0),
+  mDepth(0),
+  mDroppedBatches(0),
+  mDroppedData(0)
+{
+}
+
+template <class DataType>
+QCPDataIngestChannel<DataType>::~QCPDataIngestChannel()
+{
+  Batch *batch = mHead.fetchAndStoreAcquire(0);
+  while (batch)
+  {
+    Batch *next = batch->next;
+    delete batch;
+    batch = next;
+  }
+}
+
+/*!
+  Sets the maximum number of batches that may be pending in this channel. Batches that are pushed
+  while the channel is full are discarded.
+  
+  This method is thread-safe.
+*/
+template <class DataType>
+void QCPDataIngestChannel<DataType>::setCapacity(int capacity)
+{
+  mCapacity.storeRelease(qMax(1, capacity));
+}
+
+/*!
+  Enqueues the data points \a data for the next \ref drainInto. If you can guarantee that the data
+  points in \a data have ascending order with respect to the DataType's sort key, set \a
+  alreadySorted to true to allow the drain to skip the sorting run.
+  
+  This method is thread-safe and lock-free. It never blocks, neither on other producers nor on the
+  consumer. If the channel already holds \ref capacity batches, \a data is discarded and false is
+  returned. Empty batches are ignored.
+*/
+template <class DataType>
+bool QCPDataIngestChannel<DataType>::push(const QVector<DataType> &data, bool alreadySorted)
+{
+  if (data.isEmpty())
+    return true;
+  if (mDepth.fetchAndAddRelaxed(1) >= mCapacity.loadAcquire())
+  {
+    mDepth.fetchAndAddRelaxed(-1);
+    mDroppedBatches.fetchAndAddRelaxed(1);
+    mDroppedData.fetchAndAddRelaxed(data.size());
+    return false;
+  }
+  
+  Batch *batch = new Batch;
+  batch->data = data;
+  batch->sorted = alreadySorted;
+  do
+  {
+    batch->next = mHead.loadAcquire();
+  } while (!mHead.testAndSetRelease(batch->next, batch));
+  return true;
+}
+
+/*!
+  Takes all pending batches from the channel and adds them to \a container. The batches are
+  concatenated in the order they were pushed and added to the container in a single \ref
+  QCPDataContainer::add call, so the container only sorts and merges once per drain. If all
+  batches were pushed as sorted and follow each other in key order, sorting is skipped entirely.
+  
+  Only the thread that owns \a container may call this method. Producers may keep pushing
+  concurrently, their batches are then picked up by the next drain.
+  
+  Returns the number of data points that were added to \a container.
+*/
+template <class DataType>
+int QCPDataIngestChannel<DataType>::drainInto(QCPDataContainer<DataType> *container)
+{
+  Batch *batch = mHead.fetchAndStoreAcquire(0);
+  if (!batch)
+    return 0;
+  
+  // the pending batches form a stack, reverse it to restore push order:
+  Batch *first = 0;
+  int batchCount = 0;
+  int dataCount = 0;
+  while (batch)
+  {
+    Batch *next = batch->next;
+    batch->next = first;
+    first = batch;
+    ++batchCount;
+    dataCount += batch->data.size();
+    batch = next;
+  }
+  
+  QVector<DataType> merged;
+  bool sorted = true;
+  if (batchCount == 1)
+  {
+    merged = first->data;
+    sorted = first->sorted;
+  } else
+  {
+    merged.reserve(dataCount);
+    for (batch = first; batch; batch = batch->next)
+    {
+      if (sorted && (!batch->sorted || (!merged.isEmpty() && qcpLessThanSortKey<DataType>(batch->data.first(), merged.last()))))
+        sorted = false;
+      for (typename QVector<DataType>::const_iterator it = batch->data.constBegin(); it != batch->data.constEnd(); ++it)
+        merged.append(*it);
+    }
+  }
+  while (first)
+  {
+    Batch *next = first->next;
+    delete first;
+    first = next;
+  }
+  mDepth.fetchAndAddRelaxed(-batchCount);
+  
+  if (container)
+    container->add(merged, sorted);
+  return dataCount;
+}
+
+/*!
+  Resets the counters reported by \ref droppedBatchCount and \ref droppedDataCount to zero.
+*/
+template <class DataType>
+void QCPDataIngestChannel<DataType>::resetCounters()
+{
+  mDroppedBatches.storeRelease(0);
+  mDroppedData.storeRelease(0);
+}
+/* end of 'src/datacontainer.cpp' */
+
+
+/* end of 'src/datacontainer.h' */
+
+
+/* including file 'src/plottable.h', size 8433                               */
+/* commit ce344b3f96a62e5f652585e55f1ae7c7883cd45b 2018-06-25 01:03:39 +0200 */
+
+class QCP_LIB_DECL QCPSelectionDecorator
+{
+  Q_GADGET
+public:
+  QCPSelectionDecorator();
+  virtual ~QCPSelectionDecorator();
+  
+  // getters:
+  QPen pen() const { return mPen; }
+  QBrush brush() const { return mBrush; }
+  QCPScatterStyle scatterStyle() const { return mScatterStyle; }
+  QCPScatterStyle::ScatterProperties usedScatterProperties() const { return mUsedScatterProperties; }
+  
+  // setters:
+  void setPen(const QPen &pen);
+  void setBrush(const QBrush &brush);
+  void setScatterStyle(const QCPScatterStyle &scatterStyle, QCPScatterStyle::ScatterProperties usedProperties=QCPScatterStyle::spPen);
+  void setUsedScatterProperties(const QCPScatterStyle::ScatterProperties &properties);
+  
+  // non-virtual methods:
+  void applyPen(QCPPainter *painter) const;
   void applyBrush(QCPPainter *painter) const;
   QCPScatterStyle getFinalScatterStyle(const QCPScatterStyle &unselectedStyle) const;
   
@@ -3341,6 +5182,8 @@ public:
   virtual QCPPlottableInterface1D *interface1D() { return 0; }
   virtual QCPRange getKeyRange(bool &foundRange, QCP::SignDomain inSignDomain=QCP::sdBoth) const = 0;
   virtual QCPRange getValueRange(bool &foundRange, QCP::SignDomain inSignDomain=QCP::sdBoth, const QCPRange &inKeyRange=QCPRange()) const = 0;
+  virtual qint64 memoryUsage(qint64 *reclaimableBytes=0) const;
+  virtual void releaseMemory();
   
   // non-property methods:
   void coordsToPixels(double key, double value, double &x, double &y) const;
@@ -3382,6 +5225,8 @@ protected:
   
   // introduced virtual methods:
   virtual void drawLegendIcon(QCPPainter *painter, const QRectF &rect) const = 0;
+  virtual void drainIngestChannel() {}
+  virtual void prepareDraw() {}
   
   // non-virtual methods:
   void applyFillAntialiasingHint(QCPPainter *painter) const;
@@ -3391,6 +5236,7 @@ private:
   Q_DISABLE_COPY(QCPAbstractPlottable)
   
   friend class QCustomPlot;
+  friend class QCPLayer;
   friend class QCPAxis;
   friend class QCPPlottableLegendItem;
 };
@@ -3436,6 +5282,7 @@ private:
   Q_DISABLE_COPY(QCPItemAnchor)
   
   friend class QCPItemPosition;
+  friend class QCPAbstractItem;
 };
 
 
@@ -3537,6 +5384,10 @@ public:
   
   // reimplemented virtual methods:
   virtual double selectTest(const QPointF &pos, bool onlySelectable, QVariant *details=0) const Q_DECL_OVERRIDE = 0;
+  virtual quint64 contentRevision() const Q_DECL_OVERRIDE;
+  
+  // introduced virtual methods:
+  virtual qint64 memoryUsage() const;
   
   // non-virtual methods:
   QList<QCPItemPosition*> positions() const { return mPositions; }
@@ -3566,22 +5417,117 @@ protected:
   virtual void selectEvent(QMouseEvent *event, bool additive, const QVariant &details, bool *selectionStateChanged) Q_DECL_OVERRIDE;
   virtual void deselectEvent(bool *selectionStateChanged) Q_DECL_OVERRIDE;
   
-  // introduced virtual methods:
-  virtual QPointF anchorPixelPosition(int anchorId) const;
+  // introduced virtual methods:
+  virtual QPointF anchorPixelPosition(int anchorId) const;
+  
+  // non-virtual methods:
+  double rectDistance(const QRectF &rect, const QPointF &pos, bool filledRect) const;
+  QCPItemPosition *createPosition(const QString &name);
+  QCPItemAnchor *createAnchor(const QString &name, int anchorId);
+  
+private:
+  Q_DISABLE_COPY(QCPAbstractItem)
+  
+  friend class QCustomPlot;
+  friend class QCPItemAnchor;
+};
+
+/* end of 'src/item.h' */
+
+
+/* including file 'src/replotstatistics.h'                                  */
+
+class QCP_LIB_DECL QCPLayerableStatistics
+{
+public:
+  QCPLayerableStatistics();
+  
+  QPointer<QCPLayerable> layerable;
+  double drawTime;
+  int inputPointCount, outputPointCount;
+};
+
+class QCP_LIB_DECL QCPReplotStatistics
+{
+public:
+  QCPReplotStatistics();
+  
+  QString toString(int maxLayerables=5) const;
+  
+  double replotTime, layoutTime, tickTime, bufferSetupTime, drawTime, paintTime;
+  int paintBufferCount, paintBufferReallocations;
+  int redrawnLayerCount, reusedLayerCount;
+  int replotRequestCount, coalescedRequestCount;
+  QList<QCPLayerableStatistics> layerables;
+  
+protected:
+  inline static bool moreDrawTime(const QCPLayerableStatistics &a, const QCPLayerableStatistics &b) { return a.drawTime > b.drawTime; }
+};
+
+class QCP_LIB_DECL QCPReplotStatisticsHud : public QCPLayerable
+{
+  Q_OBJECT
+public:
+  explicit QCPReplotStatisticsHud(QCustomPlot *parentPlot);
+  
+  // getters:
+  QFont font() const { return mFont; }
+  QColor textColor() const { return mTextColor; }
+  QBrush brush() const { return mBrush; }
+  
+  // setters:
+  void setFont(const QFont &font);
+  void setTextColor(const QColor &color);
+  void setBrush(const QBrush &brush);
+  
+protected:
+  // property members:
+  QFont mFont;
+  QColor mTextColor;
+  QBrush mBrush;
+  
+  // reimplemented virtual methods:
+  virtual void applyDefaultAntialiasingHint(QCPPainter *painter) const Q_DECL_OVERRIDE;
+  virtual void draw(QCPPainter *painter) Q_DECL_OVERRIDE;
+};
+
+/* end of 'src/replotstatistics.h' */
+
+
+/* including file 'src/memoryreport.h'                                      */
+
+class QCP_LIB_DECL QCPMemoryReport
+{
+public:
+  /*!
+    Defines what a \ref Entry of the report accounts for.
+  */
+  enum Category { mcPlottable   ///< the data (including unused pre- and post-allocation) and cached images of a plottable
+                  ,mcPaintBuffer ///< a paint buffer holding the drawn content of one or more layers
+                  ,mcLabelCache  ///< the cached tick label pixmaps of an axis
+                  ,mcItem        ///< an item, including the pixmaps it holds
+                  ,mcScratch     ///< the temporary vectors pooled for reuse by the drawing code of all plots (see \ref QCPScratchVector)
+                };
+  
+  struct Entry
+  {
+    Category category;
+    QString name;
+    qint64 bytes;
+    qint64 reclaimableBytes;
+  };
   
-  // non-virtual methods:
-  double rectDistance(const QRectF &rect, const QPointF &pos, bool filledRect) const;
-  QCPItemPosition *createPosition(const QString &name);
-  QCPItemAnchor *createAnchor(const QString &name, int anchorId);
+  QCPMemoryReport();
   
-private:
-  Q_DISABLE_COPY(QCPAbstractItem)
+  qint64 totalBytes() const;
+  qint64 totalBytes(Category category) const;
+  qint64 reclaimableBytes() const;
+  QString toString() const;
   
-  friend class QCustomPlot;
-  friend class QCPItemAnchor;
+  QList<Entry> entries;
 };
 
-/* end of 'src/item.h' */
+/* end of 'src/memoryreport.h' */
 
 
 /* including file 'src/core.h', size 14886                                   */
@@ -3601,6 +5547,11 @@ class QCP_LIB_DECL QCustomPlot : public QWidget
   Q_PROPERTY(bool noAntialiasingOnDrag READ noAntialiasingOnDrag WRITE setNoAntialiasingOnDrag)
   Q_PROPERTY(Qt::KeyboardModifier multiSelectModifier READ multiSelectModifier WRITE setMultiSelectModifier)
   Q_PROPERTY(bool openGl READ openGl WRITE setOpenGl)
+  Q_PROPERTY(QCPReplotScheduler* replotScheduler READ replotScheduler WRITE setReplotScheduler)
+  Q_PROPERTY(int replotPriority READ replotPriority WRITE setReplotPriority)
+  Q_PROPERTY(bool replotStatisticsEnabled READ replotStatisticsEnabled WRITE setReplotStatisticsEnabled)
+  Q_PROPERTY(qint64 memoryBudget READ memoryBudget WRITE setMemoryBudget)
+  Q_PROPERTY(bool autoReleaseMemory READ autoReleaseMemory WRITE setAutoReleaseMemory)
   /// \endcond
 public:
   /*!
@@ -3646,6 +5597,20 @@ public:
   QCP::SelectionRectMode selectionRectMode() const { return mSelectionRectMode; }
   QCPSelectionRect *selectionRect() const { return mSelectionRect; }
   bool openGl() const { return mOpenGl; }
+  int redrawnLayerCount() const { return mRedrawnLayerCount; }
+  int reusedLayerCount() const { return mReusedLayerCount; }
+  QCP::InteractionDegradations interactionDegradations() const { return mInteractionDegradations; }
+  double interactionFrameBudget() const { return mInteractionFrameBudget; }
+  int interactionRefineDelay() const { return mInteractionRefineDelay; }
+  int interactionLevel() const { return mInteractionLevel; }
+  QCP::InteractionDegradations activeInteractionDegradations() const { return mActiveInteractionDegradations; }
+  QCPReplotScheduler *replotScheduler() const { return mReplotScheduler.data(); }
+  int replotPriority() const { return mReplotPriority; }
+  bool replotStatisticsEnabled() const { return mReplotStatisticsEnabled; }
+  QCPReplotStatistics replotStatistics() const { return mReplotStatistics; }
+  QCPReplotStatisticsHud *replotStatisticsHud() const { return mReplotStatisticsHud; }
+  qint64 memoryBudget() const { return mMemoryBudget; }
+  bool autoReleaseMemory() const { return mAutoReleaseMemory; }
   
   // setters:
   void setViewport(const QRect &rect);
@@ -3670,8 +5635,20 @@ public:
   void setSelectionRectMode(QCP::SelectionRectMode mode);
   void setSelectionRect(QCPSelectionRect *selectionRect);
   void setOpenGl(bool enabled, int multisampling=16);
+  void setInteractionDegradations(const QCP::InteractionDegradations &degradations);
+  void setInteractionFrameBudget(double milliseconds);
+  void setInteractionRefineDelay(int milliseconds);
+  void setReplotScheduler(QCPReplotScheduler *scheduler);
+  void setReplotPriority(int priority);
+  void setReplotStatisticsEnabled(bool enabled);
+  void setReplotStatisticsHudVisible(bool visible);
+  void setMemoryBudget(qint64 bytes);
+  void setAutoReleaseMemory(bool enabled);
   
   // non-property methods:
+  void notifyInteraction();
+  QCPMemoryReport memoryReport() const;
+  void releaseMemory();
   // plottable interface:
   QCPAbstractPlottable *plottable(int index);
   QCPAbstractPlottable *plottable();
@@ -3714,6 +5691,7 @@ public:
   bool addLayer(const QString &name, QCPLayer *otherLayer=0, LayerInsertMode insertMode=limAbove);
   bool removeLayer(QCPLayer *layer);
   bool moveLayer(QCPLayer *layer, QCPLayer *otherLayer, LayerInsertMode insertMode=limAbove);
+  void markAllLayersDirty();
   
   // axis rect/layout interface:
   int axisRectCount() const;
@@ -3758,6 +5736,7 @@ signals:
   void selectionChangedByUser();
   void beforeReplot();
   void afterReplot();
+  void memoryBudgetExceeded(qint64 bytes, qint64 budget);
   
 protected:
   // property members:
@@ -3784,6 +5763,14 @@ protected:
   QCP::SelectionRectMode mSelectionRectMode;
   QCPSelectionRect *mSelectionRect;
   bool mOpenGl;
+  QCP::InteractionDegradations mInteractionDegradations;
+  double mInteractionFrameBudget;
+  int mInteractionRefineDelay;
+  QPointer<QCPReplotScheduler> mReplotScheduler;
+  int mReplotPriority;
+  bool mReplotStatisticsEnabled;
+  qint64 mMemoryBudget;
+  bool mAutoReleaseMemory;
   
   // non-property members:
   QList<QSharedPointer<QCPAbstractPaintBuffer> > mPaintBuffers;
@@ -3794,7 +5781,21 @@ protected:
   QVariant mMouseEventLayerableDetails;
   QVariant mMouseSignalLayerableDetails;
   bool mReplotting;
-  bool mReplotQueued;
+  bool mReplotQueued, mProcessingQueuedReplot;
+  int mRedrawnLayerCount, mReusedLayerCount;
+  QPointer<QCPAxisRect> mFastPanAxisRect;
+  QRect mFastPanRect;
+  QPoint mFastPanDelta;
+  bool mFastPanCancelled;
+  bool mInteracting;
+  int mInteractionLevel, mInteractionFastFrames;
+  QCP::InteractionDegradations mActiveInteractionDegradations;
+  QTimer *mInteractionRefineTimer;
+  QCPReplotStatistics mReplotStatistics, mPendingStatistics;
+  QHash<const QCPLayerable*, QCPLayerableStatistics> mLayerableStatistics;
+  QMutex mLayerableStatisticsMutex;
+  QCPReplotStatisticsHud *mReplotStatisticsHud;
+  QElapsedTimer mMemoryCheckTimer;
   int mOpenGlMultisamples;
   QCP::AntialiasedElements mOpenGlAntialiasedElementsBackup;
   bool mOpenGlCacheLabelsBackup;
@@ -3833,6 +5834,25 @@ protected:
   QList<QCPLayerable*> layerableListAt(const QPointF &pos, bool onlySelectable, QList<QVariant> *selectionDetails=0) const;
   void drawBackground(QCPPainter *painter);
   void setupPaintBuffers();
+  void collectDirtyLayers();
+  bool beginFastPanStep(QCPAxisRect *axisRect);
+  void addFastPanStep(QCPAxisRect *axisRect, const QPoint &delta);
+  void cancelFastPan();
+  bool axisFollowsFastPan(QCPAxis *axis) const;
+  bool layerableFollowsFastPan(QCPLayerable *layerable) const;
+  bool layerFollowsFastPan(QCPLayer *layer) const;
+  bool scrollFastPanLayers(int begin, int end);
+  void updateInteractionQuality();
+  void adjustInteractionLevel(double frameTime);
+  QCP::InteractionDegradations interactionDegradationsForLevel(int level) const;
+  double effectiveBufferDevicePixelRatio() const;
+  Q_SLOT void finishInteraction();
+  Q_SLOT void processQueuedReplot();
+  bool collectsReplotStatistics() const { return mReplotStatisticsEnabled && mReplotting; }
+  void addLayerableDrawTime(const QCPLayerable *layerable, double milliseconds);
+  void addLayerablePointCounts(const QCPLayerable *layerable, int inputCount, int outputCount);
+  void finishReplotStatistics();
+  void checkMemoryBudget();
   QCPAbstractPaintBuffer *createPaintBuffer();
   bool hasInvalidatedPaintBuffers();
   bool setupOpenGl();
@@ -3845,6 +5865,7 @@ protected:
   friend class QCPAbstractPlottable;
   friend class QCPGraph;
   friend class QCPAbstractItem;
+  friend class QCPReplotScheduler;
 };
 Q_DECLARE_METATYPE(QCustomPlot::LayerInsertMode)
 Q_DECLARE_METATYPE(QCustomPlot::RefreshPriority)
@@ -3852,6 +5873,85 @@ Q_DECLARE_METATYPE(QCustomPlot::RefreshPriority)
 /* end of 'src/core.h' */
 
 
+/* including file 'src/replotscheduler.h'                                    */
+
+class QCP_LIB_DECL QCPReplotScheduler : public QObject
+{
+  Q_OBJECT
+  /// \cond INCLUDE_QPROPERTIES
+  Q_PROPERTY(double frameRate READ frameRate WRITE setFrameRate)
+  Q_PROPERTY(double frameBudget READ frameBudget WRITE setFrameBudget)
+  /// \endcond
+public:
+  explicit QCPReplotScheduler(QObject *parent=0);
+  virtual ~QCPReplotScheduler();
+  static QCPReplotScheduler *instance();
+  
+  // getters:
+  double frameRate() const { return mFrameRate; }
+  double frameBudget() const { return mFrameBudget; }
+  QList<QCustomPlot*> plots() const;
+  int pendingReplotCount() const;
+  int frameCount() const { return mFrameCount; }
+  int missedFrameCount() const { return mMissedFrameCount; }
+  int deferredReplotCount() const { return mDeferredReplotCount; }
+  int skippedReplotCount() const { return mSkippedReplotCount; }
+  double lastFrameTime() const { return mLastFrameTime; }
+  double maxFrameTime() const { return mMaxFrameTime; }
+  double averageFrameTime() const { return mFrameCount > 0 ? mTotalFrameTime/mFrameCount : 0; }
+  
+  // setters:
+  void setFrameRate(double framesPerSecond);
+  void setFrameBudget(double milliseconds);
+  
+  // non-property methods:
+  void resetStatistics();
+  
+signals:
+  void frameFinished(int replotCount, double frameTime);
+  void budgetMissed(double frameTime, int deferredCount);
+  
+protected:
+  struct Request
+  {
+    QPointer<QCustomPlot> plot;
+    int waitedFrames;
+  };
+  
+  // property members:
+  double mFrameRate;
+  double mFrameBudget;
+  
+  // non-property members:
+  QList<QPointer<QCustomPlot> > mPlots;
+  QList<Request> mPending;
+  QList<QPointer<QCustomPlot> > mHidden;
+  QTimer *mFrameTimer;
+  QElapsedTimer mFrameClock;
+  int mFrameCount, mMissedFrameCount, mDeferredReplotCount, mSkippedReplotCount;
+  double mLastFrameTime, mMaxFrameTime, mTotalFrameTime;
+  
+  // reimplemented virtual methods:
+  virtual bool eventFilter(QObject *object, QEvent *event) Q_DECL_OVERRIDE;
+  
+  // non-virtual methods:
+  void registerPlot(QCustomPlot *plot);
+  void unregisterPlot(QCustomPlot *plot);
+  void requestReplot(QCustomPlot *plot);
+  void scheduleFrame();
+  double effectiveFrameBudget() const;
+  bool isPlotExposed(QCustomPlot *plot) const;
+  Q_SLOT void processFrame();
+  
+private:
+  Q_DISABLE_COPY(QCPReplotScheduler)
+  
+  friend class QCustomPlot;
+};
+
+/* end of 'src/replotscheduler.h' */
+
+
 /* including file 'src/plottable1d.h', size 4544                             */
 /* commit ce344b3f96a62e5f652585e55f1ae7c7883cd45b 2018-06-25 01:03:39 +0200 */
 
@@ -3895,11 +5995,21 @@ public:
   
   // reimplemented virtual methods:
   virtual double selectTest(const QPointF &pos, bool onlySelectable, QVariant *details=0) const Q_DECL_OVERRIDE;
+  virtual quint64 contentRevision() const Q_DECL_OVERRIDE;
   virtual QCPPlottableInterface1D *interface1D() Q_DECL_OVERRIDE { return this; }
+  virtual qint64 memoryUsage(qint64 *reclaimableBytes=0) const Q_DECL_OVERRIDE;
+  virtual void releaseMemory() Q_DECL_OVERRIDE;
+  
+  // non-virtual methods:
+  QSharedPointer<QCPDataIngestChannel<DataType> > ingestChannel();
   
 protected:
   // property members:
   QSharedPointer<QCPDataContainer<DataType> > mDataContainer;
+  QSharedPointer<QCPDataIngestChannel<DataType> > mIngestChannel;
+  
+  // reimplemented virtual methods:
+  virtual void drainIngestChannel() Q_DECL_OVERRIDE;
   
   // helpers for subclasses:
   void getDataSegments(QList<QCPDataRange> &selectedSegments, QList<QCPDataRange> &unselectedSegments) const;
@@ -4112,6 +6222,40 @@ QCPAbstractPlottable1D<DataType>::~QCPAbstractPlottable1D()
 {
 }
 
+/*!
+  Returns the ingest channel of this plottable, creating it on first use.
+  
+  Threads other than the GUI thread must not modify the data container of a plottable directly.
+  Instead, they can keep a copy of the returned shared pointer and push batches of data points
+  into it with \ref QCPDataIngestChannel::push, which never blocks. All pending batches are merged
+  into this plottable's data container at the beginning of the next \ref QCustomPlot::replot,
+  right after the \ref QCustomPlot::beforeReplot signal. To make the new data appear, a producer
+  thread can request a replot with <tt>QMetaObject::invokeMethod(plot, "replot",
+  Qt::QueuedConnection)</tt>, or the GUI thread replots periodically.
+  
+  The ingest channel itself must be obtained in the GUI thread (i.e. call this method before
+  handing the pointer to producer threads). It stays valid even after the plottable was deleted.
+*/
+template <class DataType>
+QSharedPointer<QCPDataIngestChannel<DataType> > QCPAbstractPlottable1D<DataType>::ingestChannel()
+{
+  if (!mIngestChannel)
+    mIngestChannel = QSharedPointer<QCPDataIngestChannel<DataType> >(new QCPDataIngestChannel<DataType>);
+  return mIngestChannel;
+}
+
+/*! \internal
+  
+  Merges the batches pending in the ingest channel (if one was created with \ref ingestChannel)
+  into the data container. Called by \ref QCustomPlot::replot.
+*/
+template <class DataType>
+void QCPAbstractPlottable1D<DataType>::drainIngestChannel()
+{
+  if (mIngestChannel)
+    mIngestChannel->drainInto(mDataContainer.data());
+}
+
 /*!
   \copydoc QCPPlottableInterface1D::dataCount
 */
@@ -4344,6 +6488,39 @@ double QCPAbstractPlottable1D<DataType>::selectTest(const QPointF &pos, bool onl
   return qSqrt(minDistSqr);
 }
 
+/*!
+  Adds the revision of the data container (\ref QCPDataContainer::revision) to the base class
+  revision, so modifications of the data are detected without calling \ref markLayerDirty.
+  
+  \seebaseclassmethod
+*/
+template <class DataType>
+quint64 QCPAbstractPlottable1D<DataType>::contentRevision() const
+{
+  return QCPAbstractPlottable::contentRevision() + mDataContainer->revision();
+}
+
+/*!
+  Returns the memory used by the data container of this plottable, see \ref
+  QCPDataContainer::memoryUsage.
+*/
+template <class DataType>
+qint64 QCPAbstractPlottable1D<DataType>::memoryUsage(qint64 *reclaimableBytes) const
+{
+  return mDataContainer->memoryUsage(reclaimableBytes);
+}
+
+/*!
+  Squeezes the data container of this plottable and frees its snapshot copy, see \ref
+  QCPDataContainer::squeeze and \ref QCPDataContainer::releaseSnapshot.
+*/
+template <class DataType>
+void QCPAbstractPlottable1D<DataType>::releaseMemory()
+{
+  mDataContainer->squeeze(true, true);
+  mDataContainer->releaseSnapshot();
+}
+
 /*!
   Splits all data into selected and unselected segments and outputs them via \a selectedSegments
   and \a unselectedSegments, respectively.
@@ -4471,6 +6648,15 @@ public:
                       };
   Q_ENUMS(GradientPreset)
   
+  /*!
+    Defines the instruction set extensions that \ref colorize may use, see \ref setSimdLevel.
+  */
+  enum SimdLevel { slNone   ///< Only the scalar loops are used
+                   ,slSse41 ///< Kernels using SSE4.1, processing four cells at once
+                   ,slAvx2  ///< Kernels using AVX2, processing eight cells at once and looking up the colors with gather instructions
+                 };
+  Q_ENUMS(SimdLevel)
+  
   QCPColorGradient();
   QCPColorGradient(GradientPreset preset);
   bool operator==(const QCPColorGradient &other) const;
@@ -4492,10 +6678,19 @@ public:
   // non-property methods:
   void colorize(const double *data, const QCPRange &range, QRgb *scanLine, int n, int dataIndexFactor=1, bool logarithmic=false);
   void colorize(const double *data, const unsigned char *alpha, const QCPRange &range, QRgb *scanLine, int n, int dataIndexFactor=1, bool logarithmic=false);
+  void colorize(const float *data, const QCPRange &range, QRgb *scanLine, int n, int dataIndexFactor=1, bool logarithmic=false);
+  void colorize(const float *data, const unsigned char *alpha, const QCPRange &range, QRgb *scanLine, int n, int dataIndexFactor=1, bool logarithmic=false);
+  void colorize(const quint16 *data, double scale, double offset, const QCPRange &range, QRgb *scanLine, int n, int dataIndexFactor=1, bool logarithmic=false);
+  void colorize(const quint16 *data, double scale, double offset, const unsigned char *alpha, const QCPRange &range, QRgb *scanLine, int n, int dataIndexFactor=1, bool logarithmic=false);
   QRgb color(double position, const QCPRange &range, bool logarithmic=false);
   void loadPreset(GradientPreset preset);
   void clearColorStops();
   QCPColorGradient inverted() const;
+  QByteArray cacheKey() const;
+  
+  static SimdLevel supportedSimdLevel();
+  static SimdLevel simdLevel();
+  static void setSimdLevel(SimdLevel level);
   
 protected:
   // property members:
@@ -4511,10 +6706,38 @@ protected:
   // non-virtual methods:
   bool stopsUseAlpha() const;
   void updateColorBuffer();
+  template <typename CellValueType, bool scaled, bool useAlpha>
+  void colorizeCells(const CellValueType *data, double scale, double offset, const unsigned char *alpha, const QCPRange &range, QRgb *scanLine, int n, int dataIndexFactor, bool logarithmic);
+  
+  friend class QCPColorMap;
+  friend class QCPTiledColorMap;
 };
 Q_DECLARE_METATYPE(QCPColorGradient::ColorInterpolation)
 Q_DECLARE_METATYPE(QCPColorGradient::GradientPreset)
 
+
+class QCPColorGradientCache
+{
+public:
+  QCPColorGradientCache();
+  static QCPColorGradientCache *instance();
+  
+  // non-property methods:
+  bool findColorBuffer(const QByteArray &key, QVector<QRgb> *colorBuffer);
+  void insertColorBuffer(const QByteArray &key, const QVector<QRgb> &colorBuffer);
+  bool findImage(const QByteArray &key, QImage *image);
+  void insertImage(const QByteArray &key, const QImage &image);
+  void clear();
+  
+protected:
+  QMutex mMutex;
+  QCache<QByteArray, QVector<QRgb> > mColorBuffers;
+  QCache<QByteArray, QImage> mImages;
+  
+private:
+  Q_DISABLE_COPY(QCPColorGradientCache)
+};
+
 /* end of 'src/colorgradient.h' */
 
 
@@ -4599,6 +6822,7 @@ class QCP_LIB_DECL QCPAxisRect : public QCPLayoutElement
   Q_PROPERTY(Qt::AspectRatioMode backgroundScaledMode READ backgroundScaledMode WRITE setBackgroundScaledMode)
   Q_PROPERTY(Qt::Orientations rangeDrag READ rangeDrag WRITE setRangeDrag)
   Q_PROPERTY(Qt::Orientations rangeZoom READ rangeZoom WRITE setRangeZoom)
+  Q_PROPERTY(bool rangeDragFastPan READ rangeDragFastPan WRITE setRangeDragFastPan)
   /// \endcond
 public:
   explicit QCPAxisRect(QCustomPlot *parentPlot, bool setupDefaultAxes=true);
@@ -4611,6 +6835,7 @@ public:
   Qt::AspectRatioMode backgroundScaledMode() const { return mBackgroundScaledMode; }
   Qt::Orientations rangeDrag() const { return mRangeDrag; }
   Qt::Orientations rangeZoom() const { return mRangeZoom; }
+  bool rangeDragFastPan() const { return mRangeDragFastPan; }
   QCPAxis *rangeDragAxis(Qt::Orientation orientation);
   QCPAxis *rangeZoomAxis(Qt::Orientation orientation);
   QList<QCPAxis*> rangeDragAxes(Qt::Orientation orientation);
@@ -4625,6 +6850,7 @@ public:
   void setBackgroundScaledMode(Qt::AspectRatioMode mode);
   void setRangeDrag(Qt::Orientations orientations);
   void setRangeZoom(Qt::Orientations orientations);
+  void setRangeDragFastPan(bool enabled);
   void setRangeDragAxes(QCPAxis *horizontal, QCPAxis *vertical);
   void setRangeDragAxes(QList<QCPAxis*> axes);
   void setRangeDragAxes(QList<QCPAxis*> horizontal, QList<QCPAxis*> vertical);
@@ -4681,6 +6907,7 @@ protected:
   QList<QPointer<QCPAxis> > mRangeDragHorzAxis, mRangeDragVertAxis;
   QList<QPointer<QCPAxis> > mRangeZoomHorzAxis, mRangeZoomVertAxis;
   double mRangeZoomFactorHorz, mRangeZoomFactorVert;
+  bool mRangeDragFastPan;
   
   // non-property members:
   QList<QCPRange> mDragStartHorzRange, mDragStartVertRange;
@@ -4702,6 +6929,7 @@ protected:
   // non-property methods:
   void drawBackground(QCPPainter *painter);
   void updateAxesOffset(QCPAxis::AxisType type);
+  bool uniformPixelShift(const QVector<double> &shifts, int &shift) const;
   
 private:
   Q_DISABLE_COPY(QCPAxisRect)
@@ -4789,6 +7017,9 @@ public:
   // getters:
   QCPAbstractPlottable *plottable() { return mPlottable; }
   
+  // reimplemented virtual methods:
+  virtual quint64 contentRevision() const Q_DECL_OVERRIDE;
+  
 protected:
   // property members:
   QCPAbstractPlottable *mPlottable;
@@ -5160,6 +7391,8 @@ Q_DECLARE_TYPEINFO(QCPGraphData, Q_PRIMITIVE_TYPE);
 */
 typedef QCPDataContainer<QCPGraphData> QCPGraphDataContainer;
 
+class QCPGraphRefinement;
+
 class QCP_LIB_DECL QCPGraph : public QCPAbstractPlottable1D<QCPGraphData>
 {
   Q_OBJECT
@@ -5169,6 +7402,7 @@ class QCP_LIB_DECL QCPGraph : public QCPAbstractPlottable1D<QCPGraphData>
   Q_PROPERTY(int scatterSkip READ scatterSkip WRITE setScatterSkip)
   Q_PROPERTY(QCPGraph* channelFillGraph READ channelFillGraph WRITE setChannelFillGraph)
   Q_PROPERTY(bool adaptiveSampling READ adaptiveSampling WRITE setAdaptiveSampling)
+  Q_PROPERTY(int progressiveThreshold READ progressiveThreshold WRITE setProgressiveThreshold)
   /// \endcond
 public:
   /*!
@@ -5196,6 +7430,8 @@ public:
   int scatterSkip() const { return mScatterSkip; }
   QCPGraph *channelFillGraph() const { return mChannelFillGraph.data(); }
   bool adaptiveSampling() const { return mAdaptiveSampling; }
+  int progressiveThreshold() const { return mProgressiveThreshold; }
+  bool isRefining() const { return !mRefinement.isNull(); }
   
   // setters:
   void setData(QSharedPointer<QCPGraphDataContainer> data);
@@ -5205,15 +7441,23 @@ public:
   void setScatterSkip(int skip);
   void setChannelFillGraph(QCPGraph *targetGraph);
   void setAdaptiveSampling(bool enabled);
+  void setProgressiveThreshold(int dataCount);
   
   // non-property methods:
   void addData(const QVector<double> &keys, const QVector<double> &values, bool alreadySorted=false);
   void addData(double key, double value);
+  void cancelRefinement();
   
   // reimplemented virtual methods:
   virtual double selectTest(const QPointF &pos, bool onlySelectable, QVariant *details=0) const Q_DECL_OVERRIDE;
+  virtual quint64 contentRevision() const Q_DECL_OVERRIDE;
   virtual QCPRange getKeyRange(bool &foundRange, QCP::SignDomain inSignDomain=QCP::sdBoth) const Q_DECL_OVERRIDE;
   virtual QCPRange getValueRange(bool &foundRange, QCP::SignDomain inSignDomain=QCP::sdBoth, const QCPRange &inKeyRange=QCPRange()) const Q_DECL_OVERRIDE;
+  virtual qint64 memoryUsage(qint64 *reclaimableBytes=0) const Q_DECL_OVERRIDE;
+  virtual void releaseMemory() Q_DECL_OVERRIDE;
+  
+signals:
+  void refinementProgress(double progress);
   
 protected:
   // property members:
@@ -5222,8 +7466,13 @@ protected:
   int mScatterSkip;
   QPointer<QCPGraph> mChannelFillGraph;
   bool mAdaptiveSampling;
+  int mProgressiveThreshold;
+  
+  // non-property members:
+  QSharedPointer<QCPGraphRefinement> mRefinement, mRefined;
   
   // reimplemented virtual methods:
+  virtual void prepareDraw() Q_DECL_OVERRIDE;
   virtual void draw(QCPPainter *painter) Q_DECL_OVERRIDE;
   virtual void drawLegendIcon(QCPPainter *painter, const QRectF &rect) const Q_DECL_OVERRIDE;
   
@@ -5240,17 +7489,25 @@ protected:
   void getVisibleDataBounds(QCPGraphDataContainer::const_iterator &begin, QCPGraphDataContainer::const_iterator &end, const QCPDataRange &rangeRestriction) const;
   void getLines(QVector<QPointF> *lines, const QCPDataRange &dataRange) const;
   void getScatters(QVector<QPointF> *scatters, const QCPDataRange &dataRange) const;
-  QVector<QPointF> dataToLines(const QVector<QCPGraphData> &data) const;
-  QVector<QPointF> dataToStepLeftLines(const QVector<QCPGraphData> &data) const;
-  QVector<QPointF> dataToStepRightLines(const QVector<QCPGraphData> &data) const;
-  QVector<QPointF> dataToStepCenterLines(const QVector<QCPGraphData> &data) const;
-  QVector<QPointF> dataToImpulseLines(const QVector<QCPGraphData> &data) const;
+  void linesFromData(QVector<QPointF> *lines, QVector<QCPGraphData> lineData) const;
+  void scattersFromData(QVector<QPointF> *scatters, QVector<QCPGraphData> data) const;
+  QCPDataRange getClipDataRange(const QRectF &clip) const;
+  void getDrawRanges(const QList<QCPDataRange> &segments, int firstSelectedSegment, const QCPDataRange &clipDataRange, QVector<QCPDataRange> &lineRanges, QVector<QCPDataRange> &scatterRanges) const;
+  bool getProgressiveRanges(QVector<QCPDataRange> &lineRanges, QVector<QCPDataRange> &scatterRanges) const;
+  QSharedPointer<QCPGraphRefinement> createRefinement(const QVector<QCPDataRange> &lineRanges, const QVector<QCPDataRange> &scatterRanges) const;
+  QVector<QCPGraphData> getPreviewData(const QCPDataRange &dataRange, int sampleCount) const;
+  Q_SLOT void refinementUpdated();
+  void dataToLines(const QVector<QCPGraphData> &data, QVector<QPointF> *lines) const;
+  void dataToStepLeftLines(const QVector<QCPGraphData> &data, QVector<QPointF> *lines) const;
+  void dataToStepRightLines(const QVector<QCPGraphData> &data, QVector<QPointF> *lines) const;
+  void dataToStepCenterLines(const QVector<QCPGraphData> &data, QVector<QPointF> *lines) const;
+  void dataToImpulseLines(const QVector<QCPGraphData> &data, QVector<QPointF> *lines) const;
   QVector<QCPDataRange> getNonNanSegments(const QVector<QPointF> *lineData, Qt::Orientation keyOrientation) const;
   QVector<QPair<QCPDataRange, QCPDataRange> > getOverlappingSegments(QVector<QCPDataRange> thisSegments, const QVector<QPointF> *thisData, QVector<QCPDataRange> otherSegments, const QVector<QPointF> *otherData) const;
   bool segmentsIntersect(double aLower, double aUpper, double bLower, double bUpper, int &bPrecedence) const;
   QPointF getFillBasePoint(QPointF matchingDataPoint) const;
-  const QPolygonF getFillPolygon(const QVector<QPointF> *lineData, QCPDataRange segment) const;
-  const QPolygonF getChannelFillPolygon(const QVector<QPointF> *lineData, QCPDataRange thisSegment, const QVector<QPointF> *otherData, QCPDataRange otherSegment) const;
+  void getFillPolygon(QVector<QPointF> *polygon, const QVector<QPointF> *lineData, QCPDataRange segment) const;
+  void getChannelFillPolygon(QVector<QPointF> *polygon, const QVector<QPointF> *thisData, QCPDataRange thisSegment, const QVector<QPointF> *otherData, QCPDataRange otherSegment) const;
   int findIndexBelowX(const QVector<QPointF> *data, double x) const;
   int findIndexAboveX(const QVector<QPointF> *data, double x) const;
   int findIndexBelowY(const QVector<QPointF> *data, double y) const;
@@ -5435,6 +7692,7 @@ protected:
   // non-virtual methods:
   void registerBars(QCPBars *bars);
   void unregisterBars(QCPBars *bars);
+  void markBarsDirty();
   
   // virtual methods:
   double keyPixelOffset(const QCPBars *bars, double keyCoord);
@@ -5535,6 +7793,7 @@ public:
   // reimplemented virtual methods:
   virtual QCPDataSelection selectTestRect(const QRectF &rect, bool onlySelectable) const Q_DECL_OVERRIDE;
   virtual double selectTest(const QPointF &pos, bool onlySelectable, QVariant *details=0) const Q_DECL_OVERRIDE;
+  virtual quint64 contentRevision() const Q_DECL_OVERRIDE;
   virtual QCPRange getKeyRange(bool &foundRange, QCP::SignDomain inSignDomain=QCP::sdBoth) const Q_DECL_OVERRIDE;
   virtual QCPRange getValueRange(bool &foundRange, QCP::SignDomain inSignDomain=QCP::sdBoth, const QCPRange &inKeyRange=QCPRange()) const Q_DECL_OVERRIDE;
   virtual QPointF dataPixelPosition(int index) const Q_DECL_OVERRIDE;
@@ -5691,6 +7950,14 @@ protected:
 class QCP_LIB_DECL QCPColorMapData
 {
 public:
+  /*!
+    Defines the type in which the cells of a \ref QCPColorMapData are stored, see \ref setCellType.
+  */
+  enum CellType { ctDouble  ///< 64 bit floating point (the default)
+                  ,ctFloat  ///< 32 bit floating point, halves the memory footprint at a precision of about 7 significant digits
+                  ,ctUInt16 ///< 16 bit unsigned integer, the cell value is <tt>raw*scale + offset</tt> (see \ref setUInt16Scaling)
+                };
+  
   QCPColorMapData(int keySize, int valueSize, const QCPRange &keyRange, const QCPRange &valueRange);
   ~QCPColorMapData();
   QCPColorMapData(const QCPColorMapData &other);
@@ -5702,6 +7969,10 @@ public:
   QCPRange keyRange() const { return mKeyRange; }
   QCPRange valueRange() const { return mValueRange; }
   QCPRange dataBounds() const { return mDataBounds; }
+  CellType cellType() const { return mCellType; }
+  double uInt16Scale() const { return mUInt16Scale; }
+  double uInt16Offset() const { return mUInt16Offset; }
+  bool ignoreNaN() const { return mIgnoreNaN; }
   double data(double key, double value);
   double cell(int keyIndex, int valueIndex);
   unsigned char alpha(int keyIndex, int valueIndex);
@@ -5716,32 +7987,64 @@ public:
   void setData(double key, double value, double z);
   void setCell(int keyIndex, int valueIndex, double z);
   void setAlpha(int keyIndex, int valueIndex, unsigned char alpha);
+  void setCellType(CellType type);
+  void setUInt16Scaling(double scale, double offset);
+  void setIgnoreNaN(bool enabled);
   
   // non-property methods:
+  void setRawCells(const double *cells);
+  void setRawCells(const float *cells);
+  void setRawCells(const quint16 *cells);
   void recalculateDataBounds();
   void clear();
   void clearAlpha();
   void fill(double z);
   void fillAlpha(unsigned char alpha);
+  void appendRow(const double *values);
   bool isEmpty() const { return mIsEmpty; }
   void coordToCell(double key, double value, int *keyIndex, int *valueIndex) const;
   void cellToCoord(int keyIndex, int valueIndex, double *key, double *value) const;
+  qint64 memoryUsage() const;
   
 protected:
   // property members:
   int mKeySize, mValueSize;
   QCPRange mKeyRange, mValueRange;
   bool mIsEmpty;
+  CellType mCellType;
+  double mUInt16Scale, mUInt16Offset;
+  bool mIgnoreNaN;
   
   // non-property members:
-  double *mData;
+  double *mData; // cell storage if mCellType is ctDouble, otherwise 0
+  float *mFloatData; // cell storage if mCellType is ctFloat, otherwise 0
+  quint16 *mUInt16Data; // cell storage if mCellType is ctUInt16, otherwise 0
   unsigned char *mAlpha;
   QCPRange mDataBounds;
+  bool mDataBoundsExact; // whether mDataBounds are known to be the true bounds, so recalculateDataBounds can skip the scan
   bool mDataModified;
+  QRect mDirtyCells; // bounding rect of the cells modified since the last map image update (x is the key index, y is the value index)
+  int mKeyIndexOffset; // storage position of key index 0, advanced by appendRow
+  quint32 mRevision; // incremented whenever cell values change, so derived data (e.g. contours) can detect that it's outdated
+  quint32 mDisplayRevision; // incremented whenever the alpha map or the covered ranges change, which affects the drawn map but not the cell values
   
   bool createAlpha(bool initializeOpaque=true);
+  bool allocateCells();
+  void freeCells();
+  double storedCell(int index) const;
+  void storeCell(int index, double z);
+  void updateDataBounds(double oldZ, double newZ);
+  void setEmptyDataBounds();
+  template <typename CellValueType>
+  void copyRawCells(CellType type, CellValueType *storage, const CellValueType *cells);
+  template <typename CellValueType>
+  bool cellBounds(const CellValueType *cells, CellValueType &minValue, CellValueType &maxValue, bool &hasNaN) const;
+  int storageKeyIndex(int keyIndex) const { const int index = keyIndex+mKeyIndexOffset; return index < mKeySize ? index : index-mKeySize; }
   
   friend class QCPColorMap;
+  friend class QCPColorMapColorizeFunctor;
+  friend class QCPColorMapContours;
+  friend class QCPColorMapContourBandFunctor;
 };
 
 
@@ -5784,8 +8087,11 @@ public:
   
   // reimplemented virtual methods:
   virtual double selectTest(const QPointF &pos, bool onlySelectable, QVariant *details=0) const Q_DECL_OVERRIDE;
+  virtual quint64 contentRevision() const Q_DECL_OVERRIDE;
   virtual QCPRange getKeyRange(bool &foundRange, QCP::SignDomain inSignDomain=QCP::sdBoth) const Q_DECL_OVERRIDE;
   virtual QCPRange getValueRange(bool &foundRange, QCP::SignDomain inSignDomain=QCP::sdBoth, const QCPRange &inKeyRange=QCPRange()) const Q_DECL_OVERRIDE;
+  virtual qint64 memoryUsage(qint64 *reclaimableBytes=0) const Q_DECL_OVERRIDE;
+  virtual void releaseMemory() Q_DECL_OVERRIDE;
   
 signals:
   void dataRangeChanged(const QCPRange &newRange);
@@ -5806,6 +8112,7 @@ protected:
   QImage mMapImage, mUndersampledMapImage;
   QPixmap mLegendIcon;
   bool mMapImageInvalidated;
+  bool mMapImageTransposed;
   
   // introduced virtual methods:
   virtual void updateMapImage();
@@ -5814,6 +8121,10 @@ protected:
   virtual void draw(QCPPainter *painter) Q_DECL_OVERRIDE;
   virtual void drawLegendIcon(QCPPainter *painter, const QRectF &rect) const Q_DECL_OVERRIDE;
   
+  // non-virtual methods:
+  void drawWrappedMapImage(QPainter *painter, const QRectF &targetRect, bool mirrorX, bool mirrorY) const;
+  void drawResampledMapImage(QCPPainter *painter, const QRectF &imageRect, bool mirrorX, bool mirrorY) const;
+  
   friend class QCustomPlot;
   friend class QCPLegend;
 };
@@ -5821,6 +8132,229 @@ protected:
 /* end of 'src/plottables/plottable-colormap.h' */
 
 
+/* including file 'src/plottables/plottable-tiledcolormap.h'                */
+
+class QCP_LIB_DECL QCPColorMapTileSource
+{
+public:
+  QCPColorMapTileSource();
+  virtual ~QCPColorMapTileSource();
+  
+  // introduced virtual methods:
+  virtual int keySize() const = 0;
+  virtual int valueSize() const = 0;
+  virtual void readCells(int keyIndex, int valueIndex, int keyCount, int valueCount, int step, double *target) const = 0;
+  
+private:
+  Q_DISABLE_COPY(QCPColorMapTileSource)
+};
+
+
+class QCP_LIB_DECL QCPColorMapDataTileSource : public QCPColorMapTileSource
+{
+public:
+  explicit QCPColorMapDataTileSource(QCPColorMapData *data);
+  
+  // reimplemented virtual methods:
+  virtual int keySize() const Q_DECL_OVERRIDE { return mData->keySize(); }
+  virtual int valueSize() const Q_DECL_OVERRIDE { return mData->valueSize(); }
+  virtual void readCells(int keyIndex, int valueIndex, int keyCount, int valueCount, int step, double *target) const Q_DECL_OVERRIDE;
+  
+protected:
+  QCPColorMapData *mData;
+};
+
+
+class QCP_LIB_DECL QCPColorMapFileTileSource : public QCPColorMapTileSource
+{
+public:
+  /*!
+    Defines the binary type of the cells stored in the file of a \ref QCPColorMapFileTileSource.
+  */
+  enum CellType { ctDouble  ///< 64 bit floating point
+                  ,ctFloat  ///< 32 bit floating point
+                  ,ctInt16  ///< 16 bit signed integer
+                  ,ctUInt16 ///< 16 bit unsigned integer
+                };
+  
+  QCPColorMapFileTileSource(const QString &fileName, int keySize, int valueSize, CellType cellType=ctDouble, qint64 headerSize=0);
+  virtual ~QCPColorMapFileTileSource();
+  
+  // getters:
+  QString fileName() const { return mFile.fileName(); }
+  CellType cellType() const { return mCellType; }
+  bool isValid() const { return mCells != 0; }
+  
+  // reimplemented virtual methods:
+  virtual int keySize() const Q_DECL_OVERRIDE { return mKeySize; }
+  virtual int valueSize() const Q_DECL_OVERRIDE { return mValueSize; }
+  virtual void readCells(int keyIndex, int valueIndex, int keyCount, int valueCount, int step, double *target) const Q_DECL_OVERRIDE;
+  
+protected:
+  QFile mFile;
+  int mKeySize, mValueSize;
+  CellType mCellType;
+  const uchar *mCells;
+  
+  template <typename CellValueType>
+  void readTypedCells(int keyIndex, int valueIndex, int keyCount, int valueCount, int step, double *target) const;
+};
+
+
+class QCP_LIB_DECL QCPTiledColorMap : public QCPAbstractPlottable
+{
+  Q_OBJECT
+  /// \cond INCLUDE_QPROPERTIES
+  Q_PROPERTY(QCPRange keyRange READ keyRange WRITE setKeyRange)
+  Q_PROPERTY(QCPRange valueRange READ valueRange WRITE setValueRange)
+  Q_PROPERTY(QCPRange dataRange READ dataRange WRITE setDataRange NOTIFY dataRangeChanged)
+  Q_PROPERTY(QCPAxis::ScaleType dataScaleType READ dataScaleType WRITE setDataScaleType NOTIFY dataScaleTypeChanged)
+  Q_PROPERTY(QCPColorGradient gradient READ gradient WRITE setGradient NOTIFY gradientChanged)
+  Q_PROPERTY(bool interpolate READ interpolate WRITE setInterpolate)
+  Q_PROPERTY(int tileSize READ tileSize WRITE setTileSize)
+  Q_PROPERTY(int cacheSize READ cacheSize WRITE setCacheSize)
+  /// \endcond
+public:
+  explicit QCPTiledColorMap(QCPAxis *keyAxis, QCPAxis *valueAxis);
+  virtual ~QCPTiledColorMap();
+  
+  // getters:
+  QCPColorMapTileSource *source() const { return mSource; }
+  QCPRange keyRange() const { return mKeyRange; }
+  QCPRange valueRange() const { return mValueRange; }
+  QCPRange dataRange() const { return mDataRange; }
+  QCPAxis::ScaleType dataScaleType() const { return mDataScaleType; }
+  QCPColorGradient gradient() const { return mGradient; }
+  bool interpolate() const { return mInterpolate; }
+  int tileSize() const { return mTileSize; }
+  int cacheSize() const { return mTileCache.maxCost()/1024; }
+  
+  // setters:
+  void setSource(QCPColorMapTileSource *source);
+  void setKeyRange(const QCPRange &keyRange);
+  void setValueRange(const QCPRange &valueRange);
+  Q_SLOT void setDataRange(const QCPRange &dataRange);
+  Q_SLOT void setDataScaleType(QCPAxis::ScaleType scaleType);
+  Q_SLOT void setGradient(const QCPColorGradient &gradient);
+  void setInterpolate(bool enabled);
+  void setTileSize(int size);
+  void setCacheSize(int megabytes);
+  
+  // non-property methods:
+  void invalidateTiles();
+  
+  // reimplemented virtual methods:
+  virtual double selectTest(const QPointF &pos, bool onlySelectable, QVariant *details=0) const Q_DECL_OVERRIDE;
+  virtual QCPRange getKeyRange(bool &foundRange, QCP::SignDomain inSignDomain=QCP::sdBoth) const Q_DECL_OVERRIDE;
+  virtual QCPRange getValueRange(bool &foundRange, QCP::SignDomain inSignDomain=QCP::sdBoth, const QCPRange &inKeyRange=QCPRange()) const Q_DECL_OVERRIDE;
+  virtual qint64 memoryUsage(qint64 *reclaimableBytes=0) const Q_DECL_OVERRIDE;
+  virtual void releaseMemory() Q_DECL_OVERRIDE;
+  
+signals:
+  void dataRangeChanged(const QCPRange &newRange);
+  void dataScaleTypeChanged(QCPAxis::ScaleType scaleType);
+  void gradientChanged(const QCPColorGradient &newGradient);
+  
+protected:
+  // property members:
+  QCPColorMapTileSource *mSource;
+  QCPRange mKeyRange, mValueRange;
+  QCPRange mDataRange;
+  QCPAxis::ScaleType mDataScaleType;
+  QCPColorGradient mGradient;
+  bool mInterpolate;
+  int mTileSize;
+  
+  // non-property members:
+  QCache<quint64, QImage> mTileCache;
+  
+  // reimplemented virtual methods:
+  virtual void draw(QCPPainter *painter) Q_DECL_OVERRIDE;
+  virtual void drawLegendIcon(QCPPainter *painter, const QRectF &rect) const Q_DECL_OVERRIDE;
+  
+  // non-virtual methods:
+  int mipLevel(double cellsPerPixel) const;
+  quint64 tileCacheKey(int level, int keyTile, int valueTile) const;
+  QImage createTile(int level, int keyTile, int valueTile);
+  QPointF cellEdgeToPixel(int keyIndex, int valueIndex) const;
+  
+  friend class QCustomPlot;
+  friend class QCPLegend;
+  friend class QCPTiledColorMapTileFunctor;
+};
+
+/* end of 'src/plottables/plottable-tiledcolormap.h' */
+
+
+/* including file 'src/plottables/plottable-colormapcontours.h'             */
+
+class QCP_LIB_DECL QCPColorMapContours : public QCPAbstractPlottable
+{
+  Q_OBJECT
+  /// \cond INCLUDE_QPROPERTIES
+  Q_PROPERTY(QCPColorMap* colorMap READ colorMap WRITE setColorMap)
+  Q_PROPERTY(QVector<double> levels READ levels WRITE setLevels)
+  /// \endcond
+public:
+  explicit QCPColorMapContours(QCPAxis *keyAxis, QCPAxis *valueAxis);
+  virtual ~QCPColorMapContours();
+  
+  // getters:
+  QCPColorMap *colorMap() const { return mColorMap.data(); }
+  QVector<double> levels() const { return mLevels; }
+  
+  // setters:
+  void setColorMap(QCPColorMap *colorMap);
+  void setLevels(const QVector<double> &levels);
+  
+  // non-property methods:
+  void setLevels(int count, const QCPRange &range);
+  void invalidateContours();
+  
+  // reimplemented virtual methods:
+  virtual double selectTest(const QPointF &pos, bool onlySelectable, QVariant *details=0) const Q_DECL_OVERRIDE;
+  virtual quint64 contentRevision() const Q_DECL_OVERRIDE;
+  virtual QCPRange getKeyRange(bool &foundRange, QCP::SignDomain inSignDomain=QCP::sdBoth) const Q_DECL_OVERRIDE;
+  virtual QCPRange getValueRange(bool &foundRange, QCP::SignDomain inSignDomain=QCP::sdBoth, const QCPRange &inKeyRange=QCPRange()) const Q_DECL_OVERRIDE;
+  virtual qint64 memoryUsage(qint64 *reclaimableBytes=0) const Q_DECL_OVERRIDE;
+  
+protected:
+  /*!
+    A part of a contour line, in cell index coordinates, with its bounding rect for culling.
+  */
+  struct ContourPiece
+  {
+    int level;
+    QPolygonF points;
+    QRectF bounds;
+  };
+  
+  // property members:
+  QPointer<QCPColorMap> mColorMap;
+  QVector<double> mLevels;
+  
+  // non-property members:
+  QVector<ContourPiece> mPieces;
+  bool mContoursInvalidated;
+  const QCPColorMapData *mContourData; // the data the contours were generated from, and its revision:
+  quint32 mContourRevision;
+  
+  // reimplemented virtual methods:
+  virtual void draw(QCPPainter *painter) Q_DECL_OVERRIDE;
+  virtual void drawLegendIcon(QCPPainter *painter, const QRectF &rect) const Q_DECL_OVERRIDE;
+  
+  // non-virtual methods:
+  void updateContours();
+  QPointF cellToPixel(const QPointF &cell, const QCPColorMapData *data) const;
+  
+  friend class QCustomPlot;
+  friend class QCPLegend;
+  friend class QCPColorMapContourStitchFunctor;
+};
+
+/* end of 'src/plottables/plottable-colormapcontours.h' */
+
+
 /* including file 'src/plottables/plottable-financial.h', size 8622          */
 /* commit ce344b3f96a62e5f652585e55f1ae7c7883cd45b 2018-06-25 01:03:39 +0200 */
 
@@ -6053,7 +8587,10 @@ public:
   
   // reimplemented virtual methods:
   virtual double selectTest(const QPointF &pos, bool onlySelectable, QVariant *details=0) const Q_DECL_OVERRIDE;
+  virtual quint64 contentRevision() const Q_DECL_OVERRIDE;
   virtual QCPPlottableInterface1D *interface1D() Q_DECL_OVERRIDE { return this; }
+  virtual qint64 memoryUsage(qint64 *reclaimableBytes=0) const Q_DECL_OVERRIDE;
+  virtual void releaseMemory() Q_DECL_OVERRIDE;
   
 protected:
   // property members:
@@ -6481,6 +9018,7 @@ public:
   
   // reimplemented virtual methods:
   virtual double selectTest(const QPointF &pos, bool onlySelectable, QVariant *details=0) const Q_DECL_OVERRIDE;
+  virtual qint64 memoryUsage() const Q_DECL_OVERRIDE;
   
   QCPItemPosition * const topLeft;
   QCPItemPosition * const bottomRight;
@@ -6574,6 +9112,7 @@ public:
 
   // reimplemented virtual methods:
   virtual double selectTest(const QPointF &pos, bool onlySelectable, QVariant *details=0) const Q_DECL_OVERRIDE;
+  virtual quint64 contentRevision() const Q_DECL_OVERRIDE;
   
   // non-virtual methods:
   void updatePosition();
@@ -1,4 +1,8 @@
 TEMPLATE = subdirs
 
 SUBDIRS += \
-    crossline
+    crossline \
+    removebenchmark \
+    colorizebenchmark \
+    allocbenchmark \
+    checks
@@ -0,0 +1,86 @@
+#include "../lib/qcustomplot.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+
+// Removes 10k key ranges from a graph data container of 1M points, once with one call of
+// QCPDataContainer::remove(sortKeyFrom, sortKeyTo) per range, once with the batch overload
+// QCPDataContainer::remove(const QVector<QCPRange>&) and once with QCPDataContainer::removeIf.
+// All three must leave the same data points. Returns 1 if they don't.
+
+namespace
+{
+	const int DataCount = 1000000;
+	const int RangeCount = 10000;
+	const int RangeStride = DataCount / RangeCount;
+	const int RangeWidth = 10;
+
+	QSharedPointer<QCPGraphDataContainer> createData()
+	{
+		QVector<QCPGraphData> data(DataCount);
+		for (int i = 0; i < DataCount; ++i)
+			data[i] = QCPGraphData(i, qSin(i / 100.0));
+		QSharedPointer<QCPGraphDataContainer> container(new QCPGraphDataContainer);
+		container->set(data, true);
+		return container;
+	}
+
+	bool equalKeys(const QCPGraphDataContainer& a, const QCPGraphDataContainer& b)
+	{
+		if (a.size() != b.size())
+			return false;
+		for (QCPGraphDataContainer::const_iterator itA = a.constBegin(), itB = b.constBegin(); itA != a.constEnd(); ++itA, ++itB)
+		{
+			if (itA->key != itB->key)
+				return false;
+		}
+		return true;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	QCoreApplication a(argc, argv);
+
+	QVector<QCPRange> ranges(RangeCount);
+	for (int i = 0; i < RangeCount; ++i)
+		ranges[i] = QCPRange(i * RangeStride, i * RangeStride + RangeWidth - 1);
+
+	QSharedPointer<QCPGraphDataContainer> single = createData();
+	QElapsedTimer timer;
+	timer.start();
+	for (int i = 0; i < RangeCount; ++i)
+		single->remove(ranges.at(i).lower, ranges.at(i).upper);
+	const qint64 singleTime = timer.nsecsElapsed();
+
+	QSharedPointer<QCPGraphDataContainer> batch = createData();
+	timer.restart();
+	batch->remove(ranges);
+	const qint64 batchTime = timer.nsecsElapsed();
+
+	QSharedPointer<QCPGraphDataContainer> predicate = createData();
+	int predicateCalls = 0;
+	timer.restart();
+	predicate->removeIf([&predicateCalls](const QCPGraphData& data)
+	{
+		++predicateCalls;
+		return int(data.key) % RangeStride < RangeWidth;
+	});
+	const qint64 predicateTime = timer.nsecsElapsed();
+
+	qDebug("remove(from, to) x %d: %8.2f ms", RangeCount, singleTime / 1e6);
+	qDebug("remove(ranges):          %8.2f ms (%.1fx)", batchTime / 1e6, singleTime / double(qMax(Q_INT64_C(1), batchTime)));
+	qDebug("removeIf(predicate):     %8.2f ms (%.1fx)", predicateTime / 1e6, singleTime / double(qMax(Q_INT64_C(1), predicateTime)));
+
+	if (single->size() != DataCount - RangeCount * RangeWidth || !equalKeys(*single, *batch) || !equalKeys(*single, *predicate))
+	{
+		qWarning("FAILED: the removal methods left different data points");
+		return 1;
+	}
+	if (predicateCalls != DataCount)
+	{
+		qWarning("FAILED: removeIf called the predicate %d times for %d data points", predicateCalls, DataCount);
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,17 @@
+#-------------------------------------------------
+#
+# Benchmark of batch range removal in QCPDataContainer
+#
+#-------------------------------------------------
+
+TARGET = removebenchmark
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle
+
+include(../common.pri)
+DESTDIR = $$PROJECT_BINDIR
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+SOURCES += main.cpp